@@ -0,0 +1,136 @@
+#include "ArmCartesian.h"
+#include "SystemCodes.h"
+
+namespace {
+const char  AXIS_NAMES[]    = "XYZP";
+const float GOAL_MM         = 0.5f;     // goal reached within this
+const float GOAL_DEG        = 0.5f;
+
+float* axis(ArmPose& p, uint8_t a) {
+    return a == 0 ? &p.x : a == 1 ? &p.y : a == 2 ? &p.z : &p.pitch;
+}
+}
+
+ArmCartesian::ArmCartesian(ServoController& servos, const ArmKinematics& kinematics)
+    : _servos(servos), _kin(kinematics) {}
+
+// ================================================================
+// COMMANDS
+// ================================================================
+FASTRUN bool ArmCartesian::command(const char* cmd) {
+    if (cmd[0] != 'J') return false;
+
+    if (cmd[1] == 'S') {
+        stop();
+    } else if (cmd[1] == 'G') {
+        ArmPose goal = {0, 0, 0, 0};
+        float   deg[ArmKinematics::JOINTS];
+        char*   end;
+        const char* p = cmd + 2;
+        for (uint8_t a = 0; a < AXES; a++) {
+            *axis(goal, a) = strtof(p, &end);
+            if (end == p) {
+                if (a < 3) return true;         // x, y and z are required
+                goal.pitch = active() ? _pose.pitch : _kin.forward(_servos.angles).pitch;
+                break;
+            }
+            p = *end == ',' ? end + 1 : end;
+        }
+        if (_kin.inverse(goal, deg) != ArmKinematics::OK) {
+            event(SAFE_ARM_LIMIT);
+            return true;
+        }
+        start();
+        for (uint8_t a = 0; a < AXES; a++) _jog[a] = 0;
+        _goal   = goal;
+        _toGoal = true;
+    } else {
+        const char* name = strchr(AXIS_NAMES, cmd[1]);
+        if (cmd[1] == '\0' || name == NULL) return true;
+        start();
+        _toGoal = false;
+        _jog[name - AXIS_NAMES] = cmd[2] == '+' ? 1 : cmd[2] == '-' ? -1 : 0;
+    }
+    return true;
+}
+
+FASTRUN void ArmCartesian::stop() {
+    _toGoal = false;
+    for (uint8_t a = 0; a < AXES; a++) _jog[a] = 0;
+}
+
+FASTRUN bool ArmCartesian::active() const {
+    return _toGoal || _jog[0] || _jog[1] || _jog[2] || _jog[3];
+}
+
+// A move starts from where the joints are now (a joint jog or a replay
+// may have moved them since the last one)
+FASTRUN void ArmCartesian::start() {
+    if (active()) return;
+    _pose    = _kin.forward(_servos.angles);
+    _limited = false;
+}
+
+// ================================================================
+// SERVO TICK
+// ================================================================
+FASTRUN void ArmCartesian::update(uint32_t nowUs) {
+    const float dt = min((nowUs - _lastUs) * 1e-6f, _servos.maxStepS);
+    _lastUs = nowUs;
+    if (!active()) return;
+
+    if (step(dt)) {
+        _limited = false;
+    } else if (!_limited) {
+        _limited = true;
+        event(SAFE_ARM_LIMIT);
+    }
+}
+
+// One tick's move. False if the arm could not take it.
+FASTRUN bool ArmCartesian::step(float dt) {
+    ArmPose next    = _pose;
+    bool    arrived = false;
+    if (_toGoal) {
+        // Along the line to the goal; the slower of position and pitch sets the pace
+        const float dx   = _goal.x - _pose.x;
+        const float dy   = _goal.y - _pose.y;
+        const float dz   = _goal.z - _pose.z;
+        const float dp   = _goal.pitch - _pose.pitch;
+        const float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+        const float f    = min(1.0f, min(dist > 0 ? JOG_MM_S * dt / dist : 1.0f,
+                                         dp != 0 ? JOG_DEG_S * dt / fabsf(dp) : 1.0f));
+        next.x     += dx * f;
+        next.y     += dy * f;
+        next.z     += dz * f;
+        next.pitch += dp * f;
+        arrived = dist * (1.0f - f) <= GOAL_MM && fabsf(dp) * (1.0f - f) <= GOAL_DEG;
+    } else {
+        for (uint8_t a = 0; a < AXES; a++) *axis(next, a) += _jog[a] * (a < 3 ? JOG_MM_S : JOG_DEG_S) * dt;
+    }
+
+    float deg[ArmKinematics::JOINTS];
+    if (_kin.inverse(next, deg) != ArmKinematics::OK) {
+        _toGoal = false;
+        return false;
+    }
+
+    // Hold every joint to the jog speed: shorten the step if one is over
+    float worst = 0;
+    for (uint8_t j = 0; j < ArmKinematics::JOINTS; j++) worst = max(worst, fabsf(deg[j] - _servos.angles[j]));
+    const float limit = _servos.maxSpeed * dt;
+    if (worst > limit) {
+        const float f = limit / worst;
+        next.x     = _pose.x + (next.x - _pose.x) * f;
+        next.y     = _pose.y + (next.y - _pose.y) * f;
+        next.z     = _pose.z + (next.z - _pose.z) * f;
+        next.pitch = _pose.pitch + (next.pitch - _pose.pitch) * f;
+        if (_kin.inverse(next, deg) != ArmKinematics::OK) return false;
+        arrived = false;
+    }
+
+    for (uint8_t j = 0; j < ArmKinematics::JOINTS; j++) _servos.setAngle(j, deg[j]);
+    _pose = next;
+    if (arrived) _toGoal = false;
+    return true;
+}
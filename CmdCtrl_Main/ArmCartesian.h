@@ -0,0 +1,67 @@
+#ifndef ARM_CARTESIAN_H
+#define ARM_CARTESIAN_H
+
+/**
+ * ARM CARTESIAN MOVES
+ * Moves the tool point in straight lines instead of one joint at a time.
+ * On every servo tick the target pose advances by the time since the
+ * last tick, at JOG_MM_S (tool pitch at JOG_DEG_S), and is solved into
+ * servo angles for joints 1-4 by ArmKinematics. No joint moves faster
+ * than the servos' jog speed: a longer step is shortened. A step that
+ * leaves the arm's reach or a servo's travel is not taken; the arm holds
+ * at the edge and reports SAFE_ARM_LIMIT once.
+ *
+ * Commands (USB or radio):
+ *   J<axis><dir>           jog: axis X, Y, Z (mm) or P (tool pitch),
+ *                          dir + or -, anything else stops that axis
+ *   JG<x>,<y>,<z>[,<p>]    go to a pose (mm, deg) in a straight line
+ *   JS                     stop
+ * Joint jogs (S...), a replay and the failsafe stop a Cartesian move.
+ * Joints 5-6 (wrist roll, gripper) keep jogging meanwhile, and a macro
+ * recording takes the Cartesian moves like any other.
+ */
+
+#include <Arduino.h>
+#include <ArmKinematics.h>
+#include "ServoController.h"
+
+class ArmCartesian {
+public:
+    typedef void (*EventFn)(uint16_t code);     // status codes (SystemCodes.h)
+
+    static const uint8_t    AXES        = 4;    // x, y, z, pitch
+    static constexpr float  JOG_MM_S    = 50.0f;
+    static constexpr float  JOG_DEG_S   = 45.0f;
+
+    ArmCartesian(ServoController& servos, const ArmKinematics& kinematics);
+
+    void    begin(EventFn onEvent)  { _onEvent = onEvent; }
+
+    /// Handle a 'J' command line. Returns false if it is not one.
+    bool    command(const char* cmd);
+
+    /// The servo tick, before the joint jog: moves joints 1-4 if active.
+    void    update(uint32_t nowUs);
+
+    /// Stop where the arm is.
+    void    stop();
+
+    bool    active() const;
+
+private:
+    bool    step(float dt);
+    void    start();
+    void    event(uint16_t code) { if (_onEvent) _onEvent(code); }
+
+    ServoController&        _servos;
+    const ArmKinematics&    _kin;
+    EventFn                 _onEvent    = nullptr;
+    ArmPose                 _pose       = {0, 0, 0, 0};     // last pose sent to the servos
+    ArmPose                 _goal       = {0, 0, 0, 0};
+    bool                    _toGoal     = false;
+    int8_t                  _jog[AXES]  = {0, 0, 0, 0};     // -1, 0, +1 per axis
+    bool                    _limited    = false;            // SAFE_ARM_LIMIT sent for this move
+    uint32_t                _lastUs     = 0;                // previous tick
+};
+
+#endif
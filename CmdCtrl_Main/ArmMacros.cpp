@@ -0,0 +1,161 @@
+#include "ArmMacros.h"
+#include "SystemCodes.h"
+
+namespace {
+// macro<n>.bin: this header, then 'frames' x JOINTS int16 (0.1 deg, LE)
+struct MacroHeader {
+    char        magic[4];
+    uint16_t    version;
+    uint16_t    tickMs;
+    uint16_t    joints;
+    uint16_t    frames;
+};
+const char      MAGIC[4]        = {'A', 'M', 'A', 'C'};
+const uint16_t  VERSION         = 1;
+const float     ARRIVED_DEG     = 0.5f;     // approach done within this
+}
+
+ArmMacros::ArmMacros(ServoController& servos, int16_t (*frames)[JOINTS], uint16_t capacity, uint16_t tickMs)
+    : _servos(servos), _frames(frames), _capacity(capacity), _tickMs(tickMs) {}
+
+FLASHMEM void ArmMacros::begin(SdFs* sd, EventFn onEvent) {
+    _sd      = sd;
+    _onEvent = onEvent;
+}
+
+// ================================================================
+// COMMANDS
+// ================================================================
+FLASHMEM bool ArmMacros::command(const char* cmd) {
+    if (cmd[0] != 'M') return false;
+    const char op   = cmd[1];
+    const int  slot = cmd[2] - '0';
+
+    if (op == 'A') {
+        abort();
+    } else if (op == 'R' && slot >= 0 && slot < SLOTS && _state == IDLE) {
+        _slot  = (uint8_t)slot;
+        _count = 0;
+        _state = RECORDING;
+        event(ACT_MACRO_RECORD);
+    } else if (op == 'S' && _state == RECORDING) {
+        _state = IDLE;
+        event(save() ? ACT_MACRO_SAVED : ERR_MACRO_FILE);
+    } else if (op == 'P' && slot >= 0 && slot < SLOTS && _state == IDLE) {
+        const char* comma = strchr(cmd, ',');
+        const int   pct   = comma ? atoi(comma + 1) : 100;
+        _scale = (uint16_t)constrain(pct, (int)MIN_SCALE, (int)MAX_SCALE);
+        if (!load((uint8_t)slot)) {
+            event(ERR_MACRO_FILE);
+        } else {
+            _slot     = (uint8_t)slot;
+            _position = 0;
+            _state    = APPROACH;
+            event(ACT_MACRO_PLAY);
+        }
+    }
+    return true;
+}
+
+FASTRUN void ArmMacros::abort() {
+    if (playing()) event(SAFE_MACRO_ABORT);
+    _state = IDLE;
+    _servos.emergencyStop();
+}
+
+// ================================================================
+// SERVO TICK
+// ================================================================
+FASTRUN void ArmMacros::update(char commands[], uint32_t nowUs) {
+    float       target[JOINTS];
+    const float elapsedS = min((nowUs - _lastUs) * 1e-6f, _servos.maxStepS);
+    _lastUs = nowUs;
+
+    switch (_state) {
+    case APPROACH: {
+        // To the first frame at jog speed
+        const float step    = _servos.maxSpeed * elapsedS;
+        bool        arrived = true;
+        for (uint8_t j = 0; j < JOINTS; j++) {
+            const float want = _frames[0][j] * 0.1f;
+            const float d    = want - _servos.angles[j];
+            arrived &= fabsf(d) <= ARRIVED_DEG;
+            target[j] = _servos.angles[j] + constrain(d, -step, step);
+        }
+        _servos.moveTo(target);
+        if (arrived) _state = PLAYING;
+        return;
+    }
+    case PLAYING: {
+        const uint16_t i    = (uint16_t)_position;
+        const uint16_t next = i + 1 < _count ? i + 1 : i;
+        const float    f    = _position - i;
+        for (uint8_t j = 0; j < JOINTS; j++) {
+            target[j] = (_frames[i][j] + (_frames[next][j] - _frames[i][j]) * f) * 0.1f;
+        }
+        _servos.moveTo(target);
+        _position += _scale / 100.0f * elapsedS * 1000.0f / _tickMs;
+        if (_position > _count - 1) {
+            _state = IDLE;
+            event(ACT_MACRO_DONE);
+        }
+        return;
+    }
+    default:
+        break;
+    }
+
+    _servos.update(commands, nowUs);
+    if (_state != RECORDING) return;
+    for (uint8_t j = 0; j < JOINTS; j++) _frames[_count][j] = (int16_t)lroundf(_servos.angles[j] * 10.0f);
+    if (++_count >= _capacity) {
+        // Buffer full: keep what fits
+        _state = IDLE;
+        event(save() ? ACT_MACRO_SAVED : ERR_MACRO_FILE);
+    }
+}
+
+// ================================================================
+// SD
+// ================================================================
+FLASHMEM void ArmMacros::fileName(uint8_t slot, char* out, size_t size) const {
+    snprintf(out, size, "macro%u.bin", (unsigned)slot);
+}
+
+FLASHMEM bool ArmMacros::save() {
+    if (!_sd || _count == 0) return false;
+    char name[16];
+    fileName(_slot, name, sizeof(name));
+    FsFile f = _sd->open(name, O_WRONLY | O_CREAT | O_TRUNC);
+    if (!f) return false;
+    MacroHeader h;
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.tickMs  = _tickMs;
+    h.joints  = JOINTS;
+    h.frames  = _count;
+    const size_t bytes = (size_t)_count * sizeof(_frames[0]);
+    const bool   ok    = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+                         f.write((const uint8_t*)_frames, bytes) == bytes;
+    f.close();
+    return ok;
+}
+
+FLASHMEM bool ArmMacros::load(uint8_t slot) {
+    if (!_sd) return false;
+    char name[16];
+    fileName(slot, name, sizeof(name));
+    FsFile f = _sd->open(name, O_RDONLY);
+    if (!f) return false;
+    MacroHeader h;
+    bool ok = f.read(&h, sizeof(h)) == (int)sizeof(h) && memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              h.version == VERSION && h.joints == JOINTS && h.frames > 0 && h.frames <= _capacity &&
+              h.tickMs == _tickMs;
+    if (ok) {
+        const int bytes = (int)(h.frames * sizeof(_frames[0]));
+        ok = f.read(_frames, bytes) == bytes;
+    }
+    f.close();
+    _count = ok ? h.frames : 0;
+    return ok;
+}
@@ -0,0 +1,77 @@
+#ifndef ARM_MACROS_H
+#define ARM_MACROS_H
+
+/**
+ * ARM MACROS (teach, store, replay)
+ * Teach: while recording, the joint angles are captured at every servo
+ * tick into a fixed buffer; the operator jogs the arm as usual.
+ * Store: the take is written to SD as macro<n>.bin.
+ * Replay: the take is loaded back into the same buffer and played on the
+ * servo tick, interpolated between frames, at a time scale (50 = half
+ * speed, 200 = double). The arm first moves to the first frame at jog
+ * speed. A jog command, MA or the failsafe stops a replay where it is.
+ *
+ * Commands (USB or radio):
+ *   MR<n>          record into slot n (0-9)
+ *   MS             stop recording and save the slot
+ *   MP<n>[,<pct>]  play slot n at pct % speed (10-400, default 100)
+ *   MA             abort recording or replay
+ */
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include "ServoController.h"
+
+class ArmMacros {
+public:
+    typedef void (*EventFn)(uint16_t code);     // status codes (SystemCodes.h)
+
+    static const uint8_t    JOINTS      = ServoController::numServos;
+    static const uint8_t    SLOTS       = 10;
+    static const uint16_t   MIN_SCALE   = 10;   // % of recorded speed
+    static const uint16_t   MAX_SCALE   = 400;
+
+    enum State : uint8_t { IDLE, RECORDING, APPROACH, PLAYING };
+
+    /// 'frames' holds 'capacity' frames of JOINTS angles in 0.1 deg
+    /// (e.g. DMAMEM); 'tickMs' is the servo tick the frames are taken at.
+    ArmMacros(ServoController& servos, int16_t (*frames)[JOINTS], uint16_t capacity, uint16_t tickMs);
+
+    /// 'sd' is null without a card (record and replay then fail).
+    void    begin(SdFs* sd, EventFn onEvent);
+
+    /// Handle an 'M' command line. Returns false if it is not one.
+    bool    command(const char* cmd);
+
+    /// The servo tick: replays, or runs the jog commands (and records).
+    /// Approach and replay advance by the time since the last tick.
+    void    update(char commands[], uint32_t nowUs);
+
+    /// Stop recording (unsaved) or replay; the arm holds where it is.
+    void    abort();
+
+    State   state() const       { return _state; }
+    bool    playing() const     { return _state == APPROACH || _state == PLAYING; }
+    bool    busy() const        { return _state != IDLE; }
+
+private:
+    bool    save();
+    bool    load(uint8_t slot);
+    void    fileName(uint8_t slot, char* out, size_t size) const;
+    void    event(uint16_t code) { if (_onEvent) _onEvent(code); }
+
+    ServoController&    _servos;
+    int16_t           (*_frames)[JOINTS];
+    uint16_t            _capacity;
+    uint16_t            _tickMs;
+    SdFs*               _sd         = nullptr;
+    EventFn             _onEvent    = nullptr;
+    State               _state      = IDLE;
+    uint8_t             _slot       = 0;
+    uint16_t            _count      = 0;        // frames in the buffer
+    uint16_t            _scale      = 100;
+    float               _position   = 0;        // replay position, frames
+    uint32_t            _lastUs     = 0;        // previous tick
+};
+
+#endif
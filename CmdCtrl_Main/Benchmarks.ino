@@ -0,0 +1,66 @@
+/**
+ * HOT-KERNEL BENCHMARKS
+ * Enabled by BENCHMARK_MODE (top of CmdCtrl_Main.ino). The sketch then
+ * times each kernel at boot, prints CSV on USB Serial (see AmbotBench.h)
+ * and idles instead of starting the control loop.
+ *
+ * The motor bridges are never enabled (begin() is not called), so the
+ * wheels cannot turn, but keep servo power off while benchmarking.
+ */
+#ifdef BENCHMARK_MODE
+#include <AmbotBench.h>
+
+FLASHMEM void runBenchmarks(Print& out) {
+    static const char SUITE[] = "actuator";
+    char              cmd[MAX_CMD_LEN];
+    uint32_t          tick = 0;
+
+    bench::header(out);
+
+    // strtok() consumes the buffer, so each op re-copies the line like checkInput() does
+    bench::run(out, SUITE, "process_command_motor", 100000, [&] {
+        strcpy(cmd, "180,-120");
+        processCommand(cmd, SRC_RADIO);
+    });
+
+    bench::run(out, SUITE, "process_command_servo", 100000, [&] {
+        strcpy(cmd, "S3R");
+        processCommand(cmd, SRC_RADIO);
+    });
+    for (int i = 0; i < ServoController::numServos; i++) servoCommands[i] = 0;
+
+    // USB holds control: radio lines are dropped at the arbiter
+    strcpy(cmd, "0,0");
+    processCommand(cmd, SRC_USB);
+    bench::run(out, SUITE, "process_command_locked_out", 100000, [&] {
+        strcpy(cmd, "180,-120");
+        processCommand(cmd, SRC_RADIO);
+    });
+
+    // Flip direction every 64 ticks so the ramp is always moving
+    bench::run(out, SUITE, "motor_update", 100000, [&] {
+        leftMotor.setTarget((++tick & 0x40) ? 255 : -255);
+        leftMotor.update();
+    });
+    leftMotor.emergencyStop();
+    rightMotor.emergencyStop();
+
+    controller.begin();
+    bench::run(out, SUITE, "servo_update", 500, [&] {
+        controller.update(servoCommands, micros());
+    });
+
+    // A fresh pose each op (around the reach) so nothing is cached
+    float ikDeg[ArmKinematics::JOINTS];
+    bench::run(out, SUITE, "arm_ik", 100000, [&] {
+        const float   s    = (++tick & 0xFF) * 0.1f;
+        const ArmPose pose = {150.0f + s, s - 12.0f, 80.0f + s, -10.0f};
+        armKinematics.inverse(pose, ikDeg);
+    });
+
+    ledSys.begin();
+    bench::run(out, SUITE, "led_update", 100000, [&] {
+        ledSys.update(true, true, true, true);
+    });
+}
+#endif
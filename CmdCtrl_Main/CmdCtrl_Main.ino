@@ -3,20 +3,102 @@
  * Target: Teensy 4.1
  */
 
+// --- BUILD OPTIONS ---
+// #define BENCHMARK_MODE   // Time the hot kernels at boot instead of running (Benchmarks.ino)
+// #define TRACE_MODE       // Record a timeline of commands, ticks and SD writes ('T' / 'TD' over USB)
+
 #include <Wire.h>
 #include "GlobalVariables.h"
 #include "SystemCodes.h" 
+#include <TraceRecorder.h>   // TRACE_* macros (no-ops unless TRACE_MODE)
+#include <Tdma.h>            // Uplink slot filter on the shared APC220 channel
+#include <Fec.h>             // Reed-Solomon framed commands from the ground
+#include <CommandArbiter.h>  // USB vs radio: priority, lease and lockout
+#include <CommandEcho.h>     // Tagged commands echoed with receive / apply times
+#include "ArmMacros.h"       // Teach / store / replay arm trajectories
+#include "ArmCartesian.h"    // Straight-line tool moves through the arm's IK
+#include <BatteryMonitor.h>  // Pack voltage / current, charge and motor limits
+
+// --- MEMORY PLACEMENT ---
+// FASTRUN  : command parsing and the control loop in zero-wait ITCM
+// FLASHMEM : boot and SD logging paths stay in flash, leaving RAM1 to DTCM
+// Check the result with Tools/memory_report.py against Tools/memory_budget.json.
 
 // RADIO CONFIGURATION (RX ONLY)
 #define APC220 Serial1
 #define APC_BAUD 9600
 
+// TDMA: follows the ground's beacons so that, on a shared channel, only
+// lines heard in the uplink slot are taken as commands (see Tdma.h).
+// The node ID is DEFAULT_NODE_ID until rover.cfg is read at boot.
+TdmaSchedule tdma(DEFAULT_NODE_ID, APC_BAUD);
+const unsigned long UPLINK_LATE_US = 10000;
+
+// FEC: the ground may send commands and beacons as frames; plain lines
+// keep working, so the decoder just sits in front of the line assembler.
+FecDecoder radioFec;
+
+// COMMAND SOURCES: USB and radio feed the same parser through an arbiter
+// (see CommandArbiter.h). A cable on the rover means someone is standing
+// next to it, so USB outranks the radio; the radio gets control back once
+// USB has been quiet for its lease. USB does not drop lines, so it stops
+// the rover sooner when its host goes quiet.
+enum CommandSource : uint8_t { SRC_USB, SRC_RADIO };
+const ArbiterSource COMMAND_SOURCES[] = {
+    // name     priority  lease ms  failsafe ms
+    {"usb",     2,        1000,     250},
+    {"radio",   1,        1500,     500},
+};
+CommandArbiter arbiter(COMMAND_SOURCES, sizeof(COMMAND_SOURCES) / sizeof(COMMAND_SOURCES[0]));
+
+// COMMAND ECHO: a tagged command ("<cmd>^<tag>") is echoed on USB once
+// the tick that applies it has run (see CommandEcho.h).
+enum EchoWait : uint8_t { ECHO_NONE, ECHO_MOTOR_TICK, ECHO_SERVO_TICK };
+echo::Echo pendingEcho;
+EchoWait   echoWait = ECHO_NONE;
+
 const unsigned long MOTOR_INTERVAL = 10;
 const unsigned long SERVO_INTERVAL = 20;
 
+// STOPPING (see StopMode in MotorDriver.h): the failsafe and X stops brake
+// outright from up to BRAKE_PWM. Above it the shorted winding would pull
+// more than loose ground grips (about 0.3 g), so the duty first comes down
+// by BRAKE_STEP per motor tick. Stop times: Simulation/README.md, Stopping.
+const int BRAKE_PWM  = 200;
+const int BRAKE_STEP = 10;
+
+// ARM MACROS: one take in RAM at a time (30 s at the servo tick), the
+// rest on SD; see ArmMacros.h for the M commands.
+const uint16_t MACRO_MAX_FRAMES = 1500;
+DMAMEM static int16_t macroFrames[MACRO_MAX_FRAMES][ArmMacros::JOINTS];
+ArmMacros macros(controller, macroFrames, MACRO_MAX_FRAMES, SERVO_INTERVAL);
+
+// ARM KINEMATICS: link lengths (mm) and servo zeros of this arm, measured
+// as in ArmKinematics.h; J commands move the tool point through them.
+//                                       base  upper  fore  tool   servo zero        sign
+const ArmKinematics armKinematics(ArmGeometry{70,  105,   98,   60,    {90, 0, 90, 90}, {1, 1, 1, 1}});
+ArmCartesian armCartesian(controller, armKinematics);
+
+// BATTERY: pack voltage and current on spare ADC pins (the telemetry node
+// reads the same sense lines), see BatteryMonitor.h. The governor holds
+// the motors' peak duty and ramp under sag and low charge. At SHUTDOWN
+// everything stops and the log says so before the regulators drop out.
+const uint8_t       BATTERY_VOLT_PIN = A14;
+const uint8_t       BATTERY_AMP_PIN  = A15;
+const unsigned long BATTERY_INTERVAL = 20;
+BatteryMonitor battery;
+PowerGovernor  governor(255, 5);    // Motor's full duty and default ramp
+
+// TIMELINE TRACE (drained by the 'T' / 'TD' commands)
+#ifdef TRACE_MODE
+DMAMEM static TraceEvent traceRing[TRACE_RING_EVENTS];
+TraceRecorder trace("ACT", traceRing, TRACE_RING_EVENTS);
+#endif
+
 // --- HELPER: LOG TO SD (Non-Blocking Attempt) ---
-void logToSD(const char* data) {
+FLASHMEM void logToSD(const char* data) {
     if (!isSDReady) return;
+    TRACE_SCOPE("sd_log");
     // Open, Write, Sync
     logFile = sd.open(LOG_FILENAME, O_RDWR | O_CREAT | O_APPEND);
     if (logFile) {
@@ -25,16 +107,169 @@ void logToSD(const char* data) {
     }
 }
 
+// --- HELPER: Node ID from the SD card ---
+// One image serves the whole fleet: "node=<id>" in rover.cfg sets this
+// rover's address and TDMA slot (same file on the telemetry card).
+FLASHMEM void loadNodeId() {
+    char   text[32] = {0};
+    FsFile cfg      = sd.open(NODE_CONFIG_FILE, O_RDONLY);
+    if (cfg) {
+        cfg.read(text, sizeof(text) - 1);
+        cfg.close();
+    }
+    tdma.setId(TdmaSchedule::configId(text, DEFAULT_NODE_ID));
+}
+
 // --- HELPER: Transmit/Log Code (SILENT VERSION) ---
-void transmitCode(uint16_t code) {
-  char codeBuffer[16];
+FLASHMEM void transmitCode(uint16_t code) {
+  char codeBuffer[24];
   // Format: "Uptime,Code"
   snprintf(codeBuffer, sizeof(codeBuffer), "%lu,%06d", millis(), code);
   logToSD(codeBuffer);
 }
 
+// --- HELPER: Battery Line (SD + USB) ---
+FLASHMEM void reportBattery() {
+    char line[64];
+    int  len = battery.format(line, sizeof(line), "ACT");
+    if (len > 0 && len < (int)sizeof(line)) {
+        logToSD(line);
+        Serial.println(line);
+    }
+}
+
+// --- HELPER: Battery Level Change ---
+// SD lines are written with open / close, so the log is complete as soon
+// as SYS_SHUTDOWN is in it.
+FLASHMEM void onBatteryLevel() {
+    switch (battery.level()) {
+    case BatteryMonitor::LOW_CHARGE: transmitCode(WARN_BATTERY_LOW);      break;
+    case BatteryMonitor::CRITICAL:   transmitCode(WARN_BATTERY_CRITICAL); break;
+    case BatteryMonitor::SHUTDOWN:
+        leftMotor.emergencyStop();
+        rightMotor.emergencyStop();
+        controller.emergencyStop();
+        macros.abort();
+        armCartesian.stop();
+        for (int i = 0; i < ServoController::numServos; i++) servoCommands[i] = 0;
+        transmitCode(SYS_SHUTDOWN);
+        break;
+    default:
+        break;
+    }
+    reportBattery();
+}
+
+// --- HELPER: Health Report (SD + USB only, radio stays silent) ---
+FLASHMEM void reportHealth() {
+    TRACE_SCOPE("health");
+    char frame[128];
+    int  len = health.format(frame, sizeof(frame));
+    if (len > 0 && len < (int)sizeof(frame)) {
+        logToSD(frame);
+        Serial.println(frame);
+    }
+    const FecStats& fs = radioFec.stats();
+    if (fs.frames || fs.uncorrectable) {
+        len = radioFec.format(frame, sizeof(frame), "ACT");
+        if (len > 0 && len < (int)sizeof(frame)) {
+            logToSD(frame);
+            Serial.println(frame);
+        }
+    }
+
+    len = arbiter.format(frame, sizeof(frame), "ACT");
+    if (len > 0 && len < (int)sizeof(frame)) {
+        logToSD(frame);
+        Serial.println(frame);
+    }
+    reportBattery();
+
+    uint8_t raised = health.raised();
+    if (raised & HealthMonitor::WARN_CPU)   transmitCode(WARN_CPU_LOAD);
+    if (raised & HealthMonitor::WARN_LOOP)  transmitCode(WARN_LOOP_SLOW);
+    if (raised & HealthMonitor::WARN_STACK) transmitCode(WARN_STACK_LOW);
+    if (raised & HealthMonitor::WARN_RAM)   transmitCode(WARN_RAM_LOW);
+    if (raised & HealthMonitor::WARN_UART)  transmitCode(WARN_UART_FULL);
+}
+
+// --- HELPER: Command Source Handoffs (SD code + USB line) ---
+FLASHMEM void onArbiterEvent(CommandArbiter::Event event, uint8_t source, uint8_t other, uint32_t nowMs) {
+    char line[64];
+    if (event == CommandArbiter::TAKEOVER) {
+        snprintf(line, sizeof(line), "C,n=ACT,t=%lu,take=%s,from=%s", (unsigned long)nowMs,
+                 arbiter.name(source), arbiter.name(other));
+        transmitCode(ACT_CONTROL_USB + source);
+    } else {
+        snprintf(line, sizeof(line), "C,n=ACT,t=%lu,free=%s", (unsigned long)nowMs, arbiter.name(source));
+        transmitCode(ACT_CONTROL_RELEASED);
+    }
+    TRACE_INSTANT(event == CommandArbiter::TAKEOVER ? "take" : "free", source);
+    Serial.println(line);
+}
+
+// --- HELPER: Command Echo (USB only, the radio stays silent) ---
+FASTRUN void sendEcho(uint32_t apUs) {
+    char line[64];
+    pendingEcho.apUs = apUs;
+    echoWait = ECHO_NONE;
+    if (echo::format(line, sizeof(line), "ACT", pendingEcho) < (int)sizeof(line)) Serial.println(line);
+}
+
+// --- HELPER: Drive Stop ---
+// 'how' is 'C' (coast), 'B' (brake) or 'R' (ramp); anything else takes the
+// fastest safe stop for the duty each wheel is at, like the failsafe.
+FASTRUN void stopDrive(char how) {
+    Motor* motors[] = {&leftMotor, &rightMotor};
+    for (Motor* m : motors) {
+        m->stop(how == 'C' ? STOP_COAST : how == 'B' ? STOP_BRAKE : how == 'R' ? STOP_RAMP : m->fastestSafeStop());
+    }
+    isLeftMotorActive  = false;
+    isRightMotorActive = false;
+}
+
 // --- COMMAND PARSING ---
-void processCommand(char* cmd) {
+// Returns false if the command was dropped (locked out by the arbiter).
+FASTRUN bool processCommand(char* cmd, CommandSource source) {
+    TRACE_SCOPE("command");
+
+#ifdef TRACE_MODE
+    // 0. TRACE DUMP: "T" drains the ring to USB, "TD" to trace.csv on SD
+    if (cmd[0] == 'T') {
+        if (cmd[1] == 'D') {
+            if (!isSDReady) return true;
+            FsFile f = sd.open("trace.csv", O_RDWR | O_CREAT | O_APPEND);
+            if (f) {
+                trace.drain(f);
+                f.close();
+            }
+        } else {
+            trace.drain(Serial);
+        }
+        return true;
+    }
+#endif
+
+    // 1. DRIVE STOP (Starts with 'X'): "X" for an obstacle, "XC" / "XB" / "XR"
+    // to coast, brake or ramp. Any source can stop the drive, even one the
+    // arbiter locks out. Repeated drive lines are ignored until "0,0".
+    if (cmd[0] == 'X') {
+        stopDrive(cmd[1]);
+        if (!driveHeld) transmitCode(SAFE_DRIVE_STOP);
+        driveHeld = true;
+        return true;
+    }
+
+    // Only the source in control moves the rover
+    if (!arbiter.accept(source, millis())) return false;
+
+    // Keepalive ("K"): holds the current targets and refreshes the timer.
+    // It cannot resume a rover the failsafe has stopped; a full command does.
+    if (cmd[0] == 'K' && cmd[1] == '\0') {
+        if (!failsafeTriggered) lastCommandTime = millis();
+        return true;
+    }
+
     // Reset Failsafe Timer
     lastCommandTime = millis();
     if(failsafeTriggered) {
@@ -42,15 +277,34 @@ void processCommand(char* cmd) {
         transmitCode(SAFE_FAILSAFE_CLEAR);
     }
 
-    // 1. SERVO COMMAND (Starts with 'S')
+    // Past SHUTDOWN the pack is about to drop out: nothing moves again
+    if (battery.level() == BatteryMonitor::SHUTDOWN) return true;
+
+    // 2. ARM MACRO (Starts with 'M'); a replay takes the arm from a Cartesian move
+    if (macros.command(cmd)) {
+        if (macros.playing()) armCartesian.stop();
+        return true;
+    }
+
+    // 3. CARTESIAN ARM MOVE (Starts with 'J'); takes joints 1-4 from a replay or a jog
+    if (cmd[0] == 'J') {
+        if (macros.playing()) macros.abort();
+        for (int i = 0; i < ArmKinematics::JOINTS; i++) servoCommands[i] = 0;
+        armCartesian.command(cmd);
+        return true;
+    }
+
+    // 4. SERVO COMMAND (Starts with 'S'); jogging takes the arm back from a replay
     if (cmd[0] == 'S') {
+        if (macros.playing()) macros.abort();
         int idx = cmd[1] - '1';
         char dir = cmd[2];
         if (idx >= 0 && idx < ServoController::numServos) {
             servoCommands[idx] = (dir == 'L' || dir == 'R') ? dir : 0;
+            if (idx < ArmKinematics::JOINTS) armCartesian.stop();
         }
     }
-    // 2. MOTOR COMMAND (Numbers)
+    // 5. MOTOR COMMAND (Numbers)
     else {
         char* token = strtok(cmd, ",");
         if (token != NULL) {
@@ -58,6 +312,10 @@ void processCommand(char* cmd) {
             token = strtok(NULL, ",");
             if (token != NULL) {
                 int rightVal = atoi(token);
+                if (driveHeld) {
+                    if (leftVal != 0 || rightVal != 0) return true;
+                    driveHeld = false;
+                }
                 leftMotor.setTarget(leftVal);
                 rightMotor.setTarget(rightVal);
                 
@@ -66,16 +324,63 @@ void processCommand(char* cmd) {
             }
         }
     }
+    return true;
+}
+
+// --- HELPER: Run One Command Line ---
+// Strips an echo tag if there is one and arms the echo for the tick that
+// will apply the command (motor tick for "L,R", servo tick for the rest).
+FASTRUN void runCommand(char* cmd, CommandSource source) {
+    uint32_t tag;
+    if (!echo::splitTag(cmd, &tag)) {
+        processCommand(cmd, source);
+        return;
+    }
+    const uint32_t rxUs  = micros();
+    const bool     drive = (cmd[0] != 'S' && cmd[0] != 'M' && cmd[0] != 'J');
+    if (echoWait != ECHO_NONE) sendEcho(0);     // superseded before a tick ran
+    pendingEcho = {tag, rxUs, 0};
+    if (processCommand(cmd, source)) echoWait = drive ? ECHO_MOTOR_TICK : ECHO_SERVO_TICK;
+    else                             sendEcho(0);
+}
+
+// --- HELPER: Radio Line Filter ---
+// Returns the command to run, or NULL for beacons, other nodes' downlink,
+// status events and their acks, and lines addressed to another rover.
+FASTRUN char* radioCommand(char* line) {
+    const unsigned long nowUs = micros();
+    if (line[0] == '@') {
+        tdma.parseBeacon(line, nowUs);
+        return NULL;
+    }
+    if ((line[0] == 'A' || line[0] == 'E') && line[1] == ',') return NULL;
+    if (tdma.synced(nowUs) && !tdma.inSlot(TdmaSchedule::UPLINK, nowUs, UPLINK_LATE_US)) return NULL;
+    return TdmaSchedule::route(line, tdma.id());
 }
 
 // --- HELPER: Read Input Stream ---
-void checkInput(Stream &stream, char* buffer, int &index) {
+// Returns true if any byte was consumed.
+FASTRUN bool checkInput(Stream &stream, char* buffer, int &index, CommandSource source) {
+    const bool fromRadio = (source == SRC_RADIO);
+    bool gotData = false;
     while (stream.available() > 0) {
+        gotData = true;
         char c = stream.read();
+        if (fromRadio) {
+            FecDecoder::Result r = radioFec.feed((uint8_t)c);
+            if (r == FecDecoder::FRAME && radioFec.length() < (size_t)MAX_CMD_LEN) {
+                char frame[MAX_CMD_LEN];
+                memcpy(frame, radioFec.payload(), radioFec.length() + 1);
+                char* cmd = radioCommand(frame);
+                if (cmd != NULL) runCommand(cmd, source);
+            }
+            if (r != FecDecoder::TEXT) continue;
+        }
         if (c == '\n' || c == '\r') {
             if (index > 0) {
                 buffer[index] = '\0'; // Null-terminate
-                processCommand(buffer);
+                char* cmd = fromRadio ? radioCommand(buffer) : buffer;
+                if (cmd != NULL) runCommand(cmd, source);
                 index = 0; // Reset
             }
         } else {
@@ -84,14 +389,29 @@ void checkInput(Stream &stream, char* buffer, int &index) {
             }
         }
     }
+    return gotData;
 }
 
 // --- SETUP ---
-void setup() {
+FLASHMEM void setup() {
+#ifdef BENCHMARK_MODE
+    // Benchmark build: report over USB, then idle (see Benchmarks.ino)
+    Serial.begin(115200);
+    while (!Serial && millis() < 3000) {}
+    runBenchmarks(Serial);
+    while (true) { yield(); }
+#endif
+
+    // Health monitor first: paints the stack while it is still shallow
+    health.begin();
+    health.thresholds().loopUs = 5000;     // half a motor tick
+
     // 1. Initialize Communication
     // APC220 (UART) does not return a status bool, so we just init it.
     APC220.begin(APC_BAUD); 
     Serial.begin(115200);
+    analogReadResolution(12);   // Battery sense (BatteryConfig counts)
+    health.watchUart(APC220, "S1", 64);
     
     // Set flag to true now that comms have begun
     serialCommunicationFlag = true;
@@ -100,6 +420,7 @@ void setup() {
     if (sd.begin(SdioConfig(FIFO_SDIO))) {
         isSDReady = true;
         logToSD("--- NEW SESSION ---");
+        loadNodeId();
     } else {
         isSDReady = false;
     }
@@ -114,9 +435,14 @@ void setup() {
     // 4. Hardware Init
     leftMotor.begin();
     rightMotor.begin();
+    leftMotor.setBrakeLimits(BRAKE_PWM, BRAKE_STEP);
+    rightMotor.setBrakeLimits(BRAKE_PWM, BRAKE_STEP);
     transmitCode(ACT_MOTORS_READY);
 
     controller.begin();
+    macros.begin(isSDReady ? &sd : NULL, transmitCode);
+    armCartesian.begin(transmitCode);
+    arbiter.onEvent(onArbiterEvent);
     transmitCode(ACT_SERVOS_READY);
 
     ledSys.begin();
@@ -133,43 +459,74 @@ void setup() {
 }
 
 // --- LOOP ---
-void loop() {
+FASTRUN void loop() {
     wdt.feed();
+    health.beginLoop();
     unsigned long now = millis();
+    bool busy = false;  // idle polls do not count as CPU load
 
     // 1. READ INPUTS (USB & Radio)
-    checkInput(Serial, usbBuffer, usbIndex);
-    checkInput(APC220, radioBuffer, radioIndex);
+    busy |= checkInput(Serial, usbBuffer, usbIndex, SRC_USB);
+    busy |= checkInput(APC220, radioBuffer, radioIndex, SRC_RADIO);
+    arbiter.poll(now);
 
-    // 2. FAILSAFE CHECK
-    if (!failsafeTriggered && (now - lastCommandTime > FAILSAFE_TIMEOUT)) {
+    // 2. FAILSAFE CHECK (timeout of the source that sent the last command)
+    // Signed: a command handled above (after 'now' was read) can stamp
+    // lastCommandTime later than 'now' when it logs to SD
+    if (!failsafeTriggered && ((long)(now - lastCommandTime) > (long)arbiter.failsafeMs())) {
         failsafeTriggered = true;
-        leftMotor.emergencyStop();
-        rightMotor.emergencyStop();
+        stopDrive(0);
         controller.emergencyStop();
-        
-        isLeftMotorActive = false;
-        isRightMotorActive = false;
+        macros.abort();
+        armCartesian.stop();
         
         for(int i=0; i<6; i++) servoCommands[i] = 0;
         
+        TRACE_INSTANT("failsafe", (int32_t)(now - lastCommandTime));
         transmitCode(SAFE_FAILSAFE_TRIGGER);
+        busy = true;
     }
 
     // 3. UPDATE MOTORS
     if (now - lastMotorTime >= MOTOR_INTERVAL) {
         lastMotorTime = now;
+        TRACE_COUNTER("radio_rx", APC220.available());
+        TRACE_BEGIN("motor_tick");
         leftMotor.update();
         rightMotor.update();
+        TRACE_END("motor_tick");
+        if (echoWait == ECHO_MOTOR_TICK) sendEcho(micros());
+        busy = true;
     }
 
     // 4. UPDATE SERVOS
     if (now - lastServoTime >= SERVO_INTERVAL) {
         lastServoTime = now;
-        controller.update(servoCommands);
+        TRACE_BEGIN("servo_tick");
+        armCartesian.update(micros());             // joints 1-4 on a Cartesian move
+        macros.update(servoCommands, micros());    // jog (and record), or replay
+        TRACE_END("servo_tick");
+        if (echoWait == ECHO_SERVO_TICK) sendEcho(micros());
+        busy = true;
+    }
+
+    // 5. BATTERY: charge, level and the motors' limits
+    if (now - lastBatteryTime >= BATTERY_INTERVAL) {
+        lastBatteryTime = now;
+        TRACE_BEGIN("battery");
+        if (battery.update(analogRead(BATTERY_VOLT_PIN), analogRead(BATTERY_AMP_PIN), now)) onBatteryLevel();
+        const GovernorLimits& limits = governor.update(battery, now);
+        leftMotor.setLimits(limits.pwmPeak, limits.pwmStep);
+        rightMotor.setLimits(limits.pwmPeak, limits.pwmStep);
+        TRACE_END("battery");
+        busy = true;
     }
 
-    // 5. UPDATE LEDs
+    // 6. UPDATE LEDs
     // Pass 'serialCommunicationFlag' to control Pin 24 blinking
-    ledSys.update(isLeftMotorActive, isRightMotorActive, controller.isActive(), serialCommunicationFlag);
+    ledSys.update(isLeftMotorActive, isRightMotorActive, controller.isActive() || macros.playing(), serialCommunicationFlag);
+
+    // 7. HEALTH: one frame per window
+    health.endLoop(busy);
+    if (health.due()) reportHealth();
 }
\ No newline at end of file
@@ -2,7 +2,8 @@
 
 // --- CONSTANTS ---
 const char* LOG_FILENAME          = "motor_log.csv";
-const int               MAX_CMD_LEN           = 32;
+const char* NODE_CONFIG_FILE      = "rover.cfg";
+const int               MAX_CMD_LEN           = 64; // Fits a TDMA beacon
 
 // --- FLAGS & STATE ---
 bool                    isSDReady             = false;
@@ -12,17 +13,18 @@ bool                    serialCommunicationFlag = false;
 bool                    isLeftMotorActive     = false;
 bool                    isRightMotorActive    = false;
 bool                    failsafeTriggered     = false;
+bool                    driveHeld             = false;
 
 // --- TIMERS ---
 unsigned long           lastCommandTime       = 0;
-unsigned long           FAILSAFE_TIMEOUT      = 500; // 0.5 Seconds
 unsigned long           lastMotorTime         = 0;
 unsigned long           lastServoTime         = 0;
+unsigned long           lastBatteryTime       = 0;
 
 // --- BUFFERS ---
-char                    usbBuffer[32]; // Size must match MAX_CMD_LEN
+char                    usbBuffer[64]; // Size must match MAX_CMD_LEN
 int                     usbIndex              = 0;
-char                    radioBuffer[32];
+char                    radioBuffer[64];
 int                     radioIndex            = 0;
 char                    servoCommands[6]      = {0,0,0,0,0,0}; // NumServos = 6
 
@@ -35,4 +37,5 @@ LedController           ledSys;
 // Motor Pins: RPWM, LPWM, R_EN, L_EN
 Motor                   leftMotor(2, 3, 21, 20);
 Motor                   rightMotor(5, 6, 22, 23);
-ServoController         controller;
\ No newline at end of file
+ServoController         controller;
+HealthMonitor           health("ACT");
\ No newline at end of file
@@ -7,10 +7,13 @@
 #include "MotorDriver.h"
 #include "ServoController.h"
 #include "LedSystems.h"
+#include <HealthMonitor.h>
 
 // --- CONSTANTS ---
 extern const char* LOG_FILENAME;
 extern const int        MAX_CMD_LEN;
+static constexpr uint8_t DEFAULT_NODE_ID = 1;  // Rover address, matches the telemetry node (Tdma.h)
+extern const char* NODE_CONFIG_FILE;            // "node=<id>" here overrides it
 
 // --- FLAGS & STATE ---
 extern bool             isSDReady;
@@ -20,12 +23,13 @@ extern bool             serialCommunicationFlag;
 extern bool             isLeftMotorActive;
 extern bool             isRightMotorActive;
 extern bool             failsafeTriggered;
+extern bool             driveHeld;          // after an X stop, until a "0,0" line
 
 // --- TIMERS ---
 extern unsigned long    lastCommandTime;
-extern unsigned long    FAILSAFE_TIMEOUT;
 extern unsigned long    lastMotorTime;
 extern unsigned long    lastServoTime;
+extern unsigned long    lastBatteryTime;
 
 // --- BUFFERS ---
 extern char             usbBuffer[];
@@ -42,5 +46,6 @@ extern LedController    ledSys;
 extern Motor            leftMotor;
 extern Motor            rightMotor;
 extern ServoController  controller;
+extern HealthMonitor    health;
 
 #endif
\ No newline at end of file
@@ -32,7 +32,7 @@ private:
     bool sSingle    = false; unsigned long tSingle  = 0; 
 
 public:
-    void begin() {
+    FLASHMEM void begin() {
         pinMode(PIN_FAST_BLINK, OUTPUT);
         pinMode(PIN_SEQUENCE, OUTPUT);
         pinMode(PIN_HEARTBEAT, OUTPUT);
@@ -40,7 +40,7 @@ public:
     }
 
     // Main Update Function
-    void update(bool leftMotorActive, bool rightMotorActive, bool servoActive, bool commsActive) {
+    FASTRUN void update(bool leftMotorActive, bool rightMotorActive, bool servoActive, bool commsActive) {
         unsigned long currentMillis = millis();
 
         // 1. Run Heartbeat (Always Running)
@@ -62,7 +62,7 @@ public:
 
 private:
     void runSimpleBlinker(int pin, int speed, unsigned long now, bool &state, unsigned long &lastTime) {
-        if (now - lastTime >= speed) {
+        if (now - lastTime >= (unsigned long)speed) {
             lastTime    = now;
             state       = !state;
             digitalWrite(pin, state);
@@ -1,10 +1,10 @@
 #include "MotorDriver.h"
 
 Motor::Motor(int rpwmPin, int lpwmPin, int renPin, int lenPin, int step)
-    : RPWM(rpwmPin), LPWM(lpwmPin), REN(renPin), LEN(lenPin), pwmStep(step),
-      targetPWM(0), currentPWM(0) {}
+    : RPWM(rpwmPin), LPWM(lpwmPin), REN(renPin), LEN(lenPin), targetPWM(0), currentPWM(0), pwmStep(step),
+      pwmPeak(255), brakePWM(255), brakeStep(255), coasting(false), ramping(false) {}
 
-void Motor::begin(int pwmFreqHz, int pwmResBits) {
+FLASHMEM void Motor::begin(int pwmFreqHz, int pwmResBits) {
     pinMode(RPWM,   OUTPUT);
     pinMode(LPWM,   OUTPUT);
     pinMode(REN,    OUTPUT);
@@ -23,12 +23,47 @@ void Motor::begin(int pwmFreqHz, int pwmResBits) {
 
 void Motor::setTarget(int pwm) {
     targetPWM = constrain(pwm, -255, 255);
+    if (targetPWM != 0) ramping = false;
 }
 
-void Motor::update() {
-    // Ramp logic
-    if(currentPWM < targetPWM) currentPWM = min(currentPWM + pwmStep, targetPWM);
-    else if(currentPWM > targetPWM) currentPWM = max(currentPWM - pwmStep, targetPWM);
+void Motor::setLimits(int peak, int step) {
+    pwmPeak = constrain(peak, 0, 255);
+    pwmStep = max(step, 1);
+}
+
+void Motor::setBrakeLimits(int pwm, int step) {
+    brakePWM  = constrain(pwm, 0, 255);
+    brakeStep = max(step, 1);
+}
+
+StopMode Motor::fastestSafeStop() const {
+    return abs(currentPWM) <= brakePWM ? STOP_BRAKE : STOP_RAMP;
+}
+
+FASTRUN void Motor::update() {
+    if (ramping) {
+        // Controlled stop: down at brakeStep until braking outright is safe
+        if (abs(currentPWM) <= brakePWM) {
+            currentPWM = 0;
+            ramping    = false;
+        } else {
+            // Never past zero, whatever brakePWM and brakeStep are
+            currentPWM = (currentPWM > 0) ? max(currentPWM - brakeStep, 0) : min(currentPWM + brakeStep, 0);
+            if (currentPWM == 0) ramping = false;
+        }
+    } else {
+        // Coasting: the bridge stays open until there is something to drive
+        if (coasting) {
+            if (targetPWM == 0) return;
+            digitalWrite(REN, HIGH);
+            digitalWrite(LEN, HIGH);
+            coasting = false;
+        }
+        // Ramp logic, toward the target held under the governor's ceiling
+        const int target = constrain(targetPWM, -pwmPeak, pwmPeak);
+        if(currentPWM < target) currentPWM = min(currentPWM + pwmStep, target);
+        else if(currentPWM > target) currentPWM = max(currentPWM - pwmStep, target);
+    }
 
     if(currentPWM >= 0){
         analogWrite(RPWM, currentPWM);
@@ -39,12 +74,24 @@ void Motor::update() {
     }
 }
 
-// CRITICAL SAFETY FUNCTION
-void Motor::emergencyStop() {
-    targetPWM   = 0;
+// Zero on both inputs with the enables high turns both low-side switches
+// on; with the enables low both half-bridges are open.
+FASTRUN void Motor::stop(StopMode mode) {
+    targetPWM = 0;
+    ramping   = (mode == STOP_RAMP);
+    if (ramping) return;    // update() walks the duty down
+
     currentPWM  = 0;
+    coasting    = (mode == STOP_COAST);
     analogWrite(RPWM, 0);
     analogWrite(LPWM, 0);
+    digitalWrite(REN, coasting ? LOW : HIGH);
+    digitalWrite(LEN, coasting ? LOW : HIGH);
+}
+
+// CRITICAL SAFETY FUNCTION
+FASTRUN void Motor::emergencyStop() {
+    stop(STOP_BRAKE);
 }
 
 int Motor::getCurrentPWM() const { return currentPWM; }
\ No newline at end of file
@@ -3,19 +3,39 @@
 
 #include <Arduino.h>
 
+// How the bridge stops the wheel
+enum StopMode : uint8_t {
+    STOP_COAST,     // Enables low: both half-bridges open, the wheel rolls on
+    STOP_BRAKE,     // Both low sides on: the shorted winding brakes at once
+    STOP_RAMP       // Duty down by brakeStep per update to brakePWM, then brake
+};
+
 class Motor {
 private:
     int RPWM, LPWM, REN, LEN;
     int targetPWM, currentPWM;
     int pwmStep;
+    int pwmPeak;
+    int brakePWM, brakeStep;
+    bool coasting, ramping;
 
 public:
     Motor(int rpwm, int lpwm, int ren, int len, int step = 5);
     void begin(int pwmFreqHz = 15000, int pwmResBits = 8);
     void setTarget(int pwm);      
     void update();                
+
+    // Power governor: duty ceiling and ramp per update (BatteryMonitor.h)
+    void setLimits(int peak, int step);
+
+    // Stopping: a non-zero target drives again after any of them
+    void stop(StopMode mode);
+    // Highest duty to brake from outright, and the ramp above it
+    void setBrakeLimits(int pwm, int step);
+    // Brake from up to brakePWM, ramp down to it from above
+    StopMode fastestSafeStop() const;
     
-    // Safety: Immediate Hard Stop
+    // Safety: Immediate Hard Stop (dynamic brake)
     void emergencyStop(); 
     
     int getCurrentPWM() const;
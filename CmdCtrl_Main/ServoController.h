@@ -11,28 +11,42 @@ public:
     int                 servoMin    = 150;
     int                 servoMax    = 600;
     float               angles[numServos];
-    float               speeds[numServos];
+    float               speeds[numServos];      // deg/s
     float               sensitivity[numServos];
-    float               maxSpeed    = 2.0;
-    float               accel       = 0.05;
-    float               decel       = 0.05;
+    float               maxSpeed    = 100.0;    // deg/s
+    float               accel       = 125.0;    // deg/s^2
+    float               decel       = 125.0;    // deg/s^2
+    float               maxStepS    = 0.1;      // longest gap integrated at once (stalled loop)
 
     ServoController() : pwm() {
         for (int i = 0; i < numServos; i++) {
             angles[i]       = 90;
             speeds[i]       = 0;
             sensitivity[i]  = 1.0;
+            _targets[i]     = 0;
         }
     }
 
-    void begin() {
+    FLASHMEM void begin() {
         pwm.begin();
         pwm.setPWMFreq(60);
         delay(10);
     }
     
-    void emergencyStop() {
-        for(int i = 0; i < numServos; i++) speeds[i] = 0;
+    FASTRUN void emergencyStop() {
+        for(int i = 0; i < numServos; i++) speeds[i] = _targets[i] = 0;
+    }
+
+    /// Put every joint at 'target' (deg) directly, bypassing the jog ramp.
+    FASTRUN void moveTo(const float target[]) {
+        for (int i = 0; i < numServos; i++) setAngle(i, target[i]);
+    }
+
+    /// Put joint 'i' at 'deg' directly, bypassing the jog ramp.
+    FASTRUN void setAngle(int i, float deg) {
+        speeds[i]   = _targets[i] = 0;
+        angles[i]   = constrain(deg, 0, 180);
+        pwm.setPWM(i, 0, angleToPulse((int)angles[i]));
     }
 
     bool isActive() {
@@ -46,21 +60,60 @@ public:
         return map(angle, 0, 180, servoMin, servoMax);
     }
 
-    void update(char commands[]) {
+    /// The servo tick. Moves the joints over the time since the last call
+    /// under the commands given then, and takes 'commands' from 'nowUs' on.
+    /// The motion is integrated exactly (speed ramps at accel/decel, angle
+    /// takes the area under it), so the path does not depend on the tick
+    /// period or its jitter.
+    FASTRUN void update(char commands[], uint32_t nowUs) {
+        const float dt = _started ? min((nowUs - _lastUs) * 1e-6f, maxStepS) : 0.0f;
+        _lastUs  = nowUs;
+        _started = true;
+
         for (int i = 0; i < numServos; i++) {
-            float targetSpeed = 0;
-            if (commands[i] == 'L') targetSpeed = -maxSpeed * sensitivity[i];
-            else if (commands[i] == 'R') targetSpeed = maxSpeed * sensitivity[i];
-
-            // Ramp logic
-            if (speeds[i] < targetSpeed) speeds[i] = min(speeds[i] + accel, targetSpeed);
-            else if (speeds[i] > targetSpeed) speeds[i] = max(speeds[i] - decel, targetSpeed);
-            
-            angles[i] += speeds[i];
-            angles[i] = constrain(angles[i], 0, 180);
+            const float v0   = speeds[i];
+            const float vt   = _targets[i];
+            const float rate = (v0 < vt) ? accel : decel;
+            const float v1   = speedAfter(v0, vt, rate, dt);
+            float       a    = angles[i] + travel(v0, vt, rate, dt);
+
+            // Against a stop the joint stays there until its speed turns
+            // round, then moves off by what it covers after that
+            if ((v0 > 0 && v1 < 0) || (v0 < 0 && v1 > 0)) {
+                const float turn = angles[i] + travel(v0, vt, rate, fabsf(v0) / rate);
+                if (turn > 180) a -= turn - 180;
+                else if (turn < 0) a -= turn;
+            }
+            angles[i] = constrain(a, 0, 180);
+            speeds[i] = v1;
+
+            _targets[i] = 0;
+            if (commands[i] == 'L') _targets[i] = -maxSpeed * sensitivity[i];
+            else if (commands[i] == 'R') _targets[i] = maxSpeed * sensitivity[i];
+
             pwm.setPWM(i, 0, angleToPulse((int)angles[i]));
         }
     }
+
+private:
+    float               _targets[numServos];    // deg/s, from the last commands
+    uint32_t            _lastUs     = 0;
+    bool                _started    = false;
+
+    /// Speed after 'dt' s ramping from 'v' toward 'target' at 'rate'.
+    static float speedAfter(float v, float target, float rate, float dt) {
+        if (v < target) return min(v + rate * dt, target);
+        return max(v - rate * dt, target);
+    }
+
+    /// Distance covered in 'dt' s by a speed ramping from 'v' toward
+    /// 'target' at 'rate', then holding it.
+    static float travel(float v, float target, float rate, float dt) {
+        if (rate <= 0 || v == target) return v * dt;
+        const float tr = fabsf(target - v) / rate;
+        if (dt <= tr) return v * dt + 0.5f * (v < target ? rate : -rate) * dt * dt;
+        return 0.5f * (v + target) * tr + target * (dt - tr);
+    }
 };
 
 #endif
\ No newline at end of file
@@ -5,19 +5,44 @@
 enum SystemCode : uint16_t {
     SYS_BOOT_START          = 1000,
     SYS_BOOT_COMPLETE       = 1001,
+    SYS_SHUTDOWN            = 1004, // Battery at cutoff: stopped, log closed out
     
     // --- ACTUATOR STATUS ---
     ACT_INIT_START          = 2000,
     ACT_MOTORS_READY        = 2001,
     ACT_SERVOS_READY        = 2002,
+
+    // --- ARM MACROS ---
+    ACT_MACRO_RECORD        = 2010, // Recording started
+    ACT_MACRO_SAVED         = 2011, // Take written to SD
+    ACT_MACRO_PLAY          = 2012, // Replay started
+    ACT_MACRO_DONE          = 2013, // Replay reached its last frame
+
+    // --- COMMAND SOURCES (see COMMAND_SOURCES in CmdCtrl_Main.ino) ---
+    ACT_CONTROL_USB         = 2020, // USB took control (2020 + source id)
+    ACT_CONTROL_RADIO       = 2021, // Radio took control
+    ACT_CONTROL_RELEASED    = 2022, // Holder went quiet for its lease
     
     // --- SAFETY EVENTS ---
     SAFE_FAILSAFE_TRIGGER   = 4005, // "I haven't heard from you! Stopping."
     SAFE_FAILSAFE_CLEAR     = 4006, // "Command received. Resuming."
+    SAFE_MACRO_ABORT        = 4007, // Replay stopped (jog, MA or failsafe)
+    SAFE_ARM_LIMIT          = 4008, // Cartesian move held at the arm's reach or a servo's travel
+    SAFE_DRIVE_STOP         = 4009, // X stop (obstacle): wheels held until a 0,0 line
+
+    // --- HEALTH WARNINGS ---
+    WARN_CPU_LOAD           = 4010,
+    WARN_LOOP_SLOW          = 4011,
+    WARN_STACK_LOW          = 4012,
+    WARN_RAM_LOW            = 4013,
+    WARN_UART_FULL          = 4014,
+    WARN_BATTERY_LOW        = 4016, // Charge under BatteryConfig::lowSoc: motors held to 75 %
+    WARN_BATTERY_CRITICAL   = 4017, // Under criticalSoc: motors held to 50 %
     
     // --- ERRORS ---
     ERR_I2C_HANG            = 5005,
-    ERR_WATCHDOG_RESET      = 5007
+    ERR_WATCHDOG_RESET      = 5007,
+    ERR_MACRO_FILE          = 5010  // Macro missing, invalid or not written
 };
 
 #endif
\ No newline at end of file
@@ -10,7 +10,11 @@ import threading
 import time
 import json
 import re
-from typing import Optional, Callable, Dict, Any
+from typing import Optional, Callable, Dict, Any, Iterable
+
+from cores import fec
+from cores.events import EventReceiver
+from cores.tdma import TdmaCoordinator, TdmaScheduler
 
 
 class ConnectionPort:
@@ -67,6 +71,23 @@ class ConnectionPort:
         # Callbacks for data updates (for future extensibility)
         self.on_data_callback: Optional[Callable] = None
         self.on_error_callback: Optional[Callable] = None
+        self.on_event_callback: Optional[Callable] = None
+
+        # TDMA uplink scheduler (None = send immediately, see enable_tdma)
+        self.tdma: Optional[TdmaScheduler] = None
+
+        # Reed-Solomon frames: always decoded, sent once enable_fec() is on
+        self.fec_decoder = fec.FecDecoder()
+        self.fec_tx = False
+        self.fec_seq = 0
+        self.remote_fec: Dict[str, Dict[str, int]] = {}     # "F,n=.." counter lines
+        self.remote_rates: Dict[str, Dict[str, float]] = {} # "R,n=.." record rate per sink (Hz)
+        self.remote_imu: Dict[str, Dict[str, str]] = {}     # "I,n=.." IMU reports, delivered/requested Hz
+
+        # Acknowledged SystemCode events ("E,..." lines, see cores/events.py)
+        self.events = EventReceiver()
+        self.acks_sent = 0
+        self._rx_line = bytearray()
     
     def set_data_callback(self, callback: Callable[[Dict[str, Any]], None]):
         """Set callback function to be called when new data is parsed."""
@@ -75,6 +96,10 @@ class ConnectionPort:
     def set_error_callback(self, callback: Callable[[Exception], None]):
         """Set callback function to be called on errors."""
         self.on_error_callback = callback
+
+    def set_event_callback(self, callback: Callable[[int, int], None]):
+        """Set callback for each new rover event: callback(code, t_ms)."""
+        self.on_event_callback = callback
     
     def detect_apc220_port(self) -> Optional[str]:
         """
@@ -140,6 +165,7 @@ class ConnectionPort:
     
     def disconnect(self):
         """Disconnect from serial port."""
+        self.disable_tdma()
         self.is_running = False
         if self.read_thread:
             self.read_thread.join(timeout=2.0)
@@ -173,17 +199,11 @@ class ConnectionPort:
                 if self.serial_port and self.serial_port.is_open:
                     # Read available data
                     if self.serial_port.in_waiting > 0:
-                        raw_data = self.serial_port.readline()
-                        try:
-                            # Decode bytes to string
-                            data_string = raw_data.decode('utf-8', errors='ignore').strip()
-                            if data_string:
-                                self.packets_received += 1
-                                self._parse_and_update(data_string)
-                        except UnicodeDecodeError:
-                            # Try alternative encoding
+                        raw_data = self.serial_port.read(self.serial_port.in_waiting)
+                        for line in self._split_frames(raw_data):
                             try:
-                                data_string = raw_data.decode('ascii', errors='ignore').strip()
+                                # Decode bytes to string
+                                data_string = line.decode('utf-8', errors='ignore').strip()
                                 if data_string:
                                     self.packets_received += 1
                                     self._parse_and_update(data_string)
@@ -209,11 +229,63 @@ class ConnectionPort:
                 if self.on_error_callback:
                     self.on_error_callback(e)
     
+    def _split_frames(self, raw_data: bytes):
+        """Yield complete lines: decoded FEC frames and plain text lines."""
+        for b in raw_data:
+            result = self.fec_decoder.feed(b)
+            if result == fec.FRAME:
+                yield self.fec_decoder.payload
+            elif result == fec.TEXT:
+                if b == 0x0A:
+                    yield bytes(self._rx_line)
+                    self._rx_line.clear()
+                elif len(self._rx_line) < 1024:
+                    self._rx_line.append(b)
+
     def _parse_and_update(self, data_string: str):
         """
         Parse data string and update status_store.
         Supports multiple formats: JSON, CSV, and custom formats.
         """
+        # TDMA slot reports size the next superframe; they carry no status
+        if self.tdma and self.tdma.coordinator.on_line(data_string):
+            return
+
+        # Events are acked every time (the rover resends until it hears one);
+        # only the first copy is reported
+        if data_string.startswith("E,"):
+            event = self.events.on_line(data_string)
+            if self.events.epoch is not None and self.send_command(self.events.ack_line()):
+                self.acks_sent += 1
+            if event and self.on_event_callback:
+                self.on_event_callback(*event)
+            return
+
+        # FEC counters of a rover node ("F,n=TLM,ok=..,fix=..,sym=..,bad=..")
+        if data_string.startswith("F,n="):
+            fields = dict(kv.split("=", 1) for kv in data_string.split(",")[1:] if "=" in kv)
+            node = fields.pop("n", "?")
+            self.remote_fec[node] = {k: int(v) for k, v in fields.items() if v.isdigit()}
+            return
+
+        # Record rate per sink of a rover node ("R,n=TLM,t=..,usb=..,radio=..,sd=..");
+        # the rover adapts them to its queues, so rescale with "radio" here
+        if data_string.startswith("R,n="):
+            fields = dict(kv.split("=", 1) for kv in data_string.split(",")[1:] if "=" in kv)
+            node = fields.pop("n", "?")
+            try:
+                self.remote_rates[node] = {k: float(v) for k, v in fields.items()}
+            except ValueError:
+                self.parse_errors += 1
+            return
+
+        # IMU reports of a rover node ("I,n=TLM,t=..,28=99.6/100,..,rst=1")
+        if data_string.startswith("I,n="):
+            fields = dict(kv.split("=", 1) for kv in data_string.split(",")[1:] if "=" in kv)
+            node = fields.pop("n", "?")
+            self.remote_imu[node] = fields
+            return
+
         try:
             # Determine format if auto
             format_type = self.data_format
@@ -416,9 +488,14 @@ class ConnectionPort:
         """
         if not self.is_connected or not self.serial_port or not self.serial_port.is_open:
             return False
+
+        # Under TDMA the command waits for the next uplink slot
+        if self.tdma:
+            self.tdma.submit(command)
+            return True
         
         try:
-            self.serial_port.write((command + '\n').encode('utf-8'))
+            self.serial_port.write(self._encode_line(command))
             return True
         except Exception as e:
             print(f"Error sending command: {e}")
@@ -426,6 +503,45 @@ class ConnectionPort:
                 self.on_error_callback(e)
             return False
     
+    def enable_tdma(self, frame_ms: int = 320, nodes: Iterable[int] = (1,)) -> bool:
+        """
+        Coordinate the shared APC220 channel with TDMA superframes (see
+        cores/tdma.py). Rover nodes follow the beacons; other nodes are
+        picked up from their slot reports.
+        """
+        if not self.is_connected or not self.serial_port:
+            return False
+        self.disable_tdma()
+        coordinator = TdmaCoordinator(frame_ms, self.baudrate)
+        for node_id in nodes:
+            coordinator.add_node(node_id)
+        coordinator.fec = self.fec_tx
+        self.tdma = TdmaScheduler(self.serial_port.write, coordinator, self.baudrate,
+                                  encode=self._encode_line)
+        self.tdma.start()
+        return True
+
+    def enable_fec(self, enabled: bool = True):
+        """
+        Send commands (and TDMA beacons) as Reed-Solomon frames, see
+        cores/fec.py. The rover accepts frames and plain lines alike.
+        """
+        self.fec_tx = enabled
+        if self.tdma:
+            self.tdma.coordinator.fec = enabled
+
+    def _encode_line(self, line: str) -> bytes:
+        if not self.fec_tx or not line:
+            return (line + '\n').encode('utf-8')
+        self.fec_seq = (self.fec_seq + 1) & 0xFF
+        return fec.encode_line(line, self.fec_seq)
+
+    def disable_tdma(self):
+        """Back to sending commands immediately; nodes free-run after 3 frames."""
+        if self.tdma:
+            self.tdma.stop()
+            self.tdma = None
+
     def get_statistics(self) -> Dict[str, int]:
         """Get communication statistics."""
         return {
@@ -433,7 +549,15 @@ class ConnectionPort:
             "packets_parsed": self.packets_parsed,
             "parse_errors": self.parse_errors,
             "is_connected": 1 if self.is_connected else 0,
-            "is_running": 1 if self.is_running else 0
+            "is_running": 1 if self.is_running else 0,
+            "tdma_beacons": self.tdma.beacons_sent if self.tdma else 0,
+            "fec_frames": self.fec_decoder.stats["frames"],
+            "fec_corrected": self.fec_decoder.stats["corrected"],
+            "fec_uncorrectable": self.fec_decoder.stats["uncorrectable"],
+            "events_unique": self.events.unique,
+            "events_duplicate": self.events.duplicates,
+            "events_bad_crc": self.events.bad_crc,
+            "event_acks_sent": self.acks_sent
         }
 
 
@@ -683,6 +807,64 @@ class RoboticHand:
             return f"S{idx+1}A{int(self.angles[idx])}"
 
 
+# ---------------- Motor Line Hold ----------------
+
+class MotorLineHold:
+    """
+    Holds the motor line on the uplink without re-sending it every loop.
+    The line goes out when it changes, and in full again every REFRESH_S so
+    a lost change is corrected. In between, a "K" keepalive every
+    keepalive_s refreshes the rover's failsafe timer and keeps its targets.
+    keepalive_s should be a fraction of the failsafe time of the link: 500 ms
+    on the radio, 250 ms on USB (COMMAND_SOURCES in CmdCtrl_Main.ino).
+    """
+
+    KEEPALIVE = "K"
+    REFRESH_S = 1.0
+
+    def __init__(self, keepalive_s: float = 0.125):
+        """
+        Args:
+            keepalive_s: Seconds between keepalives while the line holds
+        """
+        self.keepalive_s = keepalive_s
+        self.keepalives = 0
+        self.refreshes = 0
+        self._line: Optional[str] = None
+        self._next_keepalive = 0.0
+        self._next_refresh = 0.0
+
+    def line(self, motor_line: str, now: Optional[float] = None) -> Optional[str]:
+        """
+        What to send for the current motor line.
+
+        Returns:
+            The motor line, "K", or None when nothing is due
+        """
+        now = time.monotonic() if now is None else now
+        if motor_line != self._line or now >= self._next_refresh:
+            if motor_line == self._line:
+                self.refreshes += 1
+            self.sent(motor_line, now)
+            return motor_line
+        if now >= self._next_keepalive:
+            self._next_keepalive = now + self.keepalive_s
+            self.keepalives += 1
+            return self.KEEPALIVE
+        return None
+
+    def sent(self, motor_line: str, now: Optional[float] = None):
+        """Note a full motor line sent some other way (e.g. with servo commands)."""
+        now = time.monotonic() if now is None else now
+        self._line = motor_line
+        self._next_refresh = now + self.REFRESH_S
+        self._next_keepalive = now + self.keepalive_s
+
+    def reset(self):
+        """Send the next line in full (new link, or control taken back)."""
+        self._line = None
+
+
 # ---------------- Global Command Generator ----------------
 
 class GlobalCommandGenerator:
@@ -0,0 +1,94 @@
+"""
+Events Module
+Ground side of the acknowledged SystemCode channel. Mirrors EventReceiver
+in libraries/AmbotCommon/src/EventLink.cpp: the rover resends every event
+until it is acknowledged, so the ground drops duplicates and answers with
+a cumulative ack plus a bitmap of what arrived beyond it.
+
+Event (rover -> ground):  E,<epoch>,<seq>,<code>,<t_ms>*<crc>
+Ack   (ground -> rover):  A,<epoch>,<cum>,<bitmap hex>*<crc>
+
+crc is CRC-8 (poly 0x07) of the text before '*', two hex digits. Lines
+that fail it are ignored, as a corrupted digit could invent an event.
+"""
+
+from typing import Optional, Tuple
+
+WINDOW = 32
+
+
+def crc8(text: str) -> int:
+    crc = 0
+    for b in text.encode("utf-8"):
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def seal(body: str) -> str:
+    return f"{body}*{crc8(body):02X}"
+
+
+def unseal(line: str) -> Optional[str]:
+    """The line without its checksum, or None if it does not match."""
+    body, star, crc = line.rpartition("*")
+    if not star or len(crc) != 2:
+        return None
+    try:
+        return body if int(crc, 16) == crc8(body) else None
+    except ValueError:
+        return None
+
+
+class EventReceiver:
+    """Duplicate filter and ack generator for one rover."""
+
+    def __init__(self):
+        self.epoch: Optional[int] = None
+        self.cum = 0
+        self.bitmap = 0
+        self.unique = 0
+        self.duplicates = 0
+        self.bad_crc = 0
+
+    def on_line(self, line: str) -> Optional[Tuple[int, int]]:
+        """(code, t_ms) for an event seen for the first time, else None."""
+        body = unseal(line)
+        if body is None:
+            self.bad_crc += 1
+            return None
+        try:
+            _, epoch, seq, code, t_ms = body.split(",")
+            epoch, seq, code, t_ms = int(epoch), int(seq), int(code), int(t_ms)
+        except ValueError:
+            return None
+        if not 0 < seq <= 0xFFFF:
+            return None
+
+        if epoch != self.epoch:                     # rover rebooted
+            self.epoch, self.cum, self.bitmap = epoch, 0, 0
+
+        d = (seq - self.cum) & 0xFFFF
+        if d == 0 or d >= 0x8000:
+            self.duplicates += 1
+            return None
+        if d > WINDOW:
+            # Too far ahead (an evicted or long-lost seq): give up on the oldest
+            shift = d - WINDOW
+            self.bitmap = 0 if shift >= WINDOW else self.bitmap >> shift
+            self.cum = (self.cum + shift) & 0xFFFF
+            d = WINDOW
+        bit = 1 << (d - 1)
+        if self.bitmap & bit:
+            self.duplicates += 1
+            return None
+        self.bitmap |= bit
+        while self.bitmap & 1:
+            self.bitmap >>= 1
+            self.cum = (self.cum + 1) & 0xFFFF
+        self.unique += 1
+        return code, t_ms
+
+    def ack_line(self) -> str:
+        return seal(f"A,{self.epoch},{self.cum},{self.bitmap:x}")
@@ -0,0 +1,227 @@
+"""
+FEC Module
+Ground-side Reed-Solomon framing for the APC220 link. Mirrors
+libraries/AmbotCommon/src/Fec.cpp byte for byte: GF(256) with polynomial
+0x11D, first consecutive root a^0, highest-degree-first codewords.
+
+Frame on air:
+    0xB5 | len, seq + 4 parity | payload in blocks of 32 + 8 parity,
+                                 interleaved column by column
+
+Frames and plain text lines share the stream (text is 7-bit ASCII);
+FecDecoder hands non-frame bytes back as text.
+"""
+
+from typing import Dict, List, Optional, Tuple
+
+SYNC = 0xB5
+HEADER_DATA = 2
+HEADER_PARITY = 4
+BLOCK_DATA = 32
+PARITY = 8
+MAX_PAYLOAD = 255
+
+# Decoder results
+BUSY, TEXT, FRAME, BAD = range(4)
+
+_EXP = [0] * 512
+_LOG = [0] * 256
+_x = 1
+for _i in range(255):
+    _EXP[_i] = _x
+    _LOG[_x] = _i
+    _x <<= 1
+    if _x & 0x100:
+        _x ^= 0x11D
+for _i in range(255, 512):
+    _EXP[_i] = _EXP[_i - 255]
+
+
+def _mul(a: int, b: int) -> int:
+    return _EXP[_LOG[a] + _LOG[b]] if a and b else 0
+
+
+def _div(a: int, b: int) -> int:
+    return _EXP[_LOG[a] + 255 - _LOG[b]] if a else 0
+
+
+def _generator(nsym: int) -> List[int]:
+    g = [1]
+    for i in range(nsym):
+        g = g + [0]
+        for j in range(len(g) - 1, 0, -1):
+            g[j] ^= _mul(g[j - 1], _EXP[i])
+    return g
+
+
+_GEN = {HEADER_PARITY: _generator(HEADER_PARITY), PARITY: _generator(PARITY)}
+
+
+def frame_size(n: int) -> int:
+    """Bytes on air for a payload of n bytes."""
+    return 1 + HEADER_DATA + HEADER_PARITY + n + ((n + BLOCK_DATA - 1) // BLOCK_DATA) * PARITY
+
+
+def rs_encode(data: bytes, nsym: int) -> bytes:
+    g = _GEN[nsym]
+    parity = [0] * nsym
+    for d in data:
+        coef = d ^ parity[0]
+        parity = parity[1:] + [0]
+        if coef:
+            for j in range(nsym):
+                parity[j] ^= _mul(g[j + 1], coef)
+    return bytes(parity)
+
+
+def rs_decode(cw: bytearray, nsym: int) -> int:
+    """Correct cw in place. Returns the bytes fixed, or -1."""
+    n = len(cw)
+    synd = []
+    for j in range(nsym):
+        v = 0
+        for c in cw:
+            v = (_EXP[_LOG[v] + j] if v else 0) ^ c
+        synd.append(v)
+    if not any(synd):
+        return 0
+
+    # Berlekamp-Massey
+    lam = [1] + [0] * nsym
+    prev = [1] + [0] * nsym
+    L, m, b = 0, 1, 1
+    for r in range(nsym):
+        d = synd[r]
+        for i in range(1, L + 1):
+            d ^= _mul(lam[i], synd[r - i])
+        if not d:
+            m += 1
+            continue
+        t = list(lam)
+        coef = _div(d, b)
+        for i in range(nsym + 1 - m):
+            lam[i + m] ^= _mul(coef, prev[i])
+        if 2 * L <= r:
+            L, prev, b, m = r + 1 - L, t, d, 1
+        else:
+            m += 1
+    if 2 * L > nsym:
+        return -1
+
+    omega = [0] * nsym
+    for i in range(nsym):
+        for j in range(min(i, L) + 1):
+            omega[i] ^= _mul(lam[j], synd[i - j])
+
+    fixes: List[Tuple[int, int]] = []
+    for i in range(n):
+        x_log = n - 1 - i
+        xi = _EXP[(255 - x_log) % 255]
+        q = 0
+        for j in range(L, -1, -1):
+            q = _mul(q, xi) ^ lam[j]
+        if q:
+            continue
+        num = 0
+        for j in range(nsym - 1, -1, -1):
+            num = _mul(num, xi) ^ omega[j]
+        xi2 = _mul(xi, xi)
+        den = 0
+        for j in range(L & ~1, -1, -2):
+            den = _mul(den, xi2) ^ lam[j + 1]
+        if not den:
+            return -1
+        fixes.append((i, _mul(_EXP[x_log], _div(num, den))))
+    if len(fixes) != L:
+        return -1
+    for i, e in fixes:
+        cw[i] ^= e
+    return L
+
+
+def _block_lengths(n: int) -> List[int]:
+    return [min(BLOCK_DATA, n - b) for b in range(0, n, BLOCK_DATA)]
+
+
+def encode(payload: bytes, seq: int = 0) -> bytes:
+    """One frame for payload (1..255 bytes, no newline)."""
+    n = len(payload)
+    if not 0 < n <= MAX_PAYLOAD:
+        raise ValueError(f"FEC payload must be 1..{MAX_PAYLOAD} bytes, got {n}")
+    header = bytes((n, seq & 0xFF))
+    blocks = []
+    for b, k in enumerate(_block_lengths(n)):
+        data = payload[b * BLOCK_DATA:b * BLOCK_DATA + k]
+        blocks.append(data + rs_encode(data, PARITY))
+    out = bytearray((SYNC,)) + header + rs_encode(header, HEADER_PARITY)
+    for col in range(BLOCK_DATA + PARITY):
+        for block in blocks:
+            if col < len(block):
+                out.append(block[col])
+    return bytes(out)
+
+
+def encode_line(line: str, seq: int = 0) -> bytes:
+    return encode(line.encode("utf-8"), seq)
+
+
+class FecDecoder:
+    """Byte-at-a-time receiver; see FecDecoder in Fec.h."""
+
+    def __init__(self):
+        self._state = 0                 # 0 idle, 1 header, 2 body
+        self._buf = bytearray()
+        self._need = 0
+        self._len = 0
+        self._hdr_fixed = 0
+        self.payload: Optional[bytes] = None
+        self.stats: Dict[str, int] = {"frames": 0, "corrected": 0, "bytes_fixed": 0,
+                                      "uncorrectable": 0}
+
+    def feed(self, b: int) -> int:
+        if self._state == 0:
+            if b != SYNC:
+                return TEXT
+            self._state, self._buf = 1, bytearray()
+            return BUSY
+        self._buf.append(b)
+        if self._state == 1:
+            if len(self._buf) < HEADER_DATA + HEADER_PARITY:
+                return BUSY
+            fixed = rs_decode(self._buf, HEADER_PARITY)
+            if fixed < 0 or self._buf[0] == 0:
+                self.stats["uncorrectable"] += 1
+                self._state = 0
+                return BAD
+            self._len, self._hdr_fixed = self._buf[0], fixed
+            self._need = frame_size(self._len) - 1 - HEADER_DATA - HEADER_PARITY
+            self._state, self._buf = 2, bytearray()
+            return BUSY
+        if len(self._buf) < self._need:
+            return BUSY
+        self._state = 0
+        return self._finish()
+
+    def _finish(self) -> int:
+        lengths = [k + PARITY for k in _block_lengths(self._len)]
+        blocks = [bytearray() for _ in lengths]
+        it = iter(self._buf)
+        for col in range(BLOCK_DATA + PARITY):
+            for b, size in enumerate(lengths):
+                if col < size:
+                    blocks[b].append(next(it))
+        fixed = self._hdr_fixed
+        payload = bytearray()
+        for block in blocks:
+            r = rs_decode(block, PARITY)
+            if r < 0:
+                self.stats["uncorrectable"] += 1
+                return BAD
+            fixed += r
+            payload += block[:-PARITY]
+        self.payload = bytes(payload)
+        self.stats["frames"] += 1
+        if fixed:
+            self.stats["corrected"] += 1
+            self.stats["bytes_fixed"] += fixed
+        return FRAME
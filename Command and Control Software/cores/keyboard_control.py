@@ -15,7 +15,7 @@ except ImportError:
     print("WARNING: 'keyboard' module not installed. Install with: pip install keyboard")
     KEYBOARD_AVAILABLE = False
 
-from cores.connection_port import TankController, RoboticHand, GlobalCommandGenerator
+from cores.connection_port import TankController, RoboticHand, GlobalCommandGenerator, MotorLineHold
 
 
 class KeyboardControlManager:
@@ -36,6 +36,8 @@ class KeyboardControlManager:
         self.tank_controller = TankController()
         self.robotic_hand = RoboticHand(num_servos=num_servos)
         self.command_generator = GlobalCommandGenerator()
+        # Motor line only on change, "K" keepalives and a 1 s refresh in between
+        self.motor_hold = MotorLineHold()
         
         self.is_running = False
         self.control_thread: Optional[threading.Thread] = None
@@ -56,6 +58,7 @@ class KeyboardControlManager:
     def set_connection_port(self, connection_port):
         """Set or update the connection port instance."""
         self.connection_port = connection_port
+        self.motor_hold.reset()
     
     def start(self):
         """Start keyboard control thread."""
@@ -67,6 +70,7 @@ class KeyboardControlManager:
             return True
         
         self.is_running = True
+        self.motor_hold.reset()
         self.control_thread = threading.Thread(target=self._control_loop, daemon=True)
         self.control_thread.start()
         print("Keyboard control thread started.")
@@ -133,8 +137,11 @@ class KeyboardControlManager:
                         left_pwm, right_pwm, servo_commands
                     )
                     self.connection_port.send_command(combined_cmd)
+                    self.motor_hold.sent(motor_cmd)
                 else:
-                    self.connection_port.send_command(motor_cmd)
+                    line = self.motor_hold.line(motor_cmd)
+                    if line:
+                        self.connection_port.send_command(line)
             
             # Check for exit
             if KEYBOARD_AVAILABLE and keyboard.is_pressed("esc"):
@@ -240,7 +247,9 @@ def _keyboard_control_loop_wrapper(toolbar):
                     except RuntimeError:
                         pass
                 
-                # Send command via connection_port or serial_port
+                # Send command via connection_port or serial_port; the motor
+                # line only on change, held with keepalives in between
+                motor_hold = toolbar._keyboard_manager.motor_hold
                 if connection_port and connection_port.is_connected:
                     motor_cmd = toolbar._keyboard_manager.command_generator.generate_motor_command(
                         left_pwm, right_pwm
@@ -251,13 +260,17 @@ def _keyboard_control_loop_wrapper(toolbar):
                             left_pwm, right_pwm, servo_commands
                         )
                         connection_port.send_command(combined_cmd)
+                        motor_hold.sent(motor_cmd)
                     else:
-                        connection_port.send_command(motor_cmd)
+                        line = motor_hold.line(motor_cmd)
+                        if line:
+                            connection_port.send_command(line)
                 elif serial_port and serial_port.is_open:
                     # Fallback to direct serial for backward compatibility
-                    cmd_string = f"{left_pwm},{right_pwm}\n"
+                    line = motor_hold.line(f"{left_pwm},{right_pwm}")
                     try:
-                        serial_port.write(cmd_string.encode())
+                        if line:
+                            serial_port.write(f"{line}\n".encode())
                     except Exception as e:
                         print(f"Serial write error: {e}")
                 
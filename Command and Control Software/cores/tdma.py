@@ -0,0 +1,207 @@
+"""
+TDMA Module
+Ground-side coordinator for the shared half-duplex APC220 channel. Mirrors
+TdmaCoordinator in libraries/AmbotCommon/src/Tdma.cpp: every superframe the
+ground sends a beacon that assigns the uplink slot (its own commands) and
+one downlink slot per rover node, sized by the queue depth each node
+reports at the start of its slot.
+
+Beacon:       @<seq>,<frame_ms>,<id>:<start>+<len>,...     (id 0 = uplink)
+Slot report:  Q,n=<id>,q=<queued bytes>,d=<dropped lines>
+
+Nodes that hear no beacon fall back to sending freely, so TDMA is opt-in:
+ConnectionPort.enable_tdma() starts the scheduler. With FEC on (cores/fec.py)
+beacons and commands go out as frames and are planned with frame airtimes.
+"""
+
+import threading
+import time
+from typing import Callable, Dict, List, Optional, Tuple
+
+from cores import fec
+
+UPLINK = 0
+JOIN = 255              # contention slot for nodes not yet listed
+JOIN_EVERY = 8
+REPORT_BYTES = 24
+MIN_UPLINK = 12
+MIN_NODE_EXTRA = 16
+
+
+class TdmaCoordinator:
+    """Plans superframes and formats beacons (no I/O)."""
+
+    def __init__(self, frame_ms: int = 320, baud: int = 9600, guard_ms: int = 12):
+        # Keep frame_ms below the actuator failsafe (500 ms): the motor line
+        # goes out once per superframe.
+        self.frame_ms = frame_ms
+        self.byte_ms = 10000.0 / baud
+        self.guard_ms = guard_ms
+        self.seq = 0
+        self.nodes: Dict[int, float] = {}       # id -> smoothed queue depth
+        self.slots: List[Tuple[int, int, int]] = []
+        self._beacon_bytes = 0
+        self.fec = False
+
+    def add_node(self, node_id: int) -> None:
+        if node_id not in (UPLINK, JOIN) and node_id not in self.nodes and len(self.nodes) < 7:
+            self.nodes[node_id] = 0.0
+
+    def on_line(self, line: str) -> bool:
+        """Feed a received line. Returns True if it was a slot report."""
+        if not line.startswith("Q,"):
+            return False
+        fields = dict(kv.split("=", 1) for kv in line.split(",")[1:] if "=" in kv)
+        try:
+            node_id, queued = int(fields["n"]), int(fields["q"])
+        except (KeyError, ValueError):
+            return True
+        self.add_node(node_id)
+        if node_id in self.nodes:
+            self.nodes[node_id] = 0.5 * self.nodes[node_id] + 0.5 * queued
+        return True
+
+    def slot(self, node_id: int) -> Optional[Tuple[int, int]]:
+        for sid, start, length in self.slots:
+            if sid == node_id:
+                return start, length
+        return None
+
+    def beacon(self, uplink_bytes: int) -> str:
+        """Plan the next superframe and return its beacon line (no newline)."""
+        self.seq = (self.seq + 1) & 0xFFFF
+        n_nodes = len(self.nodes)
+        if not self._beacon_bytes:
+            self._beacon_bytes = 10 + 12 * (n_nodes + 2)
+        budget = int(self.frame_ms - self._beacon_bytes * self.byte_ms) - self.guard_ms
+        report = fec.frame_size(REPORT_BYTES - 1) if self.fec else REPORT_BYTES
+        join_ms = int(report * self.byte_ms) + 1
+        min_node_ms = int((report + MIN_NODE_EXTRA) * self.byte_ms) + 1
+        uplink_ms = min(int(max(uplink_bytes, MIN_UPLINK) * self.byte_ms) + 1, self.frame_ms // 4)
+
+        rest = budget - self.guard_ms - uplink_ms - n_nodes * (min_node_ms + self.guard_ms)
+        join = (self.seq % JOIN_EVERY == 0 or n_nodes == 0) and rest >= join_ms + self.guard_ms
+        if join:
+            rest -= join_ms + self.guard_ms
+        rest = max(rest, 0)
+
+        demand = sum(self.nodes.values())
+        cursor = self.guard_ms
+        self.slots = [(UPLINK, cursor, uplink_ms)]
+        cursor += uplink_ms + self.guard_ms
+        for node_id, queued in self.nodes.items():
+            share = queued / demand if demand > 0 else 1.0 / n_nodes
+            length = min_node_ms + int(rest * share)
+            self.slots.append((node_id, cursor, length))
+            cursor += length + self.guard_ms
+        if join:
+            self.slots.append((JOIN, cursor, join_ms))
+
+        line = f"@{self.seq},{self.frame_ms}" + "".join(f",{s}:{a}+{n}" for s, a, n in self.slots)
+        wire = fec.frame_size(len(line)) if self.fec else len(line) + 1
+        self._beacon_bytes = wire + (0 if join else 12)
+        return line
+
+
+class TdmaScheduler:
+    """
+    Owns the uplink while TDMA is on: one beacon per superframe, then the
+    queued command lines that fit the uplink slot. Motor lines are held:
+    the newest replaces any waiting one and is re-sent every superframe.
+    Event acks (cores/events.py) go first and only the newest is kept.
+    """
+
+    def __init__(self, write: Callable[[bytes], None], coordinator: TdmaCoordinator,
+                 baud: int = 9600, encode: Optional[Callable[[str], bytes]] = None):
+        self.write = write
+        self.encode = encode or (lambda line: (line + "\n").encode("utf-8"))
+        self.coordinator = coordinator
+        self.byte_s = 10.0 / baud
+        self.pending: List[str] = []
+        self.motor_line: Optional[str] = None
+        self.ack_line: Optional[str] = None
+        self.lock = threading.Lock()
+        self.running = False
+        self.thread: Optional[threading.Thread] = None
+        self.beacons_sent = 0
+
+    @staticmethod
+    def _is_motor(line: str) -> bool:
+        body = line.split(":", 1)[-1]
+        return "," in body and not body.startswith("S")
+
+    def submit(self, line: str) -> None:
+        with self.lock:
+            if line.startswith("A,"):
+                self.ack_line = line
+            elif self._is_motor(line):
+                self.motor_line = line
+            else:
+                self.pending.append(line)
+
+    def start(self) -> None:
+        if self.running:
+            return
+        self.running = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def stop(self) -> None:
+        self.running = False
+        if self.thread:
+            self.thread.join(timeout=2.0)
+
+    def _run(self) -> None:
+        frame_s = self.coordinator.frame_ms / 1000.0
+        next_frame = time.monotonic()
+        while self.running:
+            with self.lock:
+                ack = self.ack_line
+                lines = ([ack] if ack else []) + self.pending
+                if self.motor_line:
+                    lines.append(self.motor_line)
+            wires = [self.encode(l) for l in lines]
+            uplink_bytes = sum(len(w) for w in wires)
+
+            beacon = self.encode(self.coordinator.beacon(uplink_bytes))
+            try:
+                self.write(beacon)
+            except Exception as e:
+                print(f"TDMA beacon error: {e}")
+                self.running = False
+                break
+            self.beacons_sent += 1
+            beacon_end = time.monotonic() + len(beacon) * self.byte_s
+
+            slot = self.coordinator.slot(UPLINK)
+            if slot:
+                start, length = slot
+                self._sleep_until(beacon_end + start / 1000.0)
+                budget = length / 1000.0
+                out = b""
+                sent = 0
+                for wire in wires:
+                    cost = len(wire) * self.byte_s
+                    if cost > budget:
+                        break
+                    budget -= cost
+                    out += wire
+                    sent += 1
+                if out:
+                    self.write(out)
+                with self.lock:
+                    # Drop what went out; a held motor line stays for the next frame
+                    if ack and sent:
+                        sent -= 1
+                        if self.ack_line == ack:
+                            self.ack_line = None
+                    self.pending = self.pending[min(sent, len(self.pending)):]
+
+            next_frame += frame_s
+            self._sleep_until(next_frame)
+
+    @staticmethod
+    def _sleep_until(deadline: float) -> None:
+        delay = deadline - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
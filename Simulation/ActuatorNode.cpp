@@ -0,0 +1,50 @@
+/**
+ * CmdCtrl_Main built for the host. Every library header is pulled in
+ * before the namespace opens, so the firmware's own #includes are no-ops.
+ */
+#include "Arduino.h"
+#include "Wire.h"
+#include "SdFat.h"
+#include "Watchdog_t4.h"
+#include "Adafruit_PWMServoDriver.h"
+#include "imxrt.h"
+#include "HealthMonitor.h"
+#include "TraceRecorder.h"
+#include "Tdma.h"
+#include "Fec.h"
+#include "CommandArbiter.h"
+#include "CommandEcho.h"
+#include "ArmKinematics.h"
+#include "BatteryMonitor.h"
+#include "Nodes.h"
+
+#ifdef BENCHMARK_MODE
+#include "AmbotBench.h"
+#endif
+
+namespace actuator {
+void runBenchmarks(Print& out);
+
+#include "../CmdCtrl_Main/CmdCtrl_Main.ino"
+#include "../CmdCtrl_Main/Benchmarks.ino"
+#include "../CmdCtrl_Main/GlobalVariables.cpp"
+#include "../CmdCtrl_Main/ArmMacros.cpp"
+#include "../CmdCtrl_Main/ArmCartesian.cpp"
+#include "../CmdCtrl_Main/MotorDriver.cpp"
+} // namespace actuator
+
+sim::Program sim::actuatorProgram() {
+    return Program{"actuator", &actuator::setup, &actuator::loop};
+}
+
+#ifdef BENCHMARK_MODE
+void sim::actuatorBenchmarks(Print& out) { actuator::runBenchmarks(out); }
+#endif
+
+const FecStats& sim::actuatorFec() { return actuator::radioFec.stats(); }
+
+const CommandArbiter& sim::actuatorArbiter() { return actuator::arbiter; }
+
+#ifdef TRACE_MODE
+TraceRecorder& sim::actuatorTrace() { return actuator::trace; }
+#endif
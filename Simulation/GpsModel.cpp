@@ -0,0 +1,197 @@
+#include "GpsModel.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace sim {
+
+namespace {
+constexpr double EARTH_R   = 6378137.0;
+constexpr double MPS_TO_KN = 1.9438445;
+
+void put16(std::vector<uint8_t>& v, size_t off, uint16_t x) { v[off] = x & 0xFF; v[off + 1] = x >> 8; }
+void put32(std::vector<uint8_t>& v, size_t off, uint32_t x) {
+    for (int i = 0; i < 4; i++) v[off + i] = (x >> (8 * i)) & 0xFF;
+}
+
+std::vector<uint8_t> ubxFrame(uint8_t cls, uint8_t id, const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> f = {0xB5, 0x62, cls, id, (uint8_t)(payload.size() & 0xFF), (uint8_t)(payload.size() >> 8)};
+    f.reserve(f.size() + payload.size() + 2);
+    f.insert(f.end(), payload.begin(), payload.end());
+    uint8_t a = 0, b = 0;
+    for (size_t i = 2; i < f.size(); i++) { a += f[i]; b += a; }
+    f.push_back(a);
+    f.push_back(b);
+    return f;
+}
+
+std::string nmeaCoord(double deg, bool isLat) {
+    double a   = fabs(deg);
+    int    d   = (int)a;
+    double m   = (a - d) * 60.0;
+    char   buf[32];
+    if (isLat) snprintf(buf, sizeof(buf), "%02d%08.5f,%c", d, m, deg >= 0 ? 'N' : 'S');
+    else       snprintf(buf, sizeof(buf), "%03d%08.5f,%c", d, m, deg >= 0 ? 'E' : 'W');
+    return buf;
+}
+} // namespace
+
+GpsModel::GpsModel(Node& telemetry, const RoverModel& rover, const GpsParams& p)
+    : _tlm(telemetry), _rover(rover), _p(p), _baud(p.bootBaud), _rateMs(p.bootRateMs),
+      _nextEpochNs(p.bootRateMs * 1000000ULL), _rng(p.seed) {}
+
+std::string GpsModel::nmeaChecksum(const std::string& body) {
+    uint8_t sum = 0;
+    for (char c : body) sum ^= (uint8_t)c;
+    char buf[8];
+    snprintf(buf, sizeof(buf), "*%02X\r\n", sum);
+    return "$" + body + buf;
+}
+
+void GpsModel::step(uint64_t t0, uint64_t t1) {
+    const double dt = (t1 - t0) * 1e-9;
+
+    // Bytes the firmware wrote to the receiver
+    _scratch.clear();
+    _tlm.board.ports[_p.port].takeDeparted(t1, _scratch);
+    for (const auto& tb : _scratch) {
+        if (tb.baud != _baud) { _rx.clear(); continue; }   // framing garbage
+        parseHostByte(tb.b, tb.t);
+    }
+    if (_pendingBaud && t1 >= _baudSwitchAt) {
+        _baud        = _pendingBaud;
+        _pendingBaud = 0;
+    }
+
+    // First-order Gauss-Markov position error
+    const double a = exp(-dt / _p.posErrorTauS);
+    const double q = _p.posErrorM * sqrt(1.0 - a * a);
+    _errE = a * _errE + q * _n01(_rng);
+    _errN = a * _errN + q * _n01(_rng);
+
+    while (t1 >= _nextEpochNs) {
+        emitEpoch(_nextEpochNs + 25000000ULL);   // ~25 ms nav solution latency
+        _nextEpochNs += _rateMs * 1000000ULL;
+    }
+}
+
+void GpsModel::parseHostByte(uint8_t b, uint64_t t) {
+    if (_rx.empty() && b != 0xB5) return;
+    if (_rx.size() == 1 && b != 0x62) { _rx.clear(); return; }
+    _rx.push_back(b);
+    if (_rx.size() < 6) return;
+    const size_t len = _rx[4] | (_rx[5] << 8);
+    if (len > 512) { _rx.clear(); return; }
+    if (_rx.size() < 8 + len) return;
+
+    uint8_t ca = 0, cb = 0;
+    for (size_t i = 2; i < 6 + len; i++) { ca += _rx[i]; cb += ca; }
+    if (ca == _rx[6 + len] && cb == _rx[7 + len]) {
+        std::vector<uint8_t> payload(_rx.begin() + 6, _rx.begin() + 6 + len);
+        handleUbx(_rx[2], _rx[3], payload, t);
+    } else {
+        _badFrames++;                                    // receiver silently drops it
+    }
+    _rx.clear();
+}
+
+void GpsModel::handleUbx(uint8_t cls, uint8_t id, const std::vector<uint8_t>& payload, uint64_t t) {
+    if (cls != 0x06) return;
+    _cfgFrames++;
+    if (id == 0x00 && payload.size() >= 20) {            // CFG-PRT
+        _pendingBaud  = payload[8] | (payload[9] << 8) | (payload[10] << 16) | ((uint32_t)payload[11] << 24);
+        _baudSwitchAt = t + 2000000ULL;
+    } else if (id == 0x08 && payload.size() >= 6) {      // CFG-RATE
+        uint16_t ms = payload[0] | (payload[1] << 8);
+        if (ms >= 25) _rateMs = ms;
+    }
+    auto ack = ubxFrame(0x05, 0x01, {cls, id});
+    send(t + 1000000ULL, ack.data(), ack.size());
+}
+
+void GpsModel::emitEpoch(uint64_t t) {
+    const RoverState& s   = _rover.state();
+    const double      lat0 = _p.originLat * M_PI / 180.0;
+    const bool        fix  = t * 1e-9 >= _p.fixDelayS;
+
+    const double lat    = _p.originLat + (s.y + _errN) / EARTH_R * 180.0 / M_PI;
+    const double lon    = _p.originLon + (s.x + _errE) / (EARTH_R * cos(lat0)) * 180.0 / M_PI;
+    const double alt    = _rover.params().baseAltitudeM + s.z;
+    double       speed  = fabs(s.speed) + _p.speedNoiseMps * _n01(_rng);
+    if (speed < 0) speed = 0;
+    double course = fmod(90.0 - s.yaw * 180.0 / M_PI + (s.speed < 0 ? 180.0 : 0.0) + 720.0, 360.0);
+
+    // UTC derived from virtual time, starting at 12:00:00.00
+    const uint64_t cs  = t / 10000000ULL + 12ULL * 3600 * 100;
+    char hhmmss[16];
+    snprintf(hhmmss, sizeof(hhmmss), "%02u%02u%02u.%02u",
+             (unsigned)(cs / 360000 % 24), (unsigned)(cs / 6000 % 60),
+             (unsigned)(cs / 100 % 60), (unsigned)(cs % 100));
+
+    char body[160];
+    if (fix) {
+        snprintf(body, sizeof(body), "GNRMC,%s,A,%s,%s,%.3f,%.2f,181026,,,A",
+                 hhmmss, nmeaCoord(lat, true).c_str(), nmeaCoord(lon, false).c_str(),
+                 speed * MPS_TO_KN, course);
+    } else {
+        snprintf(body, sizeof(body), "GNRMC,%s,V,,,,,,,181026,,,N", hhmmss);
+    }
+    std::string out = nmeaChecksum(body);
+
+    if (fix) {
+        snprintf(body, sizeof(body), "GNGGA,%s,%s,%s,1,12,0.8,%.1f,M,0.0,M,,",
+                 hhmmss, nmeaCoord(lat, true).c_str(), nmeaCoord(lon, false).c_str(), alt);
+    } else {
+        snprintf(body, sizeof(body), "GNGGA,%s,,,,,0,00,99.99,,,,,,", hhmmss);
+    }
+    out += nmeaChecksum(body);
+    send(t, (const uint8_t*)out.data(), out.size());
+    _sentences += 2;
+
+    if (_p.emitUbx) {
+        auto pvt = navPvt(t, lat, lon, alt, speed, course, fix);
+        send(t, pvt.data(), pvt.size());
+    }
+}
+
+std::vector<uint8_t> GpsModel::navPvt(uint64_t t, double lat, double lon, double alt,
+                                      double speed, double course, bool fix) const {
+    std::vector<uint8_t> p(92, 0);
+    const uint64_t ms = t / 1000000ULL + 12ULL * 3600 * 1000;
+    put32(p, 0, (uint32_t)(ms % (7ULL * 86400 * 1000)));       // iTOW
+    put16(p, 4, 2026); p[6] = 10; p[7] = 18;
+    p[8]  = (uint8_t)(ms / 3600000 % 24);
+    p[9]  = (uint8_t)(ms / 60000 % 60);
+    p[10] = (uint8_t)(ms / 1000 % 60);
+    p[11] = 0x07;                                                // date/time valid
+    p[20] = fix ? 3 : 0;                                         // 3D fix
+    p[21] = fix ? 0x01 : 0x00;                                   // gnssFixOK
+    p[23] = fix ? 12 : 0;
+    put32(p, 24, (uint32_t)(int32_t)lround(lon * 1e7));
+    put32(p, 28, (uint32_t)(int32_t)lround(lat * 1e7));
+    put32(p, 32, (uint32_t)(int32_t)lround(alt * 1000));
+    put32(p, 36, (uint32_t)(int32_t)lround(alt * 1000));
+    put32(p, 40, 1500);
+    put32(p, 44, 2500);
+    const double c = course * M_PI / 180.0;
+    put32(p, 48, (uint32_t)(int32_t)lround(speed * cos(c) * 1000));   // velN
+    put32(p, 52, (uint32_t)(int32_t)lround(speed * sin(c) * 1000));   // velE
+    put32(p, 60, (uint32_t)(int32_t)lround(speed * 1000));            // gSpeed
+    put32(p, 64, (uint32_t)(int32_t)lround(course * 1e5));            // headMot
+    put16(p, 76, 120);                                                // pDOP 1.20
+    return ubxFrame(0x01, 0x07, p);
+}
+
+void GpsModel::send(uint64_t t, const uint8_t* data, size_t n) {
+    SerialPort&    port = _tlm.board.ports[_p.port];
+    const uint64_t bt   = 10ULL * 1000000000ULL / _baud;
+    uint64_t       at   = t > _txFreeAt ? t : _txFreeAt;
+    for (size_t i = 0; i < n; i++) {
+        at += bt;
+        port.pushRx(at, data[i], _baud);
+    }
+    _txFreeAt = at;
+}
+
+} // namespace sim
@@ -0,0 +1,76 @@
+/**
+ * HOST SIMULATION - u-blox NEO-M10 RECEIVER
+ * Sits on the telemetry node's GPS UART. Listens for the UBX-CFG-PRT and
+ * UBX-CFG-RATE frames GPS_Init() sends, switches baud / rate accordingly,
+ * and streams NMEA RMC + GGA (and optionally UBX-NAV-PVT) built from the
+ * rover's true position plus a slowly wandering error.
+ */
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RoverModel.h"
+
+namespace sim {
+
+struct GpsParams {
+    double   originLat      = 14.6537;  // test field origin (deg)
+    double   originLon      = 121.0687;
+    double   fixDelayS      = 3.0;      // hot start
+    double   posErrorM      = 1.5;      // 1-sigma Gauss-Markov wander
+    double   posErrorTauS   = 30.0;
+    double   speedNoiseMps  = 0.04;
+    uint32_t bootBaud       = 9600;
+    uint16_t bootRateMs     = 1000;
+    bool     emitUbx        = false;    // UBX-NAV-PVT after the NMEA pair
+    int      port           = 2;        // Serial2 on the telemetry node
+    unsigned seed           = 2;
+};
+
+class GpsModel : public Model {
+public:
+    GpsModel(Node& telemetry, const RoverModel& rover, const GpsParams& p = GpsParams());
+
+    void step(uint64_t t0, uint64_t t1) override;
+
+    uint32_t baud() const           { return _baud; }
+    uint16_t rateMs() const         { return _rateMs; }
+    uint64_t sentences() const      { return _sentences; }
+    uint64_t configFrames() const   { return _cfgFrames; }
+    uint64_t badFrames() const      { return _badFrames; }
+
+    static std::string nmeaChecksum(const std::string& body);
+
+private:
+    void  parseHostByte(uint8_t b, uint64_t t);
+    void  handleUbx(uint8_t cls, uint8_t id, const std::vector<uint8_t>& payload, uint64_t t);
+    void  emitEpoch(uint64_t t);
+    void  send(uint64_t t, const uint8_t* data, size_t n);
+    std::vector<uint8_t> navPvt(uint64_t t, double lat, double lon, double alt,
+                                double speed, double course, bool fix) const;
+
+    Node&             _tlm;
+    const RoverModel& _rover;
+    GpsParams         _p;
+    uint32_t          _baud;
+    uint32_t          _pendingBaud = 0;
+    uint64_t          _baudSwitchAt = 0;
+    uint16_t          _rateMs;
+    uint64_t          _nextEpochNs;
+    uint64_t          _txFreeAt = 0;
+    uint64_t          _sentences = 0;
+    uint64_t          _cfgFrames = 0;
+    uint64_t          _badFrames = 0;
+    double            _errE = 0, _errN = 0;
+
+    // UBX receive state
+    std::vector<uint8_t> _rx;
+
+    std::mt19937                     _rng;
+    std::normal_distribution<double> _n01{0.0, 1.0};
+    std::vector<SerialPort::TimedByte> _scratch;
+};
+
+} // namespace sim
@@ -0,0 +1,271 @@
+#include "GroundStation.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#include "CommandEcho.h"
+#include "Tdma.h"
+
+namespace sim {
+
+GroundStation::GroundStation(uint32_t uartBaud) : _baud(uartBaud) {}
+GroundStation::~GroundStation() = default;
+
+void GroundStation::enableTdma(uint16_t frameMs, uint16_t guardMs, const std::vector<uint8_t>& nodes) {
+    _tdma.reset(new TdmaCoordinator(frameMs, _baud, guardMs));
+    _tdma->setFec(_fecTx);
+    for (uint8_t id : nodes) _tdma->addNode(id);
+    _nextFrame = 0;
+}
+
+void GroundStation::enableFec(bool on) {
+    _fecTx = on;
+    if (_tdma) _tdma->setFec(on);
+}
+
+void GroundStation::addEntry(uint64_t tMs, const std::string& cmd) {
+    _script.push_back({tMs * 1000000ULL, cmd});
+}
+
+bool GroundStation::loadScript(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    _script.clear();
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (!*p) continue;
+        char* end;
+        unsigned long tMs = strtoul(p, &end, 10);
+        while (isspace((unsigned char)*end)) end++;
+        std::string cmd(end);
+        while (!cmd.empty() && isspace((unsigned char)cmd.back())) cmd.pop_back();
+        if (!cmd.empty()) addEntry(tMs, cmd);
+    }
+    fclose(f);
+    std::stable_sort(_script.begin(), _script.end(),
+                     [](const Entry& a, const Entry& b) { return a.tNs < b.tNs; });
+    _next = 0;
+    return true;
+}
+
+// Drive out, arc right, spin left, stop, jog the base servo, then go
+// silent so the actuator failsafe has to trip.
+void GroundStation::loadDefaultScript() {
+    _script.clear();
+    addEntry(0,     "repeat 50");
+    addEntry(0,     "0,0");
+    addEntry(3000,  "180,180");
+    addEntry(8000,  "200,90");
+    addEntry(11000, "-140,140");
+    addEntry(13000, "0,0");
+    addEntry(14000, "S1R");
+    addEntry(15500, "S1X");
+    addEntry(16000, "255,255");
+    addEntry(19000, "silence");
+    _next = 0;
+}
+
+void GroundStation::openRxLog(const char* path) {
+    closeRxLog();
+    _rxLog = fopen(path, "w");
+    if (_rxLog) fprintf(_rxLog, "t_ms,line\n");
+}
+
+void GroundStation::closeRxLog() {
+    if (_rxLog) fclose(_rxLog);
+    _rxLog = nullptr;
+}
+
+void GroundStation::sendLine(uint64_t t, const std::string& cmd, bool command) {
+    const uint64_t bt = 10ULL * 1000000000ULL / _baud;
+    uint64_t at = std::max(t, _txFreeAt);
+    std::string line = (_address && command) ? std::to_string(_address) + ":" + cmd : cmd;
+    if (_echo && command) line += echo::TAG_MARK + std::to_string((uint32_t)(at / 1000));
+    std::string wire = line + "\n";
+    if (_fecTx) {
+        uint8_t frame[fec::MAX_FRAME];
+        size_t  n = fec::encode((const uint8_t*)line.data(), line.size(), _fecSeq++, frame, sizeof(frame));
+        wire.assign((const char*)frame, n);
+    }
+    for (char c : wire) {
+        at += bt;
+        _tx.push_back({at, (uint8_t)c, _baud});
+    }
+    _txFreeAt = at;
+    _stats.linesSent++;
+    _stats.bytesSent += wire.size();
+    _sent.insert(line);
+}
+
+size_t GroundStation::airBytes(const std::string& line, bool command) const {
+    size_t n = line.size() + (_echo && command ? 11 : 0);           // "^" + up to 10 digits
+    if (_address && command) n += std::to_string(_address).size() + 1;
+    return _fecTx ? fec::frameSize(n) : n + 1;
+}
+
+// Beacons and acks: protocol overhead, not counted as command lines.
+void GroundStation::sendOverhead(uint64_t t, const char* line, uint64_t& count, uint64_t& bytes) {
+    sendLine(t, line, false);
+    count++;
+    bytes += airBytes(line, false);
+    _stats.linesSent--;
+    _stats.bytesSent -= airBytes(line, false);
+    _sent.erase(line);
+}
+
+// The line that holds the motor targets at 't': the motor line itself, or
+// a keepalive between refreshes.
+std::string GroundStation::holdLine(uint64_t t) {
+    const bool full = !_keepaliveNs || t >= _nextRefresh;
+    if (full) _nextRefresh = t + REFRESH;
+    else      _stats.keepalives++;
+    const std::string line = full ? _motorLine : KEEPALIVE;
+    _stats.holdLines++;
+    _stats.holdBytes += airBytes(line);
+    return line;
+}
+
+void GroundStation::queueLine(uint64_t t, const std::string& line) {
+    if (_tdma) _uplink.push_back(line);
+    else       sendLine(t, line);
+}
+
+void GroundStation::step(uint64_t t0, uint64_t t1) {
+    (void)t0;
+    while (_next < _script.size() && _script[_next].tNs < t1) {
+        const Entry& e = _script[_next++];
+        if (e.cmd.rfind("repeat", 0) == 0) {
+            _repeatNs = strtoull(e.cmd.c_str() + 6, nullptr, 10) * 1000000ULL;
+        } else if (e.cmd.rfind("keepalive", 0) == 0) {
+            _keepaliveNs = strtoull(e.cmd.c_str() + 9, nullptr, 10) * 1000000ULL;
+        } else if (e.cmd == "silence") {
+            _motorLine.clear();
+        } else if (isdigit((unsigned char)e.cmd[0]) || e.cmd[0] == '-') {
+            _motorLine  = e.cmd;
+            queueLine(e.tNs, _motorLine);
+            _nextRepeat  = e.tNs + (_keepaliveNs ? _keepaliveNs : _repeatNs);
+            _nextRefresh = e.tNs + REFRESH;
+            _nextShadow  = e.tNs + _repeatNs;
+        } else {
+            queueLine(e.tNs, e.cmd);
+        }
+    }
+    if (_events.ackDue() && t1 >= _nextAck) {
+        char ack[48];
+        if (_events.ackLine(ack, sizeof(ack)) < (int)sizeof(ack)) {
+            if (_tdma) {
+                // Only the newest ack waits for the slot, ahead of commands
+                _uplink.erase(std::remove_if(_uplink.begin(), _uplink.end(),
+                                             [](const std::string& l) { return l.rfind("A,", 0) == 0; }),
+                              _uplink.end());
+                _uplink.push_front(ack);
+            } else {
+                sendOverhead(t1, ack, _stats.acksSent, _stats.ackBytes);
+            }
+        }
+        _nextAck = t1 + ACK_INTERVAL;
+    }
+    if (_tdma) {
+        stepTdma(t1);
+        return;
+    }
+    if (_motorLine.empty() || !_repeatNs) return;
+    while (t1 > _nextShadow) {
+        _stats.repeatBytes += airBytes(_motorLine);
+        _nextShadow += _repeatNs;
+    }
+    if (t1 > _nextRepeat) {
+        sendLine(_nextRepeat, holdLine(_nextRepeat));
+        _nextRepeat += _keepaliveNs ? _keepaliveNs : _repeatNs;
+    }
+}
+
+// One superframe: beacon, then as many queued lines as fit the uplink
+// slot. The motor line is held once per superframe (re-sent, or a keepalive).
+void GroundStation::stepTdma(uint64_t t1) {
+    if (t1 <= _nextFrame) return;
+    const uint64_t frameStart = std::max(_nextFrame, _txFreeAt);
+    _nextFrame += _tdma->frameMs() * 1000000ULL;
+
+    if (!_motorLine.empty() && _repeatNs &&
+        std::find(_uplink.begin(), _uplink.end(), _motorLine) == _uplink.end() &&
+        std::find(_uplink.begin(), _uplink.end(), KEEPALIVE) == _uplink.end()) {
+        _stats.repeatBytes += airBytes(_motorLine);
+        _uplink.push_back(holdLine(frameStart));
+    }
+    uint32_t queued = 0;
+    for (const auto& l : _uplink) queued += airBytes(l, l.rfind("A,", 0) != 0);
+
+    char beacon[128];
+    int  n = _tdma->beacon(beacon, sizeof(beacon), queued);
+    if (n <= 0 || n >= (int)sizeof(beacon)) return;
+    sendOverhead(frameStart, beacon, _stats.beaconsSent, _stats.beaconBytes);
+
+    const TdmaSlot* up = _tdma->slot(TdmaSchedule::UPLINK);
+    if (!up) return;
+    const uint64_t beaconEnd = _txFreeAt;
+    const uint64_t slotEnd   = beaconEnd + (up->startMs + up->lenMs) * 1000000ULL;
+    uint64_t       at        = beaconEnd + up->startMs * 1000000ULL;
+    const uint64_t bt        = 10ULL * 1000000000ULL / _baud;
+    while (!_uplink.empty()) {
+        const std::string& line = _uplink.front();
+        const bool         ack  = line.rfind("A,", 0) == 0;
+        if (at + airBytes(line, !ack) * bt > slotEnd) break;
+        if (ack) sendOverhead(at, line.c_str(), _stats.acksSent, _stats.ackBytes);
+        else     sendLine(at, line);
+        at = _txFreeAt;
+        _uplink.pop_front();
+    }
+}
+
+void GroundStation::collectTx(uint64_t upTo, std::vector<SerialPort::TimedByte>& out) {
+    size_t n = 0;
+    while (n < _tx.size() && _tx[n].t <= upTo) out.push_back(_tx[n++]);
+    _tx.erase(_tx.begin(), _tx.begin() + n);
+}
+
+void GroundStation::onLine(uint64_t t, const std::string& line, bool clean) {
+    _stats.linesReceived++;
+    if (_rxLog) fprintf(_rxLog, "%.3f,\"%s\"\n", t / 1e6, line.c_str());
+    if (_tdma) _tdma->onLine(line.c_str());
+    uint16_t code = 0;
+    if (line.rfind("Q,n=", 0) == 0) {
+        _stats.reports++;
+    } else if (_events.onLine(line.c_str(), &code)) {
+        _eventCodes.push_back(code);
+    } else if (clean) {
+        _stats.goodBytes += line.size() + 1;
+        if (std::count(line.begin(), line.end(), ',') == 17) _stats.records++;
+    }
+}
+
+void GroundStation::deliver(uint64_t t, uint8_t b) {
+    _stats.bytesReceived++;
+    switch (_fec.feed(b)) {
+    case FecDecoder::TEXT:
+        break;
+    case FecDecoder::FRAME:
+        onLine(t, std::string((const char*)_fec.payload(), _fec.length()), true);
+        return;
+    default:
+        return;
+    }
+    if (b == '\n' || b == '\r') {
+        if (!_rxLine.empty()) {
+            onLine(t, _rxLine, _rxClean);
+            _rxLine.clear();
+        }
+        _rxClean = true;
+        return;
+    }
+    if (!isprint(b)) _rxClean = false;
+    if (_rxLine.size() < 512) _rxLine.push_back(isprint(b) ? (char)b : '?');
+}
+
+} // namespace sim
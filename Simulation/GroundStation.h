@@ -0,0 +1,162 @@
+/**
+ * HOST SIMULATION - GROUND STATION
+ * Stands in for the Command and Control software on the APC220 COM port.
+ * Uplink: plays a timed script of command lines, re-sending the current
+ * motor line at a fixed period like the keyboard loop does (50 ms).
+ * Downlink: splits what it hears into lines and logs them with a timestamp.
+ *
+ * Script format, one entry per line ('#' starts a comment):
+ *     <t_ms>  <command>        e.g.  2000  180,180     or   12000  S1R
+ *     <t_ms>  repeat <ms>      motor line re-send period (0 = send once)
+ *     <t_ms>  keepalive <ms>   hold with "K" every <ms> instead (0 = off)
+ *     <t_ms>  silence          stop re-sending (lets the failsafe trip)
+ *
+ * With keepalives the motor line only goes out when it changes, plus a
+ * refresh every REFRESH (a lost change or a tripped failsafe then costs at
+ * most that long); the actuator holds its targets on "K". The stats keep
+ * what re-sending the line every repeat period would have cost as well.
+ *
+ * With TDMA enabled (see Tdma.h) the ground is the coordinator: it opens
+ * every superframe with a beacon, holds command lines until its uplink
+ * slot, sends the current motor line once per superframe, and sizes the
+ * downlink slots from the nodes' queue reports.
+ *
+ * With FEC enabled (see Fec.h) every uplink line, beacons included, goes
+ * out as a Reed-Solomon frame. Received frames are always decoded.
+ *
+ * Status events ("E,..." lines, see EventLink.h) are de-duplicated and
+ * acknowledged on the uplink, at most one ack per ACK_INTERVAL.
+ *
+ * With echo enabled every command line carries the ground's clock as an
+ * echo tag ("<cmd>^<us>", see CommandEcho.h), taken when its first byte
+ * goes out.
+ *
+ * With an address set, command lines go out as "<id>:<cmd>" for one rover
+ * of a fleet (see Tdma.h); beacons and acks stay unaddressed.
+ */
+#pragma once
+
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "EventLink.h"
+#include "Fec.h"
+#include "RadioLink.h"
+
+class TdmaCoordinator;
+
+namespace sim {
+
+struct GroundStats {
+    uint64_t linesSent      = 0;
+    uint64_t bytesSent      = 0;
+    uint64_t linesReceived  = 0;
+    uint64_t bytesReceived  = 0;
+    uint64_t goodBytes      = 0;    // printable lines, excluding TDMA overhead
+    uint64_t records        = 0;    // complete 18-field telemetry records
+    uint64_t beaconsSent    = 0;
+    uint64_t beaconBytes    = 0;
+    uint64_t reports        = 0;    // TDMA slot reports heard
+    uint64_t acksSent       = 0;
+    uint64_t ackBytes       = 0;
+    uint64_t holdLines      = 0;    // re-sent motor lines and keepalives
+    uint64_t holdBytes      = 0;
+    uint64_t keepalives     = 0;
+    uint64_t repeatBytes    = 0;    // the same hold, re-sending the line every repeat period
+};
+
+class GroundStation : public RadioStation, public Model {
+public:
+    struct Entry { uint64_t tNs; std::string cmd; };
+
+    explicit GroundStation(uint32_t uartBaud = 9600);
+    ~GroundStation() override;
+
+    bool loadScript(const char* path);
+    void loadDefaultScript();
+    void openRxLog(const char* path);
+    void closeRxLog();
+    void enableTdma(uint16_t frameMs, uint16_t guardMs, const std::vector<uint8_t>& nodes);
+    void enableFec(bool on);
+    void enableEcho(bool on) { _echo = on; }
+    void setKeepalive(unsigned ms) { _keepaliveNs = ms * 1000000ULL; }
+    void setAddress(uint8_t id) { _address = id; }     // 0 = every rover
+
+    /// 'line' is a command exactly as the ground sent it.
+    bool wasSent(const std::string& line) const { return _sent.count(line) != 0; }
+
+    // RadioStation
+    const char* stationName() const override { return "ground"; }
+    void collectTx(uint64_t upTo, std::vector<SerialPort::TimedByte>& out) override;
+    void deliver(uint64_t t, uint8_t b) override;
+
+    // Model
+    void step(uint64_t t0, uint64_t t1) override;
+
+    const GroundStats& stats() const    { return _stats; }
+    const FecStats&    fecStats() const { return _fec.stats(); }
+    const EventReceiver& events() const { return _events; }
+
+    /// Unique status codes received, in arrival order.
+    const std::vector<uint16_t>& eventCodes() const { return _eventCodes; }
+
+    /// The loaded script, sorted by time.
+    const std::vector<Entry>& script() const { return _script; }
+
+private:
+    void addEntry(uint64_t tMs, const std::string& cmd);
+    void sendLine(uint64_t t, const std::string& line, bool command = true);
+    size_t airBytes(const std::string& line, bool command = true) const;
+    void onLine(uint64_t t, const std::string& line, bool clean);
+    void queueLine(uint64_t t, const std::string& line);
+    void stepTdma(uint64_t t1);
+    void sendOverhead(uint64_t t, const char* line, uint64_t& count, uint64_t& bytes);
+    std::string holdLine(uint64_t t);
+
+    uint32_t                _baud;
+    std::vector<Entry>      _script;
+    size_t                  _next       = 0;
+    std::string             _motorLine;
+    uint64_t                _repeatNs   = 50000000ULL;
+    uint64_t                _nextRepeat = 0;
+
+    // Keepalives: "K" holds the motor line, refreshed in full now and then
+    static constexpr uint64_t REFRESH = 1000000000ULL;
+    static constexpr const char* KEEPALIVE = "K";
+    uint64_t                _keepaliveNs = 0;
+    uint64_t                _nextRefresh = 0;
+    uint64_t                _nextShadow  = 0;   // repeat-period accounting
+    std::vector<SerialPort::TimedByte> _tx;
+    uint64_t                _txFreeAt   = 0;
+    std::string             _rxLine;
+    bool                    _rxClean    = true;
+    FILE*                   _rxLog      = nullptr;
+    GroundStats             _stats;
+    std::unordered_set<std::string> _sent;
+
+    // FEC: frames out when enabled, always decoded on the way in
+    FecDecoder              _fec;
+    bool                    _fecTx      = false;
+    uint8_t                 _fecSeq     = 0;
+
+    // Echo tags and the rover address on command lines
+    bool                    _echo       = false;
+    uint8_t                 _address    = 0;
+
+    // Status events: dedupe and acks
+    static constexpr uint64_t ACK_INTERVAL = 100000000ULL;
+    EventReceiver           _events;
+    std::vector<uint16_t>   _eventCodes;
+    uint64_t                _nextAck    = 0;
+
+    // TDMA coordinator state
+    std::unique_ptr<TdmaCoordinator> _tdma;
+    uint64_t                _nextFrame  = 0;
+    std::deque<std::string> _uplink;    // lines waiting for the uplink slot
+};
+
+} // namespace sim
@@ -0,0 +1,75 @@
+/**
+ * HOST SIMULATION - FIRMWARE IMAGES
+ * Each firmware is compiled unmodified inside its own namespace so both
+ * can live in one process. Hardware access goes through the shims.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "SimNode.h"
+
+class Print;
+class TraceRecorder;
+struct FecStats;
+struct EventStats;
+class AdaptiveRate;
+class Resampler;
+class PoseEstimator;
+class CommandArbiter;
+
+namespace sim {
+
+Program actuatorProgram();     // CmdCtrl_Main
+Program telemetryProgram();    // TmtryData_Main
+
+// Radio FEC decoder counters: commands at the actuator, beacons at telemetry
+const FecStats& actuatorFec();
+const FecStats& telemetryFec();
+
+// USB / radio command arbitration at the actuator
+const CommandArbiter& actuatorArbiter();
+
+// Status events queued for acknowledged delivery by the telemetry node
+const EventStats& telemetryEvents();
+
+// Telemetry record rate per sink (USB, radio, SD)
+const AdaptiveRate& telemetryUsbRate();
+const AdaptiveRate& telemetryRadioRate();
+const AdaptiveRate& telemetrySdRate();
+
+// Fixed-rate fused records written to fused.csv
+const Resampler& telemetryFused();
+
+// 200 Hz dead-reckoning pose (local_pose.csv)
+const PoseEstimator& telemetryPose();
+
+// Every telemetry record formatted so far, whether or not a sink took it
+const std::vector<std::string>& telemetryRecords();
+
+#ifdef BENCHMARK_MODE
+// Each sketch's Benchmarks.ino suite (build with -DBENCHMARK_MODE)
+void actuatorBenchmarks(Print& out);
+void telemetryBenchmarks(Print& out);
+#endif
+
+#ifdef TRACE_MODE
+// Each sketch's timeline ring (build with -DTRACE_MODE)
+TraceRecorder& actuatorTrace();
+TraceRecorder& telemetryTrace();
+#endif
+
+// Actuator wiring used by the world model (see CmdCtrl_Main/GlobalVariables.cpp)
+struct MotorPins { int rpwm, lpwm, ren, len; };
+constexpr MotorPins ACT_LEFT_MOTOR  = {2, 3, 21, 20};
+constexpr MotorPins ACT_RIGHT_MOTOR = {5, 6, 22, 23};
+
+// Telemetry wiring
+constexpr int TLM_THERMISTOR_PIN = 14;   // A0
+
+// Battery sense lines, wired to both nodes (BatteryMonitor.h)
+constexpr int BATTERY_VOLT_PIN   = 38;   // A14
+constexpr int BATTERY_AMP_PIN    = 39;   // A15
+
+} // namespace sim
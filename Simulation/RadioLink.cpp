@@ -0,0 +1,69 @@
+#include "RadioLink.h"
+
+#include <algorithm>
+
+namespace sim {
+
+RadioChannel::RadioChannel(const char* name, const RadioParams& p)
+    : _name(name), _p(p), _noise(p) {}
+
+// anyOther: does any station other than 'from' overlap x?
+// otherwise: does station 'from' itself overlap x?
+bool RadioChannel::overlaps(const AirByte& x, size_t from, bool anyOther) const {
+    const uint64_t air = byteAirNs();
+    auto hit = [&](const AirByte& y) {
+        bool who = anyOther ? (y.from != from) : (y.from == from);
+        return who && y.start < x.start + air && y.start + air > x.start;
+    };
+    return std::any_of(_recent.begin(), _recent.end(), hit) ||
+           std::any_of(_air.begin(), _air.end(), hit);
+}
+
+void RadioChannel::step(uint64_t t0, uint64_t t1) {
+    (void)t0;
+    const uint64_t air = byteAirNs();
+
+    // 1. Key up every station that has UART bytes waiting
+    for (size_t i = 0; i < _stations.size(); i++) {
+        _scratch.clear();
+        _stations[i].station->collectTx(t1, _scratch);
+        for (const auto& tb : _scratch) {
+            uint64_t start = std::max(tb.t + _p.latencyNs, _stations[i].airFreeAt);
+            _stations[i].airFreeAt = start + air;
+            _air.push_back({start, tb.b, i, false});
+            _stats.sent++;
+        }
+    }
+    std::stable_sort(_air.begin(), _air.end(),
+                     [](const AirByte& a, const AirByte& b) { return a.start < b.start; });
+
+    // 2. Anything collected later starts no earlier than t1 + latency, so
+    //    bytes that end before that horizon can be resolved now.
+    const uint64_t horizon = t1 + _p.latencyNs;
+    size_t done = 0;
+    for (; done < _air.size() && _air[done].start + air <= horizon; done++) {
+        AirByte& x = _air[done];
+        x.collided = overlaps(x, x.from, true);
+        if (x.collided) _stats.collided++;
+        const uint8_t b = x.collided ? 0 : _noise.corrupt(x.b);
+        if (!x.collided && b != x.b) _stats.corrupted++;
+
+        for (size_t j = 0; j < _stations.size(); j++) {
+            if (j == x.from) continue;
+            if (overlaps(x, j, false))   { _stats.deafened++; continue; }
+            if (x.collided)              { _stats.lost++;     continue; }
+            if (_noise.lose())           { _stats.lost++;     continue; }
+            _stations[j].station->deliver(x.start + air, b);
+            _stats.delivered++;
+        }
+        _recent.push_back(x);
+    }
+    _air.erase(_air.begin(), _air.begin() + done);
+
+    const uint64_t keepAfter = horizon > 2 * air ? horizon - 2 * air : 0;
+    _recent.erase(std::remove_if(_recent.begin(), _recent.end(),
+                                 [&](const AirByte& y) { return y.start + air < keepAfter; }),
+                  _recent.end());
+}
+
+} // namespace sim
@@ -0,0 +1,131 @@
+/**
+ * HOST SIMULATION - APC220 RADIO CHANNEL
+ * A half-duplex broadcast medium shared by any number of stations (node
+ * UARTs or the ground station). Each byte occupies the air for 10 bit
+ * times at the air rate; overlapping transmissions collide, a station
+ * cannot hear while it is keyed up, and the channel adds random byte loss
+ * plus Gilbert-Elliott burst bit errors.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Simulator.h"
+
+namespace sim {
+
+struct RadioParams {
+    uint32_t airBaud        = 9600;
+    uint64_t latencyNs      = 8000000;  // module buffering / preamble
+    double   byteLoss       = 0.0;      // independent erasures
+    double   berGood        = 0.0;      // bit error rate, good state
+    double   berBad         = 0.0;      // bit error rate, burst state
+    double   pGoodToBad     = 0.0;      // per byte
+    double   pBadToGood     = 0.2;      // per byte
+    unsigned seed           = 3;
+};
+
+struct RadioStats {
+    uint64_t sent       = 0;
+    uint64_t delivered  = 0;            // byte x receivers
+    uint64_t corrupted  = 0;
+    uint64_t lost       = 0;
+    uint64_t collided   = 0;
+    uint64_t deafened   = 0;            // receiver was transmitting
+};
+
+// The channel's byte loss and Gilbert-Elliott bit errors on their own,
+// for tools that want the impairments without the air timing.
+class RadioNoise {
+public:
+    explicit RadioNoise(const RadioParams& p) : _p(p), _rng(p.seed) {}
+
+    uint8_t corrupt(uint8_t b) {
+        if (!_burst && _u(_rng) < _p.pGoodToBad)     _burst = true;
+        else if (_burst && _u(_rng) < _p.pBadToGood) _burst = false;
+        const double ber = _burst ? _p.berBad : _p.berGood;
+        if (ber <= 0) return b;
+        for (int bit = 0; bit < 8; bit++) {
+            if (_u(_rng) < ber) b ^= (uint8_t)(1u << bit);
+        }
+        return b;
+    }
+    bool lose() { return _u(_rng) < _p.byteLoss; }
+
+private:
+    RadioParams                 _p;
+    bool                        _burst = false;
+    std::mt19937                _rng;
+    std::uniform_real_distribution<double> _u{0.0, 1.0};
+};
+
+// Anything that can key the radio and listen to it.
+class RadioStation {
+public:
+    virtual ~RadioStation() = default;
+    virtual const char* stationName() const = 0;
+    virtual void collectTx(uint64_t upTo, std::vector<SerialPort::TimedByte>& out) = 0;
+    virtual void deliver(uint64_t t, uint8_t b) = 0;
+};
+
+// Adapter for an APC220 wired to a node UART.
+class PortStation : public RadioStation {
+public:
+    PortStation(Node& node, int port) : _node(node), _port(port) {}
+    const char* stationName() const override { return _node.name.c_str(); }
+    void collectTx(uint64_t upTo, std::vector<SerialPort::TimedByte>& out) override {
+        _node.board.ports[_port].takeDeparted(upTo, out);
+    }
+    void deliver(uint64_t t, uint8_t b) override { _node.board.ports[_port].pushRx(t, b); }
+
+private:
+    Node& _node;
+    int   _port;
+};
+
+// Receive-only view of another station (e.g. the ground station on a
+// downlink frequency it never transmits on).
+class ListenOnlyStation : public RadioStation {
+public:
+    explicit ListenOnlyStation(RadioStation& inner) : _inner(inner) {}
+    const char* stationName() const override { return _inner.stationName(); }
+    void collectTx(uint64_t, std::vector<SerialPort::TimedByte>&) override {}
+    void deliver(uint64_t t, uint8_t b) override { _inner.deliver(t, b); }
+
+private:
+    RadioStation& _inner;
+};
+
+class RadioChannel : public Model {
+public:
+    explicit RadioChannel(const char* name, const RadioParams& p = RadioParams());
+
+    void attach(RadioStation* station) { _stations.push_back({station, 0}); }
+    void step(uint64_t t0, uint64_t t1) override;
+
+    const RadioStats&  stats() const  { return _stats; }
+    const RadioParams& params() const { return _p; }
+    const std::string& name() const   { return _name; }
+    uint64_t byteAirNs() const        { return 10ULL * 1000000000ULL / _p.airBaud; }
+
+private:
+    struct Attached { RadioStation* station; uint64_t airFreeAt; };
+    struct AirByte  { uint64_t start; uint8_t b; size_t from; bool collided; };
+
+    bool    overlaps(const AirByte& x, size_t from, bool anyOther) const;
+
+    std::string                 _name;
+    RadioParams                 _p;
+    RadioStats                  _stats;
+    std::vector<Attached>       _stations;
+    std::vector<AirByte>        _air;       // on air, fate not yet decided
+    std::vector<AirByte>        _recent;    // decided, may still overlap
+    std::vector<SerialPort::TimedByte> _scratch;
+    RadioNoise                  _noise;
+};
+
+} // namespace sim
@@ -0,0 +1,226 @@
+#include "RoverModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+constexpr double G = 9.80665;
+
+// Firmware THERMISTOR_CORE constants (TmtryData_Main/GlobalVariables.h)
+constexpr double THERM_R0   = 10000.0;
+constexpr double THERM_BETA = 3435.0;
+constexpr double THERM_T0   = 298.15;
+constexpr double ADC_VREF   = 3.3;      // what the Teensy pin actually sees
+
+// Firmware battery sense (BatteryConfig defaults in BatteryMonitor.h)
+constexpr double BATT_DIVIDER   = 11.0;     // 100k / 10k
+constexpr double BATT_V_PER_A   = 0.04;     // Hall sensor, zero at mid-rail
+
+// Resting LiPo cell voltage at 0, 10, ... 100 % charge
+constexpr double OCV_CELL[] = {3.27, 3.69, 3.73, 3.77, 3.80, 3.84, 3.87, 3.95, 4.02, 4.11, 4.20};
+
+double cellOcv(double soc) {
+    const double x = std::min(std::max(soc, 0.0), 1.0) * 10.0;
+    const int    i = std::min((int)x, 9);
+    return OCV_CELL[i] + (OCV_CELL[i + 1] - OCV_CELL[i]) * (x - i);
+}
+
+int adcCounts(double v) {
+    return (int)lround(std::min(std::max(v / ADC_VREF, 0.0), 1.0) * 4095.0);
+}
+} // namespace
+
+RoverModel::RoverModel(Node& actuator, Node& telemetry, const RoverParams& p)
+    : _act(actuator), _tlm(telemetry), _p(p), _rng(p.seed) {
+    _s.yaw = p.headingDeg * M_PI / 180.0;
+    _s.z   = terrainHeight(0, 0);
+    _s.batterySoc = p.batterySoc;
+    batteryStep(0.0);
+    synthesiseSensors(1e-3);
+}
+
+double RoverModel::terrainHeight(double x, double y) const {
+    return _p.hillAmplitudeM * sin(x / _p.hillLengthM) * cos(y / _p.hillLengthM);
+}
+
+void RoverModel::readBridge(const MotorPins& pins, double& duty, bool& enabled) const {
+    const Board& b   = _act.board;
+    const double top = (double)((1 << b.analogWriteBits) - 1);
+    enabled = b.digital[pins.ren] && b.digital[pins.len];
+    duty    = (b.analogOut[pins.rpwm] - b.analogOut[pins.lpwm]) / top;
+    if (duty > 1) duty = 1;
+    if (duty < -1) duty = -1;
+}
+
+// Bridge enabled: the winding sees duty * Vbat, so zero duty shorts it and
+// brakes. Bridge disabled: high impedance, the wheel coasts on friction.
+double RoverModel::wheelStep(double v, double duty, bool enabled, double slope, double dt) const {
+    const double gravity = G * sin(slope);
+    if (enabled) {
+        // The gearbox carries most of the slope load while the bridge drives.
+        return v + ((_p.maxWheelSpeedMps * duty - v) / _p.motorTauS - gravity * 0.1) * dt;
+    }
+    if (fabs(v) < _p.stictionMps && fabs(gravity) < _p.coastDecelMps2) return 0.0;
+    double friction = v > 0 ? _p.coastDecelMps2 : (v < 0 ? -_p.coastDecelMps2 : 0.0);
+    return v - (friction + gravity) * dt;
+}
+
+void RoverModel::step(uint64_t t0, uint64_t t1) {
+    const double dt = (t1 - t0) * 1e-9;
+
+    readBridge(ACT_LEFT_MOTOR,  _s.dutyLeft,  _s.bridgeLeft);
+    readBridge(ACT_RIGHT_MOTOR, _s.dutyRight, _s.bridgeRight);
+
+    // Terrain slope along the heading
+    const double e     = 0.05;
+    const double dzdx  = (terrainHeight(_s.x + e, _s.y) - terrainHeight(_s.x - e, _s.y)) / (2 * e);
+    const double dzdy  = (terrainHeight(_s.x, _s.y + e) - terrainHeight(_s.x, _s.y - e)) / (2 * e);
+    const double cy    = cos(_s.yaw), sy = sin(_s.yaw);
+    const double along = dzdx * cy + dzdy * sy;
+    const double cross = -dzdx * sy + dzdy * cy;
+    _s.pitch = atan(along);
+    _s.roll  = -atan(cross);
+
+    _s.vLeft  = wheelStep(_s.vLeft,  _s.dutyLeft,  _s.bridgeLeft,  _s.pitch, dt);
+    _s.vRight = wheelStep(_s.vRight, _s.dutyRight, _s.bridgeRight, _s.pitch, dt);
+
+    _prevSpeed  = _s.speed;
+    _s.speed    = 0.5 * (_s.vLeft + _s.vRight);
+    _s.yawRate  = (_s.vRight - _s.vLeft) / _p.trackWidthM;
+    _s.accelFwd = (_s.speed - _prevSpeed) / dt;
+    _s.accelLat = _s.speed * _s.yawRate;
+
+    const double ground = _s.speed * cos(_s.pitch);
+    _s.x   += ground * cos(_s.yaw) * dt;
+    _s.y   += ground * sin(_s.yaw) * dt;
+    _s.yaw  = remainder(_s.yaw + _s.yawRate * dt, 2 * M_PI);
+    _s.z    = terrainHeight(_s.x, _s.y);
+    _s.odometerM += fabs(_s.speed) * dt;
+
+    for (int i = 0; i < 6; i++) {
+        uint16_t pulse = _act.board.servoPulse[i];
+        if (pulse) _s.armDeg[i] = (pulse - 150) * 180.0f / 450.0f;
+    }
+
+    batteryStep(dt);
+    synthesiseSensors(dt);
+    trackStop(t1 * 1e-9, dt);
+
+    if (_trace && t1 >= _nextTraceNs) {
+        _nextTraceNs += _tracePeriodNs;
+        fprintf(_trace, "%.3f,%.4f,%.4f,%.4f,%.3f,%.3f,%.3f,%.4f,%.4f,%.3f,%.3f,%.4f,%.4f",
+                t1 * 1e-9, _s.x, _s.y, _s.z, _s.yaw * 180 / M_PI, _s.pitch * 180 / M_PI,
+                _s.roll * 180 / M_PI, _s.speed, _s.yawRate, _s.dutyLeft, _s.dutyRight,
+                _s.vLeft, _s.vRight);
+        for (float a : _s.armDeg) fprintf(_trace, ",%.1f", a);
+        fputc('\n', _trace);
+    }
+}
+
+void RoverModel::synthesiseSensors(double dt) {
+    Board& b = _tlm.board;
+    (void)dt;
+
+    // --- BNO08x: ZYX Euler -> quaternion (same convention the firmware inverts)
+    const double hy = _s.yaw * 0.5, hp = _s.pitch * 0.5, hr = _s.roll * 0.5;
+    const double cy = cos(hy), sy = sin(hy), cp = cos(hp), sp = sin(hp), cr = cos(hr), sr = sin(hr);
+    b.imu.qr = (float)(cr * cp * cy + sr * sp * sy);
+    b.imu.qi = (float)(sr * cp * cy - cr * sp * sy);
+    b.imu.qj = (float)(cr * sp * cy + sr * cp * sy);
+    b.imu.qk = (float)(cr * cp * sy - sr * sp * cy);
+    b.imu.linX  = (float)(_s.accelFwd + _p.imuNoise * _n01(_rng));
+    b.imu.linY  = (float)(_s.accelLat + _p.imuNoise * _n01(_rng));
+    b.imu.linZ  = (float)(_p.imuNoise * _n01(_rng));
+    b.imu.gyroZ = (float)_s.yawRate;
+
+    // --- MS5611: ISA barometric formula at site elevation + terrain
+    const double h = _p.baseAltitudeM + _s.z;
+    b.baro.pressurePa   = 101325.0 * pow(1.0 - 2.25577e-5 * h, 5.25588) + _p.baroNoisePa * _n01(_rng);
+    b.baro.temperatureC = _p.ambientC;
+
+    // --- Thermistor on the low side of a 10k divider into A0
+    const double tK  = _p.ambientC + 273.15;
+    const double rT  = THERM_R0 * exp(THERM_BETA * (1.0 / tK - 1.0 / THERM_T0));
+    const double v   = ADC_VREF * rT / (rT + THERM_R0);
+    b.analogIn[TLM_THERMISTOR_PIN] = (int)lround(v / ADC_VREF * 4095.0);
+}
+
+// A drive that rises again, or holds a non-zero duty for longer than a few
+// motor ticks, was slowing down rather than stopping.
+void RoverModel::trackStop(double t, double dt) {
+    const double duty[2] = {_s.bridgeLeft ? fabs(_s.dutyLeft) : 0.0, _s.bridgeRight ? fabs(_s.dutyRight) : 0.0};
+    const bool   rising  = duty[0] > _prevDuty[0] + 1e-6 || duty[1] > _prevDuty[1] + 1e-6;
+    const bool   falling = duty[0] < _prevDuty[0] - 1e-6 || duty[1] < _prevDuty[1] - 1e-6;
+    const bool   zero    = duty[0] < 1e-6 && duty[1] < 1e-6;
+    const double wheel   = std::max(fabs(_s.vLeft), fabs(_s.vRight));
+    _prevDuty[0] = duty[0];
+    _prevDuty[1] = duty[1];
+
+    if (_drifting) {
+        if (rising) _drifting = false;
+        else        _stops.back().driftM += wheel * dt;
+    }
+    if (!_stopping) {
+        if (!falling || rising || wheel < STOP_MPS) return;
+        const char* how = (!_s.bridgeLeft && !_s.bridgeRight) ? "coast" : zero ? "brake" : "ramp";
+        _stop     = {t, wheel, 0.0, 0.0, 0.0, how};
+        _stopping = true;
+        _heldS    = 0;
+        return;
+    }
+    _heldS = (falling || zero) ? 0.0 : _heldS + dt;
+    if (rising || _heldS > 0.05) {
+        _stopping = false;
+        return;
+    }
+    _stop.timeS     += dt;
+    _stop.distanceM += wheel * dt;
+    if (wheel < STOP_MPS) {
+        _stops.push_back(_stop);
+        _stopping = false;
+        _drifting = true;
+    }
+}
+
+// Each bridge draws its duty share of the winding current, which is what
+// the applied voltage has left over the back EMF (speed / top speed)
+void RoverModel::batteryStep(double dt) {
+    double amps = _p.baseLoadA;
+    const double duty[2] = {_s.dutyLeft, _s.dutyRight};
+    const double v[2]    = {_s.vLeft, _s.vRight};
+    const bool   on[2]   = {_s.bridgeLeft, _s.bridgeRight};
+    for (int m = 0; m < 2; m++) {
+        if (on[m]) amps += fabs(duty[m] * _p.motorStallA * (duty[m] - v[m] / _p.maxWheelSpeedMps));
+    }
+    _s.batterySoc   = std::max(0.0, _s.batterySoc - amps * dt / (3600.0 * _p.batteryAh));
+    _s.batteryA     = amps;
+    _s.batteryV     = _p.batteryCells * cellOcv(_s.batterySoc) - amps * _p.batteryOhm;
+    _s.batteryMinV  = std::min(_s.batteryMinV, _s.batteryV);
+    _s.batteryPeakA = std::max(_s.batteryPeakA, amps);
+
+    const int vCounts = adcCounts(_s.batteryV / BATT_DIVIDER);
+    const int aCounts = adcCounts(ADC_VREF / 2 + amps * BATT_V_PER_A);
+    for (Node* n : {&_act, &_tlm}) {
+        n->board.analogIn[BATTERY_VOLT_PIN] = vCounts;
+        n->board.analogIn[BATTERY_AMP_PIN]  = aCounts;
+    }
+}
+
+void RoverModel::openTrace(const char* path, unsigned periodMs) {
+    closeTrace();
+    _trace = fopen(path, "w");
+    if (!_trace) return;
+    _tracePeriodNs = periodMs * 1000000ULL;
+    _nextTraceNs   = 0;
+    fprintf(_trace, "t_s,x_m,y_m,z_m,yaw_deg,pitch_deg,roll_deg,speed_mps,yaw_rate_rps,"
+                    "duty_l,duty_r,v_l_mps,v_r_mps,arm1,arm2,arm3,arm4,arm5,arm6\n");
+}
+
+void RoverModel::closeTrace() {
+    if (_trace) fclose(_trace);
+    _trace = nullptr;
+}
+
+} // namespace sim
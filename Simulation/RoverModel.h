@@ -0,0 +1,115 @@
+/**
+ * HOST SIMULATION - DIFFERENTIAL-DRIVE ROVER (2.5D)
+ * Reads the actuator node's H-bridge pins, turns PWM into wheel speed with
+ * a first-order motor model, integrates the pose over a height-field and
+ * synthesises what the telemetry node's sensors would see: BNO08x
+ * quaternion / linear acceleration / gyro, MS5611 pressure and the
+ * thermistor divider voltage. The motors draw on a LiPo pack whose sense
+ * lines both nodes read. GPS truth is exported for GpsModel.
+ *
+ * Every stop is timed: from the step the drive lets go (duty falling on
+ * both wheels, or the bridges opening) to the wheels under STOP_MPS. What
+ * the wheels roll after that, until the drive picks up again, is drift
+ * (a coasting rover on a slope rolls back down it).
+ */
+#pragma once
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Nodes.h"
+#include "Simulator.h"
+
+namespace sim {
+
+struct RoverParams {
+    double trackWidthM      = 0.26;     // wheel centre to wheel centre
+    double maxWheelSpeedMps = 0.65;     // 520 gear motor at full duty
+    double motorTauS        = 0.18;     // electrical + mechanical lag
+    double coastDecelMps2   = 0.6;      // rolling resistance, bridge open
+    double stictionMps      = 0.02;
+    double baseAltitudeM    = 45.0;     // site elevation (MSL)
+    double ambientC         = 29.0;
+    double hillAmplitudeM   = 0.8;      // terrain: z = A sin(x/L) cos(y/L)
+    double hillLengthM      = 6.0;
+    double imuNoise         = 0.04;     // m/s^2 RMS on linear accel
+    double baroNoisePa      = 1.2;
+    double headingDeg       = 0.0;      // initial heading, ENU (0 = East)
+    double batteryCells     = 3;        // LiPo in series
+    double batteryAh        = 5.0;
+    double batterySoc       = 0.9;      // charge at the start
+    double batteryOhm       = 0.06;     // internal resistance + wiring
+    double motorStallA      = 4.0;      // per motor, full duty, stalled
+    double baseLoadA        = 0.8;      // boards, sensors, radio, idle servos
+    unsigned seed           = 1;
+};
+
+struct RoverState {
+    double x = 0, y = 0, z = 0;         // ENU metres from the start point
+    double yaw = 0, pitch = 0, roll = 0;// rad
+    double vLeft = 0, vRight = 0;       // wheel ground speed m/s
+    double speed = 0, yawRate = 0;
+    double accelFwd = 0, accelLat = 0;
+    double dutyLeft = 0, dutyRight = 0;
+    bool   bridgeLeft = false, bridgeRight = false;
+    double odometerM = 0;
+    float  armDeg[6] = {90, 90, 90, 90, 90, 90};
+    double batterySoc = 0, batteryV = 0, batteryA = 0;
+    double batteryMinV = 1e9, batteryPeakA = 0;
+};
+
+/// One stop, from the first step the drive let go to standstill.
+struct StopRecord {
+    double      tS;                     // when it began
+    double      fromMps;                // fastest wheel then
+    double      timeS;
+    double      distanceM;              // fastest wheel's travel
+    double      driftM;                 // ... after standstill
+    const char* how;                    // what the bridges did first: coast, brake or ramp
+};
+
+class RoverModel : public Model {
+public:
+    static constexpr double STOP_MPS = 0.05;    // braked on a slope, the gearbox creeps
+    RoverModel(Node& actuator, Node& telemetry, const RoverParams& p = RoverParams());
+
+    void step(uint64_t t0, uint64_t t1) override;
+    const RoverState&  state() const  { return _s; }
+    const RoverParams& params() const { return _p; }
+    const std::vector<StopRecord>& stops() const { return _stops; }
+
+    // CSV trace of the pose, one row per 'periodMs' of virtual time.
+    void  openTrace(const char* path, unsigned periodMs = 20);
+    void  closeTrace();
+
+    double terrainHeight(double x, double y) const;
+
+private:
+    double wheelStep(double v, double duty, bool enabled, double slope, double dt) const;
+    void   readBridge(const MotorPins& pins, double& duty, bool& enabled) const;
+    void   synthesiseSensors(double dt);
+    void   batteryStep(double dt);
+    void   trackStop(double t, double dt);
+
+    Node&                       _act;
+    Node&                       _tlm;
+    RoverParams                 _p;
+    RoverState                  _s;
+    double                      _prevSpeed = 0;
+    std::mt19937                _rng;
+    std::normal_distribution<double> _n01{0.0, 1.0};
+    FILE*                       _trace = nullptr;
+    uint64_t                    _tracePeriodNs = 0;
+    uint64_t                    _nextTraceNs = 0;
+
+    // Stop being timed
+    std::vector<StopRecord>     _stops;
+    StopRecord                  _stop{};
+    bool                        _stopping = false;
+    bool                        _drifting = false;     // _stops.back() since standstill
+    double                      _heldS = 0;     // duty flat and non-zero since
+    double                      _prevDuty[2] = {0, 0};
+};
+
+} // namespace sim
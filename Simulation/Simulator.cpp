@@ -0,0 +1,72 @@
+#include "Simulator.h"
+
+#include <chrono>
+#include <thread>
+
+namespace sim {
+
+PortTap::PortTap(Node& node, int port, const char* path)
+    : _node(node), _port(port), _fp(fopen(path, "w")) {}
+
+PortTap::~PortTap() { close(); }
+
+void PortTap::close() {
+    if (_fp) fclose(_fp);
+    _fp = nullptr;
+}
+
+void PortTap::step(uint64_t t0, uint64_t t1) {
+    (void)t0;
+    _scratch.clear();
+    _node.board.ports[_port].takeDeparted(t1, _scratch);
+    _bytes += _scratch.size();
+    for (const auto& tb : _scratch) {
+        if (!intercept(tb.t, tb.b) && _fp) fputc(tb.b, _fp);
+    }
+}
+
+Simulator::~Simulator() { stop(); }
+
+Node& Simulator::addNode(const Program& program) {
+    _nodes.emplace_back(new Node(program));
+    return *_nodes.back();
+}
+
+void Simulator::run(uint64_t durationNs, double speed) {
+    using clock = std::chrono::steady_clock;
+    if (!_started) {
+        for (auto& n : _nodes) n->start();
+        _started = true;
+    }
+
+    const auto     wall0 = clock::now();
+    const uint64_t t0    = _t;
+    std::vector<SerialPort::TimedByte> scrap;
+
+    while (_t - t0 < durationNs) {
+        const uint64_t t1 = _t + _quantum;
+        for (auto& n : _nodes) n->runUntil(t1);
+        for (Model* m : _models) m->step(_t, t1);
+
+        // Bytes nobody listens to still leave the UART.
+        for (auto& n : _nodes) {
+            for (SerialPort& p : n->board.ports) {
+                scrap.clear();
+                p.takeDeparted(t1, scrap);
+            }
+        }
+        _t = t1;
+
+        if (speed > 0) {
+            auto due = wall0 + std::chrono::nanoseconds((uint64_t)((_t - t0) / speed));
+            std::this_thread::sleep_until(due);
+        }
+    }
+    _wallSeconds += std::chrono::duration<double>(clock::now() - wall0).count();
+}
+
+void Simulator::stop() {
+    for (auto& n : _nodes) n->stop();
+}
+
+} // namespace sim
@@ -0,0 +1,74 @@
+/**
+ * HOST SIMULATION - LOCK-STEP SCHEDULER
+ * Virtual time advances in fixed quanta. In every quantum each firmware
+ * node runs until its clock reaches the quantum end, then every world
+ * model (rover physics, GPS, radio, ground station) steps over the same
+ * interval. Runs as fast as the host allows unless a speed is given.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "SimNode.h"
+
+namespace sim {
+
+class Model {
+public:
+    virtual ~Model() = default;
+    virtual void step(uint64_t t0, uint64_t t1) = 0;
+};
+
+// Copies whatever a node writes to one of its ports into a host file
+// (the USB console, usually).
+class PortTap : public Model {
+public:
+    PortTap(Node& node, int port, const char* path);
+    ~PortTap() override;
+    void step(uint64_t t0, uint64_t t1) override;
+    void close();
+    uint64_t bytes() const { return _bytes; }
+
+protected:
+    // A byte the subclass keeps out of the file (returns true).
+    virtual bool intercept(uint64_t t, uint8_t b) { (void)t; (void)b; return false; }
+
+    Node&                               _node;
+    int                                 _port;
+
+private:
+    FILE*                               _fp;
+    uint64_t                            _bytes = 0;
+    std::vector<SerialPort::TimedByte>  _scratch;
+};
+
+class Simulator {
+public:
+    explicit Simulator(uint64_t quantumNs = 100000) : _quantum(quantumNs) {}
+    ~Simulator();
+
+    Node&    addNode(const Program& program);
+    void     addModel(Model* model) { _models.push_back(model); }
+
+    // speed <= 0: as fast as possible; 1.0: real time; 10.0: ten times faster.
+    void     run(uint64_t durationNs, double speed = 0.0);
+    void     stop();
+
+    uint64_t now() const            { return _t; }
+    uint64_t quantumNs() const      { return _quantum; }
+    double   wallSeconds() const    { return _wallSeconds; }
+    const std::vector<std::unique_ptr<Node>>& nodes() const { return _nodes; }
+
+private:
+    uint64_t                            _quantum;
+    uint64_t                            _t          = 0;
+    double                              _wallSeconds= 0;
+    bool                                _started    = false;
+    std::vector<std::unique_ptr<Node>>  _nodes;
+    std::vector<Model*>                 _models;
+};
+
+} // namespace sim
@@ -0,0 +1,122 @@
+/**
+ * TmtryData_Main built for the host. The .ino files are concatenated in
+ * the same order the Arduino builder uses (main sketch first, then the
+ * rest alphabetically), preceded by the prototypes it would generate.
+ */
+#include <math.h>
+
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "SdFat.h"
+#include "Watchdog_t4.h"
+#include "imxrt.h"
+#include "HealthMonitor.h"
+#include "TraceRecorder.h"
+#include "Tdma.h"
+#include "Fec.h"
+#include "EventLink.h"
+#include "LogServer.h"
+#include "AdaptiveRate.h"
+#include "ImuReports.h"
+#include "Resampler.h"
+#include "Filters.h"
+#include "PoseEstimator.h"
+#include "BatteryMonitor.h"
+#include "MS5611.h"
+#include "SimpleKalmanFilter.h"
+#include "TinyGPS++.h"
+#include "SoftwareSerial.h"
+#include "Adafruit_BNO08x.h"
+#include "Nodes.h"
+
+#ifdef BENCHMARK_MODE
+#include "AmbotBench.h"
+#endif
+
+namespace telemetry {
+
+// --- Arduino builder prototypes ---
+void doTelemetry();
+int  formatTelemetry(char* buffer, size_t size);
+void runBenchmarks(Print& out);
+void MS5611_Init();
+void MS5611_CORE();
+void IMU_Init(void);
+void IMU_CORE();
+void GPS_Init();
+void GPS_CORE();
+void displayInfo();
+void THERMISTOR_CORE();
+float thermistorCelsius(int raw);
+void print_data(double data, int decimal);
+void print_data(const char* s);
+void print_data(char c);
+void reportHealth();
+void traceCommand(int c);
+void usbConsole();
+void feedWatchdog();
+bool telemetryDue(uint32_t now);
+void sendTelemetry(const char* line, size_t len);
+void reportRates();
+void fusedInit();
+void fusedCore();
+void fusedEnd();
+void filterLogInit();
+void filterLog(uint32_t t, char ch, float value);
+void filterLogEnd();
+void pushFusedAttitude();
+void poseInit();
+void poseCore();
+void poseEnd();
+void batteryCore();
+void batteryLevelChanged();
+void reportBattery();
+
+// Every record the sketch formats, whichever sinks then take it
+// (sim::telemetryRecords). Its one sendTelemetry call is in the main sketch.
+std::vector<std::string> formattedRecords;
+#define sendTelemetry(line, len) (formattedRecords.emplace_back(line), sendTelemetry(line, len))
+#include "../TmtryData_Main/TmtryData_Main.ino"
+#undef sendTelemetry
+#include "../TmtryData_Main/Battery.ino"
+#include "../TmtryData_Main/Benchmarks.ino"
+#include "../TmtryData_Main/FilterLog.ino"
+#include "../TmtryData_Main/Fused.ino"
+#include "../TmtryData_Main/GPS_Core.ino"
+#include "../TmtryData_Main/Health.ino"
+#include "../TmtryData_Main/IMU_BNO08X.ino"
+#include "../TmtryData_Main/MS5611_Core.ino"
+#include "../TmtryData_Main/Pose.ino"
+#include "../TmtryData_Main/Printing_Data.ino"
+#include "../TmtryData_Main/Sinks.ino"
+#include "../TmtryData_Main/THERMISTOR_CORE.ino"
+#include "../TmtryData_Main/Trace.ino"
+#include "../TmtryData_Main/UsbConsole.ino"
+#include "../TmtryData_Main/GlobalVariables.cpp"
+#include "../TmtryData_Main/SDCardLogger.cpp"
+
+} // namespace telemetry
+
+sim::Program sim::telemetryProgram() {
+    return Program{"telemetry", &telemetry::setup, &telemetry::loop};
+}
+
+#ifdef BENCHMARK_MODE
+void sim::telemetryBenchmarks(Print& out) { telemetry::runBenchmarks(out); }
+#endif
+
+const FecStats& sim::telemetryFec() { return telemetry::radio.fec().stats(); }
+const EventStats& sim::telemetryEvents() { return telemetry::events.stats(); }
+const AdaptiveRate& sim::telemetryUsbRate() { return telemetry::usbRate; }
+const AdaptiveRate& sim::telemetryRadioRate() { return telemetry::radioRate; }
+const AdaptiveRate& sim::telemetrySdRate() { return telemetry::sdRate; }
+const Resampler& sim::telemetryFused() { return telemetry::fused; }
+const PoseEstimator& sim::telemetryPose() { return telemetry::pose; }
+const std::vector<std::string>& sim::telemetryRecords() { return telemetry::formattedRecords; }
+
+#ifdef TRACE_MODE
+TraceRecorder& sim::telemetryTrace() { return telemetry::trace; }
+#endif
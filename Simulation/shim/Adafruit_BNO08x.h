@@ -0,0 +1,157 @@
+/**
+ * HOST SIMULATION - Adafruit_BNO08x / SH-2 SHIM
+ * Reports are generated from board.imu at the intervals the firmware
+ * enabled. getSensorEvent() hands out at most one due report per call and
+ * charges an SHTP read over I2C, like the real driver.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+typedef uint8_t sh2_SensorId_t;
+
+enum {
+    SH2_RAW_ACCELEROMETER           = 0x14,
+    SH2_ACCELEROMETER               = 0x01,
+    SH2_GYROSCOPE_CALIBRATED        = 0x02,
+    SH2_MAGNETIC_FIELD_CALIBRATED   = 0x03,
+    SH2_LINEAR_ACCELERATION         = 0x04,
+    SH2_ROTATION_VECTOR             = 0x05,
+    SH2_GRAVITY                     = 0x06,
+    SH2_GAME_ROTATION_VECTOR        = 0x08,
+    SH2_GEOMAGNETIC_ROTATION_VECTOR = 0x09,
+    SH2_STABILITY_CLASSIFIER        = 0x13,
+    SH2_ARVR_STABILIZED_RV          = 0x28,
+    SH2_ARVR_STABILIZED_GRV         = 0x29,
+    SH2_GYRO_INTEGRATED_RV          = 0x2A,
+    SH2_MAX_SENSOR_ID               = 0x2F
+};
+
+typedef struct { float x, y, z; }                               sh2_Accelerometer_t;
+typedef struct { float x, y, z; }                               sh2_Gyroscope_t;
+typedef struct { float x, y, z; }                               sh2_MagneticField_t;
+typedef struct { float i, j, k, real, accuracy; }               sh2_RotationVectorWAcc_t;
+typedef struct { float i, j, k, real; }                         sh2_RotationVector_t;
+typedef struct { float i, j, k, real, angVelX, angVelY, angVelZ; } sh2_GyroIntegratedRV_t;
+
+typedef struct sh2_SensorValue {
+    uint8_t  sensorId;
+    uint8_t  sequence;
+    uint8_t  status;
+    uint64_t timestamp;
+    uint32_t delay;
+    union {
+        sh2_Accelerometer_t      accelerometer;
+        sh2_Accelerometer_t      linearAcceleration;
+        sh2_Accelerometer_t      gravity;
+        sh2_Gyroscope_t          gyroscope;
+        sh2_MagneticField_t      magneticField;
+        sh2_RotationVectorWAcc_t rotationVector;
+        sh2_RotationVectorWAcc_t geoMagRotationVector;
+        sh2_RotationVectorWAcc_t arvrStabilizedRV;
+        sh2_RotationVector_t     gameRotationVector;
+        sh2_RotationVector_t     arvrStabilizedGRV;
+        sh2_GyroIntegratedRV_t   gyroIntegratedRV;
+    } un;
+} sh2_SensorValue_t;
+
+class Adafruit_BNO08x {
+public:
+    explicit Adafruit_BNO08x(int8_t resetPin = -1) { (void)resetPin; }
+
+    bool begin_I2C(uint8_t addr = 0x4A, void* wire = nullptr, int32_t sensorId = 0) {
+        (void)addr; (void)wire; (void)sensorId;
+        sim::Node& n = sim::current();
+        n.charge(50000000);                          // boot + product id exchange
+        _started    = n.board.imu.present;
+        _resetFlag  = _started;                      // hub reports a reset after boot
+        for (auto& r : _reports) r = Report{};
+        return _started;
+    }
+
+    bool enableReport(sh2_SensorId_t id, uint32_t intervalUs = 10000) {
+        sim::Node& n = sim::current();
+        n.charge(n.board.costs.i2cEventNs);
+        if (!_started || id > SH2_MAX_SENSOR_ID) return false;
+        _reports[id].intervalNs = (uint64_t)intervalUs * 1000ULL;
+        _reports[id].nextNs     = n.now() + _reports[id].intervalNs;
+        return true;
+    }
+
+    // True once after the hub (re)booted; all reports are then disabled.
+    bool wasReset() {
+        sim::Node& n = sim::current();
+        if (n.board.imuResetPending) {
+            n.board.imuResetPending = false;
+            _resetFlag = true;
+            for (auto& r : _reports) r = Report{};
+        }
+        bool r = _resetFlag;
+        _resetFlag = false;
+        return r;
+    }
+
+    bool getSensorEvent(sh2_SensorValue_t* value);
+
+    // Reports delivered since boot, per sensor id (simulation only).
+    uint32_t delivered(sh2_SensorId_t id) const { return _reports[id].count; }
+
+private:
+    struct Report {
+        uint64_t intervalNs = 0;
+        uint64_t nextNs     = 0;
+        uint32_t count      = 0;
+        uint8_t  seq        = 0;
+    };
+
+    Report _reports[SH2_MAX_SENSOR_ID + 1];
+    bool   _started   = false;
+    bool   _resetFlag = false;
+};
+
+inline bool Adafruit_BNO08x::getSensorEvent(sh2_SensorValue_t* value) {
+    sim::Node& n = sim::current();
+    if (!_started) return false;
+
+    int due = -1;
+    for (int id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        const Report& r = _reports[id];
+        if (r.intervalNs && r.nextNs <= n.now() && (due < 0 || r.nextNs < _reports[due].nextNs)) due = id;
+    }
+    if (due < 0) {
+        n.charge(n.board.costs.i2cIdleNs);
+        return false;
+    }
+
+    Report& r = _reports[due];
+    // The hub only buffers the latest sample per sensor; catch up.
+    while (r.nextNs <= n.now()) r.nextNs += r.intervalNs;
+    r.count++;
+
+    const sim::ImuInputs& imu = n.board.imu;
+    memset(value, 0, sizeof(*value));
+    value->sensorId  = (uint8_t)due;
+    value->sequence  = r.seq++;
+    value->status    = imu.accuracy;
+    value->timestamp = n.now() / 1000ULL;
+    switch (due) {
+        case SH2_LINEAR_ACCELERATION:
+            value->un.linearAcceleration = {imu.linX, imu.linY, imu.linZ};
+            break;
+        case SH2_GYROSCOPE_CALIBRATED:
+            value->un.gyroscope = {imu.gyroX, imu.gyroY, imu.gyroZ};
+            break;
+        case SH2_GYRO_INTEGRATED_RV:
+            value->un.gyroIntegratedRV = {imu.qi, imu.qj, imu.qk, imu.qr, imu.gyroX, imu.gyroY, imu.gyroZ};
+            break;
+        case SH2_GAME_ROTATION_VECTOR:
+        case SH2_ARVR_STABILIZED_GRV:
+            value->un.gameRotationVector = {imu.qi, imu.qj, imu.qk, imu.qr};
+            break;
+        default:
+            value->un.rotationVector = {imu.qi, imu.qj, imu.qk, imu.qr, 0.05f};
+            break;
+    }
+    n.charge(n.board.costs.i2cEventNs);
+    return true;
+}
@@ -0,0 +1,28 @@
+/**
+ * HOST SIMULATION - PCA9685 SHIM
+ * Pulse widths land in board.servoPulse[] for the world model to read.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+class Adafruit_PWMServoDriver {
+public:
+    Adafruit_PWMServoDriver(uint8_t addr = 0x40) : _addr(addr) {}
+
+    bool begin(uint8_t prescale = 0) { (void)prescale; return true; }
+    void setPWMFreq(float freq)      { _freq = freq; }
+    void setOscillatorFrequency(uint32_t) {}
+
+    uint8_t setPWM(uint8_t num, uint16_t on, uint16_t off) {
+        sim::Node& n = sim::current();
+        (void)on;
+        if (num < sim::Board::NUM_SERVOS) n.board.servoPulse[num] = off;
+        n.charge(n.board.costs.i2cServoNs);
+        return 0;
+    }
+
+private:
+    uint8_t _addr;
+    float   _freq = 60;
+};
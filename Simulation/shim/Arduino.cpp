@@ -0,0 +1,28 @@
+#include "Arduino.h"
+#include "Wire.h"
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+HardwareSerial Serial3(3);
+TwoWire        Wire;
+
+size_t HardwareSerial::write(uint8_t b) {
+    sim::Node&       n = sim::current();
+    sim::SerialPort& p = port();
+    if (p.isUsb ? !p.hostConnected : p.baud == 0) return 0;
+
+    // A full TX ring blocks the caller until the UART shifts a byte out,
+    // exactly like the Teensy core does.
+    while (p.txOccupancy(n.now()) >= (int)p.txCapacity) n.charge(p.byteTimeNs());
+
+    p.enqueueTx(n.now(), b);
+    n.charge(n.board.costs.serialWriteNs);
+    return 1;
+}
+
+void HardwareSerial::flush() {
+    sim::Node&       n = sim::current();
+    sim::SerialPort& p = port();
+    while (p.txOccupancy(n.now()) > 0) n.charge(p.byteTimeNs());
+}
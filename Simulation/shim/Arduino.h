@@ -0,0 +1,254 @@
+/**
+ * HOST SIMULATION - ARDUINO / TEENSYDUINO CORE SHIM
+ * Just enough of the Teensy 4.1 core for both firmware images to compile
+ * unmodified on the host. All hardware access goes to sim::current().board.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#include "SimNode.h"
+
+using std::abs;
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+// --- CONSTANTS ---
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define LED_BUILTIN     13
+#define A0              14
+#define A1              15
+#define A2              16
+#define A3              17
+#define A4              18
+#define A5              19
+#define A6              20
+#define A7              21
+#define A8              22
+#define A9              23
+#define A10             24
+#define A11             25
+#define A12             26
+#define A13             27
+#define A14             38
+#define A15             39
+#define A16             40
+#define A17             41
+#define DEC             10
+#define HEX             16
+#define BIN             2
+#define PI              3.1415926535897932384626433832795
+#define DEG_TO_RAD      0.017453292519943295769236907684886
+#define RAD_TO_DEG      57.295779513082320876798154814105
+#define F_CPU           600000000
+#define F_CPU_ACTUAL    600000000UL
+
+// Teensy 4 placement attributes have no meaning on the host.
+#define FASTRUN
+#define FLASHMEM
+#define PROGMEM
+#define DMAMEM
+#define EXTMEM
+
+#define sq(x)           ((x) * (x))
+#define radians(deg)    ((deg) * DEG_TO_RAD)
+#define degrees(rad)    ((rad) * RAD_TO_DEG)
+
+template <class A, class B>
+inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+template <class A, class B>
+inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template <class T, class L, class H>
+inline T constrain(T x, L lo, H hi) { return x < lo ? (T)lo : (x > hi ? (T)hi : x); }
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// --- TIME ---
+inline unsigned long micros() {
+    sim::Node& n = sim::current();
+    n.charge(n.board.costs.clockReadNs);
+    return (unsigned long)(n.now() / 1000ULL);
+}
+inline unsigned long millis() {
+    sim::Node& n = sim::current();
+    n.charge(n.board.costs.clockReadNs);
+    return (unsigned long)(n.now() / 1000000ULL);
+}
+inline void delay(unsigned long ms)          { sim::current().charge(ms * 1000000ULL); }
+inline void delayMicroseconds(uint32_t us)   { sim::current().charge(us * 1000ULL); }
+inline void yield()                          { sim::current().charge(50); }
+
+// DWT cycle counter. The host clock is the node's virtual clock expressed
+// in target cycles, so cycle deltas mean the same thing on both sides.
+#define ARM_DWT_CYCCNT  ((uint32_t)(sim::current().now() * (F_CPU_ACTUAL / 1000000UL) / 1000ULL))
+
+// --- GPIO / ADC / PWM ---
+inline void pinMode(uint8_t pin, uint8_t mode) {
+    sim::Node& n = sim::current();
+    n.board.pinModes[pin] = mode;
+    n.charge(n.board.costs.gpioNs);
+}
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+    sim::Node& n = sim::current();
+    n.board.digital[pin] = val ? 1 : 0;
+    n.charge(n.board.costs.gpioNs);
+}
+inline int digitalRead(uint8_t pin) {
+    sim::Node& n = sim::current();
+    n.charge(n.board.costs.gpioNs);
+    return n.board.digital[pin];
+}
+inline void analogWrite(uint8_t pin, int val) {
+    sim::Node& n = sim::current();
+    n.board.analogOut[pin] = val;
+    n.charge(n.board.costs.analogWriteNs);
+}
+inline void analogWriteResolution(int bits)          { sim::current().board.analogWriteBits = bits; }
+inline void analogWriteFrequency(uint8_t, float)     {}
+inline void analogReadResolution(int bits)           { sim::current().board.analogReadBits = bits; }
+inline void analogReadAveraging(int)                 {}
+// Core clock (clockspeed.c): recorded only, the cost model stays at 600 MHz
+inline uint32_t set_arm_clock(uint32_t hz)          { sim::current().board.armClockHz = hz; return hz; }
+inline int  analogRead(uint8_t pin) {
+    sim::Node& n = sim::current();
+    n.charge(n.board.costs.analogReadNs);
+    int raw12 = n.board.analogIn[pin];
+    int bits  = n.board.analogReadBits;
+    return bits >= 12 ? raw12 << (bits - 12) : raw12 >> (12 - bits);
+}
+
+// --- PRINT / STREAM ---
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buf, size_t n) {
+        size_t w = 0;
+        while (n--) w += write(*buf++);
+        return w;
+    }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t write(const char* s)                  { return write((const uint8_t*)s, strlen(s)); }
+    size_t write(const char* s, size_t n)        { return write((const uint8_t*)s, n); }
+
+    size_t print(const char* s)                  { return write(s); }
+    size_t print(const __FlashStringHelper* s)   { return write((const char*)s); }
+    size_t print(char c)                         { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC)          { return print((long)v, base); }
+    size_t print(unsigned v, int base = DEC)     { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC) {
+        char b[40];
+        if (base == DEC) snprintf(b, sizeof(b), "%ld", v);
+        else return print((unsigned long)v, base);
+        return write(b);
+    }
+    size_t print(unsigned long v, int base = DEC) {
+        char b[72];
+        if (base == HEX)      snprintf(b, sizeof(b), "%lX", v);
+        else if (base == DEC) snprintf(b, sizeof(b), "%lu", v);
+        else {
+            int i = 70; b[71] = 0;
+            do { b[i--] = '0' + (v % base); v /= base; } while (v && i >= 0);
+            return write(b + i + 1);
+        }
+        return write(b);
+    }
+    size_t print(double v, int digits = 2) {
+        char b[64];
+        snprintf(b, sizeof(b), "%.*f", digits, v);
+        return write(b);
+    }
+
+    size_t println()                                 { return write("\r\n"); }
+    template <class T> size_t println(T v)           { size_t n = print(v); return n + println(); }
+    template <class T> size_t println(T v, int fmt)  { size_t n = print(v, fmt); return n + println(); }
+
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char b[512];
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(b, sizeof(b), fmt, ap);
+        va_end(ap);
+        write(b);
+        return n;
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read()      = 0;
+    virtual int peek()      = 0;
+    size_t readBytes(char* buf, size_t n) {
+        size_t i = 0;
+        while (i < n && available() > 0) buf[i++] = (char)read();
+        return i;
+    }
+};
+
+// Serial, Serial1, Serial2 forward to the current node's board ports.
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int index) : _index(index) {}
+
+    void begin(uint32_t baud) { port().baud = baud ? baud : 1; }
+    void end()                { port().baud = 0; }
+    // Teensy extends the core ring with caller-provided memory
+    void addMemoryForRead(void*, size_t n)  { port().rxCapacity += n; }
+    void addMemoryForWrite(void*, size_t n) { port().txCapacity += n; }
+    int  available() override {
+        sim::Node& n = sim::current();
+        n.charge(n.board.costs.serialPollNs);
+        return port().available(n.now());
+    }
+    int  read() override {
+        sim::Node& n = sim::current();
+        n.charge(n.board.costs.serialPollNs);
+        return port().read(n.now());
+    }
+    int  peek() override {
+        sim::Node& n = sim::current();
+        return port().peek(n.now());
+    }
+    int  availableForWrite() override {
+        sim::Node& n = sim::current();
+        return (int)port().txCapacity - port().txOccupancy(n.now());
+    }
+    using Print::write;
+    size_t write(uint8_t b) override;
+    void flush() override;
+    explicit operator bool() {
+        sim::SerialPort& p = port();
+        return p.isUsb ? p.hostConnected : p.baud != 0;
+    }
+    bool operator!() { return !static_cast<bool>(*this); }
+
+    sim::SerialPort& port() { return sim::current().board.ports[_index]; }
+
+private:
+    int _index;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
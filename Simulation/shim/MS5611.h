@@ -0,0 +1,81 @@
+/**
+ * HOST SIMULATION - MS5611 SHIM
+ * Mirrors the barometer library API used by TmtryData_Main, including its
+ * built-in Kalman smoothing and vertical-velocity helper. Every read does
+ * a conversion wait, so a full MS5611_CORE() costs what it does on target.
+ * Raw counts are plausible values, not an inverse of the PROM math.
+ */
+#pragma once
+
+#include "Arduino.h"
+#include "SimpleKalmanFilter.h"
+
+enum ms5611_osr_t {
+    ULTRA_HIGH_RES  = 0x08,
+    HIGH_RES        = 0x06,
+    STANDARD        = 0x04,
+    LOW_POWER       = 0x02,
+    ULTRA_LOW_POWER = 0x00
+};
+
+class MS5611 {
+public:
+    bool begin(ms5611_osr_t osr = HIGH_RES) {
+        static const uint64_t conv[] = {600000, 1170000, 2280000, 4540000, 9040000};
+        _convNs = conv[osr / 2];
+        sim::current().charge(3000000);                  // reset + PROM read
+        return sim::current().board.baro.present;
+    }
+
+    uint32_t readRawTemperature() {
+        convert();
+        return (uint32_t)(8077636 + (baro().temperatureC - 20.0) * 42000.0);
+    }
+    uint32_t readRawPressure() {
+        convert();
+        return (uint32_t)(6465444 + (baro().pressurePa - 100009.0) * 49.0);
+    }
+    double readTemperature(bool = false) {
+        convert();
+        return baro().temperatureC;
+    }
+    int32_t readPressure(bool = false) {
+        convert();                                       // D2 for compensation
+        convert();                                       // D1
+        return (int32_t)lround(baro().pressurePa);
+    }
+
+    double getAltitude(double pressure, double seaLevelPressure = 101325.0) {
+        return 44330.0 * (1.0 - pow(pressure / seaLevelPressure, 0.1902949));
+    }
+    double getSeaLevel(double pressure, double altitude) {
+        return pressure / pow(1.0 - (altitude / 44330.0), 5.255);
+    }
+
+    void enableKalmanFilter(float mea_e, float est_e, float q) {
+        _kalman = SimpleKalmanFilter(mea_e, est_e, q);
+    }
+    double kalmanFilter(double value) { return _kalman.updateEstimate((float)value); }
+
+    // Vertical speed from successive altitude samples (time in ms).
+    float getVelocity(double altitude, unsigned long timeMs) {
+        float v = _velocity;
+        if (_prevTime != 0 && timeMs > _prevTime) {
+            v = (float)((altitude - _prevAltitude) / ((timeMs - _prevTime) / 1000.0));
+        }
+        _prevAltitude = altitude;
+        _prevTime     = timeMs;
+        _velocity     = v;
+        return v;
+    }
+
+private:
+    const sim::BaroInputs& baro() { return sim::current().board.baro; }
+    void convert()                { sim::current().charge(_convNs); }
+
+    uint64_t            _convNs       = 4540000;
+    SimpleKalmanFilter  _kalman;
+    double              _prevAltitude = 0;
+    unsigned long       _prevTime     = 0;
+    float               _velocity     = 0;
+};
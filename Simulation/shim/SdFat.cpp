@@ -0,0 +1,163 @@
+#include "SdFat.h"
+
+#include <sys/stat.h>
+
+#include <cstring>
+
+namespace {
+void charge(uint64_t ns) { sim::current().charge(ns); }
+const sim::Costs& costs() { return sim::current().board.costs; }
+} // namespace
+
+// ================================================================
+// SdFs
+// ================================================================
+bool SdFs::begin(SdioConfig) {
+    const std::string& root = sim::current().board.sdRoot;
+    charge(costs().sdOpenCloseNs);
+    if (root.empty()) return false;
+    ::mkdir(root.c_str(), 0755);
+    _root = root;
+    _card.reset(new SdCard());
+    return true;
+}
+
+FsFile SdFs::open(const char* path, oflag_t flags) {
+    FsFile f;
+    if (_card) f.open(_root + "/" + path, flags);
+    return f;
+}
+
+bool SdFs::exists(const char* path) {
+    struct stat st;
+    return _card && ::stat((_root + "/" + path).c_str(), &st) == 0;
+}
+
+bool SdFs::remove(const char* path) {
+    return _card && ::remove((_root + "/" + path).c_str()) == 0;
+}
+
+// ================================================================
+// FsFile
+// ================================================================
+bool FsFile::open(const std::string& hostPath, oflag_t flags) {
+    struct stat st;
+    if (::stat(hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        charge(costs().sdOpenCloseNs);
+        DIR* d = opendir(hostPath.c_str());
+        if (!d) return false;
+        _dir.reset(d, closedir);
+        _path = hostPath;
+        return true;
+    }
+    const char* mode = "rb";
+    if (flags & O_APPEND)                    mode = "a+b";
+    else if (flags & O_TRUNC)                mode = "w+b";
+    else if ((flags & O_ACCMODE) != O_RDONLY) {
+        FILE* probe = fopen(hostPath.c_str(), "rb");
+        mode = probe ? "r+b" : ((flags & O_CREAT) ? "w+b" : "r+b");
+        if (probe) fclose(probe);
+    }
+    charge(costs().sdOpenCloseNs);
+    FILE* fp = fopen(hostPath.c_str(), mode);
+    if (!fp) return false;
+    _fp.reset(fp, fclose);
+    _path = hostPath;
+    _name = hostPath.substr(hostPath.find_last_of('/') + 1);
+    if (flags & O_APPEND) fseek(fp, 0, SEEK_END);
+    return true;
+}
+
+bool FsFile::close() {
+    if (_dir) {
+        _dir.reset();
+        return true;
+    }
+    if (!_fp) return false;
+    sync();
+    charge(costs().sdOpenCloseNs);
+    _fp.reset();
+    return true;
+}
+
+bool FsFile::sync() {
+    if (!_fp) return false;
+    fflush(_fp.get());
+    charge(costs().sdSyncNs);
+    _unsynced = 0;
+    return true;
+}
+
+size_t FsFile::write(const uint8_t* buf, size_t n) {
+    if (!_fp) return 0;
+    size_t w = fwrite(buf, 1, n, _fp.get());
+    charge(costs().sdBytesNs * n);
+    // Every full 512-byte sector in the cache gets programmed.
+    _unsynced += n;
+    while (_unsynced >= 512) {
+        charge(costs().sdSectorNs);
+        _unsynced -= 512;
+    }
+    return w;
+}
+
+int FsFile::available() {
+    if (!_fp) return 0;
+    uint64_t rem = size() - position();
+    return rem > 0x7FFFFFFF ? 0x7FFFFFFF : (int)rem;
+}
+
+int FsFile::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int FsFile::read(void* buf, size_t n) {
+    if (!_fp) return -1;
+    size_t r = fread(buf, 1, n, _fp.get());
+    charge(costs().sdBytesNs * r + (r / 512) * (costs().sdSectorNs / 3));
+    return (int)r;
+}
+
+int FsFile::peek() {
+    if (!_fp) return -1;
+    int c = fgetc(_fp.get());
+    if (c != EOF) ungetc(c, _fp.get());
+    return c == EOF ? -1 : c;
+}
+
+uint64_t FsFile::size() const {
+    if (!_fp) return 0;
+    long cur = ftell(_fp.get());
+    fseek(_fp.get(), 0, SEEK_END);
+    long end = ftell(_fp.get());
+    fseek(_fp.get(), cur, SEEK_SET);
+    return (uint64_t)end;
+}
+
+uint64_t FsFile::position() const {
+    return _fp ? (uint64_t)ftell(_fp.get()) : 0;
+}
+
+bool FsFile::seek(uint64_t pos) {
+    return _fp && fseek(_fp.get(), (long)pos, SEEK_SET) == 0;
+}
+
+bool FsFile::getName(char* name, size_t len) const {
+    if (!_fp || len == 0) return false;
+    snprintf(name, len, "%s", _name.c_str());
+    return true;
+}
+
+bool FsFile::openNext(FsFile* dir, oflag_t flags) {
+    if (!dir || !dir->_dir) return false;
+    while (struct dirent* e = readdir(dir->_dir.get())) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+        FsFile next;
+        if (!next.open(dir->_path + "/" + e->d_name, flags)) continue;
+        next._name = e->d_name;
+        *this = next;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,87 @@
+/**
+ * HOST SIMULATION - SdFat SHIM
+ * Files live under board.sdRoot on the host file system. Write, sync and
+ * open/close charge SDIO-like costs so logging shows up in loop timing.
+ */
+#pragma once
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+
+#ifndef O_READ
+#define O_READ      O_RDONLY
+#endif
+#ifndef O_WRITE
+#define O_WRITE     O_WRONLY
+#endif
+#ifndef O_AT_END
+#define O_AT_END    0x4000
+#endif
+
+typedef int oflag_t;
+
+#define FIFO_SDIO   0
+#define DMA_SDIO    1
+
+struct SdioConfig {
+    explicit SdioConfig(int opt = FIFO_SDIO) : options(opt) {}
+    int options;
+};
+
+class SdCard {
+public:
+    bool     isBusy()       { return false; }
+    uint32_t sectorCount()  { return 62333952; }   // 32 GB card
+};
+
+class FsFile : public Stream {
+public:
+    FsFile() = default;
+
+    bool open(const std::string& hostPath, oflag_t flags);
+    bool close();
+    bool sync();
+    bool isOpen() const      { return _fp || _dir; }
+    explicit operator bool() const { return isOpen(); }
+
+    using Print::write;
+    size_t   write(uint8_t b) override { return write(&b, 1); }
+    size_t   write(const uint8_t* buf, size_t n) override;
+    int      available() override;
+    int      read() override;
+    int      read(void* buf, size_t n);
+    int      peek() override;
+    uint64_t size() const;
+    uint64_t position() const;
+    bool     seek(uint64_t pos);
+    bool     seekEnd()       { return seek(size()); }
+    bool     getName(char* name, size_t len) const;
+    bool     isDir() const   { return (bool)_dir; }
+    // Next entry of the open directory 'dir' ("." and ".." skipped).
+    bool     openNext(FsFile* dir, oflag_t flags = O_RDONLY);
+
+private:
+    std::shared_ptr<FILE> _fp;
+    std::shared_ptr<DIR>  _dir;
+    std::string           _path;
+    std::string           _name;
+    uint64_t              _unsynced = 0;   // bytes since the last sector program
+};
+
+class SdFs {
+public:
+    bool    begin(SdioConfig cfg);
+    void    end()            { _card.reset(); }
+    SdCard* card()           { return _card.get(); }
+    FsFile  open(const char* path, oflag_t flags = O_RDONLY);
+    bool    exists(const char* path);
+    bool    remove(const char* path);
+
+private:
+    std::string             _root;
+    std::unique_ptr<SdCard> _card;
+};
@@ -0,0 +1,122 @@
+/**
+ * HOST SIMULATION - VIRTUAL BOARD
+ * One instance per simulated Teensy 4.1. Holds the pin state, UART ports,
+ * sensor inputs and the node's virtual clock. Every shimmed Arduino call
+ * charges a small CPU cost to the clock, so firmware busy-waits advance
+ * virtual time exactly like they burn real time on the target.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+// --- CPU COST MODEL (nanoseconds) ---
+// Rough Teensy 4.1 @ 600 MHz figures. They only need to be plausible;
+// the point is that nothing in the firmware is free.
+struct Costs {
+    uint64_t loopOverheadNs     = 500;       // loop() call + yield()
+    uint64_t clockReadNs        = 20;        // millis()/micros()
+    uint64_t gpioNs             = 15;        // digitalWrite/pinMode
+    uint64_t analogWriteNs      = 120;
+    uint64_t analogReadNs       = 17000;     // 12-bit conversion
+    uint64_t serialPollNs       = 40;        // available()/read()
+    uint64_t serialWriteNs      = 60;        // per byte into the TX ring
+    uint64_t i2cEventNs         = 280000;    // BNO08x SHTP packet @400 kHz
+    uint64_t i2cIdleNs          = 45000;     // BNO08x poll with nothing queued
+    uint64_t i2cServoNs         = 120000;    // PCA9685 setPWM (5 bytes)
+    uint64_t sdBytesNs          = 20;        // memcpy into SdFat cache
+    uint64_t sdSectorNs         = 150000;    // SDIO sector program
+    uint64_t sdSyncNs           = 1500000;   // dir entry + FAT update
+    uint64_t sdOpenCloseNs      = 3000000;   // directory walk
+};
+
+// --- UART / USB PORT ---
+// TX bytes get a departure time on the wire (10 bit times each at the
+// configured baud). RX bytes carry an arrival time and only become visible
+// to the firmware once the node's clock has passed it.
+class SerialPort {
+public:
+    struct TimedByte { uint64_t t; uint8_t b; uint32_t baud; };
+
+    std::string         name;
+    uint32_t            baud            = 0;       // 0 = closed
+    bool                isUsb           = false;
+    bool                hostConnected   = true;    // USB enumerated
+    size_t              rxCapacity      = 64;
+    size_t              txCapacity      = 64;
+    uint64_t            rxOverflows     = 0;
+    uint64_t            rxFramingErrors = 0;       // sender at the wrong baud
+
+    uint64_t byteTimeNs() const;
+
+    // Firmware side (called from the node thread)
+    int      available(uint64_t now);
+    int      read(uint64_t now);
+    int      peek(uint64_t now);
+    int      txOccupancy(uint64_t now) const;
+    uint64_t enqueueTx(uint64_t now, uint8_t b); // returns departure time
+
+    // World side (called from the scheduler between quanta)
+    // wireBaud = 0 means "whatever the port is set to" (radio modules, USB).
+    void     pushRx(uint64_t t, uint8_t b, uint32_t wireBaud = 0) { _pending.push_back({t, b, wireBaud}); }
+    void     pushRx(uint64_t t, const uint8_t* data, size_t n, uint32_t wireBaud);
+    size_t   takeDeparted(uint64_t upTo, std::vector<TimedByte>& out);
+    uint64_t nextDeparture() const { return _tx.empty() ? 0 : _tx.front().t; }
+
+private:
+    void settle(uint64_t now);
+
+    std::deque<TimedByte> _pending;   // in flight towards the RX ring
+    std::deque<uint8_t>   _rx;        // what Serial.read() sees
+    std::deque<TimedByte> _tx;        // queued or on the wire
+    uint64_t              _lineFreeAt = 0;
+};
+
+// --- SENSOR INPUTS (written by the world model) ---
+struct ImuInputs {
+    float qr = 1, qi = 0, qj = 0, qk = 0;    // orientation
+    float linX = 0, linY = 0, linZ = 0;      // gravity-free accel (m/s^2)
+    float gyroX = 0, gyroY = 0, gyroZ = 0;   // rad/s
+    uint8_t accuracy = 3;
+    bool    present  = true;
+};
+
+struct BaroInputs {
+    double pressurePa   = 101325.0;
+    double temperatureC = 25.0;
+    bool   present      = true;
+};
+
+// --- BOARD ---
+struct Board {
+    static constexpr int NUM_PINS   = 64;
+    static constexpr int NUM_PORTS  = 4;     // Serial (USB), Serial1..Serial3
+    static constexpr int NUM_SERVOS = 16;    // PCA9685 channels
+
+    int         pinModes[NUM_PINS]      = {};
+    int         digital[NUM_PINS]       = {};
+    int         analogOut[NUM_PINS]     = {};
+    int         analogIn[NUM_PINS]      = {};   // raw counts at 12 bits
+    int         analogWriteBits         = 8;
+    int         analogReadBits          = 10;
+    uint32_t    armClockHz              = 600000000;  // set_arm_clock()
+    uint16_t    servoPulse[NUM_SERVOS]  = {};
+    SerialPort  ports[NUM_PORTS];
+
+    ImuInputs   imu;
+    BaroInputs  baro;
+    bool        imuResetPending         = false;  // hub reset injection
+
+    std::string sdRoot;                 // empty = no card inserted
+    uint32_t    srcSrsr                 = 0x1;    // power-on reset
+    Costs       costs;
+
+    Board();
+};
+
+} // namespace sim
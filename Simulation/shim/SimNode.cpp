@@ -0,0 +1,198 @@
+#include "SimNode.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace sim {
+
+namespace {
+// Thrown inside the node thread to unwind the firmware stack on stop().
+struct StopNode {};
+
+thread_local Node* tCurrent = nullptr;
+
+Node& standaloneNode() {
+    static Node node(Program{"standalone", nullptr, nullptr});
+    return node;
+}
+} // namespace
+
+Node& current() {
+    return tCurrent ? *tCurrent : standaloneNode();
+}
+
+void bindStandalone(Node* node) { tCurrent = node; }
+
+// ================================================================
+// BOARD / SERIAL PORT
+// ================================================================
+Board::Board() {
+    ports[0].name = "Serial";  ports[0].isUsb = true;
+    ports[0].rxCapacity = 4096; ports[0].txCapacity = 4096;
+    ports[1].name = "Serial1";
+    ports[2].name = "Serial2";
+    ports[3].name = "Serial3";
+}
+
+uint64_t SerialPort::byteTimeNs() const {
+    if (isUsb) return 700;                        // ~12 Mbit/s effective
+    if (baud == 0) return 0;
+    return 10ULL * 1000000000ULL / baud;          // 8N1 = 10 bit times
+}
+
+void SerialPort::settle(uint64_t now) {
+    while (!_pending.empty() && _pending.front().t <= now) {
+        const TimedByte& tb = _pending.front();
+        if (baud == 0 || (tb.baud && !isUsb && tb.baud != baud)) rxFramingErrors++;
+        else if (_rx.size() < rxCapacity) _rx.push_back(tb.b);
+        else rxOverflows++;
+        _pending.pop_front();
+    }
+}
+
+int SerialPort::available(uint64_t now) {
+    settle(now);
+    return (int)_rx.size();
+}
+
+int SerialPort::read(uint64_t now) {
+    settle(now);
+    if (_rx.empty()) return -1;
+    int b = _rx.front();
+    _rx.pop_front();
+    return b;
+}
+
+int SerialPort::peek(uint64_t now) {
+    settle(now);
+    return _rx.empty() ? -1 : _rx.front();
+}
+
+int SerialPort::txOccupancy(uint64_t now) const {
+    int n = 0;
+    for (auto it = _tx.rbegin(); it != _tx.rend() && it->t > now; ++it) n++;
+    return n;
+}
+
+uint64_t SerialPort::enqueueTx(uint64_t now, uint8_t b) {
+    uint64_t start  = std::max(now, _lineFreeAt);
+    _lineFreeAt     = start + byteTimeNs();
+    _tx.push_back({_lineFreeAt, b, baud});
+    return _lineFreeAt;
+}
+
+void SerialPort::pushRx(uint64_t t, const uint8_t* data, size_t n, uint32_t wireBaud) {
+    uint64_t bt = wireBaud ? 10ULL * 1000000000ULL / wireBaud : 0;
+    for (size_t i = 0; i < n; i++) pushRx(t + (i + 1) * bt, data[i], wireBaud);
+}
+
+size_t SerialPort::takeDeparted(uint64_t upTo, std::vector<TimedByte>& out) {
+    size_t n = 0;
+    while (!_tx.empty() && _tx.front().t <= upTo) {
+        out.push_back(_tx.front());
+        _tx.pop_front();
+        n++;
+    }
+    return n;
+}
+
+// ================================================================
+// NODE
+// ================================================================
+Node::Node(const Program& program) : name(program.name), _program(program) {}
+
+Node::~Node() { stop(); }
+
+void Node::start() {
+    _thread = std::thread(&Node::threadMain, this);
+}
+
+void Node::waitTurn(std::unique_lock<std::mutex>& lk) {
+    _cv.wait(lk, [this] { return _nodeTurn; });
+    if (_stopReq) throw StopNode{};
+}
+
+void Node::giveBack(std::unique_lock<std::mutex>& lk) {
+    _nodeTurn = false;
+    _cv.notify_all();
+    (void)lk;
+}
+
+void Node::threadMain() {
+    tCurrent = this;
+    std::unique_lock<std::mutex> lk(_m);
+    try {
+        waitTurn(lk);
+        lk.unlock();
+        _program.setup();
+        for (;;) {
+            _program.loop();
+            loops++;
+            charge(board.costs.loopOverheadNs);
+        }
+    } catch (const StopNode&) {
+        // fall through
+    }
+    if (!lk.owns_lock()) lk.lock();
+    _finished = true;
+    giveBack(lk);
+}
+
+void Node::runUntil(uint64_t deadlineNs) {
+    if (_finished || _t >= deadlineNs) return;
+    std::unique_lock<std::mutex> lk(_m);
+    _deadline = deadlineNs;
+    _nodeTurn = true;
+    _cv.notify_all();
+    _cv.wait(lk, [this] { return !_nodeTurn; });
+}
+
+void Node::stop() {
+    if (!_thread.joinable()) return;
+    {
+        std::unique_lock<std::mutex> lk(_m);
+        _stopReq  = true;
+        _nodeTurn = true;
+        _cv.notify_all();
+    }
+    _thread.join();
+}
+
+void Node::charge(uint64_t ns) {
+    _t += ns;
+    checkWatchdog();
+    if (this == &standaloneNode() || tCurrent != this) return;
+    while (_t >= _deadline || _halted) {
+        std::unique_lock<std::mutex> lk(_m);
+        giveBack(lk);
+        waitTurn(lk);
+    }
+}
+
+void Node::halt(const std::string& reason) {
+    if (_halted) return;
+    _halted     = true;
+    _haltReason = reason;
+    std::fprintf(stderr, "[%s] HALT at %.3f s: %s\n", name.c_str(), _t / 1e9, reason.c_str());
+}
+
+void Node::wdtBegin(uint64_t triggerNs, uint64_t timeoutNs, void (*cb)()) {
+    _wdtArmed    = true;
+    _wdtWarned   = false;
+    _wdtTrigger  = triggerNs;
+    _wdtTimeout  = timeoutNs;
+    _wdtCallback = cb;
+    _wdtLastFeed = _t;
+}
+
+void Node::checkWatchdog() {
+    if (!_wdtArmed || _halted) return;
+    uint64_t starved = _t - _wdtLastFeed;
+    if (!_wdtWarned && _wdtTrigger && starved >= _wdtTrigger) {
+        _wdtWarned = true;
+        if (_wdtCallback) _wdtCallback();
+    }
+    if (starved >= _wdtTimeout) halt("watchdog reset (loop starved)");
+}
+
+} // namespace sim
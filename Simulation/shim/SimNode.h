@@ -0,0 +1,88 @@
+/**
+ * HOST SIMULATION - NODE CONTEXT
+ * Runs one firmware image (setup() + loop()) on its own thread, but only
+ * while the scheduler hands it the baton. The node gives the baton back as
+ * soon as its virtual clock crosses the current quantum boundary, so all
+ * nodes advance in lock-step and the run is fully deterministic.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "SimBoard.h"
+
+namespace sim {
+
+struct Program {
+    const char* name;
+    void (*setup)();
+    void (*loop)();
+};
+
+class Node {
+public:
+    explicit Node(const Program& program);
+    ~Node();
+
+    Node(const Node&)            = delete;
+    Node& operator=(const Node&) = delete;
+
+    // --- Scheduler side ---
+    void     start();                      // spawn thread (does not run yet)
+    void     runUntil(uint64_t deadlineNs);// give baton, wait for it back
+    void     stop();                       // unwind and join
+    bool     halted() const { return _halted; }
+    const std::string& haltReason() const { return _haltReason; }
+
+    // --- Firmware side (node thread) ---
+    uint64_t now() const { return _t; }
+    void     charge(uint64_t ns);
+    void     halt(const std::string& reason);
+
+    // --- Watchdog (WDT_T4 shim) ---
+    void     wdtBegin(uint64_t triggerNs, uint64_t timeoutNs, void (*cb)());
+    void     wdtFeed() { _wdtLastFeed = _t; _wdtWarned = false; }
+
+    // --- Bookkeeping ---
+    const std::string name;
+    Board    board;
+    uint64_t loops = 0;
+
+private:
+    void threadMain();
+    void waitTurn(std::unique_lock<std::mutex>& lk);
+    void giveBack(std::unique_lock<std::mutex>& lk);
+    void checkWatchdog();
+
+    Program                 _program;
+    std::thread             _thread;
+    std::mutex              _m;
+    std::condition_variable _cv;
+    bool                    _nodeTurn   = false;
+    bool                    _stopReq    = false;
+    bool                    _finished   = false;
+    bool                    _halted     = false;
+    std::string             _haltReason;
+    uint64_t                _t          = 0;
+    uint64_t                _deadline   = 0;
+
+    bool                    _wdtArmed   = false;
+    bool                    _wdtWarned  = false;
+    uint64_t                _wdtTrigger = 0;
+    uint64_t                _wdtTimeout = 0;
+    uint64_t                _wdtLastFeed= 0;
+    void                  (*_wdtCallback)() = nullptr;
+};
+
+// Node the calling thread belongs to. Outside a node thread (benchmarks,
+// offline tools) this is a free-running standalone node that never yields.
+Node& current();
+
+// Bind the calling thread to a node without a scheduler (offline tools).
+void  bindStandalone(Node* node);
+
+} // namespace sim
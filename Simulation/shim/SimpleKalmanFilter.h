@@ -0,0 +1,36 @@
+/**
+ * HOST SIMULATION - SimpleKalmanFilter
+ * Same one-dimensional update rule as the Arduino library.
+ */
+#pragma once
+
+#include <cmath>
+
+class SimpleKalmanFilter {
+public:
+    SimpleKalmanFilter(float mea_e = 1, float est_e = 1, float q = 0.01f)
+        : _err_measure(mea_e), _err_estimate(est_e), _q(q) {}
+
+    float updateEstimate(float mea) {
+        _kalman_gain      = _err_estimate / (_err_estimate + _err_measure);
+        _current_estimate = _last_estimate + _kalman_gain * (mea - _last_estimate);
+        _err_estimate     = (1.0f - _kalman_gain) * _err_estimate
+                          + std::fabs(_last_estimate - _current_estimate) * _q;
+        _last_estimate    = _current_estimate;
+        return _current_estimate;
+    }
+
+    void setMeasurementError(float mea_e) { _err_measure = mea_e; }
+    void setEstimateError(float est_e)    { _err_estimate = est_e; }
+    void setProcessNoise(float q)         { _q = q; }
+    float getKalmanGain()                 { return _kalman_gain; }
+    float getEstimateError()              { return _err_estimate; }
+
+private:
+    float _err_measure;
+    float _err_estimate;
+    float _q;
+    float _current_estimate = 0;
+    float _last_estimate    = 0;
+    float _kalman_gain      = 0;
+};
@@ -0,0 +1,11 @@
+/**
+ * HOST SIMULATION - SoftwareSerial SHIM (included but unused by firmware)
+ */
+#pragma once
+
+#include "Arduino.h"
+
+class SoftwareSerial {
+public:
+    SoftwareSerial(uint8_t, uint8_t) {}
+};
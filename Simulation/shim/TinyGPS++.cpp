@@ -0,0 +1,117 @@
+#include "TinyGPS++.h"
+
+namespace {
+int hexVal(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// ddmm.mmmm / dddmm.mmmm + hemisphere -> signed decimal degrees
+double parseDegrees(const char* field, const char* hemi) {
+    double raw = atof(field);
+    int    deg = (int)(raw / 100);
+    double v   = deg + (raw - deg * 100) / 60.0;
+    return (hemi[0] == 'S' || hemi[0] == 'W') ? -v : v;
+}
+} // namespace
+
+bool TinyGPSPlus::encode(char c) {
+    _chars++;
+    if (c == '$') {
+        _inSentence = true;
+        _len = 0;
+        return false;
+    }
+    if (!_inSentence) return false;
+    if (c == '\r' || c == '\n') {
+        _inSentence = false;
+        _buf[_len] = '\0';
+        return commitSentence();
+    }
+    if (_len < sizeof(_buf) - 1) _buf[_len++] = c;
+    else _inSentence = false;                      // runaway, resync on '$'
+    return false;
+}
+
+bool TinyGPSPlus::commitSentence() {
+    char* star = strchr(_buf, '*');
+    if (!star || hexVal(star[1]) < 0 || hexVal(star[2]) < 0) { _failed++; return false; }
+    uint8_t sum = 0;
+    for (char* p = _buf; p < star; p++) sum ^= (uint8_t)*p;
+    if (sum != (uint8_t)(hexVal(star[1]) * 16 + hexVal(star[2]))) { _failed++; return false; }
+    _passed++;
+    *star = '\0';
+
+    // Split in place; empty fields stay as "".
+    const char* f[24] = {};
+    int n = 0;
+    char* p = _buf;
+    while (n < 24) {
+        f[n++] = p;
+        char* comma = strchr(p, ',');
+        if (!comma) break;
+        *comma = '\0';
+        p = comma + 1;
+    }
+    if (strlen(f[0]) < 5) return false;
+    const char* type = f[0] + 2;                   // skip talker id
+
+    if (strcmp(type, "RMC") == 0 && n >= 10) {
+        bool active = f[2][0] == 'A';
+        if (f[1][0]) time.commit(atof(f[1]) * 100);
+        if (f[9][0]) date.commit(atof(f[9]));
+        if (active && f[3][0] && f[5][0]) {
+            location._lat   = parseDegrees(f[3], f[4]);
+            location._lng   = parseDegrees(f[5], f[6]);
+            location._valid = location._updated = true;
+            location._stamp = millis();
+            _withFix++;
+        }
+        if (active && f[7][0]) speed.commit(atof(f[7]));
+        if (active && f[8][0]) course.commit(atof(f[8]));
+        return true;
+    }
+    if (strcmp(type, "GGA") == 0 && n >= 10) {
+        bool fix = f[6][0] && f[6][0] != '0';
+        if (f[1][0]) time.commit(atof(f[1]) * 100);
+        if (f[7][0]) satellites.commit(atoi(f[7]));
+        if (f[8][0]) hdop.commit(atof(f[8]));
+        if (fix && f[2][0] && f[4][0]) {
+            location._lat   = parseDegrees(f[2], f[3]);
+            location._lng   = parseDegrees(f[4], f[5]);
+            location._valid = location._updated = true;
+            location._stamp = millis();
+            _withFix++;
+        }
+        if (fix && f[9][0]) altitude.commit(atof(f[9]));
+        return true;
+    }
+    return false;
+}
+
+double TinyGPSPlus::distanceBetween(double lat1, double lon1, double lat2, double lon2) {
+    double delta = radians(lon1 - lon2);
+    double sdlong = sin(delta), cdlong = cos(delta);
+    lat1 = radians(lat1);
+    lat2 = radians(lat2);
+    double slat1 = sin(lat1), clat1 = cos(lat1);
+    double slat2 = sin(lat2), clat2 = cos(lat2);
+    delta = sq(clat1 * slat2 - slat1 * clat2 * cdlong) + sq(clat2 * sdlong);
+    delta = sqrt(delta);
+    double denom = slat1 * slat2 + clat1 * clat2 * cdlong;
+    return atan2(delta, denom) * 6372795;
+}
+
+double TinyGPSPlus::courseTo(double lat1, double lon1, double lat2, double lon2) {
+    double dlon = radians(lon2 - lon1);
+    lat1 = radians(lat1);
+    lat2 = radians(lat2);
+    double a1 = sin(dlon) * cos(lat2);
+    double a2 = sin(lat1) * cos(lat2) * cos(dlon);
+    a2 = cos(lat1) * sin(lat2) - a2;
+    a2 = atan2(a1, a2);
+    if (a2 < 0.0) a2 += 2 * PI;
+    return degrees(a2);
+}
@@ -0,0 +1,94 @@
+/**
+ * HOST SIMULATION - TinyGPS++ SHIM
+ * A compact NMEA parser with the TinyGPS++ surface the firmware uses.
+ * Handles RMC and GGA from any talker (GP/GN/GL...), validates checksums
+ * and commits fields only on a good sentence, like the real library.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+class TinyGPSPlus;
+
+class TinyGPSLocation {
+    friend class TinyGPSPlus;
+public:
+    bool     isValid() const    { return _valid; }
+    bool     isUpdated() const  { return _updated; }
+    uint32_t age() const        { return _valid ? millis() - _stamp : 0xFFFFFFFF; }
+    double   lat()              { _updated = false; return _lat; }
+    double   lng()              { _updated = false; return _lng; }
+private:
+    bool _valid = false, _updated = false;
+    uint32_t _stamp = 0;
+    double _lat = 0, _lng = 0;
+};
+
+class TinyGPSDecimal {
+    friend class TinyGPSPlus;
+public:
+    bool     isValid() const    { return _valid; }
+    bool     isUpdated() const  { return _updated; }
+    uint32_t age() const        { return _valid ? millis() - _stamp : 0xFFFFFFFF; }
+    double   value()            { _updated = false; return _val; }
+protected:
+    bool _valid = false, _updated = false;
+    uint32_t _stamp = 0;
+    double _val = 0;
+    void commit(double v) { _val = v; _valid = _updated = true; _stamp = millis(); }
+};
+
+struct TinyGPSSpeed : TinyGPSDecimal {
+    double knots() { return value(); }
+    double mph()   { return value() * 1.15077945; }
+    double mps()   { return value() * 0.51444444; }
+    double kmph()  { return value() * 1.852; }
+};
+struct TinyGPSCourse   : TinyGPSDecimal { double deg()    { return value(); } };
+struct TinyGPSAltitude : TinyGPSDecimal { double meters() { return value(); } };
+struct TinyGPSHDOP     : TinyGPSDecimal { double hdop()   { return value(); } };
+struct TinyGPSInteger  : TinyGPSDecimal { uint32_t value() { return (uint32_t)TinyGPSDecimal::value(); } };
+
+struct TinyGPSTime : TinyGPSDecimal {
+    uint8_t hour()   { return (uint8_t)((uint32_t)value() / 1000000); }
+    uint8_t minute() { return (uint8_t)((uint32_t)value() / 10000 % 100); }
+    uint8_t second() { return (uint8_t)((uint32_t)value() / 100 % 100); }
+};
+struct TinyGPSDate : TinyGPSDecimal {
+    uint8_t  day()   { return (uint8_t)((uint32_t)value() / 10000); }
+    uint8_t  month() { return (uint8_t)((uint32_t)value() / 100 % 100); }
+    uint16_t year()  { return (uint16_t)(2000 + (uint32_t)value() % 100); }
+};
+
+class TinyGPSPlus {
+public:
+    bool encode(char c);
+
+    TinyGPSLocation location;
+    TinyGPSDate     date;
+    TinyGPSTime     time;
+    TinyGPSSpeed    speed;
+    TinyGPSCourse   course;
+    TinyGPSAltitude altitude;
+    TinyGPSInteger  satellites;
+    TinyGPSHDOP     hdop;
+
+    uint32_t charsProcessed() const   { return _chars; }
+    uint32_t sentencesWithFix() const { return _withFix; }
+    uint32_t failedChecksum() const   { return _failed; }
+    uint32_t passedChecksum() const   { return _passed; }
+
+    static double distanceBetween(double lat1, double lon1, double lat2, double lon2);
+    static double courseTo(double lat1, double lon1, double lat2, double lon2);
+
+private:
+    bool commitSentence();
+
+    char     _buf[96];
+    size_t   _len      = 0;
+    bool     _inSentence = false;
+    uint32_t _chars    = 0;
+    uint32_t _withFix  = 0;
+    uint32_t _failed   = 0;
+    uint32_t _passed   = 0;
+};
@@ -0,0 +1,38 @@
+/**
+ * HOST SIMULATION - WDT_T4 SHIM
+ * The node checks for starvation on every clock charge: the warning
+ * callback fires at 'trigger' and the node halts at 'timeout'.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+typedef void (*watchdog_class_ptr)();
+
+struct WDT_timings_t {
+    float               trigger     = 5;
+    float               timeout     = 10;
+    float               window      = 0;
+    uint8_t             pin         = 0;
+    watchdog_class_ptr  callback    = nullptr;
+    uint32_t            lp_divider  = 1;
+};
+
+enum WDT_DEV { WDT1, WDT2, WDT3 };
+
+template <WDT_DEV WDT>
+class WDT_T4 {
+public:
+    // Same units and clamping as the library: seconds, 0.5 .. 128.
+    void begin(WDT_timings_t config) {
+        sim::current().wdtBegin(toNs(config.trigger), toNs(config.timeout), config.callback);
+    }
+    void feed()  { sim::current().wdtFeed(); }
+    void reset() { sim::current().halt("software reset requested"); }
+
+private:
+    static uint64_t toNs(float v) {
+        v = v < 0.5f ? 0.5f : (v > 128.0f ? 128.0f : v);
+        return (uint64_t)(v * 1e9);
+    }
+};
@@ -0,0 +1,16 @@
+/**
+ * HOST SIMULATION - Wire (I2C) SHIM
+ * Bus traffic is accounted for inside the device shims, so this is inert.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+    void begin()                {}
+    void setClock(uint32_t)     {}
+    void end()                  {}
+};
+
+extern TwoWire Wire;
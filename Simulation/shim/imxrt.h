@@ -0,0 +1,10 @@
+/**
+ * HOST SIMULATION - i.MX RT1062 REGISTER SHIM
+ * Only the registers the firmware touches are modelled.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+// System Reset Controller status (bit 5 = watchdog reset)
+#define SRC_SRSR (sim::current().board.srcSrsr)
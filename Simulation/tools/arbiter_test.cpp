@@ -0,0 +1,113 @@
+/**
+ * COMMAND ARBITER TEST
+ * Drives CommandArbiter directly with interleaved USB and radio command
+ * streams, one poll per millisecond like the actuator loop, and checks:
+ *   - radio lines are locked out while the USB lease runs
+ *   - USB takes over on its first line
+ *   - USB lets go one lease after its last line, and the radio's next
+ *     line takes control back
+ *   - both handoffs land within a bound, and the failsafe time follows
+ *     the source that sent the last accepted command
+ *
+ * Usage: arbiter_test        (exits 1 if any check fails)
+ */
+#include <cstdio>
+#include <vector>
+
+#include "CommandArbiter.h"
+
+namespace {
+// Same table as COMMAND_SOURCES in CmdCtrl_Main.ino
+enum : uint8_t { SRC_USB, SRC_RADIO };
+const ArbiterSource SOURCES[] = {
+    // name     priority  lease ms  failsafe ms
+    {"usb",     2,        1000,     250},
+    {"radio",   1,        1500,     500},
+};
+
+const uint32_t LINE_MS      = 50;       // both hosts re-send the motor line this often
+const uint32_t USB_FIRST_MS = 2000;     // bench host plugged in
+const uint32_t USB_LAST_MS  = 5000;     // ... and quiet after this line
+const uint32_t END_MS       = 9000;
+const uint32_t USB_OFFSET   = 25;       // interleaved with the radio lines
+
+struct Handoff {
+    CommandArbiter::Event event;
+    uint8_t               source, other;
+    uint32_t              ms;
+};
+std::vector<Handoff> handoffs;
+
+void onEvent(CommandArbiter::Event event, uint8_t source, uint8_t other, uint32_t nowMs) {
+    handoffs.push_back({event, source, other, nowMs});
+}
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    printf("%s  %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) failures++;
+}
+} // namespace
+
+int main() {
+    CommandArbiter arbiter(SOURCES, 2);
+    arbiter.onEvent(onEvent);
+
+    const uint32_t usbFirst = USB_FIRST_MS + (LINE_MS - (USB_FIRST_MS - USB_OFFSET) % LINE_MS) % LINE_MS;
+    const uint32_t usbLast  = USB_LAST_MS - (USB_LAST_MS - USB_OFFSET) % LINE_MS;
+
+    uint32_t radioLocked = 0, radioLockedInLease = 0, radioLinesInLease = 0;
+    uint32_t usbDropped = 0, radioBackMs = 0;
+    bool     failsafeOk = true;
+    for (uint32_t ms = 0; ms <= END_MS; ms++) {
+        const bool usbLine   = ms >= USB_FIRST_MS && ms <= USB_LAST_MS && (ms - USB_OFFSET) % LINE_MS == 0;
+        const bool radioLine = ms % LINE_MS == 0;
+        const bool inLease   = ms >= usbFirst && ms <= usbLast + SOURCES[SRC_USB].leaseMs;
+
+        if (usbLine && !arbiter.accept(SRC_USB, ms)) usbDropped++;
+        if (radioLine) {
+            const bool ok = arbiter.accept(SRC_RADIO, ms);
+            if (!ok) radioLocked++;
+            if (inLease) {
+                radioLinesInLease++;
+                if (!ok) radioLockedInLease++;
+            }
+            if (ok && ms > USB_LAST_MS && !radioBackMs) radioBackMs = ms;
+        }
+        arbiter.poll(ms);
+
+        if (usbLine)   failsafeOk &= arbiter.failsafeMs() == SOURCES[SRC_USB].failsafeMs;
+        if (radioLine && arbiter.holder() == SRC_RADIO)
+            failsafeOk &= arbiter.failsafeMs() == SOURCES[SRC_RADIO].failsafeMs;
+    }
+
+    // Expected: radio takes the free arbiter, usb preempts, usb releases, radio takes it back
+    const bool shape = handoffs.size() == 4 && handoffs[0].event == CommandArbiter::TAKEOVER &&
+                       handoffs[0].source == SRC_RADIO && handoffs[1].event == CommandArbiter::TAKEOVER &&
+                       handoffs[1].source == SRC_USB && handoffs[1].other == SRC_RADIO &&
+                       handoffs[2].event == CommandArbiter::RELEASE && handoffs[2].source == SRC_USB &&
+                       handoffs[3].event == CommandArbiter::TAKEOVER && handoffs[3].source == SRC_RADIO;
+    check(shape, "handoffs: radio takes, usb preempts, usb releases, radio takes back");
+    check(usbDropped == 0, "no usb line dropped");
+    check(radioLinesInLease > 0 && radioLockedInLease == radioLinesInLease,
+          "every radio line locked out during the usb lease");
+    check(radioLocked == radioLockedInLease, "no radio line locked out outside the usb lease");
+
+    if (shape) {
+        const uint32_t takeMs    = handoffs[1].ms - usbFirst;
+        const uint32_t releaseMs = handoffs[2].ms - usbLast;
+        const uint32_t backMs    = handoffs[3].ms - usbLast;
+        printf("      usb took over %lu ms after its first line, released %lu ms and radio back %lu ms "
+               "after its last\n",
+               (unsigned long)takeMs, (unsigned long)releaseMs, (unsigned long)backMs);
+        check(takeMs == 0, "usb takes over on its first line");
+        check(releaseMs == SOURCES[SRC_USB].leaseMs + 1u, "usb lets go one lease after its last line");
+        check(handoffs[3].ms == radioBackMs && backMs <= SOURCES[SRC_USB].leaseMs + LINE_MS,
+              "radio back on its next line, within lease + one line period");
+    }
+    check(failsafeOk, "failsafe time follows the source of the last accepted command");
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * AMBOT HOST MICROBENCHMARKS
+ * Runs the Benchmarks.ino suite of both sketches on the host and prints
+ * the CSV records on stdout (format in AmbotBench.h). The firmware runs on
+ * a standalone node, so shim calls cost host time but never block.
+ *
+ * Usage: bench [actuator|telemetry]...     (default: both)
+ */
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "Arduino.h"
+#include "Nodes.h"
+
+namespace {
+class StdoutPrint : public Print {
+public:
+    size_t write(uint8_t b) override { return fputc(b, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t* buf, size_t n) override { return fwrite(buf, 1, n, stdout); }
+};
+} // namespace
+
+int main(int argc, char** argv) {
+    bool runActuator  = argc < 2;
+    bool runTelemetry = argc < 2;
+    for (int i = 1; i < argc; i++) {
+        if      (!strcmp(argv[i], "actuator"))  runActuator  = true;
+        else if (!strcmp(argv[i], "telemetry")) runTelemetry = true;
+        else {
+            fprintf(stderr, "usage: bench [actuator|telemetry]...\n");
+            return 2;
+        }
+    }
+
+    // The SD record kernel writes bench.csv under the standalone node's card
+    mkdir("bench_sd", 0755);
+    sim::current().board.sdRoot = "bench_sd";
+
+    StdoutPrint out;
+    if (runActuator)  sim::actuatorBenchmarks(out);
+    if (runTelemetry) sim::telemetryBenchmarks(out);
+    return 0;
+}
@@ -0,0 +1,811 @@
+/**
+ * AMBOT CO-SIMULATION
+ * Runs CmdCtrl_Main and TmtryData_Main in lock-step virtual time against
+ * the rover model: ground commands -> radio -> actuator PWM -> wheels ->
+ * pose -> BNO08x / GPS / MS5611 -> telemetry firmware -> radio -> ground.
+ *
+ * Usage: cosim [options]
+ *   --duration <s>       virtual seconds to run (default 25)
+ *   --speed <x>          pace at x times real time (default: as fast as possible)
+ *   --realtime           same as --speed 1
+ *   --script <file>      ground command script (see GroundStation.h)
+ *   --out <dir>          output directory (default sim_out)
+ *   --quantum-us <n>     lock-step quantum (default 100)
+ *   --shared-channel     ground, telemetry and actuator on one frequency
+ *   --loss <p>           radio byte loss probability
+ *   --ber <p>            radio bit error rate
+ *   --burst <p>          probability per byte of entering a 1e-2 BER burst
+ *   --ubx                GPS also emits UBX-NAV-PVT
+ *   --tdma <ms>          ground runs a TDMA superframe of <ms> (implies --shared-channel)
+ *   --guard-ms <n>       TDMA guard time between slots (default 12)
+ *   --seed <n>           seed for every random source
+ *   --download <file>    at 5 s, fetch <file> from the telemetry SD over USB
+ *   --parked             ... as a parked (XP) transfer instead of background
+ *   --usb-pty <link>     expose the telemetry USB console as a pty at <link>
+ *                        (for Tools/sd_download; use with --realtime)
+ *   --imu-reset <s>      reset the BNO08x hub at <s> (reports must come back)
+ *   --usb-script <file>  a bench host on the actuator's USB, same script format
+ *                        as --script; reports the arbiter's handoffs
+ *   --echo               ground tags its commands; the actuator's echoes give
+ *                        the round trip and its parts (see CommandEcho.h)
+ *   --keepalive <ms>     ground holds the motor line with "K" every <ms> and
+ *                        reports the uplink saved (see GroundStation.h)
+ *   --battery-soc <f>    pack charge at the start, 0..1 (default 0.9)
+ *   --battery-ah <Ah>    pack capacity (default 5; small values drain it in a run)
+ *
+ * Built with -DRADIO_FEC, the telemetry node and the ground send FEC frames
+ * (see Fec.h); compare goodput against a plain build on the same --burst.
+ *
+ * Built with -DTRACE_MODE, both trace rings are drained continuously into
+ * <out>/{actuator,telemetry}_trace.csv (see Tools/trace_to_perfetto.py).
+ */
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "AdaptiveRate.h"
+#include "CommandArbiter.h"
+#include "CommandEcho.h"
+#include "EventLink.h"
+#include "Fec.h"
+#include "GpsModel.h"
+#include "GroundStation.h"
+#include "LogTransfer.h"
+#include "Nodes.h"
+#include "RadioLink.h"
+#include "PoseEstimator.h"
+#include "Resampler.h"
+#include "RoverModel.h"
+#include "Simulator.h"
+
+#ifdef TRACE_MODE
+#include "TraceRecorder.h"
+#endif
+
+using namespace sim;
+
+namespace {
+void usage() {
+    fprintf(stderr, "usage: cosim [--duration s] [--speed x | --realtime] [--script file] [--out dir]\n"
+                    "             [--quantum-us n] [--shared-channel] [--loss p] [--ber p]\n"
+                    "             [--burst p] [--ubx] [--tdma ms] [--guard-ms n] [--seed n]\n"
+                    "             [--download file [--parked]] [--usb-pty link] [--imu-reset s]\n"
+                    "             [--usb-script file] [--echo] [--keepalive ms]\n"
+                    "             [--battery-soc f] [--battery-ah Ah]\n");
+}
+
+void printRadio(const RadioChannel& ch) {
+    const RadioStats& s = ch.stats();
+    printf("  radio %-9s sent %8llu  delivered %8llu  corrupted %6llu  lost %6llu  collided %6llu  deaf %6llu\n",
+           ch.name().c_str(), (unsigned long long)s.sent, (unsigned long long)s.delivered,
+           (unsigned long long)s.corrupted, (unsigned long long)s.lost,
+           (unsigned long long)s.collided, (unsigned long long)s.deafened);
+}
+
+// Counts the command lines that reach a node's radio exactly as the ground
+// sent them, framed or plain.
+class CommandProbe : public RadioStation {
+public:
+    CommandProbe(RadioStation& inner, const GroundStation& ground) : _inner(inner), _ground(ground) {}
+    const char* stationName() const override { return _inner.stationName(); }
+    void collectTx(uint64_t upTo, std::vector<SerialPort::TimedByte>& out) override {
+        _inner.collectTx(upTo, out);
+    }
+    void deliver(uint64_t t, uint8_t b) override {
+        _inner.deliver(t, b);
+        switch (_fec.feed(b)) {
+        case FecDecoder::TEXT:  break;
+        case FecDecoder::FRAME: count(std::string((const char*)_fec.payload(), _fec.length())); return;
+        default:                return;
+        }
+        if (b != '\n') { if (_line.size() < 128) _line.push_back((char)b); return; }
+        count(_line);
+        _line.clear();
+    }
+    uint64_t commands() const { return _commands; }
+
+private:
+    void count(const std::string& line) {
+        if (_ground.wasSent(line)) _commands++;
+    }
+
+    RadioStation&        _inner;
+    const GroundStation& _ground;
+    FecDecoder           _fec;
+    std::string          _line;
+    uint64_t             _commands = 0;
+};
+
+// Downlink lines the ground logged that match, byte for byte, a record the
+// telemetry node formatted or a line it printed on USB or wrote to SD. Each
+// sink takes its own subset of the records at its own rate, so the radio's
+// are checked against all of them.
+struct ExactLines { uint64_t lines = 0, bytes = 0, records = 0, wrong = 0; };
+
+ExactLines exactDownlink(const std::vector<std::string>& records, const std::string& usbLog,
+                         const std::string& sdLog, const std::string& rxLog) {
+    std::unordered_set<std::string> printed(records.begin(), records.end());
+    for (const std::string& path : {usbLog, sdLog}) {
+        std::ifstream in(path);
+        for (std::string l; std::getline(in, l);) {
+            if (!l.empty() && l.back() == '\r') l.pop_back();
+            printed.insert(l);
+        }
+    }
+    ExactLines r;
+    std::ifstream rx(rxLog);
+    for (std::string l; std::getline(rx, l);) {
+        const size_t q = l.find(",\"");
+        if (q == std::string::npos || l.size() < q + 3) continue;
+        const std::string line = l.substr(q + 2, l.size() - q - 3);
+        if (line.rfind("Q,n=", 0) == 0 || line.rfind("E,", 0) == 0) continue;  // radio-only lines
+        if (!printed.count(line)) { r.wrong++; continue; }
+        r.lines++;
+        r.bytes += line.size() + 1;
+        if (std::count(line.begin(), line.end(), ',') == 17) r.records++;
+    }
+    return r;
+}
+
+// local_pose.csv against the rover's true track (pose.csv). The estimator's
+// origin is its first fix, so it is moved into the model's frame first.
+void printPose(const std::string& out, const PoseEstimator& pose, const GpsParams& gp) {
+    std::vector<std::pair<long, std::pair<double, double>>> est;
+    std::ifstream in(out + "/telemetry_sd/local_pose.csv");
+    for (std::string l; std::getline(in, l);) {
+        long   t;
+        double x, y;
+        if (sscanf(l.c_str(), "%ld,%lf,%lf", &t, &x, &y) == 3) est.push_back({t, {x, y}});
+    }
+    const double mPerDeg = 111320.0;
+    const double dE = (pose.originLon() - gp.originLon) * mPerDeg * cos(gp.originLat * M_PI / 180.0);
+    const double dN = (pose.originLat() - gp.originLat) * mPerDeg;
+
+    std::ifstream truth(out + "/pose.csv");
+    double   sum2 = 0, worst = 0, last = 0;
+    uint64_t n    = 0;
+    size_t   k    = 0;
+    for (std::string l; std::getline(truth, l);) {
+        double ts, x, y;
+        if (est.empty() || sscanf(l.c_str(), "%lf,%lf,%lf", &ts, &x, &y) != 3) continue;
+        const long t = lround(ts * 1000.0);
+        while (k + 1 < est.size() && est[k + 1].first <= t) k++;
+        if (est[k].first > t || t - est[k].first > 5) continue;
+        const double e = hypot(est[k].second.first + dE - x, est[k].second.second + dN - y);
+        sum2 += e * e;
+        worst = std::max(worst, e);
+        last  = e;
+        n++;
+    }
+    const PoseStats& st = pose.stats();
+    printf("  pose      %lu steps, %lu fixes (%lu rejected), %lu speeds; error rms %.2f m, max %.2f m, final %.2f m "
+           "(sigma %.2f m), heading offset %.1f deg\n",
+           (unsigned long)st.steps, (unsigned long)st.fixes, (unsigned long)st.rejected, (unsigned long)st.speeds,
+           n ? sqrt(sum2 / n) : 0.0, worst, last, pose.sigmaM(), pose.offsetDeg());
+}
+
+// fused.csv: records on the grid (every step the same), and value ages of
+// a baro, an IMU and a GPS field.
+void printFused(const std::string& path, const Resampler& fused) {
+    std::ifstream in(path);
+    uint64_t      rows = 0, irregular = 0;
+    long          prevT = -1, step = 0;
+    const char*   names[] = {"pressure_pa_age_ms", "yaw_deg_age_ms", "latitude_age_ms"};
+    int           column[3] = {-1, -1, -1};
+    double        sum[3] = {}, worst[3] = {};
+    uint64_t      count[3] = {};
+    for (std::string l; std::getline(in, l);) {
+        if (!l.empty() && l.back() == '\r') l.pop_back();
+        std::vector<std::string> f;
+        for (size_t a = 0, b; a <= l.size(); a = b + 1) {
+            b = l.find(',', a);
+            if (b == std::string::npos) b = l.size();
+            f.push_back(l.substr(a, b - a));
+        }
+        if (f[0] == "t_ms") {
+            for (int k = 0; k < 3; k++)
+                column[k] = (int)(std::find(f.begin(), f.end(), names[k]) - f.begin());
+            prevT = -1;
+            continue;
+        }
+        if (f[0].empty() || !isdigit((unsigned char)f[0][0])) continue;
+        const long t = atol(f[0].c_str());
+        if (prevT >= 0) {
+            if (step == 0) step = t - prevT;
+            if (t - prevT != step) irregular++;
+        }
+        prevT = t;
+        rows++;
+        for (int k = 0; k < 3; k++) {
+            if (column[k] < 0 || column[k] >= (int)f.size() || f[column[k]].empty()) continue;
+            const double age = atof(f[column[k]].c_str());
+            sum[k] += age;
+            worst[k] = std::max(worst[k], age);
+            count[k]++;
+        }
+    }
+    printf("  fused     %llu records, %ld ms apart (%llu irregular, %lu skipped); age mean/max baro %.0f/%.0f ms, "
+           "imu %.0f/%.0f ms, gps %.0f/%.0f ms\n",
+           (unsigned long long)rows, step, (unsigned long long)irregular, (unsigned long)fused.skipped(),
+           count[0] ? sum[0] / count[0] : 0.0, worst[0], count[1] ? sum[1] / count[1] : 0.0, worst[1],
+           count[2] ? sum[2] / count[2] : 0.0, worst[2]);
+}
+
+void printFec(const char* who, const FecStats& f) {
+    if (!f.frames && !f.uncorrectable) return;
+    printf("  fec       %-9s %6lu frames, %5lu corrected (%lu bytes), %4lu uncorrectable\n", who,
+           (unsigned long)f.frames, (unsigned long)f.corrected, (unsigned long)f.bytesFixed,
+           (unsigned long)f.uncorrectable);
+}
+
+// The telemetry node's USB console, with a host asking for one SD file:
+// blocks go to <out>/download_<file>, text to the console log as before.
+class UsbDownload : public PortTap {
+public:
+    UsbDownload(Node& node, const std::string& out, const std::string& file, bool parked,
+                uint64_t atNs)
+        : PortTap(node, 0, (out + "/telemetry_usb.log").c_str()), _file(file), _parked(parked),
+          _atNs(atNs), _fp(file.empty() ? nullptr : fopen((out + "/download_" + file).c_str(), "wb")) {}
+    ~UsbDownload() override { if (_fp) fclose(_fp); }
+
+    void step(uint64_t t0, uint64_t t1) override {
+        if (!_asked && t1 >= _atNs) {
+            const std::string req = std::string(_parked ? "XP," : "XG,") + _file + ",0,0\n";
+            _node.board.ports[0].pushRx(t1, (const uint8_t*)req.data(), req.size(), 0);
+            _asked = true;
+            _askedNs = t1;
+        }
+        PortTap::step(t0, t1);
+    }
+
+    void report(double loopHz) const {
+        if (!_asked) return;
+        const double s = (_lastNs - _firstNs) / 1e9;
+        printf("  download  %s %s: %llu of %llu B in %.3f s (%.2f MB/s sustained, first block after %.1f ms), "
+               "%u bad blocks, crc %s; telemetry loop %.0f Hz\n",
+               _file.c_str(), _parked ? "parked" : "background", (unsigned long long)_bytes,
+               (unsigned long long)_expect, s, s > 0 ? _bytes / s / 1e6 : 0.0,
+               _firstNs ? (_firstNs - _askedNs) / 1e6 : 0.0, (unsigned)_parser.bad(),
+               !_done ? "pending" : _crcOk ? "ok" : "MISMATCH", loopHz);
+    }
+
+protected:
+    bool intercept(uint64_t t, uint8_t b) override {
+        const bool wasBlock = _parser.inBlock();
+        switch (_parser.feed(b)) {
+        case xfer::BlockParser::BLOCK:
+            if (!_firstNs) _firstNs = t;
+            _lastNs = t;
+            if (_fp) {
+                fseek(_fp, _parser.offset(), SEEK_SET);
+                fwrite(_parser.data(), 1, _parser.length(), _fp);
+            }
+            _crc    = xfer::crc32(_parser.data(), _parser.length(), _crc);
+            _bytes += _parser.length();
+            return true;
+        case xfer::BlockParser::LINE:
+            onLine(_parser.line());
+            return false;
+        default:
+            return wasBlock || _parser.inBlock();
+        }
+    }
+
+private:
+    void onLine(const char* line) {
+        unsigned long a = 0, c = 0;
+        char name[64];
+        if (sscanf(line, "XG,%63[^,],%lu,%lu", name, &a, &c) == 3) _expect = c;
+        if (sscanf(line, "XE,%lu,%lx", &a, &c) == 2) {
+            _done  = true;
+            _crcOk = a == _bytes && (uint32_t)c == _crc;
+        }
+    }
+
+    std::string         _file;
+    bool                _parked;
+    uint64_t            _atNs;
+    FILE*               _fp;
+    xfer::BlockParser   _parser;
+    bool                _asked      = false;
+    bool                _done       = false;
+    bool                _crcOk      = false;
+    uint64_t            _askedNs    = 0;
+    uint64_t            _firstNs    = 0;
+    uint64_t            _lastNs     = 0;
+    uint64_t            _bytes      = 0;
+    uint64_t            _expect     = 0;
+    uint32_t            _crc        = 0;
+};
+
+// The telemetry node's USB console on a host pseudo-terminal, so host tools
+// can talk to it. Download blocks are kept out of the console log.
+class UsbPty : public PortTap {
+public:
+    UsbPty(Node& node, const std::string& out, const char* link)
+        : PortTap(node, 0, (out + "/telemetry_usb.log").c_str()), _link(link) {
+        _master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (_master < 0 || grantpt(_master) || unlockpt(_master)) return;
+        fcntl(_master, F_SETFL, O_NONBLOCK);
+        unlink(link);
+        if (symlink(ptsname(_master), link)) perror(link);
+    }
+    ~UsbPty() override {
+        if (_master >= 0) ::close(_master);
+        unlink(_link.c_str());
+    }
+    bool ok() const { return _master >= 0; }
+
+    void step(uint64_t t0, uint64_t t1) override {
+        uint8_t buf[256];
+        ssize_t n;
+        while (_master >= 0 && (n = ::read(_master, buf, sizeof(buf))) > 0)
+            _node.board.ports[0].pushRx(t1, buf, (size_t)n, 0);
+        PortTap::step(t0, t1);
+        while (!_pending.empty()) {
+            n = ::write(_master, _pending.data(), _pending.size());
+            if (n <= 0) break;
+            _pending.erase(0, (size_t)n);
+        }
+    }
+
+protected:
+    bool intercept(uint64_t, uint8_t b) override {
+        if (_pending.size() < (64u << 20)) _pending.push_back((char)b);
+        const bool wasBlock = _parser.inBlock();
+        const auto r        = _parser.feed(b);
+        return wasBlock || _parser.inBlock() || r == xfer::BlockParser::BLOCK;
+    }
+
+private:
+    std::string         _link;
+    int                 _master     = -1;
+    std::string         _pending;
+    xfer::BlockParser   _parser;
+};
+
+/// p-th percentile (0..1) of 'v', which it sorts.
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+// A bench host on the actuator's USB port. Can fight the ground for
+// control: plays a script (GroundStation.h format) into the port and
+// times the arbiter's handoffs from the "C,...,take=" lines it prints.
+// Also collects command echoes ("K,..."): ground clock, actuator clock
+// and this port share the virtual time, so every leg is exact.
+class UsbOperator : public PortTap {
+public:
+    UsbOperator(Node& node, const std::string& out)
+        : PortTap(node, 0, (out + "/actuator_usb.log").c_str()) {}
+
+    bool loadScript(const char* path) {
+        GroundStation parser;       // same grammar; only its entries are used
+        if (!parser.loadScript(path)) return false;
+        _script = parser.script();
+        return true;
+    }
+
+    void step(uint64_t t0, uint64_t t1) override {
+        while (_next < _script.size() && _script[_next].tNs < t1) {
+            const GroundStation::Entry& e = _script[_next++];
+            if (e.cmd.rfind("repeat", 0) == 0) {
+                _repeatNs = strtoull(e.cmd.c_str() + 6, nullptr, 10) * 1000000ULL;
+            } else if (e.cmd.rfind("keepalive", 0) == 0) {
+                _keepaliveNs = strtoull(e.cmd.c_str() + 9, nullptr, 10) * 1000000ULL;
+            } else if (e.cmd == "silence") {
+                _motorLine.clear();
+            } else if (isdigit((unsigned char)e.cmd[0]) || e.cmd[0] == '-') {
+                _motorLine  = e.cmd;
+                send(e.tNs, _motorLine);
+                _nextRepeat = e.tNs + (_keepaliveNs ? _keepaliveNs : _repeatNs);
+            } else {
+                send(e.tNs, e.cmd);
+            }
+        }
+        // USB does not drop lines: with keepalives the motor line goes once
+        if (!_motorLine.empty() && _repeatNs && t1 > _nextRepeat) {
+            send(_nextRepeat, _keepaliveNs ? "K" : _motorLine);
+            _nextRepeat += _keepaliveNs ? _keepaliveNs : _repeatNs;
+        }
+        PortTap::step(t0, t1);
+    }
+
+    void report() const {
+        reportEcho();
+        if (_script.empty()) return;
+        const CommandArbiter& a = actuatorArbiter();
+        printf("  arbiter   usb sent %llu lines; %llu handoffs;", (unsigned long long)_sent,
+               (unsigned long long)_handoffs);
+        for (uint8_t src = 0; src < 2; src++) {
+            printf(" %s %lu ok / %lu locked out / %lu takeovers%s", a.name(src),
+                   (unsigned long)a.stats(src).accepted, (unsigned long)a.stats(src).lockedOut,
+                   (unsigned long)a.stats(src).takeovers, src ? "\n" : ";");
+        }
+        if (_takeovers)
+            printf("            usb took over %llu times, %.1f ms after its first line (max %.1f)\n",
+                   (unsigned long long)_takeovers, _takeSumNs / 1e6 / _takeovers, _takeMaxNs / 1e6);
+        if (_regains)
+            printf("            radio took back %llu times, %.0f ms after usb went quiet (max %.0f)\n",
+                   (unsigned long long)_regains, _regainSumNs / 1e6 / _regains, _regainMaxNs / 1e6);
+    }
+
+protected:
+    bool intercept(uint64_t t, uint8_t b) override {
+        if (b != '\n') {
+            if (b != '\r' && _line.size() < 128) _line.push_back((char)b);
+            return false;
+        }
+        echo::Echo e;
+        if (echo::parse(_line.c_str(), &e)) onEcho(t, e);
+        // Timed by the actuator's own stamp, not by when the line got out
+        if (_line.rfind("C,n=ACT,t=", 0) == 0)
+            onHandoff(strtoull(_line.c_str() + 10, nullptr, 10) * 1000000ULL, _line);
+        _line.clear();
+        return false;
+    }
+
+private:
+    // All legs in ms; the tags are the ground's clock in us
+    struct EchoLegs { std::vector<double> rtt, uplink, firmware, usb; };
+
+    void onEcho(uint64_t t, const echo::Echo& e) {
+        if (e.apUs == 0) { _echoDropped++; return; }
+        const double hostUs = t / 1e3;
+        _legs.rtt.push_back((hostUs - e.tag) / 1e3);
+        _legs.uplink.push_back(((double)e.rxUs - e.tag) / 1e3);
+        _legs.firmware.push_back(((double)e.apUs - e.rxUs) / 1e3);
+        _legs.usb.push_back((hostUs - e.apUs) / 1e3);
+    }
+
+    void reportEcho() const {
+        if (_legs.rtt.empty() && !_echoDropped) return;
+        EchoLegs l = _legs;
+        printf("  echo      %llu echoes (%llu dropped); ms p50 / p90 / p99 / max:\n",
+               (unsigned long long)l.rtt.size(), (unsigned long long)_echoDropped);
+        const std::pair<const char*, std::vector<double>*> legs[] = {
+            {"rtt", &l.rtt}, {"uplink", &l.uplink}, {"firmware", &l.firmware}, {"usb back", &l.usb}};
+        for (const auto& k : legs) {
+            printf("            %-9s %6.1f %6.1f %6.1f %6.1f\n", k.first, percentile(*k.second, 0.5),
+                   percentile(*k.second, 0.9), percentile(*k.second, 0.99), percentile(*k.second, 1.0));
+        }
+    }
+
+    void send(uint64_t t, const std::string& line) {
+        const std::string l = line + "\n";
+        _node.board.ports[0].pushRx(t, (const uint8_t*)l.data(), l.size(), 0);
+        if (!_holding && !_asking) _askedNs = t;
+        _asking  = !_holding;
+        _lastNs  = t;
+        _sent++;
+    }
+
+    void onHandoff(uint64_t t, const std::string& line) {
+        if (line.find(",take=") == std::string::npos) {
+            if (line.find(",free=usb") != std::string::npos) _holding = false;
+            return;
+        }
+        _handoffs++;
+        const bool usb = line.find(",take=usb") != std::string::npos;
+        if (usb && _asking) {
+            const uint64_t d = t > _askedNs ? t - _askedNs : 0;
+            _takeSumNs += d;
+            _takeMaxNs  = std::max(_takeMaxNs, d);
+            _takeovers++;
+        } else if (!usb && _sent && line.find(",from=none") != std::string::npos && !_holding) {
+            const uint64_t d = t > _lastNs ? t - _lastNs : 0;
+            _regainSumNs += d;
+            _regainMaxNs  = std::max(_regainMaxNs, d);
+            _regains++;
+        }
+        _holding = usb;
+        _asking  = false;
+    }
+
+    std::vector<GroundStation::Entry> _script;
+    size_t              _next       = 0;
+    std::string         _motorLine;
+    uint64_t            _repeatNs   = 50000000ULL;
+    uint64_t            _nextRepeat = 0;
+    uint64_t            _keepaliveNs = 0;
+    std::string         _line;
+    bool                _holding    = false;    // last handoff went to usb
+    bool                _asking     = false;    // sent while not holding
+    uint64_t            _askedNs    = 0;
+    uint64_t            _lastNs     = 0;        // last line sent
+    uint64_t            _sent       = 0;
+    uint64_t            _handoffs   = 0;
+    uint64_t            _takeovers  = 0;
+    uint64_t            _takeSumNs  = 0;
+    uint64_t            _takeMaxNs  = 0;
+    uint64_t            _regains    = 0;
+    uint64_t            _regainSumNs = 0;
+    uint64_t            _regainMaxNs = 0;
+    EchoLegs            _legs;
+    uint64_t            _echoDropped = 0;
+};
+
+// Resets the telemetry node's IMU hub once, like a brown-out on its rail.
+class ImuReset : public Model {
+public:
+    ImuReset(Node& node, uint64_t atNs) : _node(node), _atNs(atNs) {}
+    void step(uint64_t, uint64_t t1) override {
+        if (t1 < _atNs) return;
+        _node.board.imuResetPending = true;
+        _atNs = UINT64_MAX;
+    }
+
+private:
+    Node&    _node;
+    uint64_t _atNs;
+};
+
+#ifdef TRACE_MODE
+class FilePrint : public Print {
+public:
+    explicit FilePrint(FILE* fp) : _fp(fp) {}
+    size_t write(uint8_t b) override { return fputc(b, _fp) == EOF ? 0 : 1; }
+    size_t write(const uint8_t* buf, size_t n) override { return fwrite(buf, 1, n, _fp); }
+
+private:
+    FILE* _fp;
+};
+
+// Drains a node's trace ring into a host file before it can wrap. Runs
+// between quanta, while the firmware threads are parked.
+class TraceTap : public Model {
+public:
+    TraceTap(TraceRecorder& rec, const char* path) : _rec(rec), _fp(fopen(path, "w")), _out(_fp) {}
+    ~TraceTap() override { if (_fp) fclose(_fp); }
+    void step(uint64_t, uint64_t) override {
+        if (_rec.size() >= _rec.capacity() / 2) flush();
+    }
+    void flush() {
+        if (_fp) _events += _rec.drain(_out);
+    }
+    uint64_t events() const { return _events; }
+
+private:
+    TraceRecorder& _rec;
+    FILE*          _fp;
+    FilePrint      _out;
+    uint64_t       _events = 0;
+};
+#endif
+} // namespace
+
+int main(int argc, char** argv) {
+    double      durationS  = 25.0;
+    double      speed      = 0.0;
+    const char* script     = nullptr;
+    std::string out        = "sim_out";
+    unsigned    quantumUs  = 100;
+    bool        shared     = false;
+    unsigned    seed       = 1;
+    unsigned    tdmaMs     = 0;
+    unsigned    guardMs    = 12;
+    const char* download   = nullptr;
+    const char* usbPty     = nullptr;
+    const char* usbScript  = nullptr;
+    bool        echoTags   = false;
+    unsigned    keepaliveMs = 0;
+    bool        parked     = false;
+    double      imuResetS  = -1.0;
+    RadioParams radio;
+    GpsParams   gpsParams;
+    RoverParams roverParams;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { usage(); exit(2); }
+            return argv[++i];
+        };
+        if      (!strcmp(a, "--duration"))       durationS = atof(next());
+        else if (!strcmp(a, "--speed"))          speed = atof(next());
+        else if (!strcmp(a, "--realtime"))       speed = 1.0;
+        else if (!strcmp(a, "--script"))         script = next();
+        else if (!strcmp(a, "--out"))            out = next();
+        else if (!strcmp(a, "--quantum-us"))     quantumUs = (unsigned)atoi(next());
+        else if (!strcmp(a, "--shared-channel")) shared = true;
+        else if (!strcmp(a, "--loss"))           radio.byteLoss = atof(next());
+        else if (!strcmp(a, "--ber"))            radio.berGood = atof(next());
+        else if (!strcmp(a, "--burst"))        { radio.pGoodToBad = atof(next()); radio.berBad = 1e-2; }
+        else if (!strcmp(a, "--ubx"))            gpsParams.emitUbx = true;
+        else if (!strcmp(a, "--tdma"))         { tdmaMs = (unsigned)atoi(next()); shared = true; }
+        else if (!strcmp(a, "--guard-ms"))       guardMs = (unsigned)atoi(next());
+        else if (!strcmp(a, "--seed"))           seed = (unsigned)atoi(next());
+        else if (!strcmp(a, "--download"))       download = next();
+        else if (!strcmp(a, "--parked"))         parked = true;
+        else if (!strcmp(a, "--usb-pty"))        usbPty = next();
+        else if (!strcmp(a, "--imu-reset"))      imuResetS = atof(next());
+        else if (!strcmp(a, "--usb-script"))     usbScript = next();
+        else if (!strcmp(a, "--echo"))           echoTags = true;
+        else if (!strcmp(a, "--keepalive"))      keepaliveMs = (unsigned)atoi(next());
+        else if (!strcmp(a, "--battery-soc"))    roverParams.batterySoc = atof(next());
+        else if (!strcmp(a, "--battery-ah"))     roverParams.batteryAh = atof(next());
+        else { usage(); return 2; }
+    }
+    if (quantumUs == 0) quantumUs = 100;
+    mkdir(out.c_str(), 0755);
+
+    // --- Nodes ---
+    Simulator sim(quantumUs * 1000ULL);
+    Node& act = sim.addNode(actuatorProgram());
+    Node& tlm = sim.addNode(telemetryProgram());
+    act.board.sdRoot = out + "/actuator_sd";
+    tlm.board.sdRoot = out + "/telemetry_sd";
+
+    // --- World ---
+    roverParams.seed = seed;
+    RoverModel rover(act, tlm, roverParams);
+    rover.openTrace((out + "/pose.csv").c_str());
+
+    gpsParams.seed = seed + 1;
+    GpsModel gps(tlm, rover, gpsParams);
+
+    GroundStation ground;
+    if (script) {
+        if (!ground.loadScript(script)) { fprintf(stderr, "cannot read %s\n", script); return 1; }
+    } else {
+        ground.loadDefaultScript();
+    }
+    ground.openRxLog((out + "/ground_rx.csv").c_str());
+    if (tdmaMs) ground.enableTdma((uint16_t)tdmaMs, (uint16_t)guardMs, {1});
+#ifdef RADIO_FEC
+    ground.enableFec(true);
+#endif
+    ground.enableEcho(echoTags);
+    ground.setKeepalive(keepaliveMs);
+
+    PortStation       actPort(act, 1);
+    CommandProbe      actRadio(actPort, ground);
+    PortStation       tlmRadio(tlm, 1);
+    ListenOnlyStation groundListen(ground);
+    ListenOnlyStation tlmListen(tlmRadio);
+    radio.seed = seed + 2;
+    RadioChannel uplink(shared ? "shared" : "uplink", radio);
+    RadioChannel downlink("downlink", radio);
+    uplink.attach(&ground);
+    uplink.attach(&actRadio);
+    if (shared) {
+        uplink.attach(&tlmRadio);
+    } else {
+        downlink.attach(&tlmRadio);
+        downlink.attach(&groundListen);
+        uplink.attach(&tlmListen);      // event acks reach the telemetry node
+    }
+
+    UsbOperator actUsb(act, out);
+    if (usbScript && !actUsb.loadScript(usbScript)) { fprintf(stderr, "cannot read %s\n", usbScript); return 1; }
+    std::unique_ptr<PortTap> tlmUsb;
+    UsbDownload*             fetch = nullptr;
+    if (usbPty) {
+        UsbPty* pty = new UsbPty(tlm, out, usbPty);
+        tlmUsb.reset(pty);
+        if (!pty->ok()) { fprintf(stderr, "cannot open a pty\n"); return 1; }
+    } else {
+        fetch = new UsbDownload(tlm, out, download ? download : "", parked,
+                                download ? 5000000000ULL : UINT64_MAX);
+        tlmUsb.reset(fetch);
+    }
+
+    sim.addModel(&rover);
+    sim.addModel(&gps);
+    sim.addModel(&ground);
+    sim.addModel(&uplink);
+    if (!shared) sim.addModel(&downlink);
+    sim.addModel(&actUsb);
+    sim.addModel(tlmUsb.get());
+    ImuReset imuReset(tlm, imuResetS >= 0 ? (uint64_t)(imuResetS * 1e9) : UINT64_MAX);
+    sim.addModel(&imuReset);
+#ifdef TRACE_MODE
+    TraceTap actTrace(actuatorTrace(), (out + "/actuator_trace.csv").c_str());
+    TraceTap tlmTrace(telemetryTrace(), (out + "/telemetry_trace.csv").c_str());
+    sim.addModel(&actTrace);
+    sim.addModel(&tlmTrace);
+#endif
+
+    // --- Run ---
+    sim.run((uint64_t)(durationS * 1e9), speed);
+    sim.stop();
+    rover.closeTrace();
+    ground.closeRxLog();
+#ifdef TRACE_MODE
+    actTrace.flush();
+    tlmTrace.flush();
+#endif
+
+    const RoverState& s = rover.state();
+    printf("co-simulation: %.1f s virtual in %.2f s wall (%.1fx real time)\n",
+           sim.now() / 1e9, sim.wallSeconds(), sim.now() / 1e9 / sim.wallSeconds());
+    for (const auto& n : sim.nodes()) {
+        printf("  node %-9s loops %9llu  (%.0f Hz)%s%s\n", n->name.c_str(),
+               (unsigned long long)n->loops, n->loops / (sim.now() / 1e9),
+               n->halted() ? "  HALTED: " : "", n->halted() ? n->haltReason().c_str() : "");
+        for (const auto& p : n->board.ports) {
+            if (p.rxOverflows || p.rxFramingErrors)
+                printf("            %-8s rx overflow %llu B, framing errors %llu B\n", p.name.c_str(),
+                       (unsigned long long)p.rxOverflows, (unsigned long long)p.rxFramingErrors);
+        }
+    }
+    printf("  rover     pose (%.2f, %.2f, %.2f) m  yaw %.1f deg  odometer %.2f m\n",
+           s.x, s.y, s.z, s.yaw * 180 / M_PI, s.odometerM);
+    printf("  battery   charge %.0f%% -> %.1f%%, now %.2f V, min %.2f V, peak %.1f A\n",
+           roverParams.batterySoc * 100, s.batterySoc * 100, s.batteryV, s.batteryMinV, s.batteryPeakA);
+    for (const StopRecord& st : rover.stops()) {
+        printf("  stop      %6.2f s  %-5s from %.2f m/s: %.2f s, %.3f m, then %.3f m drift\n", st.tS, st.how,
+               st.fromMps, st.timeS, st.distanceM, st.driftM);
+    }
+    printf("  gps       %u baud, %u ms epochs, %llu sentences, %llu UBX-CFG frames (%llu bad checksum)\n",
+           gps.baud(), gps.rateMs(), (unsigned long long)gps.sentences(),
+           (unsigned long long)gps.configFrames(), (unsigned long long)gps.badFrames());
+    printf("  ground    sent %llu lines / %llu B, received %llu lines / %llu B\n",
+           (unsigned long long)ground.stats().linesSent, (unsigned long long)ground.stats().bytesSent,
+           (unsigned long long)ground.stats().linesReceived,
+           (unsigned long long)ground.stats().bytesReceived);
+    printRadio(uplink);
+    if (!shared) printRadio(downlink);
+    const double     seconds  = sim.now() / 1e9;
+    const GroundStats& g      = ground.stats();
+    actUsb.close();
+    tlmUsb->close();
+    const ExactLines x = exactDownlink(telemetryRecords(), out + "/telemetry_usb.log",
+                                       out + "/telemetry_sd/data.csv", out + "/ground_rx.csv");
+    printf("  goodput   downlink %.0f B/s exact (%.0f%% of %u B/s air), %llu records (%.2f/s), %llu lines corrupted\n",
+           x.bytes / seconds, 100.0 * x.bytes / seconds / (radio.airBaud / 10), radio.airBaud / 10,
+           (unsigned long long)x.records, x.records / seconds, (unsigned long long)x.wrong);
+    printf("            uplink %llu of %llu command lines intact at the actuator\n",
+           (unsigned long long)actRadio.commands(), (unsigned long long)g.linesSent);
+    if (g.keepalives) {
+        printf("            motor line held with %llu keepalives + %llu refreshes: %.0f B/s, vs %.0f B/s "
+               "re-sending it in full; %.0f B/s saved\n",
+               (unsigned long long)g.keepalives, (unsigned long long)(g.holdLines - g.keepalives),
+               g.holdBytes / seconds, g.repeatBytes / seconds, (g.repeatBytes - (double)g.holdBytes) / seconds);
+    }
+    const EventStats& ev = telemetryEvents();
+    printf("  events    %lu posted, %lu sent (%lu resends), %lu acked, %lu dropped; ground %lu unique, %lu dup, %lu bad, %llu acks (%.0f B/s)\n",
+           (unsigned long)ev.posted, (unsigned long)ev.sent, (unsigned long)ev.retransmits,
+           (unsigned long)ev.acked, (unsigned long)ev.dropped, (unsigned long)ground.events().unique(),
+           (unsigned long)ground.events().duplicates(), (unsigned long)ground.events().badCrc(),
+           (unsigned long long)g.acksSent, g.ackBytes / seconds);
+    printf("  rates    ");
+    const std::pair<const char*, const AdaptiveRate*> sinks[] = {
+        {"usb", &telemetryUsbRate()}, {"radio", &telemetryRadioRate()}, {"sd", &telemetrySdRate()}};
+    for (const auto& k : sinks) {
+        printf(" %s %.1f Hz (%lu sent, %lu skipped, %lu cuts)%s", k.first, k.second->rateHz(),
+               (unsigned long)k.second->stats().sent, (unsigned long)k.second->stats().skipped,
+               (unsigned long)k.second->stats().cuts, k.first[0] == 's' ? "\n" : ";");
+    }
+    printFused(out + "/telemetry_sd/fused.csv", telemetryFused());
+    rover.closeTrace();
+    printPose(out, telemetryPose(), gpsParams);
+    printFec("ground", ground.fecStats());
+    printFec("actuator", actuatorFec());
+    printFec("telemetry", telemetryFec());
+    if (fetch) fetch->report(tlm.loops / (sim.now() / 1e9));
+    actUsb.report();
+    if (tdmaMs)
+        printf("  tdma      %u ms superframe, %llu beacons (%.0f B/s), %llu slot reports\n", tdmaMs,
+               (unsigned long long)g.beaconsSent, g.beaconBytes / seconds, (unsigned long long)g.reports);
+#ifdef TRACE_MODE
+    printf("  trace     %llu actuator / %llu telemetry events\n",
+           (unsigned long long)actTrace.events(), (unsigned long long)tlmTrace.events());
+    printf("  outputs   %s/{pose.csv,ground_rx.csv,*_sd/,*_usb.log,*_trace.csv}\n", out.c_str());
+#else
+    printf("  outputs   %s/{pose.csv,ground_rx.csv,*_sd/,*_usb.log}\n", out.c_str());
+#endif
+    return 0;
+}
@@ -0,0 +1,409 @@
+/**
+ * AMBOT FLEET SIMULATION
+ * Runs N independent rovers, each a full co-simulation (actuator and
+ * telemetry firmware, rover model, GPS, its own uplink and downlink radio
+ * and ground station), to load the ground side at fleet scale and to
+ * measure what one simulated rover costs.
+ *
+ * Usage: fleet [options]
+ *   --rovers <n>         instances (default 4); rover k has node ID k
+ *   --jobs <n>           instances running at once (default: host cores)
+ *   --duration <s>       virtual seconds per rover (default 25)
+ *   --speed <x>          pace every rover at x times real time (default: as fast as possible)
+ *   --realtime           same as --speed 1
+ *   --script <file>      ground command script for every rover (see GroundStation.h)
+ *   --out <dir>          output directory (default fleet_out); rover k in <out>/rover<k>
+ *   --quantum-us <n>     lock-step quantum (default 100)
+ *   --seed <n>           base seed; rover k uses seed + 10 * k
+ *   --loss <p>           radio byte loss probability
+ *   --ber <p>            radio bit error rate
+ *   --burst <p>          probability per byte of entering a 1e-2 BER burst
+ *   --tdma <ms>          each ground runs a TDMA superframe with its rover's slot
+ *   --radio-pty <prefix> what each ground radio hears, on a pty at <prefix><k>
+ *                        (for the ground gateway; use with --realtime)
+ *   --scaling            run the fleet with 1, 2, 4 ... host-core jobs and print
+ *                        the speedup table
+ *
+ * The firmware keeps its state in globals, one copy per process, so the
+ * instances are worker processes rather than threads: up to --jobs of them
+ * run at once, each in lock-step with its own virtual clock. Each rover's
+ * cards get a rover.cfg ("node=<k>"), so both firmwares boot as node k and
+ * its ground addresses commands "<k>:<cmd>"; a rover that read the wrong ID
+ * does not move.
+ *
+ * Per rover the table gives the host CPU time (user + system, from the
+ * kernel) and the cores it needs to keep up with real time; the totals give
+ * how many rovers one core carries.
+ *
+ * Built with -DRADIO_FEC, telemetry and ground send FEC frames as in cosim.
+ */
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GpsModel.h"
+#include "GroundStation.h"
+#include "Nodes.h"
+#include "RadioLink.h"
+#include "RoverModel.h"
+#include "Simulator.h"
+
+using namespace sim;
+
+namespace {
+struct Options {
+    unsigned    rovers      = 4;
+    unsigned    jobs        = 0;
+    double      durationS   = 25.0;
+    double      speed       = 0.0;
+    const char* script      = nullptr;
+    std::string out         = "fleet_out";
+    unsigned    quantumUs   = 100;
+    unsigned    seed        = 1;
+    unsigned    tdmaMs      = 0;
+    const char* radioPty    = nullptr;
+    bool        scaling     = false;
+    RadioParams radio;
+};
+
+// What a worker sends back on its pipe when its rover is done.
+struct Result {
+    double   virtualS   = 0;
+    double   wallS      = 0;
+    double   odometerM  = 0;
+    uint64_t sent       = 0;        // ground command lines
+    uint64_t received   = 0;        // ground lines heard
+    uint64_t records    = 0;        // complete telemetry records heard
+    uint64_t events     = 0;        // unique status events
+    uint64_t reports    = 0;        // TDMA slot reports
+    uint64_t corrected  = 0;        // FEC frames repaired
+    uint64_t ptyDropped = 0;        // gateway did not keep up
+    bool     halted     = false;
+};
+
+struct Instance {
+    explicit Instance(unsigned rover) : id(rover) {}
+
+    unsigned id;
+    pid_t    pid    = -1;
+    int      fd     = -1;
+    double   cpuS   = 0;
+    bool     ok     = false;
+    Result   r;
+};
+
+void usage() {
+    fprintf(stderr, "usage: fleet [--rovers n] [--jobs n] [--duration s] [--speed x | --realtime]\n"
+                    "             [--script file] [--out dir] [--quantum-us n] [--seed n] [--loss p]\n"
+                    "             [--ber p] [--burst p] [--tdma ms] [--radio-pty prefix] [--scaling]\n");
+}
+
+unsigned hostCores() {
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+}
+
+bool writeConfig(const std::string& sdRoot, unsigned id) {
+    mkdir(sdRoot.c_str(), 0755);
+    FILE* fp = fopen((sdRoot + "/rover.cfg").c_str(), "w");
+    if (!fp) return false;
+    fprintf(fp, "node=%u\n", id);
+    return fclose(fp) == 0;
+}
+
+// The ground radio on a host pseudo-terminal: every byte the ground hears
+// also goes to <prefix><k>, for a gateway process to decode. Bytes the
+// gateway does not read in time are counted and dropped, never queued
+// without bound. What the gateway writes is ignored; the simulated ground
+// keeps the uplink.
+class GatewayPty : public RadioStation, public Model {
+public:
+    GatewayPty(RadioStation& inner, const std::string& link) : _inner(inner), _link(link) {
+        _master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (_master < 0 || grantpt(_master) || unlockpt(_master)) return;
+        fcntl(_master, F_SETFL, O_NONBLOCK);
+        termios tio;
+        if (tcgetattr(_master, &tio) == 0) {
+            cfmakeraw(&tio);                // FEC frames are binary
+            tcsetattr(_master, TCSANOW, &tio);
+        }
+        unlink(link.c_str());
+        if (symlink(ptsname(_master), link.c_str())) perror(link.c_str());
+    }
+    ~GatewayPty() override {
+        if (_master >= 0) ::close(_master);
+        unlink(_link.c_str());
+    }
+    bool ok() const { return _master >= 0; }
+
+    // RadioStation
+    const char* stationName() const override { return _inner.stationName(); }
+    void collectTx(uint64_t upTo, std::vector<SerialPort::TimedByte>& out) override {
+        _inner.collectTx(upTo, out);
+    }
+    void deliver(uint64_t t, uint8_t b) override {
+        _inner.deliver(t, b);
+        if (_pending.size() < MAX_PENDING) _pending.push_back((char)b);
+        else                               _dropped++;
+    }
+
+    // Model
+    void step(uint64_t, uint64_t) override {
+        char    buf[256];
+        ssize_t n;
+        while (_master >= 0 && ::read(_master, buf, sizeof(buf)) > 0) {}   // nothing goes up
+        while (_master >= 0 && !_pending.empty()) {
+            n = ::write(_master, _pending.data(), _pending.size());
+            if (n <= 0) break;
+            _pending.erase(0, (size_t)n);
+        }
+    }
+
+    uint64_t dropped() const { return _dropped; }
+
+private:
+    static constexpr size_t MAX_PENDING = 64 * 1024;
+
+    RadioStation&   _inner;
+    std::string     _link;
+    int             _master     = -1;
+    std::string     _pending;
+    uint64_t        _dropped    = 0;
+};
+
+// One rover and its ground, run to the end in this (worker) process.
+Result runRover(const Options& o, unsigned id) {
+    const std::string dir = o.out + "/rover" + std::to_string(id);
+    mkdir(dir.c_str(), 0755);
+    writeConfig(dir + "/actuator_sd", id);
+    writeConfig(dir + "/telemetry_sd", id);
+
+    Simulator sim(o.quantumUs * 1000ULL);
+    Node& act = sim.addNode(actuatorProgram());
+    Node& tlm = sim.addNode(telemetryProgram());
+    act.board.sdRoot = dir + "/actuator_sd";
+    tlm.board.sdRoot = dir + "/telemetry_sd";
+
+    const unsigned seed = o.seed + 10 * id;
+    RoverParams    roverParams;
+    roverParams.seed       = seed;
+    roverParams.headingDeg = 40.0 * (id - 1);   // fan out
+    RoverModel rover(act, tlm, roverParams);
+    rover.openTrace((dir + "/pose.csv").c_str());
+
+    GpsParams gpsParams;
+    gpsParams.seed = seed + 1;
+    GpsModel gps(tlm, rover, gpsParams);
+
+    GroundStation ground;
+    if (o.script) ground.loadScript(o.script);
+    else          ground.loadDefaultScript();
+    ground.openRxLog((dir + "/ground_rx.csv").c_str());
+    ground.setAddress((uint8_t)id);
+    if (o.tdmaMs) ground.enableTdma((uint16_t)o.tdmaMs, 12, {(uint8_t)id});
+#ifdef RADIO_FEC
+    ground.enableFec(true);
+#endif
+
+    RadioParams radio = o.radio;
+    radio.seed        = seed + 2;
+    PortStation       actRadio(act, 1);
+    PortStation       tlmRadio(tlm, 1);
+    ListenOnlyStation tlmListen(tlmRadio);
+    std::unique_ptr<GatewayPty> pty;
+    if (o.radioPty) pty.reset(new GatewayPty(ground, o.radioPty + std::to_string(id)));
+    if (pty && !pty->ok()) { fprintf(stderr, "rover %u: cannot open a pty\n", id); _exit(1); }
+    RadioStation&     groundRadio = pty ? (RadioStation&)*pty : (RadioStation&)ground;
+    ListenOnlyStation groundListen(groundRadio);
+
+    // With TDMA the rover shares one frequency with its ground, as in cosim
+    RadioChannel uplink(o.tdmaMs ? "shared" : "uplink", radio);
+    RadioChannel downlink("downlink", radio);
+    uplink.attach(&groundRadio);
+    uplink.attach(&actRadio);
+    if (o.tdmaMs) {
+        uplink.attach(&tlmRadio);
+    } else {
+        downlink.attach(&tlmRadio);
+        downlink.attach(&groundListen);
+        uplink.attach(&tlmListen);
+    }
+
+    PortTap actUsb(act, 0, (dir + "/actuator_usb.log").c_str());
+    PortTap tlmUsb(tlm, 0, (dir + "/telemetry_usb.log").c_str());
+
+    sim.addModel(&rover);
+    sim.addModel(&gps);
+    sim.addModel(&ground);
+    sim.addModel(&uplink);
+    if (!o.tdmaMs) sim.addModel(&downlink);
+    if (pty) sim.addModel(pty.get());
+    sim.addModel(&actUsb);
+    sim.addModel(&tlmUsb);
+
+    sim.run((uint64_t)(o.durationS * 1e9), o.speed);
+    sim.stop();
+    rover.closeTrace();
+    ground.closeRxLog();
+    actUsb.close();
+    tlmUsb.close();
+
+    Result r;
+    r.virtualS   = sim.now() / 1e9;
+    r.wallS      = sim.wallSeconds();
+    r.odometerM  = rover.state().odometerM;
+    r.sent       = ground.stats().linesSent;
+    r.received   = ground.stats().linesReceived;
+    r.records    = ground.stats().records;
+    r.events     = ground.events().unique();
+    r.reports    = ground.stats().reports;
+    r.corrected  = ground.fecStats().corrected;
+    r.ptyDropped = pty ? pty->dropped() : 0;
+    for (const auto& n : sim.nodes()) r.halted |= n->halted();
+    return r;
+}
+
+double cpuSeconds(const rusage& ru) {
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+/// Runs every rover, at most 'jobs' at a time. Returns the wall time.
+double runFleet(const Options& o, unsigned jobs, std::vector<Instance>& fleet) {
+    fleet.clear();
+    for (unsigned k = 1; k <= o.rovers; k++) fleet.emplace_back(k);
+    const auto t0      = std::chrono::steady_clock::now();
+    size_t     next    = 0;
+    unsigned   running = 0;
+    fflush(stdout);
+
+    while (next < fleet.size() || running > 0) {
+        while (next < fleet.size() && running < jobs) {
+            Instance& in = fleet[next++];
+            int p[2];
+            if (pipe(p)) { perror("pipe"); continue; }
+            in.pid = fork();
+            if (in.pid == 0) {
+                ::close(p[0]);
+                const Result r = runRover(o, in.id);
+                const bool   ok = ::write(p[1], &r, sizeof(r)) == (ssize_t)sizeof(r);
+                _exit(ok ? 0 : 1);
+            }
+            ::close(p[1]);
+            if (in.pid < 0) { perror("fork"); ::close(p[0]); continue; }
+            in.fd = p[0];
+            running++;
+        }
+        int    status;
+        rusage ru;
+        const pid_t pid = wait4(-1, &status, 0, &ru);
+        if (pid < 0) break;
+        for (Instance& in : fleet) {
+            if (in.pid != pid) continue;
+            in.cpuS = cpuSeconds(ru);
+            in.ok   = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                      ::read(in.fd, &in.r, sizeof(in.r)) == (ssize_t)sizeof(in.r);
+            ::close(in.fd);
+            running--;
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void printFleet(const Options& o, unsigned jobs, double wallS, const std::vector<Instance>& fleet) {
+    printf("fleet: %u rovers x %.1f s virtual, %u at a time, %.2f s wall\n", o.rovers, o.durationS, jobs, wallS);
+    printf("  rover   cpu s  cores@1x  wall s  odometer  sent  heard  records  events  reports  fec  %s\n",
+           o.radioPty ? "pty drop" : "");
+    double   cpu = 0, virt = 0;
+    unsigned failed = 0;
+    for (const Instance& in : fleet) {
+        if (!in.ok) {
+            printf("  %5u  worker failed\n", in.id);
+            failed++;
+            continue;
+        }
+        const Result& r = in.r;
+        printf("  %5u  %6.2f  %8.3f  %6.2f  %6.2f m  %4llu  %5llu  %7llu  %6llu  %7llu  %3llu", in.id, in.cpuS,
+               in.cpuS / r.virtualS, r.wallS, r.odometerM, (unsigned long long)r.sent,
+               (unsigned long long)r.received, (unsigned long long)r.records, (unsigned long long)r.events,
+               (unsigned long long)r.reports, (unsigned long long)r.corrected);
+        if (o.radioPty) printf("  %8llu", (unsigned long long)r.ptyDropped);
+        printf("%s\n", r.halted ? "  HALTED" : "");
+        cpu  += in.cpuS;
+        virt += r.virtualS;
+    }
+    if (virt <= 0) return;
+    printf("  total   %.2f s cpu for %.1f rover-s: %.3f cores per rover in real time, "
+           "%.1f rovers per core, ~%.0f on this host (%u cores)%s\n",
+           cpu, virt, cpu / virt, virt / cpu, virt / cpu * hostCores(), hostCores(),
+           failed ? "; some workers failed" : "");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { usage(); exit(2); }
+            return argv[++i];
+        };
+        if      (!strcmp(a, "--rovers"))     o.rovers = (unsigned)atoi(next());
+        else if (!strcmp(a, "--jobs"))       o.jobs = (unsigned)atoi(next());
+        else if (!strcmp(a, "--duration"))   o.durationS = atof(next());
+        else if (!strcmp(a, "--speed"))      o.speed = atof(next());
+        else if (!strcmp(a, "--realtime"))   o.speed = 1.0;
+        else if (!strcmp(a, "--script"))     o.script = next();
+        else if (!strcmp(a, "--out"))        o.out = next();
+        else if (!strcmp(a, "--quantum-us")) o.quantumUs = (unsigned)atoi(next());
+        else if (!strcmp(a, "--seed"))       o.seed = (unsigned)atoi(next());
+        else if (!strcmp(a, "--loss"))       o.radio.byteLoss = atof(next());
+        else if (!strcmp(a, "--ber"))        o.radio.berGood = atof(next());
+        else if (!strcmp(a, "--burst"))    { o.radio.pGoodToBad = atof(next()); o.radio.berBad = 1e-2; }
+        else if (!strcmp(a, "--tdma"))       o.tdmaMs = (unsigned)atoi(next());
+        else if (!strcmp(a, "--radio-pty"))  o.radioPty = next();
+        else if (!strcmp(a, "--scaling"))    o.scaling = true;
+        else { usage(); return 2; }
+    }
+    if (o.rovers == 0 || o.rovers > 254) { usage(); return 2; }
+    if (o.quantumUs == 0) o.quantumUs = 100;
+    if (o.jobs == 0) o.jobs = hostCores();
+    if (o.script && access(o.script, R_OK)) { fprintf(stderr, "cannot read %s\n", o.script); return 1; }
+    mkdir(o.out.c_str(), 0755);
+
+    std::vector<Instance> fleet;
+    if (!o.scaling) {
+        const double wallS = runFleet(o, o.jobs, fleet);
+        printFleet(o, o.jobs, wallS, fleet);
+        return std::all_of(fleet.begin(), fleet.end(), [](const Instance& in) { return in.ok; }) ? 0 : 1;
+    }
+
+    // Same fleet at 1, 2, 4 ... jobs up to the host's cores
+    std::vector<unsigned> steps;
+    for (unsigned j = 1; j < hostCores(); j *= 2) steps.push_back(j);
+    steps.push_back(hostCores());
+    printf("scaling: %u rovers x %.1f s virtual\n", o.rovers, o.durationS);
+    printf("  jobs  wall s  rover-s/s  speedup  efficiency  cpu s\n");
+    double base = 0;
+    for (unsigned j : steps) {
+        const double wallS = runFleet(o, j, fleet);
+        double       cpu   = 0;
+        for (const Instance& in : fleet) cpu += in.cpuS;
+        if (base == 0) base = wallS;
+        printf("  %4u  %6.2f  %9.1f  %6.2fx  %9.0f%%  %6.2f\n", j, wallS, o.rovers * o.durationS / wallS,
+               base / wallS, 100.0 * base / wallS / std::min(j, o.rovers), cpu);
+        fflush(stdout);
+    }
+    return 0;
+}
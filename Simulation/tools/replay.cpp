@@ -0,0 +1,330 @@
+/**
+ * AMBOT TELEMETRY REPLAY SERVER
+ * Streams a recorded log into pseudo-terminals so the ground software can
+ * be load-tested without a rover: point the GUI at the pty as if it were
+ * the APC220 COM port.
+ *
+ * Usage: replay <file> [options]
+ *   --link <path>        pty symlink (default /tmp/ambot_radio); with
+ *                        --consumers n, <path>0 .. <path>n-1
+ *   --consumers <n>      independent consumers, each with its own pty
+ *   --speed <x>          x times the recorded pace (default 1)
+ *   --fast               as fast as each consumer reads
+ *   --raw                binary log (auto-detected): paced by --baud
+ *   --baud <n>           byte pace of a binary log (default 9600, 8N1)
+ *   --loss <p>           byte loss probability       } the co-sim's radio
+ *   --ber <p>            bit error rate              } model (RadioLink.h),
+ *   --burst <p>          probability per byte of a   } drawn per consumer
+ *                        1e-2 BER burst
+ *   --seed <n>           seed of the impairments
+ *
+ * Text logs are replayed line by line at their own timestamps: data.csv
+ * from the telemetry SD (records start with millis; code and health lines
+ * go with the record before them), a *_usb.log, or the co-sim's
+ * ground_rx.csv ("t_ms,line"). A binary log (a raw capture of the radio,
+ * e.g. FEC frames) is cut into bytes at the --baud pace.
+ *
+ * Each consumer's clock starts when it opens its pty, and it is fed no
+ * further ahead than a small backlog. So a slow consumer falls behind
+ * ("lag") instead of being flooded. On exit (end of file for everyone,
+ * or Ctrl-C) the tool prints what each consumer sustained.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -ISimulation/shim -ISimulation -Ilibraries/AmbotCommon/src \
+ *       Simulation/tools/replay.cpp -o replay
+ */
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RadioLink.h"
+
+using namespace sim;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t    MAX_BACKLOG     = 4096;     // bytes queued per consumer beyond what the pty took
+constexpr size_t    RAW_CHUNK       = 16;       // bytes per step of a binary log
+constexpr uint64_t  SESSION_GAP_US  = 100000;   // between sessions whose clocks restarted
+constexpr uint64_t  DRAIN_US        = 5000000;  // wait for a consumer to read the pty's last bytes
+
+volatile sig_atomic_t stopRequested = 0;
+
+uint64_t nowUs() {
+    static const Clock::time_point t0 = Clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count();
+}
+
+struct Chunk {
+    uint64_t    tUs;        // from the start of the recording
+    std::string bytes;
+};
+
+bool looksBinary(const std::string& data) {
+    for (unsigned char c : data) {
+        if (c == 0 || c >= 0x80 || (c < 0x20 && c != '\n' && c != '\r' && c != '\t')) return true;
+    }
+    return false;
+}
+
+std::vector<Chunk> loadRaw(const std::string& data, unsigned baud) {
+    std::vector<Chunk> out;
+    const double usPerByte = 10e6 / baud;
+    for (size_t i = 0; i < data.size(); i += RAW_CHUNK)
+        out.push_back({(uint64_t)(i * usPerByte), data.substr(i, RAW_CHUNK)});
+    return out;
+}
+
+/// One line per chunk. "t_ms,line" files carry the time in front; anything
+/// else takes it from a leading "<ms>," record field.
+std::vector<Chunk> loadText(const std::string& data) {
+    std::vector<Chunk> out;
+    const bool groundLog = data.compare(0, 10, "t_ms,line\n") == 0;
+    uint64_t   t = 0, base = 0, first = UINT64_MAX;
+    size_t     pos = groundLog ? 10 : 0;
+    while (pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        if (end == std::string::npos) end = data.size();
+        std::string line = data.substr(pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+
+        char*        rest;
+        const double ms = strtod(line.c_str(), &rest);
+        if (rest != line.c_str() && *rest == ',') {
+            uint64_t stamp = (uint64_t)(ms * 1000.0);
+            if (groundLog) {
+                // Quoted CSV field, "" for a quote
+                std::string text(rest + 1);
+                if (text.size() >= 2 && text.front() == '"' && text.back() == '"') text = text.substr(1, text.size() - 2);
+                for (size_t q = 0; (q = text.find("\"\"", q)) != std::string::npos; q++) text.erase(q, 1);
+                line = text;
+            }
+            if (first == UINT64_MAX) first = stamp;
+            if (stamp + base < t) base = t + SESSION_GAP_US - stamp;    // a new session restarted millis
+            t = stamp + base;
+        }
+        out.push_back({t, line + "\n"});
+    }
+    for (auto& c : out) c.tUs = (first != UINT64_MAX && c.tUs >= first) ? c.tUs - first : 0;
+    return out;
+}
+
+struct Consumer {
+    std::string                 link;
+    int                         master      = -1;
+    int                         probe       = -1;   // our own slave fd while draining
+    std::unique_ptr<RadioNoise> noise;
+    bool                        connected   = false;
+    bool                        done        = false;
+    uint64_t                    startUs     = 0;
+    uint64_t                    endUs       = 0;
+    size_t                      next        = 0;    // next chunk
+    std::string                 pending;
+    uint64_t                    bytes       = 0;    // taken by the consumer
+    uint64_t                    lines       = 0;
+    uint64_t                    lost        = 0;
+    uint64_t                    corrupted   = 0;
+    uint64_t                    maxLagUs    = 0;
+};
+
+/// A pty whose slave end is raw and closed: POLLHUP until someone opens it.
+bool openPty(Consumer& c) {
+    c.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (c.master < 0 || grantpt(c.master) || unlockpt(c.master)) return false;
+    fcntl(c.master, F_SETFL, O_NONBLOCK);
+    const int slave = ::open(ptsname(c.master), O_RDWR | O_NOCTTY);
+    if (slave < 0) return false;
+    termios tio;
+    if (tcgetattr(slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+    ::close(slave);
+    unlink(c.link.c_str());
+    if (symlink(ptsname(c.master), c.link.c_str())) {
+        perror(c.link.c_str());
+        return false;
+    }
+    return true;
+}
+
+/// Queue every chunk that is due (all of them with 'fast') while the
+/// backlog has room, through the consumer's own radio impairments.
+void feed(Consumer& c, const std::vector<Chunk>& chunks, uint64_t now, double speed, bool fast) {
+    const uint64_t elapsed = now - c.startUs;
+    while (c.next < chunks.size() && c.pending.size() < MAX_BACKLOG) {
+        const Chunk&   k   = chunks[c.next];
+        const uint64_t due = (uint64_t)(k.tUs / speed);
+        if (!fast && due > elapsed) break;
+        if (!fast && elapsed - due > c.maxLagUs) c.maxLagUs = elapsed - due;
+        for (char ch : k.bytes) {
+            if (c.noise) {
+                if (c.noise->lose()) { c.lost++; continue; }
+                const uint8_t b = c.noise->corrupt((uint8_t)ch);
+                if (b != (uint8_t)ch) c.corrupted++;
+                ch = (char)b;
+            }
+            c.pending.push_back(ch);
+        }
+        c.next++;
+    }
+}
+
+void report(const std::vector<Consumer>& consumers, const char* file, const std::vector<Chunk>& chunks) {
+    uint64_t total = 0;
+    for (const auto& k : chunks) total += k.bytes.size();
+    printf("replay %s: %zu chunks, %llu B over %.1f s recorded\n", file, chunks.size(),
+           (unsigned long long)total, chunks.empty() ? 0.0 : chunks.back().tUs / 1e6);
+    for (const auto& c : consumers) {
+        if (!c.connected) {
+            printf("  %-20s never opened\n", c.link.c_str());
+            continue;
+        }
+        const double s = ((c.endUs ? c.endUs : nowUs()) - c.startUs) / 1e6;
+        printf("  %-20s %7.1f s %10llu B %9.0f B/s %7.0f lines/s  %5.1f%% of the log%s  max lag %.0f ms",
+               c.link.c_str(), s, (unsigned long long)c.bytes, s > 0 ? c.bytes / s : 0.0,
+               s > 0 ? c.lines / s : 0.0, chunks.empty() ? 0.0 : 100.0 * c.next / chunks.size(),
+               c.next < chunks.size() ? " (left early)" : "", c.maxLagUs / 1e3);
+        if (c.noise)
+            printf("  lost %llu B, corrupted %llu B", (unsigned long long)c.lost,
+                   (unsigned long long)c.corrupted);
+        printf("\n");
+    }
+}
+
+void usage() {
+    fprintf(stderr, "usage: replay <file> [--link path] [--consumers n] [--speed x | --fast]\n"
+                    "              [--raw] [--baud n] [--loss p] [--ber p] [--burst p] [--seed n]\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') { usage(); return 2; }
+    const char* file      = argv[1];
+    std::string link      = "/tmp/ambot_radio";
+    unsigned    consumers = 1;
+    double      speed     = 1.0;
+    bool        fast      = false;
+    bool        raw       = false;
+    unsigned    baud      = 9600;
+    bool        impair    = false;
+    RadioParams radio;
+
+    for (int i = 2; i < argc; i++) {
+        const char* a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { usage(); exit(2); }
+            return argv[++i];
+        };
+        if      (!strcmp(a, "--link"))       link = next();
+        else if (!strcmp(a, "--consumers"))  consumers = (unsigned)atoi(next());
+        else if (!strcmp(a, "--speed"))      speed = atof(next());
+        else if (!strcmp(a, "--fast"))       fast = true;
+        else if (!strcmp(a, "--raw"))        raw = true;
+        else if (!strcmp(a, "--baud"))       baud = (unsigned)atoi(next());
+        else if (!strcmp(a, "--loss"))     { radio.byteLoss = atof(next()); impair = true; }
+        else if (!strcmp(a, "--ber"))      { radio.berGood = atof(next()); impair = true; }
+        else if (!strcmp(a, "--burst"))    { radio.pGoodToBad = atof(next()); radio.berBad = 1e-2; impair = true; }
+        else if (!strcmp(a, "--seed"))       radio.seed = (unsigned)atoi(next());
+        else { usage(); return 2; }
+    }
+    if (consumers == 0) consumers = 1;
+    if (speed <= 0.0) speed = 1.0;
+    if (baud == 0) baud = 9600;
+
+    FILE* fp = fopen(file, "rb");
+    if (!fp) { perror(file); return 1; }
+    std::string data;
+    char        buf[65536];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), fp)) > 0;) data.append(buf, n);
+    fclose(fp);
+    const std::vector<Chunk> chunks = (raw || looksBinary(data)) ? loadRaw(data, baud) : loadText(data);
+
+    std::vector<Consumer> cs(consumers);
+    for (unsigned i = 0; i < consumers; i++) {
+        Consumer& c = cs[i];
+        c.link = consumers == 1 ? link : link + std::to_string(i);
+        if (impair) {
+            RadioParams p = radio;
+            p.seed += i;
+            c.noise.reset(new RadioNoise(p));
+        }
+        if (!openPty(c)) { fprintf(stderr, "cannot open a pty for %s\n", c.link.c_str()); return 1; }
+        printf("%s ready\n", c.link.c_str());
+    }
+    fflush(stdout);
+    signal(SIGINT, [](int) { stopRequested = 1; });
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<pollfd> fds(consumers);
+    while (!stopRequested) {
+        bool active = false;
+        for (unsigned i = 0; i < consumers; i++) {
+            fds[i] = {cs[i].master, (short)(cs[i].pending.empty() ? 0 : POLLOUT), 0};
+            active |= !cs[i].done;
+        }
+        if (!active) break;
+        poll(fds.data(), fds.size(), 1);
+
+        const uint64_t now = nowUs();
+        for (unsigned i = 0; i < consumers; i++) {
+            Consumer& c = cs[i];
+            if (c.done) continue;
+            const bool hangup = fds[i].revents & POLLHUP;
+            if (!c.connected) {
+                if (hangup) continue;
+                c.connected = true;
+                c.startUs   = now;
+            } else if (hangup) {
+                c.done  = true;             // consumer went away
+                c.endUs = now;
+                continue;
+            }
+            feed(c, chunks, now, speed, fast);
+            if (!c.pending.empty()) {
+                const ssize_t n = ::write(c.master, c.pending.data(), c.pending.size());
+                if (n > 0) {
+                    for (ssize_t k = 0; k < n; k++) c.lines += c.pending[k] == '\n';
+                    c.bytes += (uint64_t)n;
+                    c.pending.erase(0, (size_t)n);
+                }
+            }
+            if (c.next >= chunks.size() && c.pending.empty()) {
+                // Done once the consumer has read what the pty still holds
+                if (c.probe < 0) {
+                    c.probe = ::open(ptsname(c.master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+                    c.endUs = now;
+                }
+                int queued = 0;
+                if (c.probe < 0 || ioctl(c.probe, FIONREAD, &queued) != 0 || queued == 0 ||
+                    now - c.endUs > DRAIN_US) {
+                    c.done  = true;
+                    c.endUs = now;
+                    c.bytes -= (uint64_t)queued;
+                }
+            }
+        }
+    }
+
+    report(cs, file, chunks);
+    for (auto& c : cs) {
+        if (c.probe >= 0) ::close(c.probe);
+        if (c.master >= 0) ::close(c.master);
+        unlink(c.link.c_str());
+    }
+    return 0;
+}
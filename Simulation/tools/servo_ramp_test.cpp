@@ -0,0 +1,113 @@
+/**
+ * SERVO RAMP TEST
+ * Drives the actuator's ServoController through one jog script at a
+ * 10, 20 and 40 ms tick period and at a randomly jittered one, and checks
+ * that every run puts the joints where the 10 ms run does. Each run also
+ * ticks on every checkpoint, so the script's commands change at the same
+ * instants in all of them and only the spacing of the other ticks differs.
+ *
+ * Usage: servo_ramp_test [seed]      (exits 1 if any run is off)
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../../CmdCtrl_Main/ServoController.h"
+
+namespace {
+const int NUM_JOINTS = ServoController::numServos;
+
+// Jog script: per joint 'L', 'R' or '.', from 'ms' until the next step.
+// Steps land on checkpoints, so every run sees them at the same time.
+struct Step {
+    uint32_t    ms;
+    const char* jog;
+};
+const Step SCRIPT[] = {
+    {0,    "RL...."},   // joint 1 runs into the 0 deg stop
+    {800,  "RLR..."},
+    {1600, "..R.LR"},   // joint 0 decelerates while the others ramp
+    {2000, "L..R.."},   // joint 0 turns round mid-ramp, off the 180 deg stop
+    {3200, "......"},
+    {4000, "RRRRRR"},   // joints 2 and 5 run into the 180 deg stop
+    {5200, "......"},
+};
+const uint32_t END_MS        = 6000;
+const uint32_t CHECKPOINT_MS = 200;
+const float    TOLERANCE_DEG = 0.01f;
+
+// Jittered ticks stay inside ServoController::maxStepS, which clamps
+// longer gaps on purpose
+const uint32_t JITTER_MIN_US = 2000;
+const uint32_t JITTER_MAX_US = 45000;
+
+void jogAt(uint32_t ms, char jog[]) {
+    const char* cmds = SCRIPT[0].jog;
+    for (const Step& s : SCRIPT)
+        if (s.ms <= ms) cmds = s.jog;
+    for (int j = 0; j < NUM_JOINTS; j++) jog[j] = cmds[j] == '.' ? 0 : cmds[j];
+}
+
+/// Angles at every checkpoint. 'periodUs' 0 jitters the tick period.
+std::vector<float> run(uint32_t periodUs, std::mt19937& rng) {
+    std::uniform_int_distribution<uint32_t> jitter(JITTER_MIN_US, JITTER_MAX_US);
+    ServoController servos;
+    std::vector<float> path;
+    char jog[NUM_JOINTS];
+
+    uint32_t us = 0;
+    for (;;) {
+        jogAt(us / 1000, jog);
+        servos.update(jog, us);
+        if (us % (CHECKPOINT_MS * 1000) == 0)
+            path.insert(path.end(), servos.angles, servos.angles + NUM_JOINTS);
+        if (us >= END_MS * 1000) break;
+
+        const uint32_t next       = us + (periodUs ? periodUs : jitter(rng));
+        const uint32_t checkpoint = (us / (CHECKPOINT_MS * 1000) + 1) * CHECKPOINT_MS * 1000;
+        us = next < checkpoint ? next : checkpoint;
+    }
+    return path;
+}
+
+int failures = 0;
+
+void compare(const std::vector<float>& ref, const std::vector<float>& path, const char* what) {
+    float worst = ref.size() == path.size() ? 0 : INFINITY;
+    for (size_t k = 0; k < ref.size() && k < path.size(); k++)
+        worst = fmaxf(worst, fabsf(path[k] - ref[k]));
+    const bool ok = worst <= TOLERANCE_DEG;
+    printf("%s  %-22s max error %.5f deg\n", ok ? "PASS" : "FAIL", what, worst);
+    if (!ok) failures++;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::mt19937 rng(argc > 1 ? strtoul(argv[1], nullptr, 0) : 1);
+
+    const std::vector<float> ref = run(10000, rng);
+    compare(ref, run(20000, rng), "20 ms tick");
+    compare(ref, run(40000, rng), "40 ms tick");
+    for (int k = 0; k < 5; k++) compare(ref, run(0, rng), "jittered 2-45 ms tick");
+
+    // The script must actually have moved every joint, and into both stops
+    float lo = 180, hi = 0;
+    bool  moved = true;
+    for (int j = 0; j < NUM_JOINTS; j++) {
+        bool jointMoved = false;
+        for (size_t k = j; k < ref.size(); k += NUM_JOINTS) {
+            lo = fminf(lo, ref[k]);
+            hi = fmaxf(hi, ref[k]);
+            jointMoved |= ref[k] != 90;
+        }
+        moved &= jointMoved;
+    }
+    const bool stops = lo == 0 && hi == 180;
+    printf("%s  script moves every joint and hits both stops\n", moved && stops ? "PASS" : "FAIL");
+    if (!moved || !stops) failures++;
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
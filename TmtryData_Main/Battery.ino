@@ -0,0 +1,57 @@
+/**
+ * BATTERY (BatteryMonitor.h)
+ * The pack sense lines the actuator reads, on this node's spare ADC pins.
+ * Here the level only sets the pace: at LOW_CHARGE every telemetry sink
+ * keeps half its ceiling and the core clock drops to BATTERY_LOW_CPU_HZ,
+ * at CRITICAL a quarter. TRACE_MODE builds keep F_CPU: a trace dump
+ * converts every cycle stamp with the one clock_hz in its header.
+ * At SHUTDOWN, SYS_SHUTDOWN goes in the log and every file on the card is
+ * synced and closed before the regulators drop out; USB and the radio
+ * carry on while there is power.
+ */
+static constexpr uint8_t  BATTERY_VOLT_PIN    = A14;
+static constexpr uint8_t  BATTERY_AMP_PIN     = A15;
+static constexpr uint32_t BATTERY_PERIOD_MS   = 20;
+static constexpr uint32_t BATTERY_LOW_CPU_HZ  = 150000000;    // from 600 MHz; the loop needs a fraction of it
+
+static uint32_t batteryLastMs = 0;
+
+FASTRUN void batteryCore() {
+  if (present - batteryLastMs < BATTERY_PERIOD_MS) return;
+  batteryLastMs = present;
+  if (battery.update(analogRead(BATTERY_VOLT_PIN), analogRead(BATTERY_AMP_PIN), present)) batteryLevelChanged();
+}
+
+FLASHMEM void batteryLevelChanged() {
+  const BatteryMonitor::Level level = battery.level();
+  const float                 scale = PowerGovernor::rateScale(level);
+  usbRate.setCeiling(usbRate.maxHz() * scale);
+  radioRate.setCeiling(radioRate.maxHz() * scale);
+  sdRate.setCeiling(sdRate.maxHz() * scale);
+#ifndef TRACE_MODE
+  set_arm_clock(level == BatteryMonitor::NORMAL ? F_CPU : BATTERY_LOW_CPU_HZ);
+#endif
+
+  reportBattery();
+  if (level == BatteryMonitor::LOW_CHARGE) transmitCode(WARN_BATTERY_LOW);      // "004016"
+  if (level == BatteryMonitor::CRITICAL)   transmitCode(WARN_BATTERY_CRITICAL); // "004017"
+  if (level == BatteryMonitor::SHUTDOWN) {
+    transmitCode(SYS_SHUTDOWN);   // "001004", before the log closes
+    fusedEnd();
+    poseEnd();
+#ifdef FILTER_LOG
+    filterLogEnd();
+#endif
+    logger.end();
+  }
+}
+
+// "B,n=TLM,..." to Serial/Radio and SD (also once per health window)
+FLASHMEM void reportBattery() {
+  char line[64];
+  int  len = battery.format(line, sizeof(line), "TLM");
+  if (len > 0 && len < (int)sizeof(line)) {
+    print_data(line);
+    logger.logValue(line);
+  }
+}
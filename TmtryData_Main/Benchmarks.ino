@@ -0,0 +1,141 @@
+/**
+ * HOT-KERNEL BENCHMARKS
+ * Enabled by BENCHMARK_MODE (top of TmtryData_Main.ino). The sketch then
+ * times each kernel at boot, prints CSV on USB Serial (see AmbotBench.h)
+ * and idles instead of starting the telemetry loop. SD records go to
+ * bench.csv, never to the flight log.
+ *
+ * The same suite runs on the host: see Simulation/README.md.
+ */
+#ifdef BENCHMARK_MODE
+#include <AmbotBench.h>
+#include <Fec.h>
+#include <SimpleKalmanFilter.h>   // the altitude filter before Filters.h, for comparison
+
+// Defined in IMU_BNO08X.ino, which the builder concatenates after this tab
+void quaternionToEuler(float qr, float qi, float qj, float qk, euler_t* ypr, bool degrees);
+
+// One 10 Hz epoch from the NEO-M10 (RMC + GGA)
+static const char BENCH_NMEA_EPOCH[] PROGMEM =
+    "$GNRMC,120000.00,A,1439.22200,N,12104.12200,E,0.350,87.50,181026,,,A*49\r\n"
+    "$GNGGA,120000.00,1439.22200,N,12104.12200,E,1,12,0.8,61.3,M,0.0,M,,*74\r\n";
+
+FLASHMEM void runBenchmarks(Print& out) {
+    static const char SUITE[]   = "telemetry";
+    volatile float    qIn[4]    = { 0.9238795f, 0.0f, 0.0f, 0.3826834f };
+    volatile int      rawIn     = 2048;
+    char              record[256];
+
+    bench::header(out);
+
+    bench::run(out, SUITE, "quaternion_to_euler", 100000, [&] {
+        euler_t e;
+        quaternionToEuler(qIn[0], qIn[1], qIn[2], qIn[3], &e, true);
+        bench::keep(e);
+    });
+
+    bench::run(out, SUITE, "thermistor_convert", 100000, [&] {
+        float c = thermistorCelsius(rawIn);
+        bench::keep(c);
+    });
+
+    bench::run(out, SUITE, "telemetry_format", 10000, [&] {
+        int len = formatTelemetry(record, sizeof(record));
+        bench::keep(len);
+    });
+
+    // Radio FEC on one record: encode, then decode clean and after the
+    // longest burst the interleaver spreads within reach (PARITY/2 per block)
+    static uint8_t frame[fec::MAX_FRAME];
+    static uint8_t hit[fec::MAX_FRAME];
+    const size_t   recordLen = (size_t)formatTelemetry(record, sizeof(record));
+    size_t         frameLen  = 0;
+    bench::run(out, SUITE, "fec_encode_record", 10000, [&] {
+        frameLen = fec::encode((const uint8_t*)record, recordLen, 0, frame, sizeof(frame));
+        bench::keep(frameLen);
+    });
+
+    FecDecoder decoder;
+    bench::run(out, SUITE, "fec_decode_clean", 10000, [&] {
+        for (size_t i = 0; i < frameLen; i++) decoder.feed(frame[i]);
+        bench::keep(decoder);
+    });
+
+    memcpy(hit, frame, frameLen);
+    const size_t   burst     = (fec::PARITY / 2) * ((recordLen + fec::BLOCK_DATA - 1) / fec::BLOCK_DATA);
+    for (size_t i = 0; i < burst; i++) hit[fec::frameSize(0) + i] ^= 0x5A;
+    bench::run(out, SUITE, "fec_decode_burst", 10000, [&] {
+        for (size_t i = 0; i < frameLen; i++) decoder.feed(hit[i]);
+        bench::keep(decoder);
+    });
+    if (decoder.stats().uncorrectable) out.println(F("# fec_decode_burst: frame not recovered"));
+
+    // Filters: the code they replaced, then float and Q16 versions (one sample per op)
+    static float filterIn[64];
+    for (int i = 0; i < 64; i++) filterIn[i] = 10.0f + 3.0f * sinf(i * 0.7f) + ((i * 37) % 11) * 0.1f;
+    uint32_t n = 0;
+    auto     next = [&] { return filterIn[n++ & 63]; };
+
+    float emaOld = 0.0f;
+    bench::run(out, SUITE, "ema_inline", 100000, [&] {
+        emaOld = (ACCEL_X_ALPHA * next()) + ((1.0f - ACCEL_X_ALPHA) * emaOld);
+        bench::keep(emaOld);
+    });
+    filt::Ema<float> emaF(ACCEL_X_ALPHA);
+    bench::run(out, SUITE, "ema_float", 100000, [&] { bench::keep(emaF.update(next())); });
+    filt::Ema<filt::Q16> emaQ(ACCEL_X_ALPHA);
+    bench::run(out, SUITE, "ema_q16", 100000, [&] { bench::keep(emaQ.update(filt::Q16(next()))); });
+
+    constexpr filt::BiquadCoeffs LP    = filt::lowPass(5.0f, 100.0f);
+    constexpr filt::BiquadCoeffs NOTCH = filt::notch(25.0f, 100.0f);
+    filt::Biquad<float> lpF(LP);
+    bench::run(out, SUITE, "biquad_lowpass_float", 100000, [&] { bench::keep(lpF.update(next())); });
+    filt::Biquad<filt::Q16> lpQ(LP);
+    bench::run(out, SUITE, "biquad_lowpass_q16", 100000, [&] { bench::keep(lpQ.update(filt::Q16(next()))); });
+    filt::Biquad<float> notchF(NOTCH);
+    bench::run(out, SUITE, "biquad_notch_float", 100000, [&] { bench::keep(notchF.update(next())); });
+
+    filt::MovingMedian<int, THERM_MEDIAN_READS> median;
+    bench::run(out, SUITE, "median5_int", 100000, [&] { bench::keep(median.update((int)(next() * 100.0f))); });
+
+    SimpleKalmanFilter kfOld(ALTITUDE_KF_MEASURE, ALTITUDE_KF_ESTIMATE, ALTITUDE_KF_PROCESS);
+    bench::run(out, SUITE, "kalman_simple", 100000, [&] { bench::keep(kfOld.updateEstimate(next())); });
+    filt::ScalarKalman<float> kfF(ALTITUDE_KF_MEASURE, ALTITUDE_KF_ESTIMATE, ALTITUDE_KF_PROCESS);
+    bench::run(out, SUITE, "kalman_float", 100000, [&] { bench::keep(kfF.update(next())); });
+    filt::ScalarKalman<filt::Q16> kfQ(ALTITUDE_KF_MEASURE, ALTITUDE_KF_ESTIMATE, ALTITUDE_KF_PROCESS);
+    bench::run(out, SUITE, "kalman_q16", 100000, [&] { bench::keep(kfQ.update(filt::Q16(next()))); });
+
+    // Pose estimator: one 200 Hz step, and one fix (two scalar updates)
+    PoseEstimator dr;
+    dr.setOrigin(14.6537, 121.0687);
+    dr.gpsSpeed(0.4f);
+    const float stepNs = bench::run(out, SUITE, "pose_predict", 100000, [&] {
+        dr.predict(next() * 10.0f, 0.05f, 0.005f);
+        bench::keep(dr);
+    });
+    uint32_t fixN = 0;
+    bench::run(out, SUITE, "pose_gps_fix", 10000, [&] {
+        fixN++;
+        dr.gpsPosition(14.6537 + (fixN % 7) * 1e-6, 121.0687 + (fixN % 5) * 1e-6, 1.0f);
+        bench::keep(dr);
+    });
+    if (stepNs > POSE_STEP_BUDGET_US * 1000.0f) out.println(F("# pose_predict: over POSE_STEP_BUDGET_US"));
+
+    TinyGPSPlus parser;
+    bench::run(out, SUITE, "tinygps_feed_epoch", 2000, [&] {
+        for (const char* p = BENCH_NMEA_EPOCH; *p; p++) parser.encode(*p);
+        bench::keep(parser);
+    });
+
+    // Format + append, including the periodic sync every SYNC_INTERVAL records
+    if (logger.begin("bench.csv")) {
+        bench::run(out, SUITE, "sd_record", 2000, [&] {
+            formatTelemetry(record, sizeof(record));
+            logger.logValue(record);
+        });
+        logger.end();
+    } else {
+        out.println(F("# sd_record skipped: no SD card"));
+    }
+}
+#endif
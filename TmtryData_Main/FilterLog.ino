@@ -0,0 +1,48 @@
+/**
+ * FILTER INPUT LOG (FILTER_LOG builds only)
+ * Every sample the tuned filters are fed, when they are fed, goes to
+ * filter_in.csv on the SD card, so Tools/filter_tune.cpp can replay a
+ * session through the same Filters.h code with other constants:
+ *   t_us,ch,value
+ *   b  baro relative altitude (m)   -> altitudeFilter, every loop
+ *   a  IMU linear accel X (m/s^2)   -> accelXFilter, imuSpeedIntegrator
+ *   S  GPS speed (m/s), fresh       -> gpsSpeedFilter (and the reference)
+ *   s  GPS speed (m/s), repeated    -> gpsSpeedFilter
+ *   d  GPS speed invalid            -> GPS_SPEED_DECAY step
+ *   h  GPS altitude (m)             reference only
+ * A few KB/s at the usual rates; leave it off for normal runs.
+ */
+#ifdef FILTER_LOG
+
+// Flush to the card about once a second
+static constexpr uint16_t FILTER_LOG_SYNC_LINES = 300;
+
+static FsFile   filterFile;
+static uint16_t filterUnsynced = 0;
+
+FLASHMEM void filterLogInit() {
+  filterFile = logger.openFile("filter_in.csv");
+  if (!filterFile) return;
+  filterFile.println("--- NEW SESSION ---");
+  filterFile.println("t_us,ch,value");
+  filterFile.sync();
+}
+
+FASTRUN void filterLog(uint32_t t, char ch, float value) {
+  if (!filterFile) return;
+  char      line[40];
+  const int len = snprintf(line, sizeof(line), "%lu,%c,%.5f\n", (unsigned long)t, ch, value);
+  if (len <= 0 || len >= (int)sizeof(line)) return;
+  filterFile.write(line, len);
+  if (++filterUnsynced >= FILTER_LOG_SYNC_LINES) {
+    filterFile.sync();
+    filterUnsynced = 0;
+  }
+}
+
+// Power down: what is buffered goes to the card, nothing more is written
+FLASHMEM void filterLogEnd() {
+  if (filterFile) filterFile.close();
+}
+
+#endif
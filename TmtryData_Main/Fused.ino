@@ -0,0 +1,59 @@
+/**
+ * FIXED-RATE FUSED RECORDS
+ * The sensor tabs push each value with the time it was taken (baro and
+ * thermistor every loop, IMU per event, GPS per sentence). Here the
+ * resampler turns those into one record every 20 ms on an exact grid,
+ * every value interpolated (or held) to the record time with its age,
+ * and appends them to fused.csv next to the flight log:
+ *   t_ms,<12 values>,<12 ages in ms>
+ * Rows are evenly spaced, so a session loads straight into arrays.
+ */
+
+// Flush to the card about once a second
+static constexpr uint16_t FUSED_SYNC_RECORDS = 50;
+
+static FsFile   fusedFile;
+static uint16_t fusedUnsynced = 0;
+
+FLASHMEM void fusedInit() {
+    // Channels in FusedField order
+    fused.addChannel("pressure_pa",    Resampler::LINEAR,    2);
+    fused.addChannel("altitude_m",     Resampler::LINEAR,    2);
+    fused.addChannel("baro_temp_c",    Resampler::LINEAR,    2);
+    fused.addChannel("therm_temp_c",   Resampler::LINEAR,    2);
+    fused.addChannel("latitude",       Resampler::LINEAR,    7);
+    fused.addChannel("longitude",      Resampler::LINEAR,    7);
+    fused.addChannel("gps_speed_mps",  Resampler::LINEAR,    2);
+    fused.addChannel("yaw_deg",        Resampler::ANGLE_DEG, 2);
+    fused.addChannel("pitch_deg",      Resampler::LINEAR,    2);
+    fused.addChannel("roll_deg",       Resampler::LINEAR,    2);
+    fused.addChannel("accel_x_mps2",   Resampler::LINEAR,    3);
+    fused.addChannel("imu_speed_mps",  Resampler::LINEAR,    3);
+
+    fusedFile = logger.openFile("fused.csv");
+    if (!fusedFile) return;
+    char header[512];
+    fusedFile.println("--- NEW SESSION ---");
+    if (fused.header(header, sizeof(header)) < (int)sizeof(header)) fusedFile.println(header);
+    fusedFile.sync();
+}
+
+FASTRUN void fusedCore() {
+    char line[320];
+    while (fused.next(micros())) {
+        if (!fusedFile) continue;
+        const int len = fused.format(line, sizeof(line));
+        if (len <= 0 || len >= (int)sizeof(line) - 1) continue;
+        line[len] = '\n';
+        fusedFile.write(line, len + 1);
+        if (++fusedUnsynced >= FUSED_SYNC_RECORDS) {
+            fusedFile.sync();
+            fusedUnsynced = 0;
+        }
+    }
+}
+
+// Power down: what is buffered goes to the card, nothing more is written
+FLASHMEM void fusedEnd() {
+    if (fusedFile) fusedFile.close();
+}
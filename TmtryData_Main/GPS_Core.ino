@@ -1,20 +1,25 @@
 // U-BLOX CONFIGURATION STRINGS (Neo M10 / M8)
 // UBX-CFG-PRT: Set Port 1 (UART) to 115200 Baud, 8N1
 // Header: 0xB5, 0x62, Class: 0x06, ID: 0x00 ...
-const byte setBaud115200[] = {
+const byte setBaud115200[] PROGMEM = {
     0xB5, 0x62, 0x06, 0x00, 0x14, 0x00, 0x01, 0x00, 0x00, 0x00,
     0xD0, 0x08, 0x00, 0x00, 0x00, 0xC2, 0x01, 0x00, 0x07, 0x00,
-    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xB0, 0x79
+    0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x7E
 };
 
 // UBX-CFG-RATE: Set Navigation/Measurement Rate to 10Hz (100ms)
-const byte setRate10Hz[] = {
+const byte setRate10Hz[] PROGMEM = {
     0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0x64, 0x00, 0x01, 0x00, 
     0x01, 0x00, 0x7A, 0x12
 };
 
-void GPS_Init() {
+// 64-byte core RX buffer holds well under one 10 Hz epoch; this keeps
+// ~0.7 s of NMEA while the loop is blocked on radio output.
+DMAMEM static uint8_t gpsRxRing[1024];
+
+FLASHMEM void GPS_Init() {
     // 1. Start at default 9600 to establish contact
+    GPSSerial.addMemoryForRead(gpsRxRing, sizeof(gpsRxRing));
     GPSSerial.begin(9600);
     // CODE: 002004 (GPS OK)
     transmitCode(SENS_GPS_OK);
@@ -29,6 +34,7 @@ void GPS_Init() {
     GPSSerial.end();
     // Now 115200 
     GPSSerial.begin(GPSBaud);
+    health.watchUart(GPSSerial, "S2", 64 + sizeof(gpsRxRing));
     delay(200);
 
     // 4. Send Command: "Set Update Rate to 10Hz"
@@ -49,7 +55,7 @@ void GPS_Init() {
     }
 }
 
-void GPS_CORE() {
+FASTRUN void GPS_CORE() {
     // Process incoming at high speed
     while (GPSSerial.available() > 0) {
         if (gps.encode(GPSSerial.read())) {
@@ -64,19 +70,42 @@ void GPS_CORE() {
     }
 }
 
-void displayInfo() {
+FASTRUN void displayInfo() {
+    // Stamped on arrival of the sentence that completed the fix
+    const uint32_t t = micros();
+
+    // --- POSITION: once per fix (RMC and GGA both carry it, same time) ---
+    static uint32_t lastFixTime = 0xFFFFFFFF;
+    if (gps.location.isValid() && gps.location.isUpdated() && gps.time.value() != lastFixTime) {
+        lastFixTime   = gps.time.value();
+        GPS_Latitude  = gps.location.lat();
+        GPS_Longitude = gps.location.lng();
+        pose.gpsPosition(GPS_Latitude, GPS_Longitude, gps.hdop.isValid() ? (float)gps.hdop.hdop() : 1.0f);
+        fused.push(FUSED_LATITUDE,  t, GPS_Latitude);
+        fused.push(FUSED_LONGITUDE, t, GPS_Longitude);
+    }
+    // GPS altitude: the reference the altitude filter is tuned against
+    if (gps.altitude.isValid() && gps.altitude.isUpdated()) FILTER_SAMPLE(t, 'h', gps.altitude.meters());
+
     // --- NEW: SPEED CALCULATION WITH FILTER ---
     if (gps.speed.isValid()) {
+        const bool fresh = gps.speed.isUpdated();
         GPS_Speed_Kmph = gps.speed.kmph();
         GPS_Speed_Mps  = gps.speed.mps();
         
         // Apply EMA Filter
-        Filtered_GPS_Speed = (FILTER_ALPHA * GPS_Speed_Mps) + ((1.0f - FILTER_ALPHA) * Filtered_GPS_Speed);
-        
+        FILTER_SAMPLE(t, fresh ? 'S' : 's', GPS_Speed_Mps);
+        Filtered_GPS_Speed = gpsSpeedFilter.update(GPS_Speed_Mps);
+        if (fresh) {
+            pose.gpsSpeed(GPS_Speed_Mps);
+            fused.push(FUSED_GPS_SPEED, t, GPS_Speed_Mps);
+        }
     } else {
         GPS_Speed_Kmph = 0.0f;
         GPS_Speed_Mps  = 0.0f;
         // Optional: Decay the filtered speed to 0 if GPS is lost, rather than hard reset
-        Filtered_GPS_Speed *= 0.95f; 
+        FILTER_SAMPLE(t, 'd', 0.0f);
+        gpsSpeedFilter.set(gpsSpeedFilter.value() * GPS_SPEED_DECAY);
+        Filtered_GPS_Speed = gpsSpeedFilter.value();
     }
 }
\ No newline at end of file
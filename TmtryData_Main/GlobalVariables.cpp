@@ -28,11 +28,11 @@ float                       Resistance_Therm            = 0.0F;
 float                       Temperature_Therm           = 0.0F;
 
 // GPS
-float                       GPS_Latitude                = 0.0F;
-float                       GPS_Longitude               = 0.0F; 
+double                      GPS_Latitude                = 0.0;
+double                      GPS_Longitude               = 0.0; 
 float                       GPS_Altitude                = 0.0F;
-float                       GPS_Latitude_Init           = 0.0F;
-float                       GPS_Longitude_Init          = 0.0F;
+double                      GPS_Latitude_Init           = 0.0;
+double                      GPS_Longitude_Init          = 0.0;
 float                       GPS_DistanceBetween         = 0.0F;
 
 // TIME
@@ -77,4 +77,7 @@ float                       Filtered_GPS_Speed          = 0.0F;
 WDT_T4<WDT1> wdt;
 
 // START UP FLAG APC COMMUNICATION
-bool                        APC_Flag_Connection         = false;
\ No newline at end of file
+bool                        APC_Flag_Connection         = false;
+
+// HEALTH MONITOR
+HealthMonitor               health("TLM", HEALTH_PERIOD_MS);
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <SdFat.h>
 #include <Watchdog_t4.h>
+#include <HealthMonitor.h>
 
 // SD CARD OBJECTS
 extern SdFs sd;
@@ -43,11 +44,11 @@ static constexpr int                TXPin                           = 1;
 // CRITICAL: Increased to 115200 to handle 10Hz data stream from Neo M10
 static constexpr uint32_t           GPSBaud                         = 115200; 
 
-extern float                        GPS_Latitude;
-extern float                        GPS_Longitude;
+extern double                       GPS_Latitude;       // Updated from each fix (double: float is ~1 m here)
+extern double                       GPS_Longitude;
 extern float                        GPS_Altitude;       
-extern float                        GPS_Latitude_Init;
-extern float                        GPS_Longitude_Init;       
+extern double                       GPS_Latitude_Init;
+extern double                       GPS_Longitude_Init;       
 extern float                        GPS_DistanceBetween;     
 
 // TIME
@@ -88,11 +89,23 @@ extern unsigned long                present;
 extern float                        Filtered_Accel_X;   // Smoothed Acceleration
 extern float                        Filtered_GPS_Speed; // Smoothed GPS Speed
 
-// FILTER STRENGTH (Alpha)
+// FILTER TUNING, per channel (filter objects in TmtryData_Main.ino, Filters.h)
+// EMA strength (Alpha)
 // 0.1 = Very Slow/Smooth (High Lag)
 // 0.5 = Balanced
 // 0.8 = Fast/Responsive (More Noise)
-static constexpr float              FILTER_ALPHA = 0.2f;
+static constexpr float              ACCEL_X_ALPHA       = 0.2f;
+static constexpr float              GPS_SPEED_ALPHA     = 0.2f;
+static constexpr float              GPS_SPEED_DECAY     = 0.95f;  // per sentence while speed is invalid
+// IMU speed: integrate accel X beyond the deadband (m/s^2), else decay per sample
+static constexpr float              IMU_SPEED_DEADBAND  = 0.1f;
+static constexpr float              IMU_SPEED_DECAY     = 0.98f;
+// Altitude Kalman: measurement error, initial estimate error, process noise
+static constexpr float              ALTITUDE_KF_MEASURE = 0.5f;
+static constexpr float              ALTITUDE_KF_ESTIMATE= 0.5f;
+static constexpr float              ALTITUDE_KF_PROCESS = 0.138f;
+// Thermistor: median of the last reads (rejects single ADC spikes)
+static constexpr size_t             THERM_MEDIAN_READS  = 5;
 
 // WATCHDOG TIMER
 // WDT1 is the standard hardware watchdog on Teensy 4.1
@@ -101,4 +114,13 @@ extern                              WDT_T4<WDT1> wdt;
 // START UP FLAG APC COMMUNICATION
 extern bool                         APC_Flag_Connection;
 
+// RADIO NODE ID (TDMA slot owner and command address, see Tdma.h)
+// "node=<id>" in NODE_CONFIG_FILE on the SD card overrides the default.
+static constexpr uint8_t            DEFAULT_NODE_ID                 = 1;
+static constexpr const char*        NODE_CONFIG_FILE                = "rover.cfg";
+
+// HEALTH MONITOR (CPU load, stack, RAM, UART and logger backlog)
+extern HealthMonitor                health;
+static constexpr uint32_t           HEALTH_PERIOD_MS                = 5000;
+
 #endif
\ No newline at end of file
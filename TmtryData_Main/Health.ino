@@ -0,0 +1,40 @@
+/**
+ * HEALTH REPORT
+ * Sends the health frame of the window that just closed to Serial/Radio
+ * and SD, the FEC counters of the beacons heard once any frame has
+ * arrived, the IMU reports delivered against those requested, the
+ * battery, then a status code for every warning that became active.
+ */
+FLASHMEM void reportHealth() {
+    TRACE_SCOPE("health");
+    char frame[160];
+    int  len = health.format(frame, sizeof(frame));
+    if (len > 0 && len < (int)sizeof(frame)) {
+        print_data(frame);
+        logger.logValue(frame);
+    }
+
+    const FecStats& fs = radio.fec().stats();
+    if (fs.frames || fs.uncorrectable) {
+        len = radio.fec().format(frame, sizeof(frame), "TLM");
+        if (len > 0 && len < (int)sizeof(frame)) {
+            print_data(frame);
+            logger.logValue(frame);
+        }
+    }
+
+    len = imuReports.format(frame, sizeof(frame), "TLM", millis());
+    if (len > 0 && len < (int)sizeof(frame)) {
+        print_data(frame);
+        logger.logValue(frame);
+    }
+    reportBattery();
+
+    uint8_t raised = health.raised();
+    if (raised & HealthMonitor::WARN_CPU)     transmitCode(WARN_CPU_LOAD);     // "004010"
+    if (raised & HealthMonitor::WARN_LOOP)    transmitCode(WARN_LOOP_SLOW);    // "004011"
+    if (raised & HealthMonitor::WARN_STACK)   transmitCode(WARN_STACK_LOW);    // "004012"
+    if (raised & HealthMonitor::WARN_RAM)     transmitCode(WARN_RAM_LOW);      // "004013"
+    if (raised & HealthMonitor::WARN_UART)    transmitCode(WARN_UART_FULL);    // "004014"
+    if (raised & HealthMonitor::WARN_BACKLOG) transmitCode(WARN_LOG_BACKLOG);  // "004015"
+}
@@ -1,4 +1,4 @@
-void IMU_Init(void) {
+FLASHMEM void IMU_Init(void) {
     if (!bno08x.begin_I2C()) {
       // CODE: 005003
       transmitCode(ERR_IMU_FAIL);
@@ -6,15 +6,15 @@ void IMU_Init(void) {
       // CODE: 002003
       transmitCode(SENS_IMU_OK);
     }
-    setReports(reportType, reportIntervalUs);
-    
-    // NEW: Enable Linear Acceleration for Velocity Calc (5000us = 200Hz)
-    bno08x.enableReport(SH2_LINEAR_ACCELERATION, 5000); 
+    // Report consumers (the hub is set to the union, re-applied after resets)
+    imuReports.request("euler",    reportType, reportIntervalUs);       // Yaw/Pitch/Roll telemetry
+    imuReports.request("velocity", SH2_LINEAR_ACCELERATION, 5000);     // IMU_Speed_X (200Hz)
+    imuReports.apply();
 
     delay(100);
 }
 
-void quaternionToEuler(float qr, float qi, float qj, float qk, euler_t* ypr, bool degrees = false) {
+FASTRUN void quaternionToEuler(float qr, float qi, float qj, float qk, euler_t* ypr, bool degrees = false) {
     float sqr = sq(qr);
     float sqi = sq(qi);
     float sqj = sq(qj);
@@ -31,27 +31,42 @@ void quaternionToEuler(float qr, float qi, float qj, float qk, euler_t* ypr, boo
     }
 }
 
-void quaternionToEulerRV(sh2_RotationVectorWAcc_t* rotational_vector, euler_t* ypr, bool degrees = false) {
+FASTRUN void quaternionToEulerRV(sh2_RotationVectorWAcc_t* rotational_vector, euler_t* ypr, bool degrees = false) {
     quaternionToEuler(rotational_vector->real, rotational_vector->i, rotational_vector->j, rotational_vector->k, ypr, degrees);
 }
 
-void quaternionToEulerGI(sh2_GyroIntegratedRV_t* rotational_vector, euler_t* ypr, bool degrees = false) {
+FASTRUN void quaternionToEulerGI(sh2_GyroIntegratedRV_t* rotational_vector, euler_t* ypr, bool degrees = false) {
     quaternionToEuler(rotational_vector->real, rotational_vector->i, rotational_vector->j, rotational_vector->k, ypr, degrees);
 }
 
-void IMU_CORE() {
+// Attitude into the fused records, stamped on arrival
+FASTRUN void pushFusedAttitude() {
+  const uint32_t t = micros();
+  fused.push(FUSED_YAW,   t, ypr.yaw);
+  fused.push(FUSED_PITCH, t, ypr.pitch);
+  fused.push(FUSED_ROLL,  t, ypr.roll);
+}
+
+// Events read per loop: one per enabled report when the loop keeps up,
+// bounded so a chatty hub cannot stall the loop
+static constexpr uint8_t IMU_EVENTS_PER_LOOP = 4;
+
+FASTRUN void IMU_CORE() {
   if (bno08x.wasReset()) {
-    setReports(reportType, reportIntervalUs);
-    bno08x.enableReport(SH2_LINEAR_ACCELERATION, 5000);
+    TRACE_INSTANT("imu_reset", 0);
+    imuReports.onReset();
   }
   
-  if (bno08x.getSensorEvent(&sensorValue)) {
+  for (uint8_t events = 0; events < IMU_EVENTS_PER_LOOP && bno08x.getSensorEvent(&sensorValue); events++) {
+    imuReports.delivered(sensorValue.sensorId);
     switch (sensorValue.sensorId) {
       case SH2_ARVR_STABILIZED_RV:
         quaternionToEulerRV(&sensorValue.un.arvrStabilizedRV, &ypr, true);
+        pushFusedAttitude();
         break;
       case SH2_GYRO_INTEGRATED_RV:
         quaternionToEulerGI(&sensorValue.un.gyroIntegratedRV, &ypr, true);
+        pushFusedAttitude();
         break;
         
       // --- NEW: LINEAR ACCELERATION FOR VELOCITY ---
@@ -60,26 +75,24 @@ void IMU_CORE() {
         IMU_Accel_Y = sensorValue.un.linearAcceleration.y;
         
         // --- APPLY EMA FILTER ---
-        // Formula: New = (Alpha * Raw) + ((1-Alpha) * Old)
-        Filtered_Accel_X = (FILTER_ALPHA * IMU_Accel_X) + ((1.0f - FILTER_ALPHA) * Filtered_Accel_X);
+        Filtered_Accel_X = accelXFilter.update(IMU_Accel_X);
         
         // Integration: V = V0 + a*dt
         static unsigned long prevAccelTime  = 0;
         unsigned long currentAccelTime      = micros();
+        FILTER_SAMPLE(currentAccelTime, 'a', IMU_Accel_X);
         
         if (prevAccelTime > 0) {
             float dt = (currentAccelTime - prevAccelTime) / 1000000.0f; // us to seconds
             
             // Use the FILTERED acceleration for integration
-            // Deadband: Ignore tiny movements < 0.1 m/s^2
-            if (abs(Filtered_Accel_X) > 0.1f) {
-                IMU_Speed_X += Filtered_Accel_X * dt;
-            } else {
-                 // Friction decay: Slowly zero out speed if no acceleration
-                 IMU_Speed_X *= 0.98f; 
-            }
+            // Deadband: Ignore tiny movements (IMU_SPEED_DEADBAND)
+            // Friction decay: Slowly zero out speed if no acceleration
+            IMU_Speed_X = imuSpeedIntegrator.update(Filtered_Accel_X, dt);
         }
         prevAccelTime = currentAccelTime;
+        fused.push(FUSED_ACCEL_X,   currentAccelTime, IMU_Accel_X);
+        fused.push(FUSED_IMU_SPEED, currentAccelTime, IMU_Speed_X);
         break;
     }
 
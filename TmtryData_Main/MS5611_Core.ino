@@ -1,4 +1,4 @@
-void MS5611_Init() {
+FLASHMEM void MS5611_Init() {
     if (!ms5611.begin(HIGH_RES)) {
         // CODE: 005006
         transmitCode(ERR_MS5611_FAIL);
@@ -7,17 +7,22 @@ void MS5611_Init() {
         transmitCode(SENS_MS5611_OK);
     }
     delay(500);
-    ms5611.enableKalmanFilter(0.5, 0.5, 0.138);
     referencePressure = ms5611.readPressure();
 }
 
-void MS5611_CORE() {
-    uint32_t    rawTemperature      = ms5611.readRawTemperature();
-    uint32_t    rawPressure         = ms5611.readRawPressure();
+FASTRUN void MS5611_CORE() {
+    ms5611.readRawTemperature();    // raw D2 / D1 reads, not used since the
+    ms5611.readRawPressure();       // compensated ones below convert again
                 realTemperature     = ms5611.readTemperature();
                 realPressure        = ms5611.readPressure();
                 absoluteAltitude    = ms5611.getAltitude(realPressure);
                 relativeAltitude    = ms5611.getAltitude(realPressure, referencePressure);
-                Altitude_Filtered   = ms5611.kalmanFilter(relativeAltitude);
+                Altitude_Filtered   = altitudeFilter.update((float)relativeAltitude);
+
+    const uint32_t t = micros();
+    FILTER_SAMPLE(t, 'b', relativeAltitude);
+    fused.push(FUSED_PRESSURE,  t, realPressure);
+    fused.push(FUSED_ALTITUDE,  t, Altitude_Filtered);
+    fused.push(FUSED_BARO_TEMP, t, realTemperature);
   
 }
\ No newline at end of file
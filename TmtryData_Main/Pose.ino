@@ -0,0 +1,83 @@
+/**
+ * LOCAL POSE (200 Hz)
+ * Dead reckoning between GPS fixes (PoseEstimator.h); displayInfo() feeds
+ * it fixes and GPS speed. The loop runs slower than 200 Hz, so each pass
+ * catches up on the 5 ms steps since the last one, with yaw interpolated
+ * across them from the previous pass to this one. Every step is appended
+ * to local_pose.csv:
+ *   t_ms,x_m,y_m,heading_deg,speed_mps,sigma_m
+ * Geofencing and navigation read pose.x() / pose.y() directly. The step
+ * clock follows micros() from boot and counts its wraps, so t_ms keeps
+ * counting past 71 minutes.
+ */
+
+static constexpr uint32_t POSE_STEP_US      = 5000;
+static constexpr uint32_t POSE_MAX_CATCHUP  = 100;      // steps per pass (0.5 s); a longer stall is one step
+static constexpr uint16_t POSE_SYNC_ROWS    = 200;      // flush about once a second
+
+static FsFile   poseFile;
+static uint16_t poseUnsynced    = 0;
+static uint32_t poseNextUs      = 0;
+static uint32_t poseWraps       = 0;        // times poseNextUs has wrapped
+static float    poseYawPrev     = 0.0f;
+
+FLASHMEM void poseInit() {
+    poseFile = logger.openFile("local_pose.csv");
+    if (!poseFile) return;
+    poseFile.println("--- NEW SESSION ---");
+    poseFile.println("t_ms,x_m,y_m,heading_deg,speed_mps,sigma_m");
+    poseFile.sync();
+}
+
+// Move the step clock on by 'us', counting the micros() wraps
+FASTRUN static void poseAdvance(uint32_t us) {
+    const uint32_t prev = poseNextUs;
+    poseNextUs += us;
+    if (poseNextUs < prev) poseWraps++;
+}
+
+FASTRUN void poseCore() {
+    const uint32_t now = micros();
+    if (!pose.hasOrigin()) {
+        // Nothing to be relative to until the first fix
+        poseAdvance(now - poseNextUs);
+        poseYawPrev = Yaw_Output;
+        return;
+    }
+
+    uint32_t steps = (now - poseNextUs) / POSE_STEP_US;
+    if (steps == 0) return;
+    float dt = POSE_STEP_US * 1e-6f;
+    if (steps > POSE_MAX_CATCHUP) {
+        // Stalled: cover the gap in one long step rather than a burst
+        dt         = (now - poseNextUs) * 1e-6f;
+        poseAdvance(now - POSE_STEP_US - poseNextUs);
+        steps      = 1;
+    }
+
+    float turn = Yaw_Output - poseYawPrev;
+    if (turn > 180.0f)  turn -= 360.0f;
+    if (turn < -180.0f) turn += 360.0f;
+
+    char row[80];
+    for (uint32_t k = 1; k <= steps; k++) {
+        pose.predict(poseYawPrev + turn * k / steps, IMU_Accel_X, dt);
+        poseAdvance(POSE_STEP_US);
+        if (!poseFile) continue;
+        const uint64_t stampUs = (uint64_t)poseWraps << 32 | poseNextUs;
+        const int len = snprintf(row, sizeof(row), "%llu,%.3f,%.3f,%.2f,%.3f,%.2f\n",
+                                 (unsigned long long)(stampUs / 1000), pose.x(), pose.y(),
+                                 pose.headingDeg(), pose.speed(), pose.sigmaM());
+        if (len > 0 && len < (int)sizeof(row)) poseFile.write(row, len);
+        if (++poseUnsynced >= POSE_SYNC_ROWS) {
+            poseFile.sync();
+            poseUnsynced = 0;
+        }
+    }
+    poseYawPrev = Yaw_Output;
+}
+
+// Power down: what is buffered goes to the card, nothing more is written
+FLASHMEM void poseEnd() {
+    if (poseFile) poseFile.close();
+}
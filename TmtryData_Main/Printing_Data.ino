@@ -1,19 +1,24 @@
+// Radio output goes through the TDMA link's queue: drained as fast as the
+// APC220 takes it while no beacon is heard, in this node's slot once the
+// ground runs TDMA. Telemetry records go through the sinks (Sinks.ino).
+
 // Existing double overload
-void print_data(double data, int decimal) {
-    Serial.println(data, decimal);
-    APC220.println(data, decimal);
+FASTRUN void print_data(double data, int decimal) {
+    char text[24];
+    snprintf(text, sizeof(text), "%.*f", decimal, data);
+    print_data(text);
 }
 
 // New overload for C-strings (null-terminated char arrays)
-void print_data(const char *s) {
+FASTRUN void print_data(const char *s) {
     Serial.println(s);
-    APC220.println(s);
+    radio.send(s);
 }
 
 // New overload for a single character
-void print_data(char c) {
-    Serial.println(c);
-    APC220.println(c);
+FASTRUN void print_data(char c) {
+    const char text[2] = { c, '\0' };
+    print_data(text);
 }
 
 // NOTE: String object overload removed to enforce JSF Rule 3 (No Dynamic Memory)
\ No newline at end of file
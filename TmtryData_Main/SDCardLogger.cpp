@@ -3,9 +3,9 @@
 // Instantiate the global object
 SDCardLogger logger;
 
-SDCardLogger::SDCardLogger() : _ready(false), _syncCounter(0) {}
+SDCardLogger::SDCardLogger() : _ready(false), _syncCounter(0), _lastWriteUs(0) {}
 
-bool SDCardLogger::begin() {
+FLASHMEM bool SDCardLogger::begin(const char* filename) {
     // If already ready, don't re-init
     if (_ready) return true;
 
@@ -23,7 +23,7 @@ bool SDCardLogger::begin() {
     // O_APPEND: Add to end of file
     // O_CREAT: Create if doesn't exist
     // O_RDWR: Read/Write permission
-    _file = _sd.open(FILENAME, O_RDWR | O_CREAT | O_APPEND);
+    _file = _sd.open(filename, O_RDWR | O_CREAT | O_APPEND);
 
     if (!_file) {
         SDCard_Status = 0;
@@ -43,7 +43,7 @@ bool SDCardLogger::begin() {
     return true;
 }
 
-void SDCardLogger::logValue(const char* value) {
+FASTRUN void SDCardLogger::logValue(const char* value) {
     // Safety check: Do not write if init failed
     if (!_ready || !_file) {
         // Optional: Try to recover? 
@@ -51,6 +51,7 @@ void SDCardLogger::logValue(const char* value) {
         return;
     }
 
+    const uint32_t start = micros();
     _file.println(value);
     
     // Periodic Sync (Flush)
@@ -60,9 +61,16 @@ void SDCardLogger::logValue(const char* value) {
         _file.sync();
         _syncCounter = 0;
     }
+    _lastWriteUs = micros() - start;
 }
 
-void SDCardLogger::end() {
+FLASHMEM FsFile SDCardLogger::openFile(const char* name) {
+    FsFile f;
+    if (_ready) f = _sd.open(name, O_RDWR | O_CREAT | O_APPEND);
+    return f;
+}
+
+FLASHMEM void SDCardLogger::end() {
     if (_file) {
         _file.sync();
         _file.close();
@@ -10,8 +10,8 @@ class SDCardLogger {
         SDCardLogger();
 
         /// Try to initialize the SD on SDIO.
-        // Returns true if successful.
-        bool begin();
+        // Returns true if successful. 'filename' defaults to the flight log.
+        bool begin(const char* filename = FILENAME);
 
         /// Append a C-string (char array) to the file.
         // Uses a buffer flush strategy for speed.
@@ -23,6 +23,19 @@ class SDCardLogger {
         /// Check if logger is healthy.
         bool isReady() const { return _ready; }
 
+        /// Records written since the last sync (lost on power cut).
+        int pending() const { return _syncCounter; }
+
+        /// Time the last logValue() took, sync included (card back-pressure).
+        uint32_t lastWriteUs() const { return _lastWriteUs; }
+
+        /// Open (append) another file on the same card, e.g. a trace dump.
+        // Returns a closed FsFile if the card is not ready.
+        FsFile openFile(const char* name);
+
+        /// The mounted card, for reading files while logging (LogServer).
+        SdFs& volume() { return _sd; }
+
     private:
         static constexpr int                MAX_ATTEMPTS        = 1; // Fast fail to avoid boot loop
         static constexpr int                SYNC_INTERVAL       = 10; // Flush to disk every 10 writes
@@ -32,6 +45,7 @@ class SDCardLogger {
         FsFile _file;
         bool   _ready;
         int    _syncCounter;
+        uint32_t _lastWriteUs;
 };
 
 // Extern instance for global access if needed, 
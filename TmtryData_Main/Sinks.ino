@@ -0,0 +1,58 @@
+/**
+ * TELEMETRY SINKS
+ * Every record is offered to USB, radio and SD, each at its own adaptive
+ * rate (AdaptiveRate.h). A sink that falls behind backs off; one that
+ * cannot take the record right now skips it instead of stalling the loop:
+ *   - USB    backs off below two lines of room in the USB TX buffer,
+ *            skips below one
+ *   - Radio  backs off past RADIO_QUEUE_MARK of the TDMA queue, skips
+ *            rather than push queued lines out
+ *   - SD     backs off when the previous write (with its sync) took over
+ *            SD_SLOW_US; writes are synchronous, so it never skips
+ * Every RATE_REPORT_MS an "R,n=TLM,t=<ms>,usb=<Hz>,radio=<Hz>,sd=<Hz>"
+ * line gives the current rates so consumers can rescale; between reports
+ * the TimeMs field of each record gives its exact spacing. It is kept
+ * rare because on the radio (under TDMA) it takes the room of a record.
+ */
+static constexpr float    RADIO_QUEUE_MARK  = 0.3f;      // ~2 records: ~0.3 s at 9600 baud
+static constexpr uint32_t SD_SLOW_US        = 5000;
+static constexpr uint32_t RATE_REPORT_MS    = 5000;
+
+// True if at least one sink wants a record now
+FASTRUN bool telemetryDue(uint32_t now) {
+    return usbRate.due(now) || radioRate.due(now) || sdRate.due(now);
+}
+
+FASTRUN void sendTelemetry(const char* line, size_t len) {
+    if (usbRate.due(present)) {
+        const int room = Serial.availableForWrite();
+        if (usbRate.offer(present, room < 2 * ((int)len + 2), room < (int)len + 2)) Serial.println(line);
+    }
+    if (radioRate.due(present) &&
+        radioRate.offer(present, radio.queued() + len + 1 > radio.capacity() * RADIO_QUEUE_MARK,
+                        radio.queued() + len + 1 > radio.capacity())) {
+        TRACE_BEGIN("radio_tx");
+        radio.send(line);
+        TRACE_END("radio_tx");
+    }
+    if (sdRate.due(present) && sdRate.offer(present, logger.lastWriteUs() > SD_SLOW_US)) {
+        TRACE_BEGIN("sd_write");
+        logger.logValue(line);
+        TRACE_END("sd_write");
+    }
+}
+
+// Current rates to every sink, once per RATE_REPORT_MS
+FASTRUN void reportRates() {
+    static uint32_t lastReport = 0;
+    if (present - lastReport < RATE_REPORT_MS) return;
+    lastReport = present;
+
+    char line[80];
+    int  len = snprintf(line, sizeof(line), "R,n=TLM,t=%lu,usb=%.1f,radio=%.1f,sd=%.1f",
+                        present, usbRate.rateHz(), radioRate.rateHz(), sdRate.rateHz());
+    if (len > 0 && len < (int)sizeof(line)) {
+        print_data(line);
+        logger.logValue(line);
+    }
+}
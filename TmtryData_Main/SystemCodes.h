@@ -31,6 +31,14 @@ enum SystemCode : uint16_t {
         // 4000 : WARNINGS (Non-fatal erros)
         WARN_GPS_NO_FIX         = 4001,
         WARN_SD_SLOW            = 4004,
+        WARN_CPU_LOAD           = 4010,
+        WARN_LOOP_SLOW          = 4011,
+        WARN_STACK_LOW          = 4012,
+        WARN_RAM_LOW            = 4013,
+        WARN_UART_FULL          = 4014,
+        WARN_LOG_BACKLOG        = 4015,
+        WARN_BATTERY_LOW        = 4016, // Rates halved, CPU clock lowered
+        WARN_BATTERY_CRITICAL   = 4017, // Rates at a quarter
 
         // 5000 : CRITICAL ERROS
         ERR_SD_INIT_FAIL        = 5001,
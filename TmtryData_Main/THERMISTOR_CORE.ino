@@ -1,6 +1,10 @@
-void THERMISTOR_CORE() {
-    int raw = analogRead(A0);
-    
+FASTRUN void THERMISTOR_CORE() {
+    Temperature_Therm = thermistorCelsius(thermistorMedian.update(analogRead(A0)));
+    fused.push(FUSED_THERM_TEMP, micros(), Temperature_Therm);
+}
+
+// Divider voltage -> resistance -> Beta equation (no I/O, safe to benchmark)
+FASTRUN float thermistorCelsius(int raw) {
     // NOTE: Teensy 4.1 ADC is usually 3.3V. If using 3.3V power, change this to 3.3f.
     // If kept at 5.0f with 3.3V power, the reading will be skewed (likely the cause of the -25 error).
     constexpr float VREF = 5.0f; 
@@ -22,5 +26,5 @@ void THERMISTOR_CORE() {
     float invT = (1.0f / THERMISTOR_TEMP_INIT) + (log(Rtherm / THERMISTOR_R0) / THERMISTOR_BETA);
     
     // Kelvin to Celsius + Calibration
-    Temperature_Therm = ((1.0f / invT) - 273.15f) + CALIBRATION_OFFSET;
+    return ((1.0f / invT) - 273.15f) + CALIBRATION_OFFSET;
 }
\ No newline at end of file
@@ -5,23 +5,45 @@
  * Standard: NASA Power of Ten / JSF C++
  */
 
+// --- BUILD OPTIONS ---
+// #define BENCHMARK_MODE   // Time the hot kernels at boot instead of running (Benchmarks.ino)
+// #define TRACE_MODE       // Record a timeline of loop stages and I/O (Trace.ino)
+// #define RADIO_FEC        // Send radio lines as Reed-Solomon frames (Fec.h); the ground decodes both
+// #define FILTER_LOG       // Log every input of the tuned filters to filter_in.csv (FilterLog.ino)
+
 // --- SYSTEM LIBRARIES ---
 #include <Arduino.h>
 #include "imxrt.h"          // Teensy 4.1 hardware registers
 #include <Wire.h>           // I2C Communication
 #include <MS5611.h>         // Barometer Library
-#include <SimpleKalmanFilter.h>
 #include <TinyGPS++.h>      // NMEA Parsing
 #include <SoftwareSerial.h> // (Backup, not used for main GPS)
 #include <Adafruit_BNO08x.h> // IMU Library
 #include <SdFat.h>          // High-performance SDIO Library
 #include <math.h>
+#include <TraceRecorder.h>  // TRACE_* macros (no-ops unless TRACE_MODE)
+#include <Tdma.h>           // Slot scheduling on the shared APC220 channel
+#include <EventLink.h>      // Acknowledged delivery of status codes
+#include <LogServer.h>      // SD log download over USB
+#include <AdaptiveRate.h>   // Per-sink telemetry rate control
+#include <ImuReports.h>     // BNO08x reports by consumer
+#include <Resampler.h>      // Fixed-rate fused records
+#include <Filters.h>        // EMA, biquad, median, Kalman per channel
+#include <PoseEstimator.h>  // Dead reckoning with GPS correction
+#include <BatteryMonitor.h> // Pack charge and the power governor's rates
 
 // --- CUSTOM MODULES ---
 #include "GlobalVariables.h" // Shared variables across files
 #include "SDCardLogger.h"    // Safe SD Card Class
 #include "SystemCodes.h"     // Numeric Status Codes (e.g., 001000)
 
+// --- MEMORY PLACEMENT ---
+// FASTRUN  : per-loop code (parsers, filters, formatter) in zero-wait ITCM
+// FLASHMEM : boot / init / error paths stay in flash, leaving RAM1 to DTCM
+// PROGMEM  : constant tables that are only read at boot
+// DMAMEM   : large buffers and rings in OCRAM (RAM2)
+// Check the result with Tools/memory_report.py against Tools/memory_budget.json.
+
 // --- HARDWARE SERIAL CONFIGURATION ---
 // Critical: Neo M10 requires Hardware Serial (Serial1), not SoftwareSerial
 #define   GPSSerial     Serial2
@@ -36,6 +58,72 @@
 MS5611                ms5611;
 TinyGPSPlus           gps;
 
+// --- RADIO LINK ---
+// Free-running until the ground sends TDMA beacons, then slot-scheduled.
+// FEC frames are always accepted; RADIO_FEC also sends them.
+DMAMEM static uint8_t radioQueue[1024];
+TdmaSchedule          tdma(DEFAULT_NODE_ID, APC_BAUD);     // rover.cfg may change the ID at boot
+TdmaLink              radio(APC220, tdma, radioQueue, sizeof(radioQueue));
+
+// --- STATUS EVENTS ---
+// Codes are queued until the ground acks them, resent with backoff and
+// held to ~5% of the link (48 B/s) so telemetry keeps its bandwidth.
+EventSender           events(48);
+
+// --- TELEMETRY RATE PER SINK (see Sinks.ino) ---
+// Each sink backs off on its own queue; the loop never waits for one.
+//                    min Hz  max Hz  start  step Hz/s  backoff
+AdaptiveRate          usbRate   (1.0f,  100.0f, 50.0f, 10.0f);
+AdaptiveRate          radioRate (0.5f,  20.0f,  4.0f,  1.0f,  0.75f);
+AdaptiveRate          sdRate    (1.0f,  100.0f, 50.0f, 10.0f);
+
+// --- SIGNAL FILTERS (tuning in GlobalVariables.h) ---
+filt::Ema<float>                              accelXFilter(ACCEL_X_ALPHA);
+filt::Ema<float>                              gpsSpeedFilter(GPS_SPEED_ALPHA);
+filt::ScalarKalman<float>                     altitudeFilter(ALTITUDE_KF_MEASURE, ALTITUDE_KF_ESTIMATE, ALTITUDE_KF_PROCESS);
+filt::DeadbandIntegrator<float>               imuSpeedIntegrator(IMU_SPEED_DEADBAND, IMU_SPEED_DECAY);
+filt::MovingMedian<int, THERM_MEDIAN_READS>   thermistorMedian;
+
+// --- FIXED-RATE FUSED RECORDS (see Fused.ino) ---
+// Sensors push timestamped samples; a record every 20 ms (50 Hz), taken
+// 40 ms behind so most values are interpolated rather than held.
+enum FusedField : uint8_t {
+  FUSED_PRESSURE, FUSED_ALTITUDE, FUSED_BARO_TEMP, FUSED_THERM_TEMP,
+  FUSED_LATITUDE, FUSED_LONGITUDE, FUSED_GPS_SPEED,
+  FUSED_YAW, FUSED_PITCH, FUSED_ROLL, FUSED_ACCEL_X, FUSED_IMU_SPEED
+};
+Resampler             fused(20000, 40000);
+
+// --- LOCAL POSE (see Pose.ino) ---
+// 200 Hz ENU pose from speed and yaw, pulled onto GPS fixes. Each step
+// must stay inside its budget (checked by the benchmark suite).
+PoseEstimator         pose;
+static constexpr uint32_t POSE_STEP_BUDGET_US = 10;
+
+// --- BATTERY (see Battery.ino) ---
+// Same sense lines and config as the actuator; low charge slows this node down.
+BatteryMonitor        battery;
+
+// --- SD LOG DOWNLOAD (USB) ---
+// Read buffer in OCRAM; 16 KiB chunks keep parked transfers near card speed.
+DMAMEM static uint8_t downloadBuffer[16384];
+LogServer             download(Serial, downloadBuffer, sizeof(downloadBuffer));
+
+// --- TIMELINE TRACE ---
+#ifdef TRACE_MODE
+DMAMEM static TraceEvent traceRing[TRACE_RING_EVENTS];
+TraceRecorder         trace("TLM", traceRing, TRACE_RING_EVENTS);
+#endif
+
+// --- FILTER INPUT LOG (see FilterLog.ino) ---
+// FILTER_SAMPLE(t_us, channel, value) at every filter input; nothing in
+// normal builds (the arguments are not even evaluated).
+#ifdef FILTER_LOG
+#define FILTER_SAMPLE(t, ch, value)   filterLog(t, ch, value)
+#else
+#define FILTER_SAMPLE(t, ch, value)   ((void)0)
+#endif
+
 // --- PIN DEFINITIONS ---
 // Pin 13 (Builtin) = Heartbeat/Status
 // Pin 24 = External Status LED
@@ -59,32 +147,42 @@ struct euler_t {
 Adafruit_BNO08x         bno08x(BNO08X_RESET);
 sh2_SensorValue_t       sensorValue;
 
-// IMU Report Rate Configuration
+// IMU Report Rate Configuration (orientation for the Euler telemetry)
 #ifdef FAST_MODE
   sh2_SensorId_t  reportType          = SH2_GYRO_INTEGRATED_RV;
-  long            reportIntervalUs    = 2000; // 500Hz
+  long            reportIntervalUs    = 2000;  // 500Hz
 #else
   sh2_SensorId_t  reportType          = SH2_ARVR_STABILIZED_RV;
-  long            reportIntervalUs    = 5000; // 200Hz
+  long            reportIntervalUs    = 10000; // 100Hz: the fastest telemetry sink
 #endif
 
-// Helper: Enable IMU Reports
-void setReports(sh2_SensorId_t reportType, long report_interval) {
-  if (! bno08x.enableReport(reportType, report_interval)) {}
+// Helper: Enable (or with 0, disable) one IMU report
+FLASHMEM bool enableImuReport(uint8_t id, uint32_t intervalUs) {
+  return bno08x.enableReport(id, intervalUs);
 }
 
+// Consumers register what they need in IMU_Init(); the hub gets the union
+ImuReports              imuReports(enableImuReport);
+
 /**
  * TELEMETRY TRANSMITTER
- * Sends a 6-digit status code to USB, Radio, and SD Card.
+ * Sends a 6-digit status code to USB and SD Card, and queues it for
+ * acknowledged delivery over the radio ("E,<epoch>,<seq>,<code>,<t_ms>").
  * Example: transmitCode(1000) -> sends "001000"
  */
-void transmitCode(uint16_t code) {
+FLASHMEM void transmitCode(uint16_t code) {
   char codeBuffer[8];
   // Safety: snprintf prevents buffer overflow
   snprintf(codeBuffer, sizeof(codeBuffer), "%06d", code);
   
-  print_data(codeBuffer);
+  Serial.println(codeBuffer);
   logger.logValue(codeBuffer);
+  events.post(code, millis());
+}
+
+// Lines from the ground that are not beacons: event acks
+FASTRUN void onRadioLine(const char* line) {
+  events.onLine(line);
 }
 
 /**
@@ -92,8 +190,12 @@ void transmitCode(uint16_t code) {
  * Triggered if the CPU hangs for 2.5 seconds.
  * Gives a final warning before the hard reset at 5.0 seconds.
  */
-void wdtWarning() {
-  print_data("005011");     // Log Code: Watchdog Warning
+FASTRUN void wdtWarning() {
+  TRACE_ISR("wdt_warning", 0);
+  // Log Code: Watchdog Warning. Straight to the UARTs: the TDMA queue is
+  // only drained by the loop that has hung, and that loop may be mid-send
+  Serial.println("005011");
+  APC220.println("005011");
   logger.logValue("005011"); 
 
   // Emergency: Turn on ALL LEDs to indicate freeze
@@ -103,11 +205,26 @@ void wdtWarning() {
     }
 }
 
+/**
+ * NODE ID FROM THE SD CARD
+ * One image serves the whole fleet: "node=<id>" in rover.cfg sets this
+ * rover's TDMA slot and slot-report ID (same file on the actuator card).
+ */
+FLASHMEM void loadNodeId() {
+  char   text[32] = {0};
+  FsFile cfg      = logger.volume().open(NODE_CONFIG_FILE, O_RDONLY);
+  if (cfg) {
+    cfg.read(text, sizeof(text) - 1);
+    cfg.close();
+  }
+  tdma.setId(TdmaSchedule::configId(text, DEFAULT_NODE_ID));
+}
+
 /**
  * RESET CAUSE CHECKER ("The Post-Mortem")
  * Checks hardware registers to see if the last reboot was caused by a crash.
  */
-void checkResetCause() {
+FLASHMEM void checkResetCause() {
   // SRC_SRSR Register Bit 5 (0x20) = Watchdog Reset
   if (SRC_SRSR & 0x20) {
     transmitCode(ERR_WATCHDOG_RESET); // Send "005010" (I crashed!)
@@ -121,10 +238,26 @@ void checkResetCause() {
 // ================================================================
 // SYSTEM SETUP
 // ================================================================
-void setup() {
+FLASHMEM void setup() {
+#ifdef BENCHMARK_MODE
+    // Benchmark build: report over USB, then idle (see Benchmarks.ino)
+    Serial.begin(115200);
+    while (!Serial && millis() < 3000) {}
+    runBenchmarks(Serial);
+    while (true) { yield(); }
+#endif
+
+    // Health monitor first: paints the stack while it is still shallow
+    health.begin();
+    health.thresholds().loopUs = 100000;   // radio-paced loop, 10 Hz design target
+
     // Initialize Serial Communication
     Serial.begin(115200);
     APC220.begin(APC_BAUD);
+    health.watchUart(APC220, "S1", 64);
+#ifdef RADIO_FEC
+    radio.setFec(true);
+#endif
     // Wait for Serial Monitor (Max 3 seconds) so we don't miss startup logs
     unsigned long startWait = millis();
     while (!Serial && (millis() - startWait < 3000) && !APC220) { 
@@ -137,7 +270,7 @@ void setup() {
     checkResetCause();
 
     // Configure Hardware Pins
-    analogReadResolution(12); // High precision for Thermistor (0-4095)
+    analogReadResolution(12); // High precision for Thermistor and battery (0-4095)
 
     for (size_t i = 0; i < LED_NUM_OUTPUT_PINS; i++) {
          pinMode(LED_OUTPUT_PINS[i], OUTPUT);
@@ -161,6 +294,7 @@ void setup() {
         }
     } else {
         transmitCode(SENS_SD_OK); // "002001"
+        loadNodeId();
     }
 
     // Initialize Sensors (This takes ~3-4 seconds total)
@@ -170,6 +304,18 @@ void setup() {
     IMU_Init();
     delay(100);
     GPS_Init(); // Note: This includes the Neo M10 handshake (slow)
+    fusedInit();
+    poseInit();
+#ifdef FILTER_LOG
+    filterLogInit();
+#endif
+
+    // Event epoch: boot time in us varies with the sensor handshakes, so
+    // it tells this boot's sequence numbers from the last one's
+    events.begin((uint16_t)micros());
+    radio.onLine(onRadioLine);
+    download.begin(logger.volume());
+    download.onIdle(feedWatchdog);
     
     transmitCode(SYS_BOOT_COMPLETE); // "001001"
     digitalWrite(LED_OUTPUT_PINS[0], LOW); // LED OFF = Ready
@@ -187,19 +333,25 @@ void setup() {
 // ================================================================
 // MAIN LOOP
 // ================================================================
-void loop() {
+FASTRUN void loop() {
   // SAFETY: Feed the Watchdog
   // Tells hardware: "I am alive. Reset the 5-second timer."
   wdt.feed();
+  health.beginLoop();
+  TRACE_BEGIN("loop");
 
   present = millis();
 
   // 1. DATA ACQUISITION
   // These functions read raw data and update GlobalVariables
-  MS5611_CORE();
-  IMU_CORE();
-  GPS_CORE();
-  THERMISTOR_CORE();
+  TRACE_BEGIN("ms5611");      MS5611_CORE();      TRACE_END("ms5611");
+  TRACE_BEGIN("imu");         IMU_CORE();         TRACE_END("imu");
+  TRACE_COUNTER("gps_rx", GPSSerial.available());
+  TRACE_BEGIN("gps");         GPS_CORE();         TRACE_END("gps");
+  TRACE_BEGIN("thermistor");  THERMISTOR_CORE();  TRACE_END("thermistor");
+  TRACE_BEGIN("battery");     batteryCore();      TRACE_END("battery");
+  TRACE_BEGIN("fused");       fusedCore();        TRACE_END("fused");
+  TRACE_BEGIN("pose");        poseCore();         TRACE_END("pose");
 
   // 2. INDEPENDENT TASK: Fast Blink (Pin 24)
   // Visual indicator that the loop is running fast
@@ -212,30 +364,65 @@ void loop() {
   }
 
   // 3. INDEPENDENT TASK: Telemetry Logging
-  // Runs at 0ms real-time
-  if (present - prevLogTime >= logGap) {
+  // Runs whenever a sink is due (each at its own adaptive rate)
+  if ((present - prevLogTime >= logGap) && telemetryDue(present)) {
     prevLogTime   = present;
     
     // Toggle Heartbeat LED
     builtinState  = !builtinState; 
     digitalWrite(LED_OUTPUT_PINS[0], builtinState);
 
+    TRACE_BEGIN("telemetry");
     doTelemetry();
+    TRACE_END("telemetry");
   }
+  reportRates();
+
+  // 4. RADIO: listen for beacons and acks, feed the APC220 inside our slot
+  TRACE_BEGIN("radio_poll");
+  char eventLine[40];
+  if (radio.urgentIdle() && events.poll(present, eventLine, sizeof(eventLine)) > 0) radio.sendUrgent(eventLine);
+  radio.poll();
+  TRACE_END("radio_poll");
+
+  // 5. HEALTH: one frame per window (see Health.ino)
+  health.noteBacklog(logger.pending());
+  health.endLoop();
+  if (health.due()) reportHealth();
+
+  // 6. USB CONSOLE: log downloads (and trace dumps), see UsbConsole.ino
+  usbConsole();
+  TRACE_END("loop");
 }
 
 /**
  * TELEMETRY FORMATTER
- * Formats data into CSV string and saves to SD/Radio
+ * Formats data into CSV string and hands it to the sinks that are due
  */
-void doTelemetry() {
+FASTRUN void doTelemetry() {
     // Update derived calculations
     Time_Elapsed              = millis() / 1000;
     Vertical_Velocity         = ms5611.getVelocity(Altitude_Filtered, present);
-    float AverageTemperature  = (realTemperature + Temperature_Therm) / 2.0f;
 
     char buffer[256]; // Large buffer to prevent overflow
-    
+    TRACE_BEGIN("format");
+    int  len = formatTelemetry(buffer, sizeof(buffer));
+    TRACE_END("format");
+  
+    // Verify formatting success before writing
+    if (len > 0 && len < (int)sizeof(buffer)) {
+        TRACE_COUNTER("radio_queue", radio.queued());
+        sendTelemetry(buffer, (size_t)len);  // USB / Radio / SD, see Sinks.ino
+    }
+}
+
+/**
+ * TELEMETRY RECORD
+ * Writes one CSV record from the current globals. Returns the snprintf length.
+ */
+FASTRUN int formatTelemetry(char* buffer, size_t size) {
+    float AverageTemperature  = (realTemperature + Temperature_Therm) / 2.0f;
+
     // CSV FORMAT SPECIFICATION:
     // 1. TimeMs (System Uptime)
     // 2. Pressure (Pa)
@@ -256,7 +443,7 @@ void doTelemetry() {
     // 17. GPS_Speed (m/s - Filtered)
     // 18. IMU_Speed (m/s - Integrated)
     
-    int len = snprintf(buffer, sizeof(buffer), 
+    return snprintf(buffer, size, 
         "%lu, %ld, %.4f, %.4f, %.4f, %.4f, %.8f, %.8f, %d, %lu, %d, %.6f, %.6f, %.6f, %.4f, %.4f, %.4f, %.4f", 
         present,            
         realPressure,
@@ -277,10 +464,4 @@ void doTelemetry() {
         Filtered_GPS_Speed,   
         IMU_Speed_X           
     );
-  
-    // Verify formatting success before writing
-    if (len > 0 && len < (int)sizeof(buffer)) {
-        print_data(buffer);       // Send to Serial/Radio
-        logger.logValue(buffer);  // Save to SD Card
-    }
 }
\ No newline at end of file
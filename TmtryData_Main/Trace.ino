@@ -0,0 +1,20 @@
+/**
+ * TIMELINE TRACE DUMP (TRACE_MODE builds only)
+ * USB console commands, one character each:
+ *   'T' : drain the trace ring to USB
+ *   'D' : drain the trace ring to trace.csv on the SD card
+ * Convert with: python Tools/trace_to_perfetto.py trace.csv -o trace.json
+ */
+#ifdef TRACE_MODE
+FLASHMEM void traceCommand(int c) {
+    if (c == 'T') {
+        trace.drain(Serial);
+    } else if (c == 'D') {
+        FsFile f = logger.openFile("trace.csv");
+        if (f) {
+            trace.drain(f);
+            f.close();
+        }
+    }
+}
+#endif
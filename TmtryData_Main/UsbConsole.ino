@@ -0,0 +1,38 @@
+/**
+ * USB CONSOLE
+ * Request lines from the USB serial port. "X..." lines are SD log
+ * downloads (see LogServer.h, host client Tools/sd_download.cpp); a
+ * download runs in the background, one block per loop, while the node
+ * keeps logging. XP requests are for a parked rover: the range is sent
+ * in one go and the loop waits for it (the watchdog is fed meanwhile).
+ * In TRACE_MODE builds 'T' and 'D' at the start of a line still dump the
+ * trace ring (Trace.ino).
+ */
+static char     consoleLine[xfer::MAX_LINE];
+static uint8_t  consoleLen  = 0;
+
+FASTRUN void usbConsole() {
+    while (Serial.available() > 0) {
+        const int c = Serial.read();
+#ifdef TRACE_MODE
+        if (consoleLen == 0 && (c == 'T' || c == 'D')) {
+            traceCommand(c);
+            continue;
+        }
+#endif
+        if (c == '\r') continue;
+        if (c == '\n') {
+            consoleLine[consoleLen] = '\0';
+            if (consoleLen > 0) download.command(consoleLine);
+            consoleLen = 0;
+            continue;
+        }
+        if (consoleLen < sizeof(consoleLine) - 1) consoleLine[consoleLen++] = (char)c;
+    }
+    download.poll();
+}
+
+// Parked downloads hold the loop for longer than the watchdog allows
+FLASHMEM void feedWatchdog() {
+    wdt.feed();
+}
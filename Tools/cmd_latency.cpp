@@ -0,0 +1,203 @@
+/**
+ * COMMAND ROUND-TRIP LATENCY (host client)
+ * Sends tagged commands on the ground radio and collects the actuator's
+ * echoes from its USB port (protocol: libraries/AmbotCommon/src/CommandEcho.h),
+ * then prints the distribution of each leg:
+ *
+ *   cmd_latency <radio port> <actuator usb port> [--count n] [--rate hz]
+ *               [--cmd line] [--baud n]
+ *
+ *   rtt        tag sent on the radio -> echo read from USB (host clock)
+ *   firmware   line complete -> motor (or servo) tick that applied it
+ *   link       rtt - firmware: radio uplink plus the USB way back
+ *   uplink     tag -> line complete, with the clock offset taken from the
+ *              fastest USB return (so an upper bound by that return)
+ *
+ * The default command is "0,0": the wheels stay stopped, but it still goes
+ * through the arbiter and a motor tick like any drive command. Run it on
+ * the bench, after each firmware or radio change, with nothing else on
+ * the actuator's USB (USB commands would lock the radio out).
+ *
+ * Build (Linux / macOS):
+ *   g++ -std=c++17 -O2 -Ilibraries/AmbotCommon/src Tools/cmd_latency.cpp -o cmd_latency
+ */
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "CommandEcho.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr double    DRAIN_S     = 1.0;      // wait for late echoes after the last send
+
+const Clock::time_point T0 = Clock::now();
+
+/// Host clock in us since start; the tag is its low 32 bits.
+uint64_t nowUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - T0).count();
+}
+
+speed_t baudFlag(unsigned baud) {
+    switch (baud) {
+    case 1200:   return B1200;
+    case 2400:   return B2400;
+    case 4800:   return B4800;
+    case 19200:  return B19200;
+    case 38400:  return B38400;
+    case 57600:  return B57600;
+    case 115200: return B115200;
+    default:     return B9600;
+    }
+}
+
+class Port {
+public:
+    bool open(const char* path, unsigned baud) {
+        _fd = ::open(path, O_RDWR | O_NOCTTY);
+        if (_fd < 0) return false;
+        termios tio;
+        if (tcgetattr(_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetspeed(&tio, baudFlag(baud));   // ignored by USB CDC
+            tcsetattr(_fd, TCSANOW, &tio);
+        }
+        tcflush(_fd, TCIFLUSH);
+        return true;
+    }
+    ~Port() { if (_fd >= 0) ::close(_fd); }
+
+    bool send(const std::string& line) {
+        const std::string l = line + "\n";
+        if (::write(_fd, l.data(), l.size()) == (ssize_t)l.size()) return true;
+        perror("write");
+        return false;
+    }
+
+    /// Next complete line, waiting up to 'timeoutS'. False on timeout.
+    bool readLine(std::string& line, double timeoutS) {
+        for (;;) {
+            const size_t nl = _pending.find('\n');
+            if (nl != std::string::npos) {
+                line = _pending.substr(0, nl);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                _pending.erase(0, nl + 1);
+                return true;
+            }
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(_fd, &fds);
+            timeval tv = {(time_t)timeoutS, (suseconds_t)((timeoutS - (time_t)timeoutS) * 1e6)};
+            if (select(_fd + 1, &fds, nullptr, nullptr, &tv) <= 0) return false;
+            char          buf[512];
+            const ssize_t n = ::read(_fd, buf, sizeof(buf));
+            if (n <= 0) return false;
+            _pending.append(buf, (size_t)n);
+            timeoutS = 0.0;
+        }
+    }
+
+private:
+    int         _fd = -1;
+    std::string _pending;
+};
+
+/// p-th percentile (0..1) of 'v', which it sorts.
+double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+void printLeg(const char* name, std::vector<double>& ms) {
+    printf("%-9s %6.1f %6.1f %6.1f %6.1f\n", name, percentile(ms, 0.5), percentile(ms, 0.9),
+           percentile(ms, 0.99), percentile(ms, 1.0));
+}
+
+struct Sample {
+    uint64_t    sentUs;     // host
+    uint64_t    readUs;     // host
+    echo::Echo  e;          // rx / ap on the actuator's clock
+};
+
+void usage() {
+    fprintf(stderr, "usage: cmd_latency <radio port> <actuator usb port> [--count n] [--rate hz]\n"
+                    "                   [--cmd line] [--baud n]\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) { usage(); return 2; }
+    unsigned    count = 200;
+    double      rate  = 20.0;
+    std::string cmd   = "0,0";
+    unsigned    baud  = 9600;
+    for (int i = 3; i < argc; i++) {
+        if      (!strcmp(argv[i], "--count") && i + 1 < argc) count = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--rate") && i + 1 < argc)  rate = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--cmd") && i + 1 < argc)   cmd = argv[++i];
+        else if (!strcmp(argv[i], "--baud") && i + 1 < argc)  baud = (unsigned)atoi(argv[++i]);
+        else { usage(); return 2; }
+    }
+    if (rate <= 0.0) rate = 20.0;
+
+    Port radio, usb;
+    if (!radio.open(argv[1], baud)) { perror(argv[1]); return 1; }
+    if (!usb.open(argv[2], 115200)) { perror(argv[2]); return 1; }
+
+    // Tags are the low 32 bits of the send time; keep the full value
+    std::vector<uint64_t> sent;
+    std::vector<Sample>   samples;
+    unsigned              dropped = 0;
+    const uint64_t        periodUs = (uint64_t)(1e6 / rate);
+    uint64_t              nextUs   = nowUs();
+    std::string           line;
+
+    while (sent.size() < count || nowUs() < nextUs + (uint64_t)(DRAIN_S * 1e6)) {
+        const uint64_t t = nowUs();
+        if (sent.size() < count && t >= nextUs) {
+            if (!radio.send(cmd + echo::TAG_MARK + std::to_string((uint32_t)t))) return 1;
+            sent.push_back(t);
+            nextUs += periodUs;
+            continue;
+        }
+        const double waitS = sent.size() < count ? (nextUs - t) / 1e6 : 0.05;
+        if (!usb.readLine(line, waitS)) continue;
+        echo::Echo e;
+        if (!echo::parse(line.c_str(), &e)) continue;
+        if (e.apUs == 0) { dropped++; continue; }
+        const auto it = std::find_if(sent.begin(), sent.end(), [&](uint64_t s) { return (uint32_t)s == e.tag; });
+        if (it != sent.end()) samples.push_back({*it, nowUs(), e});
+    }
+
+    // Clock offset (host - actuator) from the fastest USB return
+    int64_t offset = INT64_MAX;
+    for (const Sample& s : samples) offset = std::min(offset, (int64_t)s.readUs - (int64_t)s.e.apUs);
+
+    std::vector<double> rtt, firmware, link, uplink;
+    for (const Sample& s : samples) {
+        rtt.push_back((s.readUs - s.sentUs) / 1e3);
+        firmware.push_back((uint32_t)(s.e.apUs - s.e.rxUs) / 1e3);
+        link.push_back(rtt.back() - firmware.back());
+        uplink.push_back(((int64_t)s.e.rxUs + offset - (int64_t)s.sentUs) / 1e3);
+    }
+    printf("%zu sent, %zu echoed, %u dropped by the actuator, %zu lost\n", sent.size(), samples.size(),
+           dropped, sent.size() - samples.size() - dropped);
+    if (samples.empty()) return 1;
+    printf("ms           p50    p90    p99    max\n");
+    printLeg("rtt", rtt);
+    printLeg("firmware", firmware);
+    printLeg("link", link);
+    printLeg("uplink", uplink);
+    return 0;
+}
@@ -0,0 +1,359 @@
+/**
+ * FILTER TUNING (host tool)
+ * Replays the filter inputs a FILTER_LOG build recorded (filter_in.csv, see
+ * TmtryData_Main/FilterLog.ino) through the firmware's own filters
+ * (libraries/AmbotCommon/src/Filters.h) with other constants, scores every
+ * set against a reference the log also carries, and ranks them:
+ *
+ *   filter_tune <filter_in.csv> [--group name] [--steps n | --random n]
+ *               [--seed n] [--jobs n] [--top n] [--set NAME=lo:hi | NAME=value]
+ *
+ *   altitude   ALTITUDE_KF_MEASURE, _ESTIMATE, _PROCESS against GPS altitude:
+ *              spread of (GPS - filtered baro) at each fix, offset free per
+ *              session (the baro reference is taken at boot)
+ *   imu_speed  ACCEL_X_ALPHA, IMU_SPEED_DEADBAND, IMU_SPEED_DECAY against GPS
+ *              speed: RMS of |IMU_Speed_X| - speed at each fresh sentence
+ *   gps_speed  GPS_SPEED_ALPHA, GPS_SPEED_DECAY: RMS error of the filtered
+ *              speed as a prediction of the next fresh sentence
+ *
+ * --steps n tries an n-point grid per parameter (log-spaced for the Kalman
+ * terms), --random n draws n sets instead; the sets are spread over every
+ * core. The firmware's current values are scored too. A parameter the log
+ * never exercises (GPS_SPEED_DECAY without a GPS dropout) ties.
+ *
+ * Build (Linux / macOS):
+ *   g++ -std=c++17 -O2 -pthread -Ilibraries/AmbotCommon/src Tools/filter_tune.cpp -o filter_tune
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Filters.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t    MAX_PARAMS  = 4;
+constexpr size_t    CHUNK       = 8;        // sets a worker takes at a time
+
+struct Sample {
+    uint32_t    t;          // us, firmware clock
+    char        ch;         // see FilterLog.ino
+    float       v;
+};
+using Session = std::vector<Sample>;
+using Set     = std::array<float, MAX_PARAMS>;
+
+struct Param {
+    const char* name;       // as in TmtryData_Main/GlobalVariables.h
+    float       current;
+    float       lo, hi;
+    bool        log;        // log-spaced grid / log-uniform draws
+};
+
+struct Group {
+    const char*         name;
+    std::vector<Param>  params;
+    double              (*score)(const std::vector<Session>&, const Set&);
+};
+
+// ================================================================
+// SCORES (lower is better), same update order as the sketch tabs
+// ================================================================
+/// MS5611_Core.ino: every loop; GPS altitude is the reference.
+double scoreAltitude(const std::vector<Session>& log, const Set& p) {
+    double   sse = 0;
+    uint64_t n   = 0;
+    for (const Session& s : log) {
+        filt::ScalarKalman<float> kf(p[0], p[1], p[2]);
+        float    alt  = 0;
+        bool     have = false;
+        double   sum = 0, sum2 = 0;
+        uint64_t m   = 0;
+        for (const Sample& x : s) {
+            if (x.ch == 'b') {
+                alt  = kf.update(x.v);
+                have = true;
+            } else if (x.ch == 'h' && have) {
+                const double d = x.v - alt;
+                sum  += d;
+                sum2 += d * d;
+                m++;
+            }
+        }
+        if (m) sse += sum2 - sum * sum / m;
+        n += m;
+    }
+    return n ? std::sqrt(sse / n) : INFINITY;
+}
+
+/// IMU_BNO08X.ino: per linear acceleration event; GPS speed is the reference.
+double scoreImuSpeed(const std::vector<Session>& log, const Set& p) {
+    double   sse = 0;
+    uint64_t n   = 0;
+    for (const Session& s : log) {
+        filt::Ema<float>                accel(p[0]);
+        filt::DeadbandIntegrator<float> speed(p[1], p[2]);
+        uint32_t                        prev = 0;
+        for (const Sample& x : s) {
+            if (x.ch == 'a') {
+                const float a = accel.update(x.v);
+                if (prev > 0) speed.update(a, (x.t - prev) / 1000000.0f);
+                prev = x.t;
+            } else if (x.ch == 'S') {
+                const double e = std::fabs(speed.value()) - x.v;
+                sse += e * e;
+                n++;
+            }
+        }
+    }
+    return n ? std::sqrt(sse / n) : INFINITY;
+}
+
+/// GPS_Core.ino: per sentence; scored before each fresh speed goes in.
+double scoreGpsSpeed(const std::vector<Session>& log, const Set& p) {
+    double   sse = 0;
+    uint64_t n   = 0;
+    for (const Session& s : log) {
+        filt::Ema<float> speed(p[0]);
+        bool             have = false;
+        for (const Sample& x : s) {
+            switch (x.ch) {
+            case 'S':
+                if (have) {
+                    const double e = speed.value() - x.v;
+                    sse += e * e;
+                    n++;
+                }
+                have = true;
+                speed.update(x.v);
+                break;
+            case 's':
+                speed.update(x.v);
+                break;
+            case 'd':
+                speed.set(speed.value() * p[1]);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return n ? std::sqrt(sse / n) : INFINITY;
+}
+
+// Current values: TmtryData_Main/GlobalVariables.h
+std::vector<Group> groups() {
+    return {
+        {"altitude",
+         {{"ALTITUDE_KF_MEASURE", 0.5f, 0.02f, 20.0f, true},
+          {"ALTITUDE_KF_ESTIMATE", 0.5f, 0.02f, 20.0f, true},
+          {"ALTITUDE_KF_PROCESS", 0.138f, 0.001f, 1.0f, true}},
+         scoreAltitude},
+        {"imu_speed",
+         {{"ACCEL_X_ALPHA", 0.2f, 0.02f, 1.0f, true},
+          {"IMU_SPEED_DEADBAND", 0.1f, 0.0f, 0.5f, false},
+          {"IMU_SPEED_DECAY", 0.98f, 0.9f, 1.0f, false}},
+         scoreImuSpeed},
+        {"gps_speed",
+         {{"GPS_SPEED_ALPHA", 0.2f, 0.02f, 1.0f, true},
+          {"GPS_SPEED_DECAY", 0.95f, 0.5f, 1.0f, false}},
+         scoreGpsSpeed},
+    };
+}
+
+// ================================================================
+// LOG, SEARCH SPACE
+// ================================================================
+bool load(const char* path, std::vector<Session>& log) {
+    std::ifstream in(path);
+    if (!in) return false;
+    for (std::string l; std::getline(in, l);) {
+        if (l.rfind("--- NEW SESSION ---", 0) == 0) {
+            log.emplace_back();
+            continue;
+        }
+        unsigned long t;
+        char          ch;
+        float         v;
+        if (sscanf(l.c_str(), "%lu,%c,%f", &t, &ch, &v) != 3) continue;
+        if (log.empty()) log.emplace_back();
+        log.back().push_back({(uint32_t)t, ch, v});
+    }
+    log.erase(std::remove_if(log.begin(), log.end(), [](const Session& s) { return s.empty(); }), log.end());
+    return true;
+}
+
+float at(const Param& p, double u) {
+    return p.log ? (float)(p.lo * std::pow((double)p.hi / p.lo, u)) : (float)(p.lo + (p.hi - p.lo) * u);
+}
+
+std::vector<Set> grid(const Group& g, unsigned steps) {
+    std::vector<Set> sets(1, Set{});
+    for (size_t k = 0; k < g.params.size(); k++) {
+        const Param&     p = g.params[k];
+        std::vector<Set> next;
+        const unsigned   n = p.lo == p.hi ? 1 : steps;
+        for (const Set& s : sets) {
+            for (unsigned i = 0; i < n; i++) {
+                Set c = s;
+                c[k]  = at(p, n > 1 ? (double)i / (n - 1) : 0.0);
+                next.push_back(c);
+            }
+        }
+        sets.swap(next);
+    }
+    return sets;
+}
+
+std::vector<Set> draw(const Group& g, unsigned count, unsigned seed) {
+    std::mt19937                           rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<Set>                       sets(count, Set{});
+    for (Set& s : sets) {
+        for (size_t k = 0; k < g.params.size(); k++) s[k] = at(g.params[k], u(rng));
+    }
+    return sets;
+}
+
+/// "NAME=lo:hi" or "NAME=value" (pinned).
+bool setRange(std::vector<Group>& all, const char* arg) {
+    const char* eq = strchr(arg, '=');
+    if (!eq) return false;
+    const std::string name(arg, eq - arg);
+    for (Group& g : all) {
+        for (Param& p : g.params) {
+            if (name != p.name) continue;
+            char* end = nullptr;
+            p.lo = p.hi = strtof(eq + 1, &end);
+            if (*end == ':') p.hi = strtof(end + 1, &end);
+            if (p.log && (p.lo <= 0 || p.hi <= 0)) p.log = false;
+            return *end == '\0' && p.lo <= p.hi;
+        }
+    }
+    return false;
+}
+
+// ================================================================
+// RUN
+// ================================================================
+/// Scores every set on 'jobs' threads. Returns the wall time in s.
+double scoreAll(const Group& g, const std::vector<Session>& log, const std::vector<Set>& sets,
+                std::vector<double>& scores, unsigned jobs) {
+    scores.assign(sets.size(), 0.0);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i; (i = next.fetch_add(CHUNK)) < sets.size();) {
+            for (size_t k = i; k < std::min(i + CHUNK, sets.size()); k++) scores[k] = g.score(log, sets[k]);
+        }
+    };
+    const auto               t0 = Clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned j = 0; j < jobs; j++) pool.emplace_back(worker);
+    for (std::thread& t : pool) t.join();
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+void tune(const Group& g, const std::vector<Session>& log, std::vector<Set> sets, unsigned jobs, unsigned top,
+          size_t samples) {
+    Set current{};
+    for (size_t k = 0; k < g.params.size(); k++) current[k] = g.params[k].current;
+    sets.push_back(current);
+
+    std::vector<double> scores;
+    const double        secs = scoreAll(g, log, sets, scores, jobs);
+    std::vector<size_t> order(sets.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores[a] < scores[b]; });
+
+    printf("\n%s: %zu sets in %.2f s on %u threads (%.0f M filter samples/s)\n", g.name, sets.size(), secs, jobs,
+           sets.size() * (double)samples / std::max(secs, 1e-9) / 1e6);
+    printf("  rank     score");
+    for (const Param& p : g.params) printf("  %20s", p.name);
+    printf("\n");
+    const size_t cur = sets.size() - 1;
+    size_t       curRank = 0;
+    for (size_t r = 0; r < order.size(); r++) {
+        if (order[r] == cur) curRank = r;
+        if (r >= top && order[r] != cur) continue;
+        printf("  %4zu  %8.4f", r + 1, scores[order[r]]);
+        for (size_t k = 0; k < g.params.size(); k++) printf("  %20.5g", sets[order[r]][k]);
+        printf("%s\n", order[r] == cur ? "  (current)" : "");
+    }
+    if (!std::isfinite(scores[order[0]])) {
+        printf("  no reference samples for this group in the log\n");
+        return;
+    }
+    printf("  best vs current: %.4f vs %.4f (%.0f%% lower), current ranks %zu of %zu\n", scores[order[0]],
+           scores[cur], 100.0 * (1.0 - scores[order[0]] / scores[cur]), curRank + 1, sets.size());
+    for (size_t k = 0; k < g.params.size(); k++) {
+        char v[32];
+        snprintf(v, sizeof(v), "%.5g", sets[order[0]][k]);
+        if (!strpbrk(v, ".e")) strcat(v, ".0");                 // a float literal needs the point
+        printf("    static constexpr float %-20s = %sf;\n", g.params[k].name, v);
+    }
+}
+
+void usage() {
+    fprintf(stderr, "usage: filter_tune <filter_in.csv> [--group altitude|imu_speed|gps_speed|all]\n"
+                    "                   [--steps n | --random n] [--seed n] [--jobs n] [--top n]\n"
+                    "                   [--set NAME=lo:hi | NAME=value]\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) { usage(); return 2; }
+    std::vector<Group> all    = groups();
+    std::string        which  = "all";
+    unsigned           steps  = 10;
+    unsigned           draws  = 0;
+    unsigned           seed   = 1;
+    unsigned           jobs   = std::max(1u, std::thread::hardware_concurrency());
+    unsigned           top    = 10;
+    for (int i = 2; i < argc; i++) {
+        if      (!strcmp(argv[i], "--group") && i + 1 < argc)  which = argv[++i];
+        else if (!strcmp(argv[i], "--steps") && i + 1 < argc)  steps = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--random") && i + 1 < argc) draws = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)   seed = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--jobs") && i + 1 < argc)   jobs = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--top") && i + 1 < argc)    top = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--set") && i + 1 < argc) {
+            if (!setRange(all, argv[++i])) { fprintf(stderr, "bad --set %s\n", argv[i]); return 2; }
+        }
+        else { usage(); return 2; }
+    }
+    if (steps < 1) steps = 1;
+
+    std::vector<Session> log;
+    if (!load(argv[1], log)) { perror(argv[1]); return 1; }
+    size_t   samples = 0, counts[128] = {};
+    double   seconds = 0;
+    for (const Session& s : log) {
+        samples += s.size();
+        seconds += (s.back().t - s.front().t) / 1e6;
+        for (const Sample& x : s) counts[(unsigned char)x.ch & 127]++;
+    }
+    printf("%s: %zu sessions, %.1f s, %zu samples (%zu baro, %zu accel, %zu gps speed, %zu gps altitude)\n",
+           argv[1], log.size(), seconds, samples, counts['b'], counts['a'], counts['S'] + counts['s'],
+           counts['h']);
+    if (samples == 0) return 1;
+
+    bool found = false;
+    for (const Group& g : all) {
+        if (which != "all" && which != g.name) continue;
+        found = true;
+        tune(g, log, draws ? draw(g, draws, seed) : grid(g, steps), jobs, top, samples);
+    }
+    if (!found) { usage(); return 2; }
+    return 0;
+}
@@ -0,0 +1,307 @@
+"""
+Memory Report Tool
+Parses a GNU ld map file from a Teensy 4.1 build and reports RAM/flash usage
+per module (object file) and per memory region, checked against budgets.
+
+Regions (Teensy 4.1):
+    FLASH  program flash, including the load images of ITCM code and .data
+    ITCM   zero-wait code, RAM1, allocated in 32 KB banks   (FASTRUN, default)
+    DTCM   zero-wait data and stack, the rest of RAM1        (globals, default)
+    OCRAM  RAM2, 512 KB, DMA-capable                         (DMAMEM)
+    PSRAM  optional external RAM                             (EXTMEM)
+
+Producing the map: add -Wl,-Map,{build.path}/{build.project_name}.map to the
+link flags, e.g.
+
+    arduino-cli compile --fqbn teensy:avr:teensy41 --libraries libraries \\
+        --build-property "build.flags.ld=-Wl,--gc-sections,--relax,-Map,{build.path}/{build.project_name}.map \\
+            \\"-T{build.core.path}/imxrt1062_t41.ld\\"" TmtryData_Main
+
+Usage:
+    python Tools/memory_report.py build/TmtryData_Main.ino.map
+    python Tools/memory_report.py firmware.map --budget Tools/memory_budget.json --csv
+
+Exit status is 1 when any region or module budget is exceeded.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+from collections import defaultdict
+from typing import Dict, List, Optional, Tuple
+
+REGIONS = ["FLASH", "ITCM", "DTCM", "OCRAM", "PSRAM"]
+
+# Linker script region name -> report name
+LD_REGION_NAMES = {
+    "FLASH": "FLASH",
+    "ITCM": "ITCM",
+    "DTCM": "DTCM",
+    "RAM": "OCRAM",
+    "ERAM": "PSRAM",
+}
+
+# imxrt1062_t41.ld, used when the map has no "Memory Configuration" block
+DEFAULT_MEMORY = [
+    ("FLASH", 0x60000000, 0x007C0000),
+    ("ITCM", 0x00000000, 0x00080000),
+    ("DTCM", 0x20000000, 0x00080000),
+    ("OCRAM", 0x20200000, 0x00080000),
+    ("PSRAM", 0x70000000, 0x01000000),
+]
+
+RAM1_SIZE = 512 * 1024
+ITCM_BANK = 32 * 1024
+
+# Budgets in bytes. DTCM shares RAM1 with ITCM and also holds the stack,
+# so its budget leaves head-room below 512 KB minus the ITCM banks.
+DEFAULT_BUDGETS = {
+    "FLASH": 1024 * 1024,
+    "ITCM": 128 * 1024,
+    "DTCM": 256 * 1024,
+    "OCRAM": 384 * 1024,
+    "PSRAM": 0,
+}
+
+SECTION_LINE = re.compile(r"^ (\S+)\s*$")
+SECTION_FULL = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+)$")
+SECTION_CONT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(.+)$")
+OUTPUT_LINE = re.compile(r"^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?")
+OUTPUT_NAME = re.compile(r"^(\.\S+)\s*$")
+OUTPUT_CONT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?\s*$")
+MEMORY_LINE = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+
+def parse_size(value) -> int:
+    """Accept 4096, "4096", "96K" or "1M"."""
+    if isinstance(value, int):
+        return value
+    text = str(value).strip().upper()
+    scale = 1
+    if text.endswith("K"):
+        scale, text = 1024, text[:-1]
+    elif text.endswith("M"):
+        scale, text = 1024 * 1024, text[:-1]
+    return int(float(text) * scale)
+
+
+def module_name(path: str, group: str) -> str:
+    """
+    Collapse an input file reference to a module name.
+
+    Args:
+        path: e.g. "/tmp/build/sketch/SDCardLogger.cpp.o" or
+              "/tmp/build/libraries/SdFat/SdFat.a(FsCache.cpp.o)"
+        group: "object" keeps one row per object file, "library" one row
+               per archive / library directory
+    """
+    path = path.strip()
+    archive = re.match(r"^(.*?)\((.*)\)$", path)
+    if archive:
+        lib = os.path.basename(archive.group(1))
+        return lib if group == "library" else f"{lib}({archive.group(2)})"
+    if group == "library":
+        parts = path.replace("\\", "/").split("/")
+        if "libraries" in parts and parts.index("libraries") + 1 < len(parts):
+            return parts[parts.index("libraries") + 1]
+        if "sketch" in parts:
+            return "sketch"
+    return os.path.basename(path)
+
+
+class MapReport:
+    """Per-module, per-region byte counts parsed from one map file."""
+
+    def __init__(self, group: str = "object"):
+        self.group = group
+        self.memory: List[Tuple[str, int, int]] = []
+        self.usage: Dict[str, Dict[str, int]] = defaultdict(lambda: defaultdict(int))
+
+    def region_of(self, address: int) -> Optional[str]:
+        for name, origin, length in self.memory or DEFAULT_MEMORY:
+            if origin <= address < origin + length:
+                return name
+        return None
+
+    def parse(self, lines: List[str]) -> None:
+        in_memory = False
+        in_map = False
+        out_vma: Optional[int] = None
+        out_lma: Optional[int] = None
+        pending_name: Optional[str] = None
+        pending_output: Optional[str] = None
+
+        for raw in lines:
+            line = raw.rstrip("\n")
+
+            if line.startswith("Memory Configuration"):
+                in_memory = True
+                continue
+            if line.startswith("Linker script and memory map"):
+                in_memory = False
+                in_map = True
+                continue
+            if in_memory:
+                m = MEMORY_LINE.match(line)
+                if m and m.group(1) in LD_REGION_NAMES:
+                    self.memory.append((LD_REGION_NAMES[m.group(1)],
+                                        int(m.group(2), 16), int(m.group(3), 16)))
+                continue
+            if not in_map or not line:
+                continue
+
+            # Output section header (one or two lines)
+            if pending_output is not None:
+                pending_output = None
+                m = OUTPUT_CONT.match(line)
+                if m:
+                    out_vma = int(m.group(1), 16)
+                    out_lma = int(m.group(3), 16) if m.group(3) else None
+                    continue
+            m = OUTPUT_LINE.match(line)
+            if m:
+                out_vma = int(m.group(2), 16)
+                out_lma = int(m.group(4), 16) if m.group(4) else None
+                continue
+            m = OUTPUT_NAME.match(line)
+            if m:
+                pending_output = m.group(1)
+                continue
+
+            # Input section (one or two lines)
+            if pending_name is not None:
+                m = SECTION_CONT.match(line)
+                name, pending_name = pending_name, None
+                if m:
+                    self.add(name, int(m.group(1), 16), int(m.group(2), 16), m.group(3), out_vma, out_lma)
+                    continue
+            m = SECTION_FULL.match(line)
+            if m:
+                self.add(m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4), out_vma, out_lma)
+                continue
+            m = SECTION_LINE.match(line)
+            if m and not m.group(1).startswith("*"):
+                pending_name = m.group(1)
+
+    def add(self, section: str, address: int, size: int, source: str,
+            out_vma: Optional[int], out_lma: Optional[int]) -> None:
+        if size == 0 or section.startswith("*") or source.startswith("load address"):
+            return
+        region = self.region_of(address)
+        if region is None:
+            return
+        module = module_name(source, self.group)
+        self.usage[module][region] += size
+        # Code and initialized data copied out of flash at boot also occupy flash
+        if out_lma is not None and out_vma is not None and region != "FLASH":
+            is_bss = ".bss" in section or section == "COMMON" or ".noinit" in section
+            if not is_bss and self.region_of(out_lma + (address - out_vma)) == "FLASH":
+                self.usage[module]["FLASH"] += size
+
+    def totals(self) -> Dict[str, int]:
+        total: Dict[str, int] = defaultdict(int)
+        for regions in self.usage.values():
+            for region, size in regions.items():
+                total[region] += size
+        return total
+
+
+def load_budgets(path: Optional[str]) -> Tuple[Dict[str, int], Dict[str, Dict[str, int]]]:
+    """
+    Budget file format (JSON, sizes in bytes or "K"/"M" strings):
+        {"regions": {"ITCM": "96K", ...},
+         "modules": {"SDCardLogger.cpp.o": {"DTCM": "2K"}, ...}}
+    """
+    regions = dict(DEFAULT_BUDGETS)
+    modules: Dict[str, Dict[str, int]] = {}
+    if path:
+        with open(path, "r", encoding="utf-8") as f:
+            data = json.load(f)
+        for region, value in data.get("regions", {}).items():
+            regions[region] = parse_size(value)
+        for module, limits in data.get("modules", {}).items():
+            modules[module] = {r: parse_size(v) for r, v in limits.items()}
+    return regions, modules
+
+
+def print_table(report: MapReport, top: int) -> None:
+    rows = sorted(report.usage.items(), key=lambda kv: -sum(kv[1].values()))
+    if top > 0:
+        rows = rows[:top]
+    width = max([len("module")] + [len(m) for m, _ in rows])
+    print(f"{'module':<{width}}" + "".join(f"{r:>10}" for r in REGIONS))
+    for module, regions in rows:
+        print(f"{module:<{width}}" + "".join(f"{regions.get(r, 0):>10}" for r in REGIONS))
+
+
+def print_csv(report: MapReport) -> None:
+    print("module," + ",".join(REGIONS))
+    for module, regions in sorted(report.usage.items()):
+        print(module + "," + ",".join(str(regions.get(r, 0)) for r in REGIONS))
+
+
+def check_budgets(report: MapReport, regions: Dict[str, int],
+                  modules: Dict[str, Dict[str, int]], out=sys.stdout) -> List[str]:
+    failures = []
+    totals = report.totals()
+    print(file=out)
+    print(f"{'region':<8}{'used':>10}{'budget':>10}{'use%':>8}", file=out)
+    for region in REGIONS:
+        used = totals.get(region, 0)
+        budget = regions.get(region, 0)
+        pct = f"{100.0 * used / budget:.1f}" if budget else "-"
+        flag = ""
+        if used > budget:
+            flag = "  OVER BUDGET"
+            failures.append(f"{region}: {used} > {budget}")
+        print(f"{region:<8}{used:>10}{budget:>10}{pct:>8}{flag}", file=out)
+
+    # ITCM is carved out of RAM1 in 32 KB banks; whatever is left is DTCM
+    itcm_banks = -(-totals.get("ITCM", 0) // ITCM_BANK)
+    dtcm_room = RAM1_SIZE - itcm_banks * ITCM_BANK - totals.get("DTCM", 0)
+    print(f"RAM1: {itcm_banks} ITCM bank(s), {dtcm_room} bytes left for DTCM stack", file=out)
+    if dtcm_room < 16 * 1024:
+        failures.append(f"RAM1: only {dtcm_room} bytes of stack head-room")
+
+    for module, limits in modules.items():
+        for region, budget in limits.items():
+            used = report.usage.get(module, {}).get(region, 0)
+            if used > budget:
+                failures.append(f"{module} {region}: {used} > {budget}")
+    return failures
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="Teensy 4.1 linker map budget report")
+    parser.add_argument("map", help="GNU ld map file")
+    parser.add_argument("--budget", help="JSON budget file (see load_budgets)")
+    parser.add_argument("--group", choices=["object", "library"], default="object",
+                        help="one row per object file or per library")
+    parser.add_argument("--top", type=int, default=25, help="rows to show (0 = all)")
+    parser.add_argument("--csv", action="store_true", help="machine-readable module table")
+    args = parser.parse_args(argv)
+
+    report = MapReport(args.group)
+    with open(args.map, "r", encoding="utf-8", errors="replace") as f:
+        report.parse(f.readlines())
+    if not report.usage:
+        print(f"no input sections found in {args.map}", file=sys.stderr)
+        return 2
+
+    if args.csv:
+        print_csv(report)
+    else:
+        print_table(report, args.top)
+
+    regions, modules = load_budgets(args.budget)
+    # Keep stdout pure CSV in --csv mode
+    failures = check_budgets(report, regions, modules, sys.stderr if args.csv else sys.stdout)
+    for failure in failures:
+        print(f"BUDGET: {failure}", file=sys.stderr)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,289 @@
+/**
+ * SD LOG DOWNLOAD (host client)
+ * Pulls files off the telemetry node's SD card over its USB port while the
+ * rover keeps running (protocol: libraries/AmbotCommon/src/LogTransfer.h).
+ *
+ *   sd_download <port> list
+ *   sd_download <port> sessions <file>
+ *   sd_download <port> get <file> [out] [--offset n] [--length n] [--parked]
+ *
+ * 'get' resumes: if 'out' already holds part of the file, the node is asked
+ * for the CRC of that much and, if it matches, only the rest is fetched.
+ * Blocks that fail their CRC (or arrive out of order) are asked for again
+ * from the first missing byte. --parked streams at full speed and holds
+ * the node's loop; use it only with the rover stopped.
+ *
+ * Build (Linux / macOS):
+ *   g++ -std=c++17 -O2 -Ilibraries/AmbotCommon/src Tools/sd_download.cpp -o sd_download
+ */
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "LogTransfer.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr double    IDLE_TIMEOUT_S  = 5.0;      // nothing heard: ask again
+constexpr int       MAX_RETRIES     = 20;
+
+double since(Clock::time_point t) {
+    return std::chrono::duration<double>(Clock::now() - t).count();
+}
+
+class Port {
+public:
+    bool open(const char* path) {
+        _fd = ::open(path, O_RDWR | O_NOCTTY);
+        if (_fd < 0) return false;
+        termios tio;
+        if (tcgetattr(_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetspeed(&tio, B115200);      // ignored by USB CDC, needed by ptys
+            tcsetattr(_fd, TCSANOW, &tio);
+        }
+        tcflush(_fd, TCIFLUSH);
+        return true;
+    }
+    ~Port() { if (_fd >= 0) ::close(_fd); }
+
+    bool send(const std::string& line) {
+        const std::string l = line + "\n";
+        if (::write(_fd, l.data(), l.size()) == (ssize_t)l.size()) return true;
+        perror("write");
+        return false;
+    }
+
+    /// Read what is there, waiting up to 'timeoutS'. Returns bytes read.
+    ssize_t read(uint8_t* buf, size_t size, double timeoutS) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(_fd, &fds);
+        timeval tv = {(time_t)timeoutS, (suseconds_t)((timeoutS - (time_t)timeoutS) * 1e6)};
+        if (select(_fd + 1, &fds, nullptr, nullptr, &tv) <= 0) return 0;
+        return ::read(_fd, buf, size);
+    }
+
+private:
+    int _fd = -1;
+};
+
+/// Feeds the parser until 'fn' returns true for a line, or times out.
+template <typename Fn>
+bool waitLine(Port& port, xfer::BlockParser& parser, Fn fn, double timeoutS = IDLE_TIMEOUT_S) {
+    uint8_t buf[4096];
+    auto    t0 = Clock::now();
+    while (since(t0) < timeoutS) {
+        const ssize_t n = port.read(buf, sizeof(buf), 0.2);
+        for (ssize_t i = 0; i < n; i++) {
+            if (parser.feed(buf[i]) == xfer::BlockParser::LINE && fn(parser.line())) return true;
+        }
+    }
+    return false;
+}
+
+int list(Port& port) {
+    xfer::BlockParser parser;
+    port.send("XL");
+    const bool ok = waitLine(port, parser, [](const char* l) {
+        if (strncmp(l, "XERR", 4) == 0) { fprintf(stderr, "%s\n", l); return true; }
+        if (strncmp(l, "XL,END", 6) == 0) return true;
+        if (strncmp(l, "XL,", 3) == 0) {
+            const char* comma = strrchr(l, ',');
+            printf("%12s  %.*s\n", comma + 1, (int)(comma - l - 3), l + 3);
+        }
+        return false;
+    });
+    return ok ? 0 : 1;
+}
+
+int sessions(Port& port, const char* file) {
+    xfer::BlockParser parser;
+    port.send(std::string("XS,") + file);
+    const bool ok = waitLine(port, parser, [](const char* l) {
+        unsigned i;
+        unsigned long off, len;
+        if (strncmp(l, "XERR", 4) == 0) { fprintf(stderr, "%s\n", l); return true; }
+        if (strncmp(l, "XS,END", 6) == 0) return true;
+        if (sscanf(l, "XS,%u,%lu,%lu", &i, &off, &len) == 3)
+            printf("session %3u  offset %10lu  length %10lu\n", i, off, len);
+        return false;
+    }, 600.0);
+    return ok ? 0 : 1;
+}
+
+/// CRC of the first 'n' bytes of a local file.
+uint32_t localCrc(FILE* fp, uint64_t n) {
+    uint8_t  buf[65536];
+    uint32_t crc = 0;
+    fseek(fp, 0, SEEK_SET);
+    while (n > 0) {
+        const size_t r = fread(buf, 1, n < sizeof(buf) ? n : sizeof(buf), fp);
+        if (r == 0) break;
+        crc = xfer::crc32(buf, r, crc);
+        n  -= r;
+    }
+    return crc;
+}
+
+int get(Port& port, const char* file, const char* outPath, uint64_t offset, uint64_t length,
+        bool parked) {
+    FILE* fp = fopen(outPath, "r+b");
+    if (!fp) fp = fopen(outPath, "w+b");
+    if (!fp) { perror(outPath); return 1; }
+    xfer::BlockParser parser;
+
+    // Resume: keep what we have if the node agrees on its CRC
+    fseek(fp, 0, SEEK_END);
+    const uint64_t have = (uint64_t)ftell(fp);
+    uint64_t       next = offset;
+    if (offset == 0 && have > 0) {
+        unsigned long crc = 0, n = 0;
+        port.send(std::string("XC,") + file + ",0," + std::to_string(have));
+        if (waitLine(port, parser, [&](const char* l) {
+                return sscanf(l, "XC,%lx,%lu", &crc, &n) == 2 || strncmp(l, "XERR", 4) == 0;
+            }, 600.0) && n == have && (uint32_t)crc == localCrc(fp, have)) {
+            next = have;
+            fprintf(stderr, "resuming at %llu\n", (unsigned long long)have);
+        } else {
+            fprintf(stderr, "local copy differs, starting over\n");
+            fclose(fp);
+            fp = fopen(outPath, "w+b");
+        }
+    }
+    const uint64_t first = next;
+
+    uint64_t   end     = length ? offset + length : 0;     // 0 until the node tells us
+    uint64_t   got     = 0;
+    int        retries = 0;
+    bool       done    = false;
+    auto       tFirst  = Clock::time_point();
+    auto       tLast   = Clock::now();
+    auto       tReport = Clock::now();
+    uint8_t    buf[65536];
+
+    auto request = [&]() {
+        const uint64_t len = end ? end - next : 0;
+        tLast = Clock::now();
+        return port.send(std::string(parked ? "XP," : "XG,") + file + "," + std::to_string(next) + "," +
+                         std::to_string(len));
+    };
+    auto retry = [&](const char* why) {
+        if (++retries > MAX_RETRIES) return false;
+        fprintf(stderr, "\n%s at %llu, asking again\n", why, (unsigned long long)next);
+        return port.send("XA") && request();
+    };
+
+    done = !request();
+    while (!done) {
+        const ssize_t n = port.read(buf, sizeof(buf), 0.2);
+        if (n <= 0 && since(tLast) > IDLE_TIMEOUT_S) {
+            if (!retry("timeout")) break;
+            continue;
+        }
+        for (ssize_t i = 0; i < n && !done; i++) {
+            switch (parser.feed(buf[i])) {
+            case xfer::BlockParser::BLOCK:
+                tLast = Clock::now();
+                if (parser.offset() != next) break;         // stale block of an aborted request
+                if (tFirst == Clock::time_point()) tFirst = tLast;
+                fseek(fp, (long)next, SEEK_SET);
+                fwrite(parser.data(), 1, parser.length(), fp);
+                next += parser.length();
+                got  += parser.length();
+                break;
+            case xfer::BlockParser::BAD:
+                if (!retry("bad block")) done = true;
+                break;
+            case xfer::BlockParser::LINE: {
+                const char*   l = parser.line();
+                unsigned long a, b;
+                char          name[64];
+                if (sscanf(l, "XG,%63[^,],%lu,%lu", name, &a, &b) == 3 && a == next) {
+                    end = a + b;
+                } else if (strncmp(l, "XE,", 3) == 0 && end && next >= end) {
+                    done = true;
+                } else if (strncmp(l, "XE,", 3) == 0) {
+                    if (!retry("gap")) done = true;
+                } else if (strncmp(l, "XERR", 4) == 0) {
+                    fprintf(stderr, "\n%s\n", l);
+                    done = true;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        if (since(tReport) > 0.5 && tFirst != Clock::time_point()) {
+            tReport = Clock::now();
+            fprintf(stderr, "\r%llu / %llu B  %.2f MB/s", (unsigned long long)next,
+                    (unsigned long long)end, got / std::chrono::duration<double>(tLast - tFirst).count() / 1e6);
+        }
+    }
+
+    // Whole-file check against the node, then the numbers
+    fflush(fp);
+    const double secs = std::chrono::duration<double>(tLast - tFirst).count();
+    bool ok = end && next == end;
+    if (ok) {
+        unsigned long crc = 0, n = 0;
+        port.send(std::string("XC,") + file + "," + std::to_string(offset) + "," + std::to_string(end - offset));
+        uint8_t  chunk[65536];
+        uint32_t mine = 0;
+        fseek(fp, (long)offset, SEEK_SET);
+        for (uint64_t left = end - offset; left > 0;) {
+            const size_t r = fread(chunk, 1, left < sizeof(chunk) ? left : sizeof(chunk), fp);
+            if (r == 0) break;
+            mine  = xfer::crc32(chunk, r, mine);
+            left -= r;
+        }
+        ok = waitLine(port, parser, [&](const char* l) { return sscanf(l, "XC,%lx,%lu", &crc, &n) == 2; }, 600.0) &&
+             (uint32_t)crc == mine;
+    }
+    fclose(fp);
+    fprintf(stderr, "\n%s: %llu B fetched (from %llu) in %.2f s, %.2f MB/s sustained, %u bad blocks, %d retries, crc %s\n",
+            outPath, (unsigned long long)got, (unsigned long long)first, secs, secs > 0 ? got / secs / 1e6 : 0.0,
+            (unsigned)parser.bad(), retries, ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+void usage() {
+    fprintf(stderr, "usage: sd_download <port> list\n"
+                    "       sd_download <port> sessions <file>\n"
+                    "       sd_download <port> get <file> [out] [--offset n] [--length n] [--parked]\n");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) { usage(); return 2; }
+    Port port;
+    if (!port.open(argv[1])) { perror(argv[1]); return 1; }
+    const std::string cmd = argv[2];
+
+    if (cmd == "list") return list(port);
+    if (cmd == "sessions" && argc >= 4) return sessions(port, argv[3]);
+    if (cmd == "get" && argc >= 4) {
+        const char* out    = argv[3];
+        uint64_t    offset = 0, length = 0;
+        bool        parked = false;
+        for (int i = 4; i < argc; i++) {
+            if      (!strcmp(argv[i], "--offset") && i + 1 < argc) offset = strtoull(argv[++i], nullptr, 10);
+            else if (!strcmp(argv[i], "--length") && i + 1 < argc) length = strtoull(argv[++i], nullptr, 10);
+            else if (!strcmp(argv[i], "--parked"))                 parked = true;
+            else if (argv[i][0] != '-')                            out = argv[i];
+            else { usage(); return 2; }
+        }
+        return get(port, argv[3], out, offset, length, parked);
+    }
+    usage();
+    return 2;
+}
@@ -0,0 +1,158 @@
+"""
+Trace Converter
+Turns TraceRecorder dumps (TRACE_MODE builds, see libraries/AmbotCommon/src/
+TraceRecorder.h) into the Chrome / Perfetto JSON trace format, one process
+per node and one thread per track (main loop, interrupts).
+
+Input, one or more drains per file:
+    # trace node=TLM clock_hz=600000000 dropped=0
+    <cycles>,<ph>,<track>,<name>,<value>        ph: B E I C
+
+Sources: the co-simulation writes sim_out/{actuator,telemetry}_trace.csv;
+on the Teensy send 'T' over USB (capture the console) or 'D' / 'TD' for
+trace.csv on the SD card.
+
+Usage:
+    python Tools/trace_to_perfetto.py sim_out/*_trace.csv -o trace.json
+    python Tools/trace_to_perfetto.py TRACE.CSV --summary
+
+Open the JSON in https://ui.perfetto.dev or chrome://tracing.
+"""
+
+import argparse
+import json
+import re
+import sys
+from collections import defaultdict
+from typing import Dict, List, Optional, TextIO, Tuple
+
+TRACK_NAMES = {0: "loop", 1: "isr"}
+
+HEADER_RE = re.compile(r"#\s*trace\s+(.*)")
+
+
+class TraceFile:
+    """Events of one node, timestamps in microseconds."""
+
+    def __init__(self, default_node: str):
+        self.node = default_node
+        self.clock_hz = 600_000_000
+        self.dropped = 0
+        self.events: List[Tuple[float, str, int, str, int]] = []
+
+    def parse(self, lines: List[str]) -> None:
+        for raw in lines:
+            line = raw.strip()
+            if not line:
+                continue
+            header = HEADER_RE.match(line)
+            if header:
+                fields = dict(kv.split("=", 1) for kv in header.group(1).split() if "=" in kv)
+                self.node = fields.get("node", self.node)
+                self.clock_hz = int(fields.get("clock_hz", self.clock_hz))
+                self.dropped += int(fields.get("dropped", 0))
+                continue
+            parts = line.split(",")
+            if len(parts) != 5 or parts[1] not in ("B", "E", "I", "C"):
+                continue                    # console chatter around a USB dump
+            try:
+                cycles, track, value = int(parts[0]), int(parts[2]), int(parts[4])
+            except ValueError:
+                continue
+            self.events.append((cycles * 1e6 / self.clock_hz, parts[1], track, parts[3], value))
+        self.events.sort(key=lambda e: e[0])
+
+
+def to_chrome(traces: List[TraceFile]) -> Dict:
+    """Chrome JSON with unbalanced spans repaired (the ring may start mid-span)."""
+    out: List[Dict] = []
+    for pid, trace in enumerate(traces, start=1):
+        out.append({"name": "process_name", "ph": "M", "pid": pid, "args": {"name": trace.node}})
+        for tid, tname in TRACK_NAMES.items():
+            out.append({"name": "thread_name", "ph": "M", "pid": pid, "tid": tid, "args": {"name": tname}})
+
+        open_spans: Dict[int, List[str]] = defaultdict(list)
+        last_ts = 0.0
+        for ts, ph, track, name, value in trace.events:
+            last_ts = ts
+            event = {"name": name, "ph": ph, "ts": ts, "pid": pid, "tid": track}
+            if ph == "B":
+                open_spans[track].append(name)
+            elif ph == "E":
+                stack = open_spans[track]
+                if name not in stack:
+                    continue                # its begin was overwritten
+                while stack and stack[-1] != name:
+                    out.append({"name": stack.pop(), "ph": "E", "ts": ts, "pid": pid, "tid": track})
+                stack.pop()
+            elif ph == "I":
+                event["s"] = "t"
+                event["args"] = {"value": value}
+            else:
+                event["args"] = {name: value}
+            out.append(event)
+
+        for track, stack in open_spans.items():
+            while stack:
+                out.append({"name": stack.pop(), "ph": "E", "ts": last_ts, "pid": pid, "tid": track})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def print_summary(traces: List[TraceFile], stream: TextIO) -> None:
+    """Per-span count, mean and worst duration."""
+    for trace in traces:
+        durations: Dict[str, List[float]] = defaultdict(list)
+        open_at: Dict[Tuple[int, str], List[float]] = defaultdict(list)
+        instants: Dict[str, int] = defaultdict(int)
+        for ts, ph, track, name, _ in trace.events:
+            if ph == "B":
+                open_at[(track, name)].append(ts)
+            elif ph == "E" and open_at[(track, name)]:
+                durations[name].append(ts - open_at[(track, name)].pop())
+            elif ph == "I":
+                instants[name] += 1
+
+        span = (trace.events[-1][0] - trace.events[0][0]) / 1e6 if trace.events else 0.0
+        print(f"{trace.node}: {len(trace.events)} events over {span:.2f} s, {trace.dropped} dropped",
+              file=stream)
+        print(f"  {'span':<16}{'count':>8}{'mean_us':>12}{'max_us':>12}{'total_%':>9}", file=stream)
+        for name, d in sorted(durations.items(), key=lambda kv: -sum(kv[1])):
+            share = 100.0 * sum(d) / (span * 1e6) if span else 0.0
+            print(f"  {name:<16}{len(d):>8}{sum(d) / len(d):>12.1f}{max(d):>12.1f}{share:>9.2f}",
+                  file=stream)
+        for name, n in sorted(instants.items()):
+            print(f"  {name:<16}{n:>8}  (instant)", file=stream)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="TraceRecorder dump to Chrome/Perfetto JSON")
+    parser.add_argument("traces", nargs="+", help="trace dumps, one node each")
+    parser.add_argument("-o", "--output", help="JSON file (default: stdout unless --summary)")
+    parser.add_argument("--summary", action="store_true", help="print per-span statistics")
+    args = parser.parse_args(argv)
+
+    traces = []
+    for path in args.traces:
+        trace = TraceFile(path)
+        with open(path, "r", encoding="utf-8", errors="replace") as f:
+            trace.parse(f.readlines())
+        if not trace.events:
+            print(f"no trace events in {path}", file=sys.stderr)
+            continue
+        traces.append(trace)
+    if not traces:
+        return 2
+
+    if args.summary:
+        print_summary(traces, sys.stdout)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            json.dump(to_chrome(traces), f)
+    elif not args.summary:
+        json.dump(to_chrome(traces), sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
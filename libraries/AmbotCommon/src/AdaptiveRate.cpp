@@ -0,0 +1,33 @@
+#include "AdaptiveRate.h"
+
+AdaptiveRate::AdaptiveRate(float minHz, float maxHz, float startHz, float stepHz, float backoff,
+                           uint16_t holdMs)
+    : _minHz(minHz), _maxHz(maxHz), _ceilingHz(maxHz), _rateHz(constrain(startHz, minHz, maxHz)), _stepHz(stepHz),
+      _backoff(backoff), _holdMs(holdMs) {}
+
+FASTRUN bool AdaptiveRate::offer(uint32_t nowMs, bool congested, bool full) {
+    // A skipped sample also restarts the interval: retry one period later
+    _lastMs = nowMs;
+    if (congested || full) {
+        if (nowMs - _cutMs >= _holdMs) {
+            _rateHz  = max(_minHz, _rateHz * _backoff);
+            _cutMs   = nowMs;
+            _stats.cuts++;
+        }
+    } else if (nowMs - _cutMs >= _holdMs) {
+        // Additive increase, per second of clear running since the last update
+        _rateHz = min(_ceilingHz, _rateHz + _stepHz * (float)(nowMs - _grownMs) * 0.001f);
+    }
+    _grownMs = nowMs;
+    if (full) {
+        _stats.skipped++;
+        return false;
+    }
+    _stats.sent++;
+    return true;
+}
+
+void AdaptiveRate::setCeiling(float hz) {
+    _ceilingHz = constrain(hz, _minHz, _maxHz);
+    _rateHz    = min(_rateHz, _ceilingHz);
+}
@@ -0,0 +1,67 @@
+/**
+ * ADAPTIVE SAMPLE RATE (AIMD)
+ * One controller per output sink (radio, USB, SD). Each time a sample is
+ * due the sketch reports the state of the sink:
+ *   - clear      the sample goes out and the rate climbs by stepHz per second
+ *   - congested  (queue past its mark, slow card writes) the sample still
+ *                goes out but the rate is cut by 'backoff'
+ *   - full       (the sample would block or push out queued data) the
+ *                sample is skipped, and the rate is cut as well
+ * as TCP does with its window. A cut holds for holdMs so one backed-up
+ * queue is one cut, not one per loop while it drains. The rate stays in
+ * [minHz, maxHz], so a sink that never clears still gets minHz worth of
+ * attempts and the queues behind it stay bounded.
+ *
+ * Nothing here waits: a congested sink costs the loop one comparison.
+ * rateHz() is what the sink currently gets; it is reported in the stream
+ * ("R," lines) so consumers can rescale. setCeiling() lowers the top of
+ * the range for a while (low battery) without touching the rest.
+ */
+#ifndef ADAPTIVE_RATE_H
+#define ADAPTIVE_RATE_H
+
+#include <Arduino.h>
+
+struct RateStats {
+    uint32_t    sent            = 0;
+    uint32_t    skipped         = 0;    // due, but the sink was full
+    uint32_t    cuts            = 0;
+};
+
+class AdaptiveRate {
+public:
+    AdaptiveRate(float minHz, float maxHz, float startHz, float stepHz = 1.0f,
+                 float backoff = 0.5f, uint16_t holdMs = 500);
+
+    /// A sample is due on this sink at 'nowMs'.
+    bool due(uint32_t nowMs) const {
+        return (float)(nowMs - _lastMs) * _rateHz >= 1000.0f;
+    }
+
+    /// Report the sink state for a due sample. Returns true if the sample
+    /// should be written now.
+    bool offer(uint32_t nowMs, bool congested, bool full = false);
+
+    /// Most the rate may climb to, within [minHz, maxHz]; maxHz restores it.
+    void setCeiling(float hz);
+
+    float               rateHz() const      { return _rateHz; }
+    float               maxHz() const       { return _maxHz; }
+    float               ceilingHz() const   { return _ceilingHz; }
+    const RateStats&    stats() const       { return _stats; }
+
+private:
+    float       _minHz;
+    float       _maxHz;
+    float       _ceilingHz;
+    float       _rateHz;
+    float       _stepHz;
+    float       _backoff;
+    uint16_t    _holdMs;
+    uint32_t    _lastMs         = 0;    // last sample written (or skipped)
+    uint32_t    _cutMs          = 0;
+    uint32_t    _grownMs        = 0;
+    RateStats   _stats;
+};
+
+#endif // ADAPTIVE_RATE_H
@@ -0,0 +1,69 @@
+/**
+ * MICROBENCHMARK HARNESS
+ * Times a kernel over a fixed number of iterations and prints one CSV
+ * record per kernel, so results can be diffed and tracked over time:
+ *
+ *     BENCH,<suite>,<kernel>,<iterations>,<ns_per_op>,<cycles_per_op>
+ *
+ * On the Teensy 4.1 the DWT cycle counter is the clock (cycles are exact,
+ * ns are derived from F_CPU_ACTUAL). On the host build ns/op comes from the
+ * host steady clock and cycles_per_op is reported as 0.
+ */
+#ifndef AMBOT_BENCH_H
+#define AMBOT_BENCH_H
+
+#include <Arduino.h>
+
+#if !defined(__IMXRT1062__)
+#include <chrono>
+#endif
+
+namespace bench {
+
+// Keep a result alive so the optimizer cannot drop the kernel.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Enable the cycle counter and print the column header (once per image).
+inline void header(Print& out) {
+    static bool printed = false;
+    if (printed) return;
+    printed = true;
+#if defined(__IMXRT1062__)
+    ARM_DEMCR     |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL  |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+    out.println(F("BENCH,suite,kernel,iterations,ns_per_op,cycles_per_op"));
+}
+
+/**
+ * Run fn() 'iterations' times after a short warm-up and print the record.
+ * Returns ns/op.
+ */
+template <typename Fn>
+float run(Print& out, const char* suite, const char* kernel, uint32_t iterations, Fn&& fn) {
+    for (uint32_t i = 0; i < iterations / 10 + 1; i++) fn();   // warm caches / predictors
+
+#if defined(__IMXRT1062__)
+    const uint32_t c0 = ARM_DWT_CYCCNT;
+    for (uint32_t i = 0; i < iterations; i++) fn();
+    const uint32_t cycles  = ARM_DWT_CYCCNT - c0;
+    const float    cyclesOp = (float)cycles / iterations;
+    const float    nsOp     = cyclesOp * (1e9f / F_CPU_ACTUAL);
+#else
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) fn();
+    const auto t1 = std::chrono::steady_clock::now();
+    const float cyclesOp = 0.0f;
+    const float nsOp     = std::chrono::duration<float, std::nano>(t1 - t0).count() / iterations;
+#endif
+
+    out.printf("BENCH,%s,%s,%lu,%.1f,%.1f\n", suite, kernel, (unsigned long)iterations, nsOp, cyclesOp);
+    return nsOp;
+}
+
+} // namespace bench
+
+#endif // AMBOT_BENCH_H
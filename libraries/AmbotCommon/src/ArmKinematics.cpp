@@ -0,0 +1,48 @@
+#include "ArmKinematics.h"
+
+namespace {
+const float DEG = (float)RAD_TO_DEG;
+}
+
+ArmPose ArmKinematics::forward(const float servoDeg[JOINTS]) const {
+    float q[JOINTS];
+    for (uint8_t j = 0; j < JOINTS; j++) q[j] = (servoDeg[j] - _g.zero[j]) / _g.sign[j] / DEG;
+
+    const float a1 = q[1];
+    const float a2 = a1 + q[2];
+    const float a3 = a2 + q[3];
+    const float r  = _g.upperArm * cosf(a1) + _g.forearm * cosf(a2) + _g.tool * cosf(a3);
+    ArmPose     p;
+    p.x     = r * cosf(q[0]);
+    p.y     = r * sinf(q[0]);
+    p.z     = _g.baseHeight + _g.upperArm * sinf(a1) + _g.forearm * sinf(a2) + _g.tool * sinf(a3);
+    p.pitch = a3 * DEG;
+    return p;
+}
+
+FASTRUN ArmKinematics::Result ArmKinematics::inverse(const ArmPose& pose, float servoDeg[JOINTS]) const {
+    const float l1    = _g.upperArm;
+    const float l2    = _g.forearm;
+    const float pitch = pose.pitch / DEG;
+
+    // Wrist axis in the arm plane
+    const float r  = sqrtf(pose.x * pose.x + pose.y * pose.y);
+    const float rw = r - _g.tool * cosf(pitch);
+    const float zw = pose.z - _g.baseHeight - _g.tool * sinf(pitch);
+    const float c  = (rw * rw + zw * zw - l1 * l1 - l2 * l2) / (2.0f * l1 * l2);
+    if (c < -1.0f || c > 1.0f) return OUT_OF_REACH;
+
+    float q[JOINTS];
+    q[0] = atan2f(pose.y, pose.x);
+    q[2] = -acosf(c);                                                   // elbow up
+    q[1] = atan2f(zw, rw) - atan2f(l2 * sinf(q[2]), l1 + l2 * cosf(q[2]));
+    q[3] = pitch - q[1] - q[2];
+
+    float deg[JOINTS];
+    for (uint8_t j = 0; j < JOINTS; j++) {
+        deg[j] = _g.zero[j] + _g.sign[j] * q[j] * DEG;
+        if (deg[j] < 0.0f || deg[j] > 180.0f) return JOINT_LIMIT;
+    }
+    for (uint8_t j = 0; j < JOINTS; j++) servoDeg[j] = deg[j];
+    return OK;
+}
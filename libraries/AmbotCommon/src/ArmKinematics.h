@@ -0,0 +1,61 @@
+/**
+ * ARM KINEMATICS
+ * Forward and inverse kinematics for the arm's first four joints: base
+ * yaw, then shoulder, elbow and wrist pitch in one vertical plane. Wrist
+ * roll and gripper do not move the tool point and are left alone.
+ *
+ * Frame: origin on the base axis at the mounting plate, X forward, Y to
+ * the left, Z up, millimetres. The tool pitch is the angle of the last
+ * link above horizontal. Joint angles:
+ *   base       yaw of the arm plane from +X (CCW)
+ *   shoulder   upper arm above horizontal
+ *   elbow      forearm relative to the upper arm (0 = straight, < 0 = down)
+ *   wrist      last link relative to the forearm
+ * Each servo reads zero + sign * joint angle (deg), see ArmGeometry.
+ *
+ * inverse() takes the elbow-up solution and rejects a pose outside the
+ * links' reach or the servos' 0-180 deg travel. It is a handful of
+ * single-precision libm calls (the Teensy 4.1 has an FPU; see the
+ * arm_ik bench), well inside the 20 ms servo tick.
+ */
+#ifndef ARM_KINEMATICS_H
+#define ARM_KINEMATICS_H
+
+#include <Arduino.h>
+
+struct ArmGeometry {
+    float   baseHeight  = 70.0f;    // mm, plate to shoulder axis
+    float   upperArm    = 105.0f;   // shoulder to elbow axis
+    float   forearm     = 98.0f;    // elbow to wrist axis
+    float   tool        = 60.0f;    // wrist axis to tool point
+    // Servo deg = zero + sign * joint deg (all at 90 = arm straight up)
+    float   zero[4]     = {90.0f, 0.0f, 90.0f, 90.0f};
+    int8_t  sign[4]     = {1, 1, 1, 1};
+};
+
+struct ArmPose {
+    float   x, y, z;                // mm
+    float   pitch;                  // deg above horizontal
+};
+
+class ArmKinematics {
+public:
+    static const uint8_t JOINTS = 4;    // base, shoulder, elbow, wrist (servos 1-4)
+
+    enum Result : uint8_t { OK, OUT_OF_REACH, JOINT_LIMIT };
+
+    explicit ArmKinematics(const ArmGeometry& geometry = ArmGeometry()) : _g(geometry) {}
+
+    const ArmGeometry& geometry() const { return _g; }
+
+    /// Tool pose for servo angles 'servoDeg' (deg, servos 1-4).
+    ArmPose forward(const float servoDeg[JOINTS]) const;
+
+    /// Servo angles (deg) for 'pose'; 'servoDeg' is only written on OK.
+    Result  inverse(const ArmPose& pose, float servoDeg[JOINTS]) const;
+
+private:
+    ArmGeometry _g;
+};
+
+#endif
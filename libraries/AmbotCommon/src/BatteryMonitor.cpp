@@ -0,0 +1,121 @@
+#include "BatteryMonitor.h"
+
+namespace {
+// Resting LiPo cell voltage at 0, 10, ... 100 % charge
+const float     OCV_CELL[]      = {3.27f, 3.69f, 3.73f, 3.77f, 3.80f, 3.84f, 3.87f, 3.95f, 4.02f, 4.11f, 4.20f};
+const uint8_t   OCV_POINTS      = sizeof(OCV_CELL) / sizeof(OCV_CELL[0]);
+const uint8_t   SEED_SAMPLES    = 10;       // filters settle before the charge is seeded
+
+// Level caps on the motors' share and the telemetry rates
+const float     LEVEL_PWM[]     = {1.0f, 0.75f, 0.5f, 0.0f};
+const float     LEVEL_RATE[]    = {1.0f, 0.5f, 0.25f, 0.25f};
+
+float cellOcv(float soc) {
+    const float   x = constrain(soc, 0.0f, 1.0f) * (OCV_POINTS - 1);
+    const uint8_t i = min((uint8_t)x, (uint8_t)(OCV_POINTS - 2));
+    return OCV_CELL[i] + (OCV_CELL[i + 1] - OCV_CELL[i]) * (x - i);
+}
+}
+
+BatteryMonitor::BatteryMonitor(const BatteryConfig& config)
+    : _c(config), _volts(config.alpha), _amps(config.alpha) {}
+
+float BatteryMonitor::ocvSoc(float cellV) const {
+    if (cellV <= OCV_CELL[0]) return 0.0f;
+    for (uint8_t i = 1; i < OCV_POINTS; i++) {
+        if (cellV < OCV_CELL[i]) return (i - 1 + (cellV - OCV_CELL[i - 1]) / (OCV_CELL[i] - OCV_CELL[i - 1])) / (OCV_POINTS - 1);
+    }
+    return 1.0f;
+}
+
+float BatteryMonitor::sagPerCell() const {
+    return max(0.0f, cellOcv(_soc) - volts() / _c.cells);
+}
+
+FASTRUN bool BatteryMonitor::update(int voltCounts, int ampCounts, uint32_t nowMs) {
+    const float v  = voltCounts * _c.voltsPerCount;
+    const float a  = (ampCounts - _c.ampsZeroCounts) * _c.ampsPerCount;
+
+    // No pack on the sense lines: hold the level, seed again once one shows
+    _present = v >= _c.noPackCellV * _c.cells && v <= _c.maxCellV * _c.cells;
+    if (!_present) {
+        _seeded = 0;
+        _under  = false;
+        return false;
+    }
+
+    const float dt = _seeded ? (nowMs - _lastMs) * 0.001f : 0.0f;
+    _lastMs = nowMs;
+    if (_seeded == 0) {
+        _volts.set(v);
+        _amps.set(a);
+    } else {
+        _volts.update(v);
+        _amps.update(a);
+    }
+
+    const float estimate = ocvSoc((volts() + amps() * _c.packOhm) / _c.cells);
+    if (_seeded < SEED_SAMPLES) {
+        _soc = estimate;
+        _seeded++;
+        return false;
+    }
+    _soc -= amps() * dt / (3600.0f * _c.capacityAh);
+    _soc += (estimate - _soc) * min(1.0f, dt / _c.ocvTauS);
+    _soc  = constrain(_soc, 0.0f, 1.0f);
+
+    const bool under = volts() / _c.cells < _c.cutoffCellV;
+    if (under && !_under) _underMs = nowMs;
+    _under = under;
+    if (_level == SHUTDOWN) return false;
+
+    Level next;
+    if (under && nowMs - _underMs >= _c.cutoffMs) {
+        next = SHUTDOWN;
+    } else {
+        // Worse at once; better only past the hysteresis
+        const Level down = _soc < _c.criticalSoc ? CRITICAL : _soc < _c.lowSoc ? LOW_CHARGE : NORMAL;
+        const Level up   = _soc < _c.criticalSoc + _c.hysteresis ? CRITICAL
+                         : _soc < _c.lowSoc + _c.hysteresis      ? LOW_CHARGE : NORMAL;
+        next = down > _level ? down : (up < _level ? up : _level);
+    }
+    if (next == _level) return false;
+    _level = next;
+    return true;
+}
+
+int BatteryMonitor::format(char* out, size_t size, const char* node) const {
+    return snprintf(out, size, "B,n=%s,v=%.2f,a=%.2f,soc=%d,lvl=%u", node, volts(), amps(),
+                    (int)lroundf(_soc * 100.0f), (unsigned)_level);
+}
+
+// ================================================================
+// GOVERNOR
+// ================================================================
+PowerGovernor::PowerGovernor(int pwmMax, int pwmStep, float sagStartV, float sagFullV, float floorShare,
+                             float recoveryPerS)
+    : _pwmMax(pwmMax), _pwmStep(pwmStep), _sagStartV(sagStartV), _sagFullV(sagFullV), _floor(floorShare),
+      _recoveryPerS(recoveryPerS), _limits{pwmMax, pwmStep, 1.0f} {}
+
+FASTRUN const GovernorLimits& PowerGovernor::update(const BatteryMonitor& battery, uint32_t nowMs) {
+    const float dt  = (nowMs - _lastMs) * 0.001f;
+    _lastMs = nowMs;
+    if (!battery.present()) {
+        _share  = 1.0f;
+        _limits = {_pwmMax, _pwmStep, 1.0f};
+        return _limits;
+    }
+
+    const float over   = constrain((battery.sagPerCell() - _sagStartV) / (_sagFullV - _sagStartV), 0.0f, 1.0f);
+    const float target = min(1.0f - (1.0f - _floor) * over, LEVEL_PWM[battery.level()]);
+    _share = target < _share ? target : min(target, _share + _recoveryPerS * dt);
+
+    _limits.pwmPeak   = (int)lroundf(_pwmMax * _share);
+    _limits.pwmStep   = max(1, (int)lroundf(_pwmStep * _share));
+    _limits.rateScale = rateScale(battery.level());
+    return _limits;
+}
+
+float PowerGovernor::rateScale(BatteryMonitor::Level level) {
+    return LEVEL_RATE[level];
+}
@@ -0,0 +1,126 @@
+/**
+ * BATTERY MONITOR AND POWER GOVERNOR
+ * The pack bus (after the Left / Both / Right selector) is sampled on two
+ * spare ADC pins: a divider for the voltage and a Hall current sensor
+ * (zero at mid-rail). Both go through an EMA.
+ *
+ * State of charge is counted in coulombs from the current, and pulled
+ * slowly toward the open-circuit estimate (voltage plus I * R, per cell,
+ * through a LiPo curve). The voltage alone dips with every acceleration
+ * and the count alone drifts with the sensor offset; together neither
+ * runs away. The first samples seed the charge from the estimate.
+ *
+ * The level follows the charge with hysteresis (LOW_CHARGE, CRITICAL).
+ * SHUTDOWN latches only once the loaded cell voltage has stayed under the
+ * cutoff for cutoffMs: the regulators drop out not far below that, so the
+ * sketches flush their logs then. A charge estimate of 0 alone is CRITICAL.
+ *
+ * A reading outside noPackCellV..maxCellV per cell is no pack at all (a
+ * USB-powered bench, sense lines unwired or floating). The monitor then
+ * stays out of the way: no level changes, and the governor gives full
+ * limits. A pack that turns up later is seeded afresh.
+ *
+ * PowerGovernor turns the monitor's state into limits for the sketches:
+ *   pwmPeak / pwmStep  motor duty ceiling and ramp per tick, cut by the
+ *                      sag past sagStartV per cell, and by level
+ *   rateScale          share of the telemetry rates to keep
+ * Cuts take effect at once and are given back slowly, so backing off the
+ * motors (which ends the sag) does not open them straight up again.
+ *
+ * Float math on a 50 Hz sample; nothing allocates.
+ */
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <Arduino.h>
+#include "Filters.h"
+
+struct BatteryConfig {
+    uint8_t     cells           = 3;                            // 3S LiPo per pack
+    float       voltsPerCount   = 3.3f / 4095.0f * 11.0f;       // 100k / 10k divider, 12-bit ADC
+    float       ampsPerCount    = 3.3f / 4095.0f / 0.04f;       // 40 mV/A Hall sensor
+    float       ampsZeroCounts  = 2048.0f;
+    float       capacityAh      = 5.0f;                         // double it when running on Both
+    float       packOhm         = 0.06f;                        // internal resistance + wiring
+    float       alpha           = 0.2f;                         // EMA per sample
+    float       ocvTauS         = 120.0f;                       // pull toward the OCV charge
+    float       lowSoc          = 0.30f;
+    float       criticalSoc     = 0.12f;
+    float       hysteresis      = 0.03f;                        // to leave a level
+    float       cutoffCellV     = 3.30f;                        // loaded
+    uint16_t    cutoffMs        = 500;
+    float       noPackCellV     = 2.50f;                        // under this, nothing is wired
+    float       maxCellV        = 4.50f;                        // over this, the line floats
+};
+
+class BatteryMonitor {
+public:
+    enum Level : uint8_t { NORMAL, LOW_CHARGE, CRITICAL, SHUTDOWN };
+
+    explicit BatteryMonitor(const BatteryConfig& config = BatteryConfig());
+
+    /// One sample (raw ADC counts) at 'nowMs'. Returns true if the level changed.
+    bool        update(int voltCounts, int ampCounts, uint32_t nowMs);
+
+    float       volts() const           { return _volts.value(); }
+    float       amps() const            { return _amps.value(); }
+    float       soc() const             { return _soc; }        // 0..1
+    Level       level() const           { return _level; }
+    bool        present() const         { return _present; }   // a plausible pack reading
+
+    /// Open-circuit estimate minus the loaded voltage, per cell.
+    float       sagPerCell() const;
+
+    const BatteryConfig& config() const { return _c; }
+
+    /// "B,n=<node>,v=<V>,a=<A>,soc=<%>,lvl=<level>"
+    int         format(char* out, size_t size, const char* node) const;
+
+private:
+    float       ocvSoc(float cellV) const;
+
+    BatteryConfig       _c;
+    filt::Ema<float>    _volts;
+    filt::Ema<float>    _amps;
+    float               _soc        = 0;
+    Level               _level      = NORMAL;
+    uint8_t             _seeded     = 0;        // samples before the charge is seeded
+    uint32_t            _lastMs     = 0;
+    uint32_t            _underMs    = 0;        // since the cell voltage went under the cutoff
+    bool                _under      = false;
+    bool                _present    = false;
+};
+
+struct GovernorLimits {
+    int         pwmPeak;
+    int         pwmStep;
+    float       rateScale;
+};
+
+class PowerGovernor {
+public:
+    /// 'pwmMax' / 'pwmStep' are the motors' limits on a healthy pack.
+    PowerGovernor(int pwmMax, int pwmStep, float sagStartV = 0.20f, float sagFullV = 0.50f,
+                  float floorShare = 0.4f, float recoveryPerS = 0.25f);
+
+    /// Limits for the monitor's latest sample, taken at 'nowMs'.
+    const GovernorLimits& update(const BatteryMonitor& battery, uint32_t nowMs);
+
+    const GovernorLimits& limits() const    { return _limits; }
+
+    /// Share of the telemetry rates to keep at 'level' (also limits().rateScale).
+    static float rateScale(BatteryMonitor::Level level);
+
+private:
+    int             _pwmMax;
+    int             _pwmStep;
+    float           _sagStartV;
+    float           _sagFullV;
+    float           _floor;             // share of pwmMax left at sagFullV
+    float           _recoveryPerS;      // share of pwmMax given back per second
+    float           _share      = 1.0f;
+    uint32_t        _lastMs     = 0;
+    GovernorLimits  _limits;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "CommandArbiter.h"
+
+CommandArbiter::CommandArbiter(const ArbiterSource* sources, uint8_t count)
+    : _sources(sources), _count(count < MAX_SOURCES ? count : MAX_SOURCES) {}
+
+FASTRUN bool CommandArbiter::accept(uint8_t source, uint32_t nowMs) {
+    if (source >= _count) return false;
+    poll(nowMs);
+
+    if (source != _holder) {
+        if (_holder != NONE && _sources[source].priority <= _sources[_holder].priority) {
+            _stats[source].lockedOut++;
+            return false;
+        }
+        const uint8_t previous = _holder;
+        _holder = source;
+        _stats[source].takeovers++;
+        if (_event) _event(TAKEOVER, source, previous, nowMs);
+    }
+    _last   = source;
+    _lastMs = nowMs;
+    _stats[source].accepted++;
+    return true;
+}
+
+FASTRUN void CommandArbiter::poll(uint32_t nowMs) {
+    if (_holder == NONE) return;
+    // Signed: the caller may pass a 'now' read before the last command
+    if ((int32_t)(nowMs - _lastMs) <= (int32_t)_sources[_holder].leaseMs) return;
+    const uint8_t released = _holder;
+    _holder = NONE;
+    if (_event) _event(RELEASE, released, NONE, nowMs);
+}
+
+uint16_t CommandArbiter::failsafeMs() const {
+    if (_last != NONE) return _sources[_last].failsafeMs;
+    uint16_t longest = 0;
+    for (uint8_t s = 0; s < _count; s++) longest = max(longest, _sources[s].failsafeMs);
+    return longest;
+}
+
+const char* CommandArbiter::name(uint8_t source) const {
+    return source < _count ? _sources[source].name : "none";
+}
+
+int CommandArbiter::format(char* out, size_t size, const char* node) const {
+    int len = snprintf(out, size, "C,n=%s,own=%s", node, name(_holder));
+    for (uint8_t s = 0; s < _count && len > 0 && (size_t)len < size; s++) {
+        len += snprintf(out + len, size - len, ",%s=%lu/%lu/%lu", _sources[s].name,
+                        (unsigned long)_stats[s].accepted, (unsigned long)_stats[s].lockedOut,
+                        (unsigned long)_stats[s].takeovers);
+    }
+    return len;
+}
@@ -0,0 +1,82 @@
+/**
+ * COMMAND ARBITER
+ * Several links (USB, radio) feed one command parser. Each source has a
+ * priority and a lease: a command from the holder renews its lease, and
+ * while the lease runs, commands from sources of the same or lower
+ * priority are dropped (locked out). A higher-priority source takes over
+ * on its first command. A holder that stays quiet for its lease lets go,
+ * and the next command from any source takes control.
+ *
+ * Each source also has its own failsafe time, i.e. how long the rover
+ * keeps going on the last command it accepted from that source. Give every
+ * source a lease longer than its failsafe: then control only passes on
+ * silence after the rover has stopped for the old holder.
+ *
+ * Takeovers and releases go to an event callback so the sketch can log
+ * them. Everything is a few comparisons per command; nothing allocates.
+ */
+#ifndef COMMAND_ARBITER_H
+#define COMMAND_ARBITER_H
+
+#include <Arduino.h>
+
+struct ArbiterSource {
+    const char* name;
+    uint8_t     priority;               // higher wins
+    uint16_t    leaseMs;                // quiet time before the source lets go
+    uint16_t    failsafeMs;             // quiet time before the rover stops
+};
+
+struct ArbiterStats {
+    uint32_t    accepted        = 0;
+    uint32_t    lockedOut       = 0;    // dropped while another source held control
+    uint32_t    takeovers       = 0;    // control gained, from nobody or by preemption
+};
+
+class CommandArbiter {
+public:
+    static constexpr uint8_t MAX_SOURCES = 4;
+    static constexpr uint8_t NONE        = 0xFF;
+
+    enum Event : uint8_t { TAKEOVER, RELEASE };
+
+    /// TAKEOVER: 'source' took control from 'other' (NONE if it was free).
+    /// RELEASE: 'source' let go after its lease ran out ('other' is NONE).
+    typedef void (*EventFn)(Event event, uint8_t source, uint8_t other, uint32_t nowMs);
+
+    /// 'sources' is indexed by the caller's source ids and must outlive
+    /// the arbiter (a const table, normally).
+    CommandArbiter(const ArbiterSource* sources, uint8_t count);
+
+    void onEvent(EventFn fn)    { _event = fn; }
+
+    /// A command arrived from 'source'. Returns true if it should run.
+    bool accept(uint8_t source, uint32_t nowMs);
+
+    /// Call every loop: releases a holder whose lease ran out.
+    void poll(uint32_t nowMs);
+
+    /// Source in control, or NONE.
+    uint8_t holder() const      { return _holder; }
+
+    /// Failsafe time of the source that sent the last accepted command
+    /// (the longest of all of them before the first one).
+    uint16_t failsafeMs() const;
+
+    const char*         name(uint8_t source) const;
+    const ArbiterStats& stats(uint8_t source) const { return _stats[source < _count ? source : 0]; }
+
+    /// "C,n=<node>,own=<holder>,<name>=<accepted>/<locked out>/<takeovers>..."
+    int format(char* out, size_t size, const char* node) const;
+
+private:
+    const ArbiterSource*    _sources;
+    uint8_t                 _count;
+    uint8_t                 _holder     = NONE;
+    uint8_t                 _last       = NONE;     // sent the last accepted command
+    uint32_t                _lastMs     = 0;        // ... at this time
+    EventFn                 _event      = nullptr;
+    ArbiterStats            _stats[MAX_SOURCES];
+};
+
+#endif // COMMAND_ARBITER_H
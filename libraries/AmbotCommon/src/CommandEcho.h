@@ -0,0 +1,65 @@
+/**
+ * COMMAND ECHO (stick-to-wheel latency)
+ * Any command line may carry a tag, "<cmd>^<tag>": the sender's clock in
+ * microseconds (decimal, 32 bits; it only has to come back unchanged).
+ * The actuator strips it, runs the command and, once the command has
+ * reached the hardware (the next motor tick for a drive command, the next
+ * servo tick otherwise), prints
+ *
+ *     K,n=<node>,k=<tag>,rx=<us>,ap=<us>
+ *
+ * rx is when the line was complete, ap the tick that applied it (0 if the
+ * command was dropped, e.g. locked out by the arbiter); both are the
+ * node's micros(). Untagged lines are handled exactly as before.
+ *
+ * The actuator's radio stays receive-only, so echoes come back on its USB
+ * port: on the bench the host holds both the ground radio and that port
+ * (Tools/cmd_latency.cpp). Plain C++ so that tool includes this header.
+ */
+#ifndef COMMAND_ECHO_H
+#define COMMAND_ECHO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace echo {
+constexpr char TAG_MARK = '^';
+
+struct Echo {
+    uint32_t    tag;
+    uint32_t    rxUs;
+    uint32_t    apUs;
+};
+
+/// Strip a trailing "^<tag>" from 'line'. Returns false (line untouched)
+/// when there is none.
+inline bool splitTag(char* line, uint32_t* tag) {
+    char* mark = strrchr(line, TAG_MARK);
+    if (!mark || mark[1] == '\0') return false;
+    char*               end;
+    const unsigned long v = strtoul(mark + 1, &end, 10);
+    if (*end != '\0') return false;
+    *mark = '\0';
+    *tag  = (uint32_t)v;
+    return true;
+}
+
+inline int format(char* out, size_t size, const char* node, const Echo& e) {
+    return snprintf(out, size, "K,n=%s,k=%lu,rx=%lu,ap=%lu", node, (unsigned long)e.tag,
+                    (unsigned long)e.rxUs, (unsigned long)e.apUs);
+}
+
+/// Parse a "K,..." line. Returns false for anything else.
+inline bool parse(const char* line, Echo* e) {
+    unsigned long k, rx, ap;
+    if (sscanf(line, "K,n=%*[^,],k=%lu,rx=%lu,ap=%lu", &k, &rx, &ap) != 3) return false;
+    e->tag  = (uint32_t)k;
+    e->rxUs = (uint32_t)rx;
+    e->apUs = (uint32_t)ap;
+    return true;
+}
+} // namespace echo
+
+#endif // COMMAND_ECHO_H
@@ -0,0 +1,203 @@
+#include "EventLink.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+constexpr uint8_t WINDOW = 32;          // seqs an ack bitmap can cover
+
+/// Severity class of a SystemCode: 1 state, 2 sensor, 4 warning, 5 fault.
+inline uint8_t severity(uint16_t code) { return (uint8_t)(code / 1000); }
+
+/// a comes before b, modulo the 16-bit wrap.
+inline bool before(uint16_t a, uint16_t b) { return (int16_t)(a - b) < 0; }
+
+uint8_t crc8(const char* s, size_t n) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= (uint8_t)s[i];
+        for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+/// Append "*CC" to the 'n' bytes in 'out'. Returns the new length.
+int seal(char* out, size_t size, int n) {
+    if (n <= 0 || n + 3 >= (int)size) return 0;
+    return n + snprintf(out + n, size - n, "*%02X", crc8(out, n));
+}
+
+/// Check and strip the "*CC" suffix (in a copy). Returns false on mismatch.
+bool unseal(const char* line, char* body, size_t size) {
+    const char* star = strrchr(line, '*');
+    if (!star || star[1] == '\0' || star[2] == '\0' || star[3] != '\0') return false;
+    const size_t n = star - line;
+    if (n >= size) return false;
+    char* end = nullptr;
+    const unsigned long crc = strtoul(star + 1, &end, 16);
+    if (*end != '\0' || crc != crc8(line, n)) return false;
+    memcpy(body, line, n);
+    body[n] = '\0';
+    return true;
+}
+}
+
+// ================================================================
+// SENDER (rover side)
+// ================================================================
+EventSender::EventSender(uint16_t bytesPerS, uint16_t burst)
+    : _rate(bytesPerS), _burst(burst), _tokens(burst) {
+    memset(_events, 0, sizeof(_events));
+}
+
+FLASHMEM void EventSender::begin(uint16_t epoch) {
+    _epoch = epoch;
+}
+
+void EventSender::post(uint16_t code, uint32_t nowMs) {
+    _stats.posted++;
+    Event* slot = nullptr;
+    for (uint8_t i = 0; i < QUEUE && !slot; i++) {
+        if (!_events[i].used) slot = &_events[i];
+    }
+    if (!slot) {
+        // Full: the least severe, oldest event goes (possibly this one)
+        Event* victim = &_events[0];
+        for (uint8_t i = 1; i < QUEUE; i++) {
+            Event& e = _events[i];
+            if (severity(e.code) < severity(victim->code) ||
+                (severity(e.code) == severity(victim->code) && before(e.seq, victim->seq))) {
+                victim = &e;
+            }
+        }
+        _stats.dropped++;
+        if (severity(code) < severity(victim->code)) return;
+        victim->used = false;
+        _count--;
+        slot = victim;
+    }
+    *slot = {_nextSeq++, code, nowMs, nowMs, RTO_MIN_MS, true, false};
+    if (_nextSeq == 0) _nextSeq = 1;
+    _count++;
+}
+
+FASTRUN int EventSender::poll(uint32_t nowMs, char* out, size_t size) {
+    _tokens += _rate * (float)(nowMs - _lastMs) / 1000.0f;
+    if (_tokens > _burst) _tokens = _burst;
+    _lastMs = nowMs;
+    if (_count == 0) return 0;
+
+    // Oldest due event first
+    Event* due = nullptr;
+    for (uint8_t i = 0; i < QUEUE; i++) {
+        Event& e = _events[i];
+        if (!e.used || (int32_t)(nowMs - e.nextMs) < 0) continue;
+        if (!due || before(e.seq, due->seq)) due = &e;
+    }
+    if (!due) return 0;
+
+    const int n = seal(out, size, snprintf(out, size, "E,%u,%u,%06u,%lu", (unsigned)_epoch,
+                                           (unsigned)due->seq, (unsigned)due->code,
+                                           (unsigned long)due->tMs));
+    if (n <= 0 || n + 1 > _tokens) return 0;
+    _tokens -= n + 1;
+
+    if (due->sent) _stats.retransmits++;
+    _stats.sent++;
+    due->sent   = true;
+    due->nextMs = nowMs + due->rtoMs;
+    due->rtoMs  = (uint16_t)min((uint32_t)due->rtoMs * 2, (uint32_t)RTO_MAX_MS);
+    return n;
+}
+
+FASTRUN bool EventSender::onLine(const char* raw) {
+    if (raw[0] != 'A' || raw[1] != ',') return false;
+    char line[48];
+    if (!unseal(raw, line, sizeof(line))) {
+        _stats.badAcks++;
+        return false;
+    }
+    char*          p      = nullptr;
+    unsigned long  epoch  = strtoul(line + 2, &p, 10);
+    if (*p != ',' || epoch != _epoch) return true;      // another boot's ack
+    unsigned long  cum    = strtoul(p + 1, &p, 10);
+    if (*p != ',') return true;
+    unsigned long  bitmap = strtoul(p + 1, &p, 16);
+    if (*p != '\0') return false;
+
+    for (uint8_t i = 0; i < QUEUE; i++) {
+        Event& e = _events[i];
+        if (!e.used) continue;
+        const int16_t d = (int16_t)(e.seq - (uint16_t)cum);
+        if (d <= 0 || (d <= WINDOW && (bitmap >> (d - 1)) & 1UL)) release(e);
+    }
+    return true;
+}
+
+void EventSender::release(Event& e) {
+    e.used = false;
+    _count--;
+    _stats.acked++;
+}
+
+// ================================================================
+// RECEIVER (ground side)
+// ================================================================
+bool EventReceiver::onLine(const char* raw, uint16_t* code, uint32_t* tMs) {
+    if (raw[0] != 'E' || raw[1] != ',') return false;
+    char line[48];
+    if (!unseal(raw, line, sizeof(line))) {
+        _badCrc++;
+        return false;
+    }
+    char*         p     = nullptr;
+    unsigned long epoch = strtoul(line + 2, &p, 10);
+    if (*p != ',') return false;
+    unsigned long seq   = strtoul(p + 1, &p, 10);
+    if (*p != ',' || seq == 0 || seq > 0xFFFF) return false;
+    unsigned long c     = strtoul(p + 1, &p, 10);
+    if (*p != ',') return false;
+    unsigned long t     = strtoul(p + 1, &p, 10);
+    if (*p != '\0') return false;
+
+    if (!_synced || epoch != _epoch) {                  // rover rebooted
+        _synced = true;
+        _epoch  = (uint16_t)epoch;
+        _cum    = 0;
+        _bitmap = 0;
+    }
+    _ackDue = true;
+
+    int16_t d = (int16_t)((uint16_t)seq - _cum);
+    if (d <= 0) {
+        _duplicates++;
+        return false;
+    }
+    if (d > WINDOW) {
+        // Too far ahead (an evicted or long-lost seq): give up on the oldest
+        const uint16_t shift = d - WINDOW;
+        _bitmap = shift >= WINDOW ? 0 : _bitmap >> shift;
+        _cum   += shift;
+        d       = WINDOW;
+    }
+    const uint32_t bit = 1UL << (d - 1);
+    if (_bitmap & bit) {
+        _duplicates++;
+        return false;
+    }
+    _bitmap |= bit;
+    while (_bitmap & 1UL) {
+        _bitmap >>= 1;
+        _cum++;
+    }
+    _unique++;
+    if (code) *code = (uint16_t)c;
+    if (tMs)  *tMs  = (uint32_t)t;
+    return true;
+}
+
+int EventReceiver::ackLine(char* out, size_t size) {
+    _ackDue = false;
+    return seal(out, size, snprintf(out, size, "A,%u,%u,%lx", (unsigned)_epoch, (unsigned)_cum,
+                                    (unsigned long)_bitmap));
+}
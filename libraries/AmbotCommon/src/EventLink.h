@@ -0,0 +1,115 @@
+/**
+ * ACKNOWLEDGED EVENT CHANNEL
+ * SystemCode events sent once over a lossy radio go missing without anyone
+ * noticing. Here every event carries a sequence number and stays queued on
+ * the rover until the ground acknowledges it (selective repeat):
+ *
+ * Event (rover -> ground):  E,<epoch>,<seq>,<code>,<t_ms>*<crc>
+ * Ack   (ground -> rover):  A,<epoch>,<cum>,<bitmap>*<crc>
+ *     cum     every seq up to and including it has arrived
+ *     bitmap  hex, bit i set = seq cum+1+i has arrived as well
+ *     crc     CRC-8 (poly 0x07) of everything before '*', two hex digits
+ *
+ * The CRC matters: a flipped digit must neither invent an event nor ack
+ * one that never arrived. Lines that fail it are ignored.
+ *
+ * 'epoch' changes on every boot, so the ground restarts its window instead
+ * of taking a fresh seq 1 for a duplicate. Unacked events are resent with
+ * exponential backoff, paced by a token bucket so they never take more
+ * than a small share of the link from telemetry. When the queue is full
+ * the least severe, oldest event makes room.
+ */
+#ifndef EVENT_LINK_H
+#define EVENT_LINK_H
+
+#include <Arduino.h>
+
+struct EventStats {
+    uint32_t    posted          = 0;
+    uint32_t    sent            = 0;    // transmissions, first tries included
+    uint32_t    retransmits     = 0;
+    uint32_t    acked           = 0;
+    uint32_t    dropped         = 0;    // pushed out of a full queue
+    uint32_t    badAcks         = 0;    // failed the CRC
+};
+
+/// Rover side: bounded queue of unacknowledged events.
+class EventSender {
+public:
+    static constexpr uint8_t    QUEUE           = 16;
+    static constexpr uint16_t   RTO_MIN_MS      = 1000;
+    static constexpr uint16_t   RTO_MAX_MS      = 16000;
+
+    /// 'bytesPerS' caps the event share of the link, 'burst' the bytes that
+    /// may go out back to back.
+    explicit EventSender(uint16_t bytesPerS = 48, uint16_t burst = 64);
+
+    /// Pick a per-boot epoch (any value that differs between boots).
+    void begin(uint16_t epoch);
+
+    /// Queue an event for reliable delivery.
+    void post(uint16_t code, uint32_t nowMs);
+
+    /// Next line to transmit, if one is due and the bucket allows it.
+    /// Returns its length, 0 when nothing goes out this time.
+    int poll(uint32_t nowMs, char* out, size_t size);
+
+    /// Feed every line heard from the ground. Returns true for valid acks.
+    bool onLine(const char* line);
+
+    uint8_t             pending() const     { return _count; }
+    const EventStats&   stats() const       { return _stats; }
+
+private:
+    struct Event {
+        uint16_t    seq;
+        uint16_t    code;
+        uint32_t    tMs;
+        uint32_t    nextMs;
+        uint16_t    rtoMs;
+        bool        used;
+        bool        sent;
+    };
+
+    void release(Event& e);
+
+    Event       _events[QUEUE];
+    uint8_t     _count      = 0;
+    uint16_t    _epoch      = 0;
+    uint16_t    _nextSeq    = 1;
+    uint16_t    _rate;
+    uint16_t    _burst;
+    float       _tokens;
+    uint32_t    _lastMs     = 0;
+    EventStats  _stats;
+};
+
+/// Ground side: duplicate filter and ack generator for one rover.
+class EventReceiver {
+public:
+    /// Parse an 'E' line. Returns true (and fills code/tMs) for an event
+    /// seen for the first time; duplicates and other lines return false.
+    bool onLine(const char* line, uint16_t* code = nullptr, uint32_t* tMs = nullptr);
+
+    /// An ack is owed since the last ackLine().
+    bool ackDue() const     { return _ackDue; }
+
+    /// Write the ack for everything received so far. Returns the length.
+    int ackLine(char* out, size_t size);
+
+    uint32_t    unique() const      { return _unique; }
+    uint32_t    duplicates() const  { return _duplicates; }
+    uint32_t    badCrc() const      { return _badCrc; }
+
+private:
+    bool        _synced     = false;
+    uint16_t    _epoch      = 0;
+    uint16_t    _cum        = 0;    // seq 0 is never used
+    uint32_t    _bitmap     = 0;
+    bool        _ackDue     = false;
+    uint32_t    _unique     = 0;
+    uint32_t    _duplicates = 0;
+    uint32_t    _badCrc     = 0;
+};
+
+#endif // EVENT_LINK_H
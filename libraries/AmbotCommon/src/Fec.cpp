@@ -0,0 +1,276 @@
+#include "Fec.h"
+
+#include <string.h>
+
+namespace {
+// ================================================================
+// GF(256) TABLES
+// exp[] is doubled so exp[log a + log b] needs no modulo. Built at
+// compile time; the 1 KiB stays in RAM (DTCM), not PROGMEM, because the
+// decoder reads it in every inner loop.
+// ================================================================
+struct GfTables {
+    uint8_t exp[512];
+    uint8_t log[256];
+
+    constexpr GfTables() : exp(), log() {
+        unsigned x = 1;
+        for (unsigned i = 0; i < 255; i++) {
+            exp[i]  = (uint8_t)x;
+            log[x]  = (uint8_t)i;
+            x <<= 1;
+            if (x & 0x100) x ^= 0x11D;
+        }
+        for (unsigned i = 255; i < 512; i++) exp[i] = exp[i - 255];
+    }
+};
+
+constexpr GfTables GF;
+
+constexpr uint8_t gfMul(uint8_t a, uint8_t b) {
+    return (a && b) ? GF.exp[GF.log[a] + GF.log[b]] : 0;
+}
+
+constexpr uint8_t gfDiv(uint8_t a, uint8_t b) {
+    return a ? GF.exp[GF.log[a] + 255 - GF.log[b]] : 0;
+}
+
+/// Generator (x - a^0)(x - a^1)...(x - a^(N-1)), highest degree first.
+template <uint8_t N>
+struct Generator {
+    uint8_t g[N + 1];
+
+    constexpr Generator() : g() {
+        g[0] = 1;
+        for (uint8_t i = 0; i < N; i++) {
+            // multiply by (x + a^i): new[j] = g[j] + a^i * g[j-1]
+            for (int j = i + 1; j > 0; j--) g[j] ^= gfMul(g[j - 1], GF.exp[i]);
+        }
+    }
+};
+
+constexpr Generator<fec::HEADER_PARITY> GEN_HEADER;
+constexpr Generator<fec::PARITY>        GEN_BLOCK;
+
+constexpr uint8_t MAX_NSYM = fec::PARITY;
+
+const uint8_t* generator(uint8_t nsym) {
+    return nsym == fec::PARITY ? GEN_BLOCK.g : nsym == fec::HEADER_PARITY ? GEN_HEADER.g : nullptr;
+}
+
+/// Block 'b' of a payload of 'n' bytes: data length.
+inline uint8_t blockData(size_t n, size_t b) {
+    const size_t left = n - b * fec::BLOCK_DATA;
+    return (uint8_t)(left < fec::BLOCK_DATA ? left : fec::BLOCK_DATA);
+}
+}
+
+namespace fec {
+
+// ================================================================
+// REED-SOLOMON
+// Codewords are highest degree first: cw[0] is the coefficient of
+// x^(n-1), so position i carries the locator a^(n-1-i).
+// ================================================================
+FASTRUN void rsEncode(const uint8_t* data, size_t k, uint8_t* parity, uint8_t nsym) {
+    const uint8_t* g = generator(nsym);
+    memset(parity, 0, nsym);
+    if (!g) return;
+    for (size_t i = 0; i < k; i++) {
+        const uint8_t coef = data[i] ^ parity[0];
+        memmove(parity, parity + 1, nsym - 1);
+        parity[nsym - 1] = 0;
+        if (!coef) continue;
+        const unsigned lc = GF.log[coef];
+        for (uint8_t j = 0; j < nsym; j++) {
+            if (g[j + 1]) parity[j] ^= GF.exp[GF.log[g[j + 1]] + lc];
+        }
+    }
+}
+
+FASTRUN int rsDecode(uint8_t* cw, size_t n, uint8_t nsym) {
+    if (nsym > MAX_NSYM || n > 255 || n <= nsym) return -1;
+
+    // Syndromes S_j = c(a^j), Horner over the codeword
+    uint8_t s[MAX_NSYM];
+    uint8_t any = 0;
+    for (uint8_t j = 0; j < nsym; j++) {
+        uint8_t v = 0;
+        for (size_t i = 0; i < n; i++) {
+            v = (v ? GF.exp[GF.log[v] + j] : 0) ^ cw[i];
+        }
+        s[j] = v;
+        any |= v;
+    }
+    if (!any) return 0;
+
+    // Berlekamp-Massey: error locator lambda (lowest degree first)
+    uint8_t lambda[MAX_NSYM + 1] = {1};
+    uint8_t prev[MAX_NSYM + 1]   = {1};
+    uint8_t L = 0, m = 1, b = 1;
+    for (uint8_t r = 0; r < nsym; r++) {
+        uint8_t d = s[r];
+        for (uint8_t i = 1; i <= L; i++) d ^= gfMul(lambda[i], s[r - i]);
+        if (!d) { m++; continue; }
+
+        uint8_t t[MAX_NSYM + 1];
+        memcpy(t, lambda, sizeof(t));
+        const uint8_t coef = gfDiv(d, b);
+        for (uint8_t i = 0; i + m <= nsym; i++) lambda[i + m] ^= gfMul(coef, prev[i]);
+        if (2 * L <= r) {
+            L = r + 1 - L;
+            memcpy(prev, t, sizeof(prev));
+            b = d;
+            m = 1;
+        } else {
+            m++;
+        }
+    }
+    if (2 * L > nsym) return -1;
+
+    // Evaluator omega = S * lambda mod x^nsym
+    uint8_t omega[MAX_NSYM];
+    for (uint8_t i = 0; i < nsym; i++) {
+        uint8_t v = 0;
+        for (uint8_t j = 0; j <= i && j <= L; j++) v ^= gfMul(lambda[j], s[i - j]);
+        omega[i] = v;
+    }
+
+    // Chien search over the (possibly shortened) codeword, Forney for values
+    uint8_t found = 0;
+    uint8_t pos[MAX_NSYM / 2];
+    uint8_t val[MAX_NSYM / 2];
+    for (size_t i = 0; i < n; i++) {
+        const unsigned xLog    = (unsigned)(n - 1 - i);     // X = a^xLog
+        const unsigned xInvLog = (255 - xLog) % 255;        // X^-1
+
+        uint8_t q = 0;                                      // lambda(X^-1)
+        for (int j = L; j >= 0; j--) q = gfMul(q, GF.exp[xInvLog]) ^ lambda[j];
+        if (q) continue;
+        if (found == L) return -1;
+
+        uint8_t num = 0;                                    // omega(X^-1)
+        for (int j = nsym - 1; j >= 0; j--) num = gfMul(num, GF.exp[xInvLog]) ^ omega[j];
+        uint8_t den = 0;                                    // lambda'(X^-1): odd terms
+        for (int j = L & ~1; j >= 0; j -= 2) {
+            den = gfMul(den, GF.exp[(2 * xInvLog) % 255]) ^ lambda[j + 1];
+        }
+        if (!den) return -1;
+        pos[found] = (uint8_t)i;
+        val[found] = gfMul(GF.exp[xLog], gfDiv(num, den));
+        found++;
+    }
+    if (found != L) return -1;                              // roots outside the codeword
+
+    for (uint8_t e = 0; e < found; e++) cw[pos[e]] ^= val[e];
+    return found;
+}
+
+// ================================================================
+// FRAMES
+// ================================================================
+FASTRUN size_t encode(const uint8_t* payload, size_t n, uint8_t seq, uint8_t* out, size_t outSize) {
+    if (n == 0 || n > MAX_PAYLOAD || outSize < frameSize(n)) return 0;
+
+    size_t o = 0;
+    out[o++] = SYNC;
+    out[o++] = (uint8_t)n;
+    out[o++] = seq;
+    rsEncode(out + 1, HEADER_DATA, out + o, HEADER_PARITY);
+    o += HEADER_PARITY;
+
+    const size_t blocks = (n + BLOCK_DATA - 1) / BLOCK_DATA;
+    uint8_t parity[MAX_BLOCKS][PARITY];
+    for (size_t b = 0; b < blocks; b++) {
+        rsEncode(payload + b * BLOCK_DATA, blockData(n, b), parity[b], PARITY);
+    }
+
+    // Column by column: a burst of B bytes costs each block about B/blocks
+    for (size_t col = 0; col < BLOCK_DATA + PARITY; col++) {
+        for (size_t b = 0; b < blocks; b++) {
+            const uint8_t k = blockData(n, b);
+            if (col < k)                out[o++] = payload[b * BLOCK_DATA + col];
+            else if (col < (size_t)k + PARITY)  out[o++] = parity[b][col - k];
+        }
+    }
+    return o;
+}
+}
+
+// ================================================================
+// DECODER
+// ================================================================
+FASTRUN FecDecoder::Result FecDecoder::feed(uint8_t b) {
+    switch (_state) {
+    case IDLE:
+        if (b != fec::SYNC) return TEXT;
+        _state  = HEADER;
+        _got    = 0;
+        return BUSY;
+
+    case HEADER:
+        _hdr[_got++] = b;
+        if (_got < HEADER_SIZE) return BUSY;
+        {
+            const int fixed = fec::rsDecode(_hdr, HEADER_SIZE, fec::HEADER_PARITY);
+            if (fixed < 0 || _hdr[0] == 0) {
+                _stats.uncorrectable++;
+                _state = IDLE;
+                return BAD;
+            }
+            _len    = _hdr[0];
+            _seq    = _hdr[1];
+            _need   = (uint16_t)(fec::frameSize(_len) - 1 - HEADER_SIZE);
+            _got    = 0;
+            _hdrFixed = (uint8_t)fixed;
+            _state  = BODY;
+        }
+        return BUSY;
+
+    case BODY:
+        _raw[_got++] = b;
+        if (_got < _need) return BUSY;
+        _state = IDLE;
+        return finish();
+    }
+    return BUSY;
+}
+
+FASTRUN FecDecoder::Result FecDecoder::finish() {
+    const size_t blocks = (_len + fec::BLOCK_DATA - 1) / fec::BLOCK_DATA;
+    uint8_t      cw[fec::MAX_BLOCKS][fec::BLOCK_DATA + fec::PARITY];
+
+    // Undo the column order in one pass
+    size_t i = 0;
+    for (size_t col = 0; col < fec::BLOCK_DATA + fec::PARITY; col++) {
+        for (size_t b = 0; b < blocks; b++) {
+            if (col < (size_t)blockData(_len, b) + fec::PARITY) cw[b][col] = _raw[i++];
+        }
+    }
+
+    uint32_t fixed = _hdrFixed;
+    for (size_t b = 0; b < blocks; b++) {
+        const uint8_t k = blockData(_len, b);
+        const int     r = fec::rsDecode(cw[b], k + fec::PARITY, fec::PARITY);
+        if (r < 0) {
+            _stats.uncorrectable++;
+            return BAD;
+        }
+        fixed += r;
+        memcpy(_body + b * fec::BLOCK_DATA, cw[b], k);
+    }
+    _body[_len] = '\0';
+
+    _stats.frames++;
+    if (fixed) {
+        _stats.corrected++;
+        _stats.bytesFixed += fixed;
+    }
+    return FRAME;
+}
+
+int FecDecoder::format(char* out, size_t size, const char* node) const {
+    return snprintf(out, size, "F,n=%s,ok=%lu,fix=%lu,sym=%lu,bad=%lu", node,
+                    (unsigned long)_stats.frames, (unsigned long)_stats.corrected,
+                    (unsigned long)_stats.bytesFixed, (unsigned long)_stats.uncorrectable);
+}
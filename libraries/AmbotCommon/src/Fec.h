@@ -0,0 +1,91 @@
+/**
+ * FORWARD ERROR CORRECTION FOR RADIO FRAMES
+ * Reed-Solomon over GF(256) (poly 0x11D, table-driven), applied to small
+ * blocks that are byte-interleaved so an APC220 error burst is spread
+ * across every block of a frame instead of wiping out one.
+ *
+ * Frame on air:
+ *     SYNC (0xB5) | header RS(6,2): len, seq | interleaved body
+ * Body: the payload in blocks of up to BLOCK_DATA bytes, each followed by
+ * PARITY parity bytes (corrects PARITY/2 byte errors per block), sent
+ * column by column: byte 0 of every block, then byte 1, ...
+ *
+ * Plain text is 7-bit ASCII, so a receiver can take frames and ordinary
+ * lines from the same stream: FecDecoder passes non-frame bytes through.
+ */
+#ifndef FEC_H
+#define FEC_H
+
+#include <Arduino.h>
+
+namespace fec {
+constexpr uint8_t   SYNC            = 0xB5;
+constexpr uint8_t   HEADER_DATA     = 2;
+constexpr uint8_t   HEADER_PARITY   = 4;
+constexpr uint8_t   BLOCK_DATA      = 32;
+constexpr uint8_t   PARITY          = 8;
+constexpr size_t    MAX_PAYLOAD     = 255;
+constexpr size_t    MAX_BLOCKS      = (MAX_PAYLOAD + BLOCK_DATA - 1) / BLOCK_DATA;
+constexpr size_t    MAX_FRAME       = 1 + HEADER_DATA + HEADER_PARITY + MAX_PAYLOAD + MAX_BLOCKS * PARITY;
+
+/// Bytes on air for a payload of 'n' bytes.
+constexpr size_t frameSize(size_t n) {
+    return 1 + HEADER_DATA + HEADER_PARITY + n + ((n + BLOCK_DATA - 1) / BLOCK_DATA) * PARITY;
+}
+
+/// Systematic RS parity of 'data' (nsym parity bytes appended by caller).
+void rsEncode(const uint8_t* data, size_t k, uint8_t* parity, uint8_t nsym);
+
+/// Correct codeword 'cw' (k data + nsym parity) in place. Returns the
+/// number of bytes corrected, or -1 if the errors are beyond nsym/2.
+int rsDecode(uint8_t* cw, size_t n, uint8_t nsym);
+
+/// Build a frame. Returns its length, or 0 if 'n' or 'outSize' is too big.
+size_t encode(const uint8_t* payload, size_t n, uint8_t seq, uint8_t* out, size_t outSize);
+}
+
+struct FecStats {
+    uint32_t    frames          = 0;    // decoded (possibly after correction)
+    uint32_t    corrected       = 0;    // frames that needed correction
+    uint32_t    bytesFixed      = 0;
+    uint32_t    uncorrectable   = 0;    // header or any block beyond repair
+};
+
+/// Byte-at-a-time receiver: frames are collected and corrected, anything
+/// else is handed back as plain text.
+class FecDecoder {
+public:
+    enum Result : uint8_t { BUSY, TEXT, FRAME, BAD };
+
+    /// BUSY: byte consumed by a frame. TEXT: not part of a frame, use it
+    /// as before. FRAME: payload() holds a corrected frame. BAD: dropped.
+    Result feed(uint8_t b);
+
+    const uint8_t*  payload() const     { return _body; }
+    size_t          length() const      { return _len; }
+    uint8_t         seq() const         { return _seq; }
+    const FecStats& stats() const       { return _stats; }
+
+    /// Counter line for logs and the ground, e.g.
+    /// "F,n=ACT,ok=120,fix=9,sym=14,bad=1".
+    int format(char* out, size_t size, const char* node) const;
+
+private:
+    static constexpr uint8_t HEADER_SIZE = fec::HEADER_DATA + fec::HEADER_PARITY;
+
+    Result finish();
+
+    enum State : uint8_t { IDLE, HEADER, BODY };
+    State       _state      = IDLE;
+    uint8_t     _hdr[HEADER_SIZE];
+    uint16_t    _got        = 0;
+    uint16_t    _need       = 0;
+    uint8_t     _len        = 0;
+    uint8_t     _seq        = 0;
+    uint8_t     _hdrFixed   = 0;
+    uint8_t     _raw[fec::MAX_FRAME];
+    uint8_t     _body[fec::MAX_PAYLOAD + 1];
+    FecStats    _stats;
+};
+
+#endif // FEC_H
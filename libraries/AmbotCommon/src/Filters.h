@@ -0,0 +1,233 @@
+/**
+ * SIGNAL FILTERS
+ * One object per channel so each can be tuned on its own:
+ *   Ema<T>              exponential moving average (one pole)
+ *   Biquad<T>           second order section: low-pass or notch
+ *   MovingMedian<T, N>  median of the last N samples (spike rejection)
+ *   ScalarKalman<T>     one-state Kalman, same rule as SimpleKalmanFilter
+ *   DeadbandIntegrator<T>  integral outside a deadband, decay inside it
+ *
+ * T is float or fixed point (Q16 below). Coefficients are designed with
+ * constexpr functions, so a filter declared with constants costs nothing
+ * at boot:
+ *
+ *     constexpr filt::BiquadCoeffs LP = filt::lowPass(5.0f, 100.0f);
+ *     filt::Biquad<float> accelLp(LP);
+ *
+ * Header only: the update calls are a handful of multiplies and inline
+ * into the loop that calls them.
+ */
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filt {
+
+// ================================================================
+// FIXED POINT
+// ================================================================
+/// Signed fixed point with FRAC fraction bits in an int32 (Q16: +-32768,
+/// 1.5e-5 resolution). Products and quotients go through int64.
+template <int FRAC>
+struct Fixed {
+    int32_t raw = 0;
+
+    constexpr Fixed() = default;
+    constexpr Fixed(float v) : raw((int32_t)(v * (float)(1L << FRAC) + (v >= 0.0f ? 0.5f : -0.5f))) {}
+    constexpr Fixed(int v) : raw((int32_t)v * (1L << FRAC)) {}
+    static constexpr Fixed fromRaw(int32_t r) { Fixed f; f.raw = r; return f; }
+    constexpr explicit operator float() const { return (float)raw / (float)(1L << FRAC); }
+
+    friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(a.raw + b.raw); }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(a.raw - b.raw); }
+    friend constexpr Fixed operator*(Fixed a, Fixed b) { return fromRaw((int32_t)(((int64_t)a.raw * b.raw) >> FRAC)); }
+    friend constexpr Fixed operator/(Fixed a, Fixed b) {
+        return fromRaw(b.raw ? (int32_t)(((int64_t)a.raw * (1LL << FRAC)) / b.raw) : 0);
+    }
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+};
+using Q16 = Fixed<16>;
+
+// ================================================================
+// COEFFICIENT DESIGN (constexpr)
+// ================================================================
+namespace detail {
+constexpr double PI_D = 3.14159265358979323846;
+
+/// Taylor series after reduction to [-pi, pi]; float-accurate there.
+constexpr double sin(double x) {
+    while (x > PI_D) x -= 2.0 * PI_D;
+    while (x < -PI_D) x += 2.0 * PI_D;
+    double term = x, sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum  += term;
+    }
+    return sum;
+}
+constexpr double cos(double x) { return sin(x + PI_D / 2.0); }
+}
+
+/// EMA weight for a one-pole low-pass at 'cutoffHz' sampled at 'sampleHz'.
+constexpr float emaAlpha(float cutoffHz, float sampleHz) {
+    const double dt = 1.0 / sampleHz;
+    const double rc = 1.0 / (2.0 * detail::PI_D * cutoffHz);
+    return (float)(dt / (rc + dt));
+}
+
+/// Normalized direct-form coefficients (a0 = 1).
+struct BiquadCoeffs {
+    float b0, b1, b2, a1, a2;
+};
+
+/// Butterworth low-pass by default (q = 1/sqrt(2)); RBJ cookbook.
+constexpr BiquadCoeffs lowPass(float cutoffHz, float sampleHz, float q = 0.70710678f) {
+    const double w0 = 2.0 * detail::PI_D * cutoffHz / sampleHz;
+    const double c  = detail::cos(w0);
+    const double al = detail::sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + al;
+    return {(float)((1.0 - c) / 2.0 / a0), (float)((1.0 - c) / a0), (float)((1.0 - c) / 2.0 / a0),
+            (float)(-2.0 * c / a0), (float)((1.0 - al) / a0)};
+}
+
+/// Rejects 'centerHz' (e.g. a motor vibration line); q sets the width.
+constexpr BiquadCoeffs notch(float centerHz, float sampleHz, float q = 5.0f) {
+    const double w0 = 2.0 * detail::PI_D * centerHz / sampleHz;
+    const double c  = detail::cos(w0);
+    const double al = detail::sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + al;
+    return {(float)(1.0 / a0), (float)(-2.0 * c / a0), (float)(1.0 / a0), (float)(-2.0 * c / a0),
+            (float)((1.0 - al) / a0)};
+}
+
+// ================================================================
+// FILTERS
+// ================================================================
+/// y = alpha * x + (1 - alpha) * y. Written this way (not y += alpha *
+/// (x - y)) so only one multiply-add sits on the sample-to-sample chain.
+template <typename T>
+class Ema {
+public:
+    constexpr explicit Ema(float alpha, T initial = T(0))
+        : _alpha(T(alpha)), _keep(T(1.0f - alpha)), _y(initial) {}
+
+    T update(T x) {
+        _y = _alpha * x + _keep * _y;
+        return _y;
+    }
+    void    set(T y)            { _y = y; }
+    T       value() const       { return _y; }
+
+private:
+    T _alpha;
+    T _keep;
+    T _y;
+};
+
+/// Transposed direct form II: two state variables, five multiplies.
+template <typename T>
+class Biquad {
+public:
+    constexpr explicit Biquad(const BiquadCoeffs& k)
+        : _b0(T(k.b0)), _b1(T(k.b1)), _b2(T(k.b2)), _a1(T(k.a1)), _a2(T(k.a2)) {}
+
+    T update(T x) {
+        const T y = _b0 * x + _z1;
+        _z1 = _b1 * x - _a1 * y + _z2;
+        _z2 = _b2 * x - _a2 * y;
+        return y;
+    }
+    void reset() { _z1 = _z2 = T(0); }
+
+private:
+    T _b0, _b1, _b2, _a1, _a2;
+    T _z1 = T(0);
+    T _z2 = T(0);
+};
+
+/// Median of the last N samples (fewer until N have arrived). Keeps the
+/// window sorted, so an update is one removal and one insertion: O(N).
+template <typename T, size_t N>
+class MovingMedian {
+    static_assert(N > 0 && N < 64, "window of 1..63 samples");
+
+public:
+    T update(T x) {
+        size_t i = _count;
+        if (_count == N) {
+            // Drop the oldest sample from the sorted copy
+            const T old = _window[_head];
+            for (i = 0; i < N - 1 && (_sorted[i] < old || old < _sorted[i]); i++) {}
+            for (; i < N - 1; i++) _sorted[i] = _sorted[i + 1];
+            i = N - 1;
+        } else {
+            _count++;
+        }
+        _window[_head] = x;
+        _head          = (_head + 1) % N;
+        for (; i > 0 && x < _sorted[i - 1]; i--) _sorted[i] = _sorted[i - 1];
+        _sorted[i] = x;
+        return _sorted[_count / 2];
+    }
+    T value() const { return _count ? _sorted[_count / 2] : T(0); }
+
+private:
+    T       _window[N] = {};
+    T       _sorted[N] = {};
+    size_t  _head      = 0;
+    size_t  _count     = 0;
+};
+
+/// The SimpleKalmanFilter rule: the estimate error shrinks with each gain
+/// and grows with how far the estimate moved, times the process noise.
+template <typename T>
+class ScalarKalman {
+public:
+    constexpr ScalarKalman(float measureError, float estimateError, float processNoise)
+        : _measure(T(measureError)), _estimate(T(estimateError)), _q(T(processNoise)) {}
+
+    T update(T z) {
+        const T gain = _estimate / (_estimate + _measure);
+        const T x    = _x + gain * (z - _x);
+        const T step = _x < x ? x - _x : _x - x;
+        _estimate    = (T(1) - gain) * _estimate + step * _q;
+        _x           = x;
+        return _x;
+    }
+    T value() const { return _x; }
+
+private:
+    T _measure;
+    T _estimate;
+    T _q;
+    T _x = T(0);
+};
+
+/// Integrates a rate (acceleration into speed) while it is outside
+/// +-deadband; inside it the output decays by 'decay' per sample, so a
+/// resting sensor's bias cannot wind the integral up.
+template <typename T>
+class DeadbandIntegrator {
+public:
+    constexpr DeadbandIntegrator(float deadband, float decay) : _band(T(deadband)), _decay(T(decay)) {}
+
+    T update(T x, T dt) {
+        if (_band < x || x < T(0) - _band) _y = _y + x * dt;
+        else                                _y = _decay * _y;
+        return _y;
+    }
+    void    set(T y)            { _y = y; }
+    T       value() const       { return _y; }
+
+private:
+    T _band;
+    T _decay;
+    T _y = T(0);
+};
+
+} // namespace filt
+
+#endif // FILTERS_H
@@ -0,0 +1,136 @@
+#include "HealthMonitor.h"
+
+#if defined(__IMXRT1062__)
+// imxrt1062_t41.ld: the stack grows down from _estack towards the end of
+// DTCM .bss; the heap lives in OCRAM between _heap_start and _heap_end.
+extern unsigned long _ebss;
+extern unsigned long _estack;
+extern char          _heap_end;
+extern "C" void*     sbrk(int incr);
+
+static constexpr uint32_t STACK_PAINT   = 0xA5A5A5A5UL;
+static constexpr uint32_t PAINT_MARGIN  = 512;  // leave the live frames alone
+#endif
+
+HealthMonitor::HealthMonitor(const char* node, uint32_t periodMs)
+    : _node(node), _periodMs(periodMs) {
+    for (int i = 0; i < MAX_UARTS; i++) {
+        _reportRx[i] = 0;
+        _reportTx[i] = 0;
+    }
+}
+
+void HealthMonitor::begin() {
+#if defined(__IMXRT1062__)
+    ARM_DEMCR     |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL  |= ARM_DWT_CTRL_CYCCNTENA;
+
+    uint32_t*       p   = (uint32_t*)&_ebss;
+    const uint32_t* end = (const uint32_t*)((uint8_t*)__builtin_frame_address(0) - PAINT_MARGIN);
+    while (p < end) *p++ = STACK_PAINT;
+#endif
+}
+
+void HealthMonitor::watchUart(Stream& port, const char* tag, uint16_t rxCapacity) {
+    if (_numUarts >= MAX_UARTS) return;
+    const int txFree = port.availableForWrite();
+    _uarts[_numUarts++] = { &port, tag, rxCapacity, (uint16_t)(txFree > 0 ? txFree : 0), 0, 0 };
+}
+
+void HealthMonitor::sampleUarts() {
+    for (int i = 0; i < _numUarts; i++) {
+        Uart&     u  = _uarts[i];
+        const int rx = u.port->available();
+        const int tx = u.txCapacity ? u.txCapacity - u.port->availableForWrite() : 0;
+        if (rx > u.rxHigh) u.rxHigh = (uint16_t)rx;
+        if (tx > u.txHigh) u.txHigh = (uint16_t)tx;
+    }
+}
+
+uint32_t HealthMonitor::stackUsed() const {
+#if defined(__IMXRT1062__)
+    return (uint32_t)((uint8_t*)&_estack - (uint8_t*)&_ebss) - stackFree();
+#else
+    return 0;
+#endif
+}
+
+uint32_t HealthMonitor::stackFree() const {
+#if defined(__IMXRT1062__)
+    const uint32_t* p   = (const uint32_t*)&_ebss;
+    const uint32_t* top = (const uint32_t*)&_estack;
+    while (p < top && *p == STACK_PAINT) p++;
+    return (uint32_t)((uint8_t*)p - (uint8_t*)&_ebss);
+#else
+    return 0;
+#endif
+}
+
+uint32_t HealthMonitor::ocramFree() const {
+#if defined(__IMXRT1062__)
+    return (uint32_t)(&_heap_end - (char*)sbrk(0));
+#else
+    return 0;
+#endif
+}
+
+bool HealthMonitor::due() {
+    const uint32_t nowMs = millis();
+    if (nowMs - _windowStartMs < _periodMs) return false;
+
+    const uint32_t nowCycles = ARM_DWT_CYCCNT;
+    const uint32_t elapsed   = nowCycles - _windowStartCycles;   // period < 7 s at 600 MHz
+    const uint32_t cyclesUs  = F_CPU_ACTUAL / 1000000UL;
+
+    _reportMs       = nowMs;
+    _cpuPct         = elapsed ? (uint8_t)min((uint64_t)100, _busyCycles * 100 / elapsed) : 0;
+    _loopMaxUs      = _maxPeriodCycles / cyclesUs;
+    _loopsPerSec    = (uint32_t)((uint64_t)_loops * 1000 / (nowMs - _windowStartMs));
+    _reportBacklog  = _backlogMax;
+
+    uint8_t flags = 0;
+    if (_cpuPct >= _limits.cpuPct)            flags |= WARN_CPU;
+    if (_loopMaxUs >= _limits.loopUs)         flags |= WARN_LOOP;
+    if (_reportBacklog > _limits.backlogMax)  flags |= WARN_BACKLOG;
+#if defined(__IMXRT1062__)
+    if (stackFree() < _limits.stackFreeMin)   flags |= WARN_STACK;
+    if (ocramFree() < _limits.ramFreeMin)     flags |= WARN_RAM;
+#endif
+    for (int i = 0; i < _numUarts; i++) {
+        Uart& u = _uarts[i];
+        if (u.rxCapacity && u.rxHigh * 100u >= (uint32_t)u.rxCapacity * _limits.uartPct) flags |= WARN_UART;
+        if (u.txCapacity && u.txHigh * 100u >= (uint32_t)u.txCapacity * _limits.uartPct) flags |= WARN_UART;
+        _reportRx[i] = u.rxHigh;
+        _reportTx[i] = u.txHigh;
+        u.rxHigh = 0;
+        u.txHigh = 0;
+    }
+    _raised = flags & ~_active;
+    _active = flags;
+
+    _windowStartMs      = nowMs;
+    _windowStartCycles  = nowCycles;
+    _busyCycles         = 0;
+    _maxPeriodCycles    = 0;
+    _loops              = 0;
+    _backlogMax         = 0;
+    _skipPeriod         = true;
+    return true;
+}
+
+int HealthMonitor::format(char* buffer, size_t size) const {
+    int len = snprintf(buffer, size, "H,n=%s,t=%lu,cpu=%u,lp=%lu,hz=%lu,stk=%lu,dtcm=%lu,ocram=%lu",
+                       _node, (unsigned long)_reportMs, (unsigned)_cpuPct,
+                       (unsigned long)_loopMaxUs, (unsigned long)_loopsPerSec,
+                       (unsigned long)stackUsed(), (unsigned long)stackFree(),
+                       (unsigned long)ocramFree());
+    for (int i = 0; i < _numUarts && len > 0 && (size_t)len < size; i++) {
+        len += snprintf(buffer + len, size - len, ",%s=%u/%u", _uarts[i].tag,
+                        (unsigned)_reportRx[i], (unsigned)_reportTx[i]);
+    }
+    if (len > 0 && (size_t)len < size) {
+        len += snprintf(buffer + len, size - len, ",bl=%lu,w=%02X",
+                        (unsigned long)_reportBacklog, (unsigned)_active);
+    }
+    return len;
+}
@@ -0,0 +1,133 @@
+/**
+ * SYSTEM HEALTH MONITOR
+ * Samples what normally only shows up as a watchdog reset:
+ *   - CPU load     busy vs idle loop cycles (DWT cycle counter)
+ *   - loop period  worst loop-to-loop time in the window
+ *   - stack        high-water mark by painting the free DTCM at boot
+ *   - free RAM     untouched DTCM stack area, free OCRAM heap
+ *   - UARTs        RX / TX buffer high-water per watched port
+ *   - backlog      caller-reported queue depth (e.g. unsynced SD records)
+ *
+ * Every period it closes a window, evaluates the thresholds and lets the
+ * sketch emit one compact key=value frame, e.g.
+ *   H,n=TLM,t=15000,cpu=97,lp=152311,hz=6,stk=3120,dtcm=401904,ocram=480128,S1=0/64,S2=311/0,bl=9,w=12
+ * Warnings are edge-triggered: raised() reports a bit only in the window it
+ * first becomes active.
+ */
+#ifndef HEALTH_MONITOR_H
+#define HEALTH_MONITOR_H
+
+#include <Arduino.h>
+
+class HealthMonitor {
+public:
+    static constexpr int MAX_UARTS = 4;
+
+    enum Warning : uint8_t {
+        WARN_CPU        = 0x01,
+        WARN_LOOP       = 0x02,
+        WARN_STACK      = 0x04,
+        WARN_RAM        = 0x08,
+        WARN_UART       = 0x10,
+        WARN_BACKLOG    = 0x20
+    };
+
+    struct Thresholds {
+        uint8_t         cpuPct          = 95;       // busy share of the window
+        uint32_t        loopUs          = 50000;    // worst loop period
+        uint32_t        stackFreeMin    = 8192;     // untouched DTCM below the stack
+        uint32_t        ramFreeMin      = 16384;    // free OCRAM heap
+        uint8_t         uartPct         = 90;       // RX or TX buffer fill
+        uint32_t        backlogMax      = 64;
+    };
+
+    explicit HealthMonitor(const char* node, uint32_t periodMs = 5000);
+
+    /// Paint the stack and enable the cycle counter. Call first thing in setup().
+    void begin();
+
+    /// Track RX/TX high-water of a port. Call after port.begin(), TX empty.
+    void watchUart(Stream& port, const char* tag, uint16_t rxCapacity);
+
+    Thresholds& thresholds() { return _limits; }
+
+    // --- Per loop ---
+    void beginLoop() {
+        const uint32_t now = ARM_DWT_CYCCNT;
+        if (_skipPeriod) {
+            _skipPeriod = false;                 // that loop carried the report itself
+        } else if (_loopStarted) {
+            const uint32_t period = now - _loopStart;
+            if (period > _maxPeriodCycles) _maxPeriodCycles = period;
+        } else {
+            _windowStartMs     = millis();      // first window starts with the loop, not boot
+            _windowStartCycles = now;
+        }
+        _loopStart   = now;
+        _loopStarted = true;
+    }
+
+    void endLoop(bool busy = true) {
+        const uint32_t spent = ARM_DWT_CYCCNT - _loopStart;
+        if (busy) _busyCycles += spent;
+        _loops++;
+        sampleUarts();
+    }
+
+    void noteBacklog(uint32_t depth) { if (depth > _backlogMax) _backlogMax = depth; }
+
+    /// True once per period; closes the window and evaluates thresholds.
+    bool due();
+
+    /// Format the last closed window. Returns snprintf length.
+    int format(char* buffer, size_t size) const;
+
+    uint8_t active() const  { return _active; }
+    uint8_t raised() const  { return _raised; }
+
+    uint32_t stackUsed() const;
+    uint32_t stackFree() const;
+    uint32_t ocramFree() const;
+
+private:
+    struct Uart {
+        Stream*     port;
+        const char* tag;
+        uint16_t    rxCapacity;
+        uint16_t    txCapacity;
+        uint16_t    rxHigh;
+        uint16_t    txHigh;
+    };
+
+    void sampleUarts();
+
+    const char*     _node;
+    uint32_t        _periodMs;
+    Thresholds      _limits;
+
+    // Open window
+    uint32_t        _windowStartMs      = 0;
+    uint32_t        _windowStartCycles  = 0;
+    uint32_t        _loopStart          = 0;
+    bool            _loopStarted        = false;
+    bool            _skipPeriod         = false;
+    uint64_t        _busyCycles         = 0;
+    uint32_t        _maxPeriodCycles    = 0;
+    uint32_t        _loops              = 0;
+    uint32_t        _backlogMax         = 0;
+    Uart            _uarts[MAX_UARTS];
+    int             _numUarts           = 0;
+
+    // Last closed window
+    uint32_t        _reportMs           = 0;
+    uint8_t         _cpuPct             = 0;
+    uint32_t        _loopMaxUs          = 0;
+    uint32_t        _loopsPerSec        = 0;
+    uint32_t        _reportBacklog      = 0;
+    uint16_t        _reportRx[MAX_UARTS];
+    uint16_t        _reportTx[MAX_UARTS];
+    uint8_t         _active             = 0;
+    uint8_t         _raised             = 0;
+};
+
+#endif // HEALTH_MONITOR_H
@@ -0,0 +1,78 @@
+#include "ImuReports.h"
+
+ImuReports::ImuReports(EnableFn enable) : _enable(enable) {}
+
+FLASHMEM int8_t ImuReports::request(const char* consumer, uint8_t id, uint32_t intervalUs) {
+    if (_numConsumers >= MAX_CONSUMERS) return -1;
+    _consumers[_numConsumers] = {consumer, id, intervalUs};
+    return (int8_t)_numConsumers++;
+}
+
+FLASHMEM void ImuReports::setInterval(int8_t handle, uint32_t intervalUs) {
+    if (handle >= 0 && handle < _numConsumers) _consumers[handle].intervalUs = intervalUs;
+}
+
+FLASHMEM bool ImuReports::apply() {
+    bool ok = true;
+    // Shortest interval per sensor id over every live request
+    for (uint8_t c = 0; c < _numConsumers; c++) {
+        const Consumer& req = _consumers[c];
+        if (req.intervalUs == 0 || find(req.id) || _numSensors >= MAX_SENSORS) continue;
+        _sensors[_numSensors++] = {req.id, 0, 0};
+    }
+    for (uint8_t s = 0; s < _numSensors; s++) {
+        Sensor&  sensor = _sensors[s];
+        uint32_t want   = 0;
+        for (uint8_t c = 0; c < _numConsumers; c++) {
+            const Consumer& req = _consumers[c];
+            if (req.id == sensor.id && req.intervalUs && (want == 0 || req.intervalUs < want)) {
+                want = req.intervalUs;
+            }
+        }
+        // Off reports are sent too: after a reset nothing is on anyway, and
+        // a report nobody wants any more must stop
+        if (!_enable(sensor.id, want)) ok = false;
+        sensor.intervalUs = want;
+    }
+    return ok;
+}
+
+FLASHMEM bool ImuReports::onReset() {
+    _resets++;
+    return apply();
+}
+
+FASTRUN void ImuReports::delivered(uint8_t id) {
+    Sensor* sensor = find(id);
+    if (sensor) sensor->count++;
+}
+
+FASTRUN uint32_t ImuReports::intervalUs(uint8_t id) const {
+    for (uint8_t s = 0; s < _numSensors; s++) {
+        if (_sensors[s].id == id) return _sensors[s].intervalUs;
+    }
+    return 0;
+}
+
+FLASHMEM int ImuReports::format(char* buffer, size_t size, const char* node, uint32_t nowMs) {
+    const float seconds = (nowMs - _windowStartMs) * 0.001f;
+    int len = snprintf(buffer, size, "I,n=%s,t=%lu", node, (unsigned long)nowMs);
+    for (uint8_t s = 0; s < _numSensors && len > 0 && (size_t)len < size; s++) {
+        Sensor& sensor = _sensors[s];
+        if (sensor.intervalUs == 0 && sensor.count == 0) continue;
+        len += snprintf(buffer + len, size - len, ",%02X=%.1f/%.0f", (unsigned)sensor.id,
+                        seconds > 0.0f ? sensor.count / seconds : 0.0f,
+                        sensor.intervalUs ? 1e6f / sensor.intervalUs : 0.0f);
+        sensor.count = 0;
+    }
+    if (len > 0 && (size_t)len < size) len += snprintf(buffer + len, size - len, ",rst=%u", (unsigned)_resets);
+    _windowStartMs = nowMs;
+    return len;
+}
+
+FASTRUN ImuReports::Sensor* ImuReports::find(uint8_t id) {
+    for (uint8_t s = 0; s < _numSensors; s++) {
+        if (_sensors[s].id == id) return &_sensors[s];
+    }
+    return nullptr;
+}
@@ -0,0 +1,83 @@
+/**
+ * BNO08x REPORT MANAGER
+ * Consumers (Euler telemetry, velocity filter, ...) ask for the SH-2
+ * reports they use and how often. The hub is then configured with the
+ * union: one report per sensor id at the shortest interval anyone asked
+ * for, and reports nobody needs any more switched off. After a hub reset
+ * (which clears every report) the same set is applied again.
+ *
+ * Delivered events are counted per sensor, so a report line shows what
+ * actually arrives against what was asked for, e.g.
+ *   I,n=TLM,t=15000,28=99.6/100,04=199.2/200,rst=1
+ * (sensor id in hex = delivered Hz / requested Hz; rst counts hub resets,
+ * the one the hub reports after power-up included).
+ *
+ * The hub is reached through an enable callback, so this class does not
+ * depend on the driver (the actuator shares the library without an IMU).
+ */
+#ifndef IMU_REPORTS_H
+#define IMU_REPORTS_H
+
+#include <Arduino.h>
+
+class ImuReports {
+public:
+    static constexpr uint8_t    MAX_CONSUMERS   = 8;
+    static constexpr uint8_t    MAX_SENSORS     = 6;    // distinct report ids
+
+    /// Enable sensor 'id' every 'intervalUs' (0 = off). Returns false if refused.
+    typedef bool (*EnableFn)(uint8_t id, uint32_t intervalUs);
+
+    explicit ImuReports(EnableFn enable);
+
+    /// Register a consumer. Returns its handle, or -1 when the table is full.
+    /// Takes effect at the next apply().
+    int8_t  request(const char* consumer, uint8_t id, uint32_t intervalUs);
+
+    /// Change or drop a consumer's request (takes effect at the next apply()).
+    void    setInterval(int8_t handle, uint32_t intervalUs);
+    void    release(int8_t handle)      { setInterval(handle, 0); }
+
+    /// Configure the hub with the union of all requests. Returns false if
+    /// the hub refused a report (e.g. not connected).
+    bool    apply();
+
+    /// The hub reported a reset: its reports are gone, apply them again.
+    bool    onReset();
+
+    /// Count one delivered event (call for every getSensorEvent()).
+    void    delivered(uint8_t id);
+
+    /// Interval the hub was given for 'id', 0 if off.
+    uint32_t intervalUs(uint8_t id) const;
+
+    /// Rates over the time since the previous call; restarts the window.
+    /// Returns the snprintf length.
+    int     format(char* buffer, size_t size, const char* node, uint32_t nowMs);
+
+    uint16_t resets() const             { return _resets; }
+
+private:
+    struct Consumer {
+        const char* name;
+        uint8_t     id;
+        uint32_t    intervalUs;             // 0 = released
+    };
+    struct Sensor {
+        uint8_t     id;
+        uint32_t    intervalUs;             // as applied, 0 = off
+        uint32_t    count;                  // delivered this window
+    };
+
+    Sensor*     find(uint8_t id);
+
+    EnableFn    _enable;
+    Consumer    _consumers[MAX_CONSUMERS];
+    uint8_t     _numConsumers   = 0;
+    Sensor      _sensors[MAX_SENSORS];
+    uint8_t     _numSensors     = 0;
+    uint32_t    _windowStartMs  = 0;
+    uint16_t    _resets         = 0;
+};
+
+#endif // IMU_REPORTS_H
@@ -0,0 +1,245 @@
+#include "LogServer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+// SDCardLogger::begin() writes this line at the start of every session
+constexpr char      MARKER[]        = "--- NEW SESSION ---";
+constexpr uint8_t   MARKER_LEN      = sizeof(MARKER) - 1;
+constexpr uint8_t   NO_MATCH        = 0xFF;
+constexpr size_t    SCAN_CHUNK      = 4096;     // bytes read per poll() when not sending
+}
+
+LogServer::LogServer(Stream& io, uint8_t* buffer, size_t size)
+    : _io(io), _buf(buffer), _size(size) {}
+
+// ================================================================
+// REQUESTS
+// ================================================================
+FLASHMEM bool LogServer::command(const char* line) {
+    if (line[0] != 'X' || line[1] == '\0') return false;
+    const char  op   = line[1];
+    const char* args = line[2] == ',' ? line + 3 : line + 2;
+
+    if (op == 'A') {
+        if (_state != IDLE) {
+            _stats.aborted++;
+            finish();
+        }
+        return true;
+    }
+    if (_state != IDLE) {
+        _stats.aborted++;
+        finish();
+    }
+    _stats.requests++;
+
+    switch (op) {
+    case 'L':
+        list();
+        break;
+    case 'S':
+        if (!open(args, false)) break;
+        _sessions  = 0;
+        _lineStart = true;
+        _state     = SESSIONS;
+        break;
+    case 'C':
+        if (!open(args, true)) break;
+        _crc   = 0;
+        _state = CHECK;
+        break;
+    case 'G':
+    case 'P':
+        if (!open(args, true)) break;
+        _crc   = 0;
+        _state = SEND;
+        _io.printf("XG,%s,%lu,%lu\n", _name, (unsigned long)_pos, (unsigned long)(_end - _pos));
+        if (op == 'P') parked();
+        break;
+    default:
+        fail("request");
+        break;
+    }
+    return true;
+}
+
+/// "<file>[,<offset>,<length>]": opens the file and sets _pos/_end.
+FLASHMEM bool LogServer::open(const char* args, bool range) {
+    const char* comma = strchr(args, ',');
+    size_t      n     = comma ? (size_t)(comma - args) : strlen(args);
+    if (!_sd || n == 0 || n >= sizeof(_name)) {
+        fail(_sd ? "name" : "nocard");
+        return false;
+    }
+    memcpy(_name, args, n);
+    _name[n] = '\0';
+
+    unsigned long offset = 0, length = 0;
+    if (range && comma) {
+        char* p = nullptr;
+        offset = strtoul(comma + 1, &p, 10);
+        if (*p == ',') length = strtoul(p + 1, &p, 10);
+    }
+
+    _file = _sd->open(_name, O_RDONLY);
+    if (!_file) {
+        fail("nofile");
+        return false;
+    }
+    const uint32_t size = (uint32_t)_file.size();
+    if (offset > size) offset = size;
+    _pos   = _start = (uint32_t)offset;
+    _end   = (length == 0 || length > size - offset) ? size : (uint32_t)(offset + length);
+    if (!_file.seek(_pos)) {
+        fail("seek");
+        return false;
+    }
+    return true;
+}
+
+FLASHMEM void LogServer::list() {
+    if (!_sd) {
+        fail("nocard");
+        return;
+    }
+    FsFile   dir = _sd->open("/", O_RDONLY);
+    FsFile   f;
+    uint16_t count = 0;
+    char     name[64];
+    while (dir && f.openNext(&dir, O_RDONLY)) {
+        if (!f.isDir() && f.getName(name, sizeof(name))) {
+            _io.printf("XL,%s,%lu\n", name, (unsigned long)f.size());
+            count++;
+        }
+        f.close();
+    }
+    dir.close();
+    _io.printf("XL,END,%u\n", (unsigned)count);
+    _stats.completed++;
+}
+
+// ================================================================
+// BACKGROUND
+// ================================================================
+FASTRUN void LogServer::poll() {
+    const uint32_t t0 = micros();
+    while (_state != IDLE) {
+        if (_pos >= _end) {
+            finish();
+            return;
+        }
+        if ((uint32_t)(micros() - t0) >= _budgetUs) return;
+
+        if (_state == SEND) {
+            const uint16_t n = (uint16_t)min((uint32_t)xfer::BLOCK, _end - _pos);
+            if (_file.read(_buf, n) != n) {
+                fail("read");
+                return;
+            }
+            emit(_buf, n);
+            continue;
+        }
+
+        const size_t want = min(min(_size, SCAN_CHUNK), (size_t)(_end - _pos));
+        if (_file.read(_buf, want) != (int)want) {
+            fail("read");
+            return;
+        }
+        if (_state == CHECK) {
+            _crc = xfer::crc32(_buf, want, _crc);
+            _pos += want;
+        } else {
+            scan(_buf, (uint16_t)want);
+        }
+    }
+}
+
+/// One block at _pos; advances _pos and the range CRC.
+FASTRUN void LogServer::emit(const uint8_t* data, uint16_t n) {
+    uint8_t head[xfer::HEADER];
+    xfer::putHeader(head, _pos, n);
+    const uint32_t crc = xfer::crc32(data, n, xfer::crc32(head + 1, xfer::HEADER - 1));
+    const uint8_t  tail[xfer::TRAILER] = {(uint8_t)crc, (uint8_t)(crc >> 8), (uint8_t)(crc >> 16),
+                                          (uint8_t)(crc >> 24)};
+    _io.write(head, sizeof(head));
+    _io.write(data, n);
+    _io.write(tail, sizeof(tail));
+    _crc = xfer::crc32(data, n, _crc);
+    _pos += n;
+    _stats.bytes += n;
+}
+
+/// Session markers only count at the start of a line.
+FASTRUN void LogServer::scan(const uint8_t* data, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++, _pos++) {
+        const char c = (char)data[i];
+        if (_lineStart) {
+            _lineAt = _pos;
+            _match  = 0;
+        }
+        _lineStart = (c == '\n');
+        if (_match == NO_MATCH) continue;
+        if (_match < MARKER_LEN && c == MARKER[_match]) {
+            if (++_match == MARKER_LEN) {
+                if (_lineAt > _start) session(_lineAt);
+                _start = _lineAt;
+                _match = NO_MATCH;
+            }
+        } else {
+            _match = NO_MATCH;
+        }
+    }
+}
+
+FASTRUN void LogServer::session(uint32_t end) {
+    _io.printf("XS,%u,%lu,%lu\n", (unsigned)_sessions++, (unsigned long)_start,
+               (unsigned long)(end - _start));
+}
+
+// ================================================================
+// PARKED
+// ================================================================
+FLASHMEM void LogServer::parked() {
+    const size_t chunk = _size - _size % xfer::BLOCK;
+    while (_pos < _end) {
+        if (_io.available() > 0) return;            // host wants something: back to poll()
+        const size_t want = min(chunk, (size_t)(_end - _pos));
+        if (_file.read(_buf, want) != (int)want) {
+            fail("read");
+            return;
+        }
+        for (size_t o = 0; o < want; o += xfer::BLOCK) {
+            emit(_buf + o, (uint16_t)min((size_t)xfer::BLOCK, want - o));
+        }
+        if (_idle) _idle();
+    }
+    finish();
+}
+
+// ================================================================
+// END OF A REQUEST
+// ================================================================
+FLASHMEM void LogServer::finish() {
+    if (_pos >= _end) {
+        switch (_state) {
+        case SEND:      _io.printf("XE,%lu,%08lx\n", (unsigned long)(_end - _start), (unsigned long)_crc); break;
+        case CHECK:     _io.printf("XC,%08lx,%lu\n", (unsigned long)_crc, (unsigned long)(_end - _start)); break;
+        case SESSIONS:
+            if (_end > _start) session(_end);
+            _io.printf("XS,END,%u\n", (unsigned)_sessions);
+            break;
+        default:        break;
+        }
+        if (_state != IDLE) _stats.completed++;
+    }
+    if (_file) _file.close();
+    _state = IDLE;
+}
+
+FLASHMEM void LogServer::fail(const char* reason) {
+    _io.printf("XERR,%s\n", reason);
+    if (_file) _file.close();
+    _state = IDLE;
+}
@@ -0,0 +1,85 @@
+/**
+ * SD LOG SERVER (node side of LogTransfer.h)
+ * Answers download requests on a USB stream without stopping the node:
+ * poll() works on the current request for at most a fixed time budget per
+ * call (10 ms by default), so a transfer costs the loop a bounded slice
+ * however large the file is. XP ("parked") instead streams the range in
+ * one go at full speed, calling the idle hook (watchdog) between chunks
+ * and returning as soon as the host sends anything.
+ *
+ * The card stays mounted by the logger; files are read through a second
+ * handle, so a range ends at what the logger had synced when it was asked.
+ */
+#ifndef LOG_SERVER_H
+#define LOG_SERVER_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include "LogTransfer.h"
+
+struct LogServerStats {
+    uint32_t    requests        = 0;
+    uint32_t    completed       = 0;
+    uint32_t    aborted         = 0;
+    uint64_t    bytes           = 0;    // file data sent in blocks
+};
+
+class LogServer {
+public:
+    typedef void (*IdleHook)();
+
+    /// 'buffer' is the read buffer (>= xfer::BLOCK bytes; larger makes
+    /// parked transfers faster), e.g. in DMAMEM.
+    LogServer(Stream& io, uint8_t* buffer, size_t size);
+
+    /// Serve files from 'sd' (mounted by the caller).
+    void begin(SdFs& sd)            { _sd = &sd; }
+
+    /// Called between chunks of a parked transfer (feed the watchdog).
+    void onIdle(IdleHook hook)      { _idle = hook; }
+
+    /// Time poll() may spend per call on a background request.
+    void setBudgetUs(uint32_t us)   { _budgetUs = us; }
+
+    /// Handle one request line. Returns false if it is not an 'X' request.
+    bool command(const char* line);
+
+    /// Call every loop: moves the current request along within the budget.
+    void poll();
+
+    bool                    busy() const    { return _state != IDLE; }
+    const LogServerStats&   stats() const   { return _stats; }
+
+private:
+    enum State : uint8_t { IDLE, SEND, SESSIONS, CHECK };
+
+    bool    open(const char* args, bool range);
+    void    list();
+    void    emit(const uint8_t* data, uint16_t n);
+    void    scan(const uint8_t* data, uint16_t n);
+    void    session(uint32_t end);
+    void    parked();
+    void    finish();
+    void    fail(const char* reason);
+
+    Stream&         _io;
+    uint8_t*        _buf;
+    size_t          _size;
+    SdFs*           _sd         = nullptr;
+    IdleHook        _idle       = nullptr;
+    uint32_t        _budgetUs   = 10000;
+    FsFile          _file;
+    char            _name[48];
+    State           _state      = IDLE;
+    uint32_t        _pos        = 0;        // next file offset
+    uint32_t        _end        = 0;
+    uint32_t        _crc        = 0;        // of the range so far
+    uint32_t        _start      = 0;        // of the range (or current session)
+    uint16_t        _sessions   = 0;
+    uint32_t        _lineAt     = 0;        // offset of the line being matched
+    uint8_t         _match      = 0;        // session marker chars matched
+    bool            _lineStart  = true;
+    LogServerStats  _stats;
+};
+
+#endif // LOG_SERVER_H
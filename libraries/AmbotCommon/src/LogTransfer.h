@@ -0,0 +1,138 @@
+/**
+ * SD LOG TRANSFER PROTOCOL
+ * Gets files off the telemetry node's card over native USB while it keeps
+ * logging (see LogServer.h for the node side, Tools/sd_download.cpp for the
+ * host side). Requests are text lines:
+ *
+ *   XL                              list files   -> XL,<name>,<size> ... XL,END,<n>
+ *   XS,<file>                       sessions     -> XS,<i>,<offset>,<length> ... XS,END,<n>
+ *   XG,<file>,<offset>,<length>     send a range in the background
+ *   XP,<file>,<offset>,<length>     same, parked: the node does nothing else
+ *   XC,<file>,<offset>,<length>     CRC of a range -> XC,<crc32>,<length>
+ *   XA                              abort the current request
+ *
+ * length 0 means "to the end of the file as it is now". XG/XP answer
+ * XG,<file>,<offset>,<length> with the clipped range, then binary blocks,
+ * then XE,<bytes>,<crc32 of the range>; failures answer XERR,<reason>.
+ *
+ * Block: MAGIC | offset (u32 LE) | len (u16 LE) | data | crc32 (u32 LE)
+ * The CRC covers offset, len and data. Text is 7-bit ASCII, so telemetry
+ * lines printed between blocks stay readable; BlockParser splits the two.
+ *
+ * Plain C++ on purpose: the host client includes this header directly.
+ */
+#ifndef LOG_TRANSFER_H
+#define LOG_TRANSFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace xfer {
+constexpr uint8_t   MAGIC       = 0xA5;
+constexpr uint16_t  BLOCK       = 512;      // one SD sector per block
+constexpr uint8_t   HEADER      = 7;        // magic, offset, len
+constexpr uint8_t   TRAILER     = 4;        // crc32
+constexpr size_t    MAX_LINE    = 96;
+
+/// Bytes on the wire for a block of 'n' data bytes.
+constexpr size_t blockSize(size_t n) { return HEADER + n + TRAILER; }
+
+struct Crc32Table {
+    uint32_t t[256];
+    constexpr Crc32Table() : t() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+    }
+};
+
+/// CRC-32 (IEEE, as zlib). Chain calls by passing the previous result.
+inline uint32_t crc32(const uint8_t* data, size_t n, uint32_t crc = 0) {
+    static constexpr Crc32Table TABLE;
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = TABLE.t[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/// Write the block header for 'n' bytes at 'offset'. Returns HEADER.
+inline size_t putHeader(uint8_t* out, uint32_t offset, uint16_t n) {
+    out[0] = MAGIC;
+    for (int i = 0; i < 4; i++) out[1 + i] = (uint8_t)(offset >> (8 * i));
+    out[5] = (uint8_t)n;
+    out[6] = (uint8_t)(n >> 8);
+    return HEADER;
+}
+
+/// Host side: splits the USB stream into text lines and checked blocks.
+class BlockParser {
+public:
+    enum Result : uint8_t { BUSY, LINE, BLOCK, BAD };
+
+    Result feed(uint8_t b) {
+        if (_got == 0 && _need == 0) {
+            if (b == MAGIC) {
+                _buf[0] = b;
+                _got    = 1;
+                _need   = HEADER;
+                return BUSY;
+            }
+            return text(b);
+        }
+        _buf[_got++] = b;
+        if (_got < _need) return BUSY;
+        if (_need == HEADER) {
+            _len = (uint16_t)(_buf[5] | (_buf[6] << 8));
+            if (_len > xfer::BLOCK) {
+                _got = _need = 0;
+                _bad++;
+                return BAD;
+            }
+            _need = (uint16_t)blockSize(_len);
+            return BUSY;
+        }
+        _got = _need = 0;
+        const uint32_t want = (uint32_t)_buf[HEADER + _len] | ((uint32_t)_buf[HEADER + _len + 1] << 8) |
+                              ((uint32_t)_buf[HEADER + _len + 2] << 16) |
+                              ((uint32_t)_buf[HEADER + _len + 3] << 24);
+        if (crc32(_buf + 1, HEADER - 1 + _len) != want) {
+            _bad++;
+            return BAD;
+        }
+        return BLOCK;
+    }
+
+    const char*     line() const    { return _line; }
+    const uint8_t*  data() const    { return _buf + HEADER; }
+    uint16_t        length() const  { return _len; }
+    uint32_t        offset() const  {
+        return (uint32_t)_buf[1] | ((uint32_t)_buf[2] << 8) | ((uint32_t)_buf[3] << 16) |
+               ((uint32_t)_buf[4] << 24);
+    }
+    uint32_t        bad() const     { return _bad; }
+    bool            inBlock() const { return _need != 0; }
+
+private:
+    Result text(uint8_t b) {
+        if (b == '\r') return BUSY;
+        if (b == '\n') {
+            _line[_lineLen] = '\0';
+            _lineLen = 0;
+            return LINE;
+        }
+        if (_lineLen < MAX_LINE - 1) _line[_lineLen++] = (char)b;
+        return BUSY;
+    }
+
+    uint8_t     _buf[HEADER + xfer::BLOCK + TRAILER];
+    uint16_t    _got        = 0;
+    uint16_t    _need       = 0;
+    uint16_t    _len        = 0;
+    char        _line[MAX_LINE];
+    size_t      _lineLen    = 0;
+    uint32_t    _bad        = 0;
+};
+}
+
+#endif // LOG_TRANSFER_H
@@ -0,0 +1,130 @@
+#include "PoseEstimator.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace {
+constexpr double    M_PER_DEG_LAT   = 111320.0;     // spherical Earth, fine over a field
+constexpr float     INITIAL_POS_VAR = 25.0f;        // m^2 until the first fix lands
+constexpr float     INITIAL_SPD_VAR = 1.0f;
+constexpr float     INITIAL_HDG_VAR = 0.01f;        // ~6 deg of mounting error
+constexpr uint8_t   MAX_REJECT_RUN  = 10;           // 1 s of fixes at 10 Hz
+}
+
+PoseEstimator::PoseEstimator(const PoseTuning& tuning) : _t(tuning) {
+    memset(_p, 0, sizeof(_p));
+    _p[0][0] = _p[1][1] = INITIAL_POS_VAR;
+    _p[2][2] = INITIAL_SPD_VAR;
+    _p[3][3] = INITIAL_HDG_VAR;
+}
+
+FLASHMEM void PoseEstimator::setOrigin(double latDeg, double lonDeg) {
+    _lat0       = latDeg;
+    _lon0       = lonDeg;
+    _mPerDegLon = M_PER_DEG_LAT * cos(latDeg * DEG_TO_RAD);
+    _hasOrigin  = true;
+    _s[0] = _s[1] = 0;
+}
+
+FASTRUN void PoseEstimator::toEnu(double latDeg, double lonDeg, float& east, float& north) const {
+    east  = (float)((lonDeg - _lon0) * _mPerDegLon);
+    north = (float)((latDeg - _lat0) * M_PER_DEG_LAT);
+}
+
+// ================================================================
+// PREDICT (every step)
+// ================================================================
+FASTRUN void PoseEstimator::predict(float yawDeg, float accelFwd, float dt) {
+    _yaw = yawDeg * DEG_TO_RAD;
+    const float c  = cosf(_yaw + _s[3]);
+    const float s  = sinf(_yaw + _s[3]);
+    const float v  = _s[2];
+
+    _s[0] += v * c * dt;
+    _s[1] += v * s * dt;
+    _s[2] += accelFwd * dt;
+
+    // P = F P F' + Q, F = I except dx/dv, dx/db, dy/dv, dy/db
+    const float fxv = c * dt, fxb = -v * s * dt;
+    const float fyv = s * dt, fyb = v * c * dt;
+    float fp[4][4];
+    for (int j = 0; j < 4; j++) {
+        fp[0][j] = _p[0][j] + fxv * _p[2][j] + fxb * _p[3][j];
+        fp[1][j] = _p[1][j] + fyv * _p[2][j] + fyb * _p[3][j];
+        fp[2][j] = _p[2][j];
+        fp[3][j] = _p[3][j];
+    }
+    for (int i = 0; i < 4; i++) {
+        _p[i][0] = fp[i][0] + fxv * fp[i][2] + fxb * fp[i][3];
+        _p[i][1] = fp[i][1] + fyv * fp[i][2] + fyb * fp[i][3];
+        _p[i][2] = fp[i][2];
+        _p[i][3] = fp[i][3];
+    }
+    const float qPos = _t.slipNoise * _t.slipNoise * dt;
+    _p[0][0] += qPos;
+    _p[1][1] += qPos;
+    _p[2][2] += _t.accelNoise * _t.accelNoise * dt;
+    _p[3][3] += _t.headingNoise * _t.headingNoise * dt;
+    _stats.steps++;
+}
+
+// ================================================================
+// CORRECT (GPS rate)
+// ================================================================
+/// Scalar measurement z = h.s with variance r (sequential update).
+FASTRUN void PoseEstimator::update(const float* h, float z, float r) {
+    float ph[4];
+    for (int i = 0; i < 4; i++) ph[i] = _p[i][0] * h[0] + _p[i][1] * h[1] + _p[i][2] * h[2] + _p[i][3] * h[3];
+    const float sInn = h[0] * ph[0] + h[1] * ph[1] + h[2] * ph[2] + h[3] * ph[3] + r;
+    const float inn  = z - (h[0] * _s[0] + h[1] * _s[1] + h[2] * _s[2] + h[3] * _s[3]);
+    for (int i = 0; i < 4; i++) {
+        const float k = ph[i] / sInn;
+        _s[i] += k * inn;
+        for (int j = 0; j < 4; j++) _p[i][j] -= k * ph[j];
+    }
+}
+
+FASTRUN bool PoseEstimator::gpsPosition(double latDeg, double lonDeg, float hdop) {
+    if (!_hasOrigin) {
+        setOrigin(latDeg, lonDeg);
+        return true;
+    }
+    float east, north;
+    toEnu(latDeg, lonDeg, east, north);
+    const float sigma = _t.gpsSigma * (hdop > 0.5f ? hdop : 0.5f);
+    const float r     = sigma * sigma;
+
+    // Gate each axis; after a run of rejections the estimate is the one
+    // that is off, so the next fix goes in whatever it says
+    const float de = east - _s[0], dn = north - _s[1];
+    const float g  = _t.gateSigmas * _t.gateSigmas;
+    if ((de * de > g * (_p[0][0] + r) || dn * dn > g * (_p[1][1] + r)) && _rejectRun < MAX_REJECT_RUN) {
+        _rejectRun++;
+        _stats.rejected++;
+        return false;
+    }
+    _rejectRun = 0;
+    static const float HX[4] = {1, 0, 0, 0};
+    static const float HY[4] = {0, 1, 0, 0};
+    update(HX, east, r);
+    update(HY, north, r);
+    _stats.fixes++;
+    return true;
+}
+
+FASTRUN void PoseEstimator::gpsSpeed(float mps) {
+    static const float HV[4] = {0, 0, 1, 0};
+    update(HV, mps, _t.gpsSpeedSigma * _t.gpsSpeedSigma);
+    _stats.speeds++;
+}
+
+FASTRUN float PoseEstimator::headingDeg() const {
+    float h = (_yaw + _s[3]) * RAD_TO_DEG;
+    while (h > 180.0f)   h -= 360.0f;
+    while (h <= -180.0f) h += 360.0f;
+    return h;
+}
+
+FASTRUN float PoseEstimator::sigmaM() const {
+    return sqrtf(_p[0][0] + _p[1][1]);
+}
@@ -0,0 +1,89 @@
+/**
+ * DEAD-RECKONING POSE ESTIMATOR (2D, local ENU)
+ * Integrates forward speed along the IMU yaw at a fixed step (200 Hz on
+ * the telemetry node) and pulls the result onto GPS fixes. The state is
+ * four numbers with a 4x4 covariance (an EKF, fixed size, no heap):
+ *
+ *   x, y   metres East / North of the origin (the first fix)
+ *   v      forward speed, m/s: integrated from linear acceleration,
+ *          corrected by GPS speed
+ *   b      heading offset, rad: IMU yaw + b = course over ground. Takes up
+ *          the mounting error and the game rotation vector's drift,
+ *          learnt from how fixes move while driving.
+ *
+ * Yaw is ENU (0 = East, counter-clockwise positive), as IMU_BNO08X.ino
+ * reports it. Fixes are weighted by HDOP; one far outside the current
+ * uncertainty (a multipath jump) is rejected and counted, unless fixes
+ * keep disagreeing for a second.
+ *
+ * predict() is the per-step cost; gpsPosition() runs at fix rate. Both
+ * are in the telemetry benchmark suite against POSE_STEP_BUDGET_US.
+ */
+#ifndef POSE_ESTIMATOR_H
+#define POSE_ESTIMATOR_H
+
+#include <Arduino.h>
+
+struct PoseTuning {
+    float   accelNoise      = 0.5f;     // m/s^2, speed random walk
+    float   slipNoise       = 0.05f;    // m/s, position random walk (wheel slip, lateral)
+    float   headingNoise    = 0.005f;   // rad/s, offset random walk
+    float   gpsSigma        = 2.0f;     // m per axis at HDOP 1
+    float   gpsSpeedSigma   = 0.15f;    // m/s
+    float   gateSigmas      = 5.0f;     // reject fixes further out than this
+};
+
+struct PoseStats {
+    uint32_t    steps       = 0;
+    uint32_t    fixes       = 0;
+    uint32_t    rejected    = 0;
+    uint32_t    speeds      = 0;
+};
+
+class PoseEstimator {
+public:
+    explicit PoseEstimator(const PoseTuning& tuning = PoseTuning());
+
+    /// Sets the ENU origin and puts the pose there (first fix).
+    void    setOrigin(double latDeg, double lonDeg);
+    bool    hasOrigin() const               { return _hasOrigin; }
+    double  originLat() const               { return _lat0; }
+    double  originLon() const               { return _lon0; }
+
+    /// One step of 'dt' seconds with the IMU yaw (deg, ENU) and the
+    /// forward linear acceleration (m/s^2).
+    void    predict(float yawDeg, float accelFwd, float dt);
+
+    /// A GPS position fix. Returns false if it was gated out.
+    bool    gpsPosition(double latDeg, double lonDeg, float hdop);
+
+    /// GPS speed over ground, m/s.
+    void    gpsSpeed(float mps);
+
+    float   x() const                       { return _s[0]; }
+    float   y() const                       { return _s[1]; }
+    float   speed() const                   { return _s[2]; }
+    float   headingDeg() const;             // course: yaw + offset, ENU
+    float   offsetDeg() const               { return _s[3] * RAD_TO_DEG; }
+    float   sigmaM() const;                 // 1-sigma position radius
+    const PoseStats& stats() const          { return _stats; }
+
+    /// Metres East / North of the origin.
+    void    toEnu(double latDeg, double lonDeg, float& east, float& north) const;
+
+private:
+    void    update(const float* h, float z, float r);
+
+    PoseTuning  _t;
+    float       _s[4]       = {0, 0, 0, 0};
+    float       _p[4][4];
+    float       _yaw        = 0;            // rad, last predict()
+    uint8_t     _rejectRun  = 0;
+    bool        _hasOrigin  = false;
+    double      _lat0       = 0;
+    double      _lon0       = 0;
+    double      _mPerDegLon = 0;
+    PoseStats   _stats;
+};
+
+#endif // POSE_ESTIMATOR_H
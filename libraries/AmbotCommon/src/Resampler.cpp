@@ -0,0 +1,132 @@
+#include "Resampler.h"
+
+#include <string.h>
+
+namespace {
+/// a is before b, modulo the 32-bit micros() wrap.
+inline bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+}
+
+Resampler::Resampler(uint32_t periodUs, uint32_t lagUs) : _periodUs(periodUs), _lagUs(lagUs) {
+    memset(_channels, 0, sizeof(_channels));
+}
+
+FLASHMEM int8_t Resampler::addChannel(const char* name, Mode mode, uint8_t decimals, uint32_t maxGapUs) {
+    if (_numChannels >= MAX_CHANNELS) return -1;
+    Channel& c = _channels[_numChannels];
+    c.name      = name;
+    c.mode      = mode;
+    c.decimals  = decimals;
+    c.maxGapUs  = maxGapUs;
+    _out[_numChannels] = {0.0, -1};
+    return (int8_t)_numChannels++;
+}
+
+FASTRUN void Resampler::push(uint8_t ch, uint32_t tUs, double value) {
+    if (ch >= _numChannels) return;
+    Channel& c = _channels[ch];
+    c.history[c.head] = {tUs, value};
+    c.head = (uint8_t)((c.head + 1) % HISTORY);
+    if (c.count < HISTORY) c.count++;
+    if (!_started) {
+        // First record on the grid after the first sample of anything
+        _nextUs  = tUs - tUs % _periodUs;
+        _started = true;
+        advance(_periodUs);
+    }
+}
+
+FASTRUN bool Resampler::next(uint32_t nowUs) {
+    if (!_started || before(nowUs - _lagUs, _nextUs)) return false;
+    if ((uint32_t)(nowUs - _lagUs - _nextUs) > MAX_BEHIND_US) {
+        // The loop stalled: jump to the newest record time instead of
+        // producing a burst from stale history
+        const uint32_t behind = nowUs - _lagUs - _nextUs;
+        _skipped += behind / _periodUs;
+        advance(behind - behind % _periodUs);
+    }
+    const uint32_t t = _nextUs;
+    _recordUs = (uint64_t)_nextWraps << 32 | t;
+    advance(_periodUs);
+    for (uint8_t ch = 0; ch < _numChannels; ch++) evaluate(_channels[ch], t, _out[ch]);
+    _records++;
+    return true;
+}
+
+/// Move the grid on by 'us', counting the wraps into the record time.
+FASTRUN void Resampler::advance(uint32_t us) {
+    const uint32_t prev = _nextUs;
+    _nextUs += us;
+    if (_nextUs < prev) _nextWraps++;
+}
+
+FASTRUN void Resampler::evaluate(const Channel& c, uint32_t tUs, Output& out) const {
+    // Newest sample at or before tUs, and the oldest one after it
+    const Sample* prev  = nullptr;
+    const Sample* after = nullptr;
+    for (uint8_t i = 0; i < c.count; i++) {
+        const Sample& s = c.history[(c.head + HISTORY - 1 - i) % HISTORY];     // newest first
+        if (before(tUs, s.tUs)) {
+            after = &s;
+        } else {
+            prev = &s;
+            break;
+        }
+    }
+    if (!prev) {
+        // Nothing that old (yet, or pushed out of the history)
+        if (after && out.ageUs >= 0) {
+            out.value = after->value;
+            out.ageUs = 0;
+        } else {
+            out.ageUs = -1;
+        }
+        return;
+    }
+    out.ageUs = (int32_t)(tUs - prev->tUs);
+    out.value = prev->value;
+    if (c.mode == HOLD || !after || after->tUs - prev->tUs > c.maxGapUs) return;
+
+    const double f     = (double)(tUs - prev->tUs) / (double)(after->tUs - prev->tUs);
+    double       delta = after->value - prev->value;
+    if (c.mode == ANGLE_DEG) {
+        if (delta > 180.0)   delta -= 360.0;
+        if (delta < -180.0)  delta += 360.0;
+        double v = prev->value + f * delta;
+        if (v > 180.0)   v -= 360.0;
+        if (v <= -180.0) v += 360.0;
+        out.value = v;
+    } else {
+        out.value = prev->value + f * delta;
+    }
+}
+
+FLASHMEM int Resampler::header(char* buffer, size_t size) const {
+    int len = snprintf(buffer, size, "t_ms");
+    for (uint8_t ch = 0; ch < _numChannels && len > 0 && (size_t)len < size; ch++) {
+        len += snprintf(buffer + len, size - len, ",%s", _channels[ch].name);
+    }
+    for (uint8_t ch = 0; ch < _numChannels && len > 0 && (size_t)len < size; ch++) {
+        len += snprintf(buffer + len, size - len, ",%s_age_ms", _channels[ch].name);
+    }
+    return len;
+}
+
+FASTRUN int Resampler::format(char* buffer, size_t size) const {
+    int len = snprintf(buffer, size, "%llu", (unsigned long long)(_recordUs / 1000));
+    for (uint8_t ch = 0; ch < _numChannels && len > 0 && (size_t)len < size; ch++) {
+        if (_out[ch].ageUs < 0) {
+            len += snprintf(buffer + len, size - len, ",");
+        } else {
+            len += snprintf(buffer + len, size - len, ",%.*f", (int)_channels[ch].decimals, _out[ch].value);
+        }
+    }
+    for (uint8_t ch = 0; ch < _numChannels && len > 0 && (size_t)len < size; ch++) {
+        if (_out[ch].ageUs < 0) {
+            len += snprintf(buffer + len, size - len, ",");
+        } else {
+            len += snprintf(buffer + len, size - len, ",%lu", (unsigned long)(_out[ch].ageUs / 1000));
+        }
+    }
+    return len;
+}
@@ -0,0 +1,87 @@
+/**
+ * FIXED-RATE RESAMPLER
+ * Sensors arrive at their own times (baro every loop, IMU events a few ms
+ * old, GPS up to 100 ms old), so a row stamped with one loop time mixes
+ * values of different ages. Here each sensor pushes timestamped samples
+ * into a short per-channel history, and records come out on an exact
+ * grid (every periodUs), each value taken at the record time:
+ *   LINEAR     interpolated between the samples either side of it
+ *   ANGLE_DEG  the same, the short way round +-180 deg (yaw)
+ *   HOLD       the last sample at or before it (discrete values)
+ * A record is produced lagUs after its time, so the sample after it has
+ * usually arrived; when it has not (or the gap is over maxGapUs) the last
+ * value is held. Every value carries its age: record time minus the time
+ * of the newest sample at or before it.
+ *
+ * Record: t_ms,<value>...,<age ms>... (empty fields before a channel's
+ * first sample), so downstream tools can load a file as evenly spaced
+ * columns. Samples come in as 32-bit micros(); the record time is kept
+ * 64-bit, carried over each wrap, so t_ms keeps counting past 71 minutes.
+ */
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <Arduino.h>
+
+class Resampler {
+public:
+    static constexpr uint8_t    MAX_CHANNELS    = 16;
+    static constexpr uint8_t    HISTORY         = 8;        // samples per channel
+    static constexpr uint32_t   MAX_BEHIND_US   = 500000;   // then records are skipped
+
+    enum Mode : uint8_t { LINEAR, ANGLE_DEG, HOLD };
+
+    Resampler(uint32_t periodUs, uint32_t lagUs);
+
+    /// Add a channel; returns its index (in call order), -1 when full.
+    int8_t  addChannel(const char* name, Mode mode, uint8_t decimals, uint32_t maxGapUs = 250000);
+
+    /// A sample of channel 'ch' taken at 'tUs' (micros()).
+    void    push(uint8_t ch, uint32_t tUs, double value);
+
+    /// Work out the next record if its time (plus the lag) has passed.
+    /// Call until it returns false; each true is one record.
+    bool    next(uint32_t nowUs);
+
+    uint64_t    timeUs() const              { return _recordUs; }      // since the micros() epoch
+    double      value(uint8_t ch) const     { return _out[ch].value; }
+    int32_t     ageUs(uint8_t ch) const     { return _out[ch].ageUs; }     // -1 before any sample
+    uint32_t    records() const             { return _records; }
+    uint32_t    skipped() const             { return _skipped; }
+
+    /// "t_ms,<names>...,<names>_age_ms..." Returns the snprintf length.
+    int     header(char* buffer, size_t size) const;
+
+    /// The current record as CSV. Returns the snprintf length.
+    int     format(char* buffer, size_t size) const;
+
+private:
+    struct Sample { uint32_t tUs; double value; };
+    struct Channel {
+        const char* name;
+        Mode        mode;
+        uint8_t     decimals;
+        uint32_t    maxGapUs;
+        Sample      history[HISTORY];
+        uint8_t     head;                   // next slot to write
+        uint8_t     count;
+    };
+    struct Output { double value; int32_t ageUs; };
+
+    void    evaluate(const Channel& c, uint32_t tUs, Output& out) const;
+    void    advance(uint32_t us);
+
+    uint32_t    _periodUs;
+    uint32_t    _lagUs;
+    Channel     _channels[MAX_CHANNELS];
+    Output      _out[MAX_CHANNELS];
+    uint8_t     _numChannels    = 0;
+    uint32_t    _nextUs         = 0;
+    uint32_t    _nextWraps      = 0;        // times _nextUs has wrapped
+    bool        _started        = false;
+    uint64_t    _recordUs       = 0;
+    uint32_t    _records        = 0;
+    uint32_t    _skipped        = 0;
+};
+
+#endif // RESAMPLER_H
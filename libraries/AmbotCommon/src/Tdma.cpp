@@ -0,0 +1,398 @@
+#include "Tdma.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+constexpr uint16_t  REPORT_BYTES    = 24;   // "Q,n=..,q=....,d=...." worst case
+constexpr uint16_t  MIN_UPLINK      = 12;   // one motor line
+constexpr uint16_t  MIN_NODE_EXTRA  = 16;   // beyond the slot report
+constexpr uint8_t   JOIN            = 255;  // contention slot for unlisted nodes
+constexpr uint8_t   JOIN_EVERY      = 8;    // superframes between join slots
+}
+
+// ================================================================
+// SCHEDULE (node side)
+// ================================================================
+TdmaSchedule::TdmaSchedule(uint8_t id, uint32_t baud)
+    : _id(id), _byteUs(10000000UL / baud) {}
+
+FASTRUN bool TdmaSchedule::parseBeacon(const char* line, uint32_t rxUs, uint32_t jitterUs) {
+    if (line[0] != '@') return false;
+    char*         p       = nullptr;
+    unsigned long seq     = strtoul(line + 1, &p, 10);
+    if (*p != ',') return false;
+    unsigned long frameMs = strtoul(p + 1, &p, 10);
+    if (frameMs < 50 || frameMs > 5000) return false;
+
+    TdmaSlot slots[MAX_SLOTS];
+    uint8_t  n = 0;
+    while (*p == ',' && n < MAX_SLOTS) {
+        unsigned long id    = strtoul(p + 1, &p, 10);
+        if (*p != ':') return false;
+        unsigned long start = strtoul(p + 1, &p, 10);
+        if (*p != '+') return false;
+        unsigned long len   = strtoul(p + 1, &p, 10);
+        if (id > 255 || start + len > frameMs) return false;
+        slots[n++] = {(uint8_t)id, (uint16_t)start, (uint16_t)len};
+    }
+    if (*p != '\0') return false;
+
+    memcpy(_slots, slots, sizeof(TdmaSlot) * n);
+    _numSlots       = n;
+    _frameMs        = (uint16_t)frameMs;
+    _frameStartUs   = rxUs;
+    _jitterUs       = jitterUs;
+    _frames         = seq;
+    _beacons++;
+    return true;
+}
+
+bool TdmaSchedule::synced(uint32_t nowUs) const {
+    return _beacons > 0 && (nowUs - _frameStartUs) < (uint32_t)SYNC_FRAMES * _frameMs * 1000UL;
+}
+
+const TdmaSlot* TdmaSchedule::slot(uint8_t id) const {
+    for (uint8_t i = 0; i < _numSlots; i++) {
+        if (_slots[i].id == id) return &_slots[i];
+    }
+    return nullptr;
+}
+
+uint32_t TdmaSchedule::offsetUs(uint32_t nowUs) const {
+    return (nowUs - _frameStartUs) % ((uint32_t)_frameMs * 1000UL);
+}
+
+uint32_t TdmaSchedule::frameIndex(uint32_t nowUs) const {
+    return _frames + (nowUs - _frameStartUs) / ((uint32_t)_frameMs * 1000UL);
+}
+
+FASTRUN bool TdmaSchedule::inSlot(uint8_t id, uint32_t nowUs, uint32_t lateUs) const {
+    if (!synced(nowUs)) return false;
+    const TdmaSlot* s = slot(id);
+    if (!s) return false;
+    const uint32_t off = offsetUs(nowUs);
+    return off >= s->startMs * 1000UL && off < (s->startMs + s->lenMs) * 1000UL + lateUs;
+}
+
+FASTRUN uint32_t TdmaSchedule::remainingUs(uint32_t nowUs) const {
+    if (!synced(nowUs)) return 0;
+    const TdmaSlot* s = slot(_id);
+    if (!s) s = slot(JOIN);
+    if (!s) return 0;
+    const uint32_t off = offsetUs(nowUs);
+    const uint32_t end = (s->startMs + s->lenMs) * 1000UL - min(_jitterUs, s->lenMs * 1000UL);
+    return (off >= s->startMs * 1000UL && off < end) ? end - off : 0;
+}
+
+FASTRUN char* TdmaSchedule::route(char* line, uint8_t id) {
+    char* p = line;
+    while (p - line < 3 && *p >= '0' && *p <= '9') p++;
+    if (p == line || *p != ':') return line;            // unaddressed
+    return (uint8_t)atoi(line) == id ? p + 1 : nullptr;
+}
+
+FLASHMEM uint8_t TdmaSchedule::configId(const char* text, uint8_t fallback) {
+    for (const char* p = text; (p = strstr(p, "node=")) != nullptr; p += 5) {
+        if (p != text && p[-1] != '\n') continue;
+        const long id = atol(p + 5);
+        return (id > UPLINK && id < JOIN) ? (uint8_t)id : fallback;
+    }
+    return fallback;
+}
+
+// ================================================================
+// LINK (node transmitter)
+// ================================================================
+TdmaLink::TdmaLink(Stream& radio, TdmaSchedule& schedule, uint8_t* queue, size_t size,
+                   uint16_t uartTxCapacity)
+    : _radio(radio), _sched(schedule), _queue(queue), _size(size), _txCapacity(uartTxCapacity) {}
+
+FASTRUN void TdmaLink::send(const char* line) {
+    // Full: the oldest waiting line goes, so the ground gets fresh data
+    const size_t n = strlen(line);
+    while (_count + n + 1 > _size) {
+        _dropped++;
+        if (_inFlight || _count == 0) return;
+        const size_t len = headLength();
+        _head   = (_head + len) % _size;
+        _count -= len;
+    }
+    push(line, n);
+    push("\n", 1);
+    if (_count > _highWater) _highWater = _count;
+}
+
+FASTRUN bool TdmaLink::sendUrgent(const char* line) {
+    const size_t n = strlen(line);
+    if (_urgentLen || n >= sizeof(_urgent)) return false;
+    memcpy(_urgent, line, n + 1);
+    _urgentLen = (uint8_t)n;
+    return true;
+}
+
+FASTRUN void TdmaLink::poll() {
+    const uint32_t now = micros();
+    listen(now);
+    if (_sched.synced(now)) pump(now);
+    else                    drain();
+    _lastPollUs = now;
+}
+
+FASTRUN void TdmaLink::listen(uint32_t nowUs) {
+    while (_radio.available() > 0) {
+        const uint8_t b = (uint8_t)_radio.read();
+        switch (_fec.feed(b)) {
+        case FecDecoder::TEXT:
+            break;
+        case FecDecoder::FRAME:
+            if (!_sched.parseBeacon((const char*)_fec.payload(), nowUs, nowUs - _lastPollUs) && _handler) {
+                _handler((const char*)_fec.payload());
+            }
+            continue;
+        default:
+            continue;                       // inside a frame, or a lost one
+        }
+        const char c = (char)b;
+        if (c == '\n' || c == '\r') {
+            if (_rxLen > 0 && _rxLen < sizeof(_rx)) {
+                _rx[_rxLen] = '\0';
+                if (!_sched.parseBeacon(_rx, nowUs, nowUs - _lastPollUs) && _handler) _handler(_rx);
+            }
+            _rxLen = 0;
+        } else if (_rxLen < sizeof(_rx) - 1) {
+            _rx[_rxLen++] = c;
+        } else {
+            _rxLen = sizeof(_rx);           // too long for a beacon or ack: skip it
+        }
+    }
+}
+
+FASTRUN uint16_t TdmaLink::uartQueued() {
+    const int room = _radio.availableForWrite();
+    return room >= _txCapacity ? 0 : (uint16_t)(_txCapacity - room);
+}
+
+FASTRUN bool TdmaLink::writeLine() {
+    while (_framePos < _frameLen) {
+        const int room = _radio.availableForWrite();
+        if (room <= 0) return false;
+        const size_t chunk = min((size_t)room, (size_t)(_frameLen - _framePos));
+        _radio.write(_frame + _framePos, chunk);
+        _framePos += chunk;
+    }
+    while (_inFlight) {
+        const int room = _radio.availableForWrite();
+        if (room <= 0) return false;
+        const size_t chunk = min((size_t)room, min(_inFlight, _size - _head));
+        _radio.write(_queue + _head, chunk);
+        _head      = (_head + chunk) % _size;
+        _count    -= chunk;
+        _inFlight -= chunk;
+    }
+    return true;
+}
+
+FASTRUN void TdmaLink::pump(uint32_t nowUs) {
+    // A started line is always finished, even past the slot end, so the
+    // ground never sees two nodes' bytes interleaved inside one line.
+    if (!writeLine()) return;
+
+    const uint32_t left = _sched.remainingUs(nowUs);
+    if (left == 0) return;
+    const uint32_t byteUs = _sched.byteUs();
+
+    // Slot report first: tells the coordinator how much is waiting
+    const uint32_t frame = _sched.frameIndex(nowUs);
+    if (frame != _reportedFrame) {
+        char q[REPORT_BYTES + 8];
+        int  n = snprintf(q, sizeof(q), "Q,n=%u,q=%u,d=%lu\n", (unsigned)_sched.id(),
+                          (unsigned)_count, (unsigned long)_dropped);
+        if ((uint32_t)(uartQueued() + airBytes(n)) * byteUs > left) return;
+        if (_fecTx) {
+            _frameLen = fec::encode((const uint8_t*)q, n - 1, _fecSeq++, _frame, sizeof(_frame));
+            _framePos = 0;
+            _reportedFrame = frame;
+            if (!writeLine()) return;
+        } else {
+            if (_radio.availableForWrite() < n) return;
+            _radio.write((const uint8_t*)q, n);
+            _reportedFrame = frame;
+        }
+    }
+    const TdmaSlot* own = _sched.slot(_sched.id());
+    if (!own) return;                               // join slot: report only
+
+    if (_urgentLen) {
+        if ((uartQueued() + airBytes(_urgentLen + 1)) * byteUs > _sched.remainingUs(micros())) return;
+        stageUrgent();
+        _linesSent++;
+        if (!writeLine()) return;
+    }
+
+    while (_count) {
+        const size_t len = headLength();
+        const size_t air = airBytes(len);
+        if (air * byteUs > own->lenMs * 1000UL) {   // can never fit: discard
+            _head   = (_head + len) % _size;
+            _count -= len;
+            _dropped++;
+            continue;
+        }
+        if ((uartQueued() + air) * byteUs > _sched.remainingUs(micros())) return;
+        _linesSent++;
+        if (_fecTx) stageFrame(len);
+        else        _inFlight = len;
+        if (!writeLine()) return;
+    }
+}
+
+/// Queue entry of 'len' bytes (newline included) on the air.
+FASTRUN size_t TdmaLink::airBytes(size_t len) const {
+    return _fecTx ? fec::frameSize(len - 1) : len;
+}
+
+/// Move the head line out of the queue and encode it into _frame.
+FASTRUN void TdmaLink::stageFrame(size_t len) {
+    uint8_t      line[fec::MAX_PAYLOAD];
+    const size_t n = len - 1;
+    _framePos = 0;
+    if (n == 0 || n > sizeof(line)) {               // nothing to send, or longer than one frame
+        _head     = (_head + len) % _size;
+        _count   -= len;
+        _frameLen = 0;
+        if (n > 0) _dropped++;
+        return;
+    }
+    for (size_t i = 0; i < n; i++) line[i] = _queue[(_head + i) % _size];
+    _head   = (_head + len) % _size;
+    _count -= len;
+    _frameLen = (uint16_t)fec::encode(line, n, _fecSeq++, _frame, sizeof(_frame));
+}
+
+/// Move the urgent line into _frame, framed or plain.
+FASTRUN void TdmaLink::stageUrgent() {
+    if (_fecTx) {
+        _frameLen = (uint16_t)fec::encode((const uint8_t*)_urgent, _urgentLen, _fecSeq++,
+                                          _frame, sizeof(_frame));
+    } else {
+        memcpy(_frame, _urgent, _urgentLen);
+        _frame[_urgentLen] = '\n';
+        _frameLen = _urgentLen + 1;
+    }
+    _framePos  = 0;
+    _urgentLen = 0;
+}
+
+/// Free-running (no beacon): urgent line first, then the queue, as much
+/// as the UART has room for.
+FASTRUN void TdmaLink::drain() {
+    if (!writeLine()) return;
+    if (_urgentLen) {
+        stageUrgent();
+        _linesSent++;
+        if (!writeLine()) return;
+    }
+    while (_count) {
+        const size_t len = headLength();
+        _linesSent++;
+        if (_fecTx) stageFrame(len);
+        else        _inFlight = len;
+        if (!writeLine()) return;
+    }
+}
+
+FASTRUN size_t TdmaLink::headLength() const {
+    for (size_t i = 0; i < _count; i++) {
+        if (_queue[(_head + i) % _size] == '\n') return i + 1;
+    }
+    return _count;
+}
+
+FASTRUN bool TdmaLink::push(const char* data, size_t n) {
+    if (_count + n > _size) return false;
+    size_t tail = (_head + _count) % _size;
+    for (size_t i = 0; i < n; i++) {
+        _queue[tail] = (uint8_t)data[i];
+        tail = (tail + 1 == _size) ? 0 : tail + 1;
+    }
+    _count += n;
+    return true;
+}
+
+// ================================================================
+// COORDINATOR (ground side)
+// ================================================================
+TdmaCoordinator::TdmaCoordinator(uint16_t frameMs, uint32_t baud, uint16_t guardMs)
+    : _frameMs(frameMs), _byteMs(10000.0f / baud), _guardMs(guardMs) {}
+
+void TdmaCoordinator::addNode(uint8_t id) {
+    if (id == TdmaSchedule::UPLINK || id == JOIN) return;
+    for (uint8_t i = 0; i < _numNodes; i++) {
+        if (_nodes[i].id == id) return;
+    }
+    if (_numNodes < MAX_NODES) _nodes[_numNodes++] = {id, 0.0f};
+}
+
+void TdmaCoordinator::onLine(const char* line) {
+    if (strncmp(line, "Q,", 2) != 0) return;
+    const char* n = strstr(line, "n=");
+    const char* q = strstr(line, "q=");
+    if (!n || !q) return;
+    const uint8_t id = (uint8_t)atoi(n + 2);
+    addNode(id);
+    for (uint8_t i = 0; i < _numNodes; i++) {
+        if (_nodes[i].id == id) _nodes[i].queued = 0.5f * _nodes[i].queued + 0.5f * atoi(q + 2);
+    }
+}
+
+const TdmaSlot* TdmaCoordinator::slot(uint8_t id) const {
+    for (uint8_t i = 0; i < _numSlots; i++) {
+        if (_slots[i].id == id) return &_slots[i];
+    }
+    return nullptr;
+}
+
+int TdmaCoordinator::beacon(char* out, size_t size, uint32_t uplinkBytes) {
+    _seq++;
+    // Airtime of this beacon, estimated from the last one (same shape)
+    const uint8_t  slots      = _numNodes + 2;
+    if (_beaconBytes == 0) _beaconBytes = 10 + 12 * slots;
+    const int      budget     = (int)(_frameMs - _beaconBytes * _byteMs) - _guardMs;
+    const uint16_t report     = _fec ? fec::frameSize(REPORT_BYTES - 1) : REPORT_BYTES;
+    const uint16_t joinMs     = (uint16_t)(report * _byteMs) + 1;
+    const uint16_t minNodeMs  = (uint16_t)((report + MIN_NODE_EXTRA) * _byteMs) + 1;
+
+    uint16_t uplinkMs = (uint16_t)(max(uplinkBytes, (uint32_t)MIN_UPLINK) * _byteMs) + 1;
+    uplinkMs = min(uplinkMs, (uint16_t)(_frameMs / 4));
+
+    // Unlisted nodes get a contention slot now and then to announce themselves
+    int rest = budget - _guardMs - uplinkMs - _numNodes * (minNodeMs + _guardMs);
+    const bool join = (_seq % JOIN_EVERY == 0 || _numNodes == 0) && rest >= joinMs + _guardMs;
+    if (join) rest -= joinMs + _guardMs;
+    if (rest < 0) rest = 0;
+
+    // Spare time goes to the nodes in proportion to their queue depth
+    float demand = 0.0f;
+    for (uint8_t i = 0; i < _numNodes; i++) demand += _nodes[i].queued;
+
+    uint16_t cursor = _guardMs;
+    _numSlots = 0;
+    _slots[_numSlots++] = {TdmaSchedule::UPLINK, cursor, uplinkMs};
+    cursor += uplinkMs + _guardMs;
+    for (uint8_t i = 0; i < _numNodes; i++) {
+        const float share = demand > 0.0f ? _nodes[i].queued / demand : 1.0f / _numNodes;
+        const uint16_t len = minNodeMs + (uint16_t)(rest * share);
+        _slots[_numSlots++] = {_nodes[i].id, cursor, len};
+        cursor += len + _guardMs;
+    }
+    if (join) _slots[_numSlots++] = {JOIN, cursor, joinMs};
+
+    int n = snprintf(out, size, "@%u,%u", (unsigned)_seq, (unsigned)_frameMs);
+    for (uint8_t i = 0; i < _numSlots && n > 0 && n < (int)size; i++) {
+        n += snprintf(out + n, size - n, ",%u:%u+%u", (unsigned)_slots[i].id,
+                      (unsigned)_slots[i].startMs, (unsigned)_slots[i].lenMs);
+    }
+    if (n > 0) _beaconBytes = (uint16_t)((_fec ? fec::frameSize(n) : n + 1) + (join ? 0 : 12));
+    return n;
+}
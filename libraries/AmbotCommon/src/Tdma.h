@@ -0,0 +1,211 @@
+/**
+ * TDMA SLOTS FOR THE SHARED APC220 CHANNEL
+ * The APC220 link is half-duplex: a station cannot hear while it is keyed
+ * up, and two stations keying at once destroy each other's bytes. Instead
+ * of transmitting whenever they like, stations follow a superframe that the
+ * ground station announces with a beacon:
+ *
+ *   | beacon | g | uplink (0) | g | node 1 | g | node 2 | g | ... | beacon
+ *
+ * Beacon (ground -> all), offsets in ms from the end of the beacon line:
+ *     @<seq>,<frame_ms>,<id>:<start>+<len>,...          id 0 = ground uplink
+ * Slot report (node -> ground), first line of each downlink slot:
+ *     Q,n=<id>,q=<queued bytes>,d=<dropped lines>
+ * Uplink lines may be addressed "<id>:<cmd>"; unaddressed lines are for
+ * every rover.
+ *
+ * The coordinator sizes the slots from the reported queue depths. A node
+ * that hears no beacon for SYNC_FRAMES superframes falls back to sending
+ * freely, so a ground station without TDMA keeps working unchanged.
+ *
+ * Any line may instead travel as an FEC frame (Fec.h); receivers accept
+ * both, and setFec() makes a node send its own lines that way.
+ */
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <Arduino.h>
+#include "Fec.h"
+
+struct TdmaSlot {
+    uint8_t     id;
+    uint16_t    startMs;
+    uint16_t    lenMs;
+};
+
+/// Node view of the current superframe, rebuilt from every beacon heard.
+class TdmaSchedule {
+public:
+    static constexpr uint8_t    UPLINK          = 0;
+    static constexpr uint8_t    MAX_SLOTS       = 8;
+    static constexpr uint8_t    SYNC_FRAMES     = 3;
+
+    explicit TdmaSchedule(uint8_t id, uint32_t baud = 9600);
+
+    /// Parse an '@' beacon line whose last byte arrived at 'rxUs', or up to
+    /// 'jitterUs' earlier (a polled UART only sees it once per loop).
+    bool parseBeacon(const char* line, uint32_t rxUs, uint32_t jitterUs = 0);
+
+    /// A beacon was heard within the last SYNC_FRAMES superframes.
+    bool synced(uint32_t nowUs) const;
+
+    /// 'nowUs' falls inside slot 'id' (late by up to 'lateUs' is accepted).
+    bool inSlot(uint8_t id, uint32_t nowUs, uint32_t lateUs = 0) const;
+
+    /// Time left in this node's own slot, 0 outside it. Ends early by the
+    /// beacon jitter so a late timestamp cannot spill into the next slot.
+    uint32_t remainingUs(uint32_t nowUs) const;
+
+    /// Superframe number of the slot 'nowUs' falls in (missed beacons counted).
+    uint32_t frameIndex(uint32_t nowUs) const;
+
+    /// Strip an "<id>:" address. Returns the payload, or nullptr when the
+    /// line is addressed to another rover.
+    static char* route(char* line, uint8_t id);
+
+    /// The id from a "node=<id>" line in a config file's text (rover.cfg),
+    /// or 'fallback' when there is none. Lets one image serve every rover.
+    static uint8_t configId(const char* text, uint8_t fallback);
+
+    void        setId(uint8_t id)   { _id = id; }
+    uint8_t     id() const          { return _id; }
+    uint32_t    byteUs() const      { return _byteUs; }
+    uint16_t    frameMs() const     { return _frameMs; }
+    uint32_t    beacons() const     { return _beacons; }
+    const TdmaSlot* slot(uint8_t id) const;
+
+private:
+    uint32_t    offsetUs(uint32_t nowUs) const;
+
+    uint8_t     _id;
+    uint32_t    _byteUs;
+    uint32_t    _frameStartUs   = 0;
+    uint32_t    _jitterUs       = 0;
+    uint32_t    _frames         = 0;    // frame count at _frameStartUs
+    uint16_t    _frameMs        = 0;
+    TdmaSlot    _slots[MAX_SLOTS];
+    uint8_t     _numSlots       = 0;
+    uint32_t    _beacons        = 0;
+};
+
+/// Line-oriented radio output that keeps to the node's slot. Lines are
+/// queued whole and only started when they will finish inside the slot;
+/// nothing ever blocks. Unsynced the queue drains as fast as the UART
+/// takes it, so the queue depth shows how far the link is behind (the
+/// telemetry rate controller backs off on it). With FEC on, each line
+/// goes out as one frame and is sized as such.
+class TdmaLink {
+public:
+    typedef void (*LineHandler)(const char* line);
+
+    TdmaLink(Stream& radio, TdmaSchedule& schedule, uint8_t* queue, size_t size,
+             uint16_t uartTxCapacity = 64);
+
+    /// Queue one line (a newline is added). When the queue is full the
+    /// oldest lines are dropped to make room.
+    void send(const char* line);
+
+    /// One short line that goes ahead of the queue at the next chance
+    /// (status events). Returns false while the previous one is waiting.
+    bool sendUrgent(const char* line);
+    bool urgentIdle() const         { return _urgentLen == 0; }
+
+    /// Call every loop: listens for beacons and feeds the UART.
+    void poll();
+
+    /// Lines heard that are not beacons (e.g. event acks) go to 'handler'.
+    void onLine(LineHandler handler)    { _handler = handler; }
+
+    /// Send lines (and slot reports) as FEC frames from now on.
+    void setFec(bool on)            { _fecTx = on; }
+    bool fecEnabled() const         { return _fecTx; }
+
+    /// Receive side: frames heard (beacons), corrected and lost.
+    const FecDecoder& fec() const   { return _fec; }
+
+    size_t      queued() const      { return _count; }
+    size_t      capacity() const    { return _size; }
+    size_t      highWater() const   { return _highWater; }
+    uint32_t    dropped() const     { return _dropped; }
+    uint32_t    linesSent() const   { return _linesSent; }
+
+private:
+    void        listen(uint32_t nowUs);
+    void        pump(uint32_t nowUs);
+    void        drain();
+    bool        writeLine();
+    void        stageFrame(size_t len);
+    void        stageUrgent();
+    size_t      airBytes(size_t len) const;
+    size_t      headLength() const;
+    bool        push(const char* data, size_t n);
+    uint16_t    uartQueued();
+
+    Stream&         _radio;
+    TdmaSchedule&   _sched;
+    uint8_t*        _queue;
+    size_t          _size;
+    uint16_t        _txCapacity;
+    size_t          _head           = 0;
+    size_t          _count          = 0;
+    size_t          _highWater      = 0;
+    size_t          _inFlight       = 0;    // bytes of a started line still to write
+    uint32_t        _dropped        = 0;
+    uint32_t        _linesSent      = 0;
+    uint32_t        _reportedFrame  = 0xFFFFFFFF;
+    uint32_t        _lastPollUs     = 0;
+    char            _rx[64];
+    uint8_t         _rxLen          = 0;
+    LineHandler     _handler        = nullptr;
+    char            _urgent[64];
+    uint8_t         _urgentLen      = 0;
+    FecDecoder      _fec;
+    bool            _fecTx          = false;
+    uint8_t         _fecSeq         = 0;
+    uint8_t         _frame[fec::MAX_FRAME];     // frame being written
+    uint16_t        _frameLen       = 0;
+    uint16_t        _framePos       = 0;
+};
+
+/// Ground side: plans each superframe and writes its beacon.
+class TdmaCoordinator {
+public:
+    static constexpr uint8_t    MAX_NODES       = TdmaSchedule::MAX_SLOTS - 1;
+
+    /// Keep frameMs below the actuator failsafe (500 ms): the motor line is
+    /// sent once per superframe. 320 ms fits one full telemetry record.
+    TdmaCoordinator(uint16_t frameMs = 320, uint32_t baud = 9600, uint16_t guardMs = 12);
+
+    void addNode(uint8_t id);
+
+    /// The ground sends beacons as FEC frames: plan with frame airtimes.
+    void setFec(bool on)            { _fec = on; _beaconBytes = 0; }
+
+    /// Feed every line heard; slot reports update the queue estimates and
+    /// register nodes that were not configured.
+    void onLine(const char* line);
+
+    /// Plan the next superframe and write its beacon. Returns the length.
+    int beacon(char* out, size_t size, uint32_t uplinkBytes);
+
+    const TdmaSlot* slot(uint8_t id) const;
+    uint16_t    frameMs() const     { return _frameMs; }
+    uint16_t    seq() const         { return _seq; }
+    uint8_t     numNodes() const    { return _numNodes; }
+
+private:
+    struct NodeDemand { uint8_t id; float queued; };
+
+    uint16_t    _frameMs;
+    float       _byteMs;
+    uint16_t    _guardMs;
+    uint16_t    _seq            = 0;
+    uint16_t    _beaconBytes    = 0;
+    bool        _fec            = false;
+    NodeDemand  _nodes[MAX_NODES];
+    uint8_t     _numNodes       = 0;
+    TdmaSlot    _slots[TdmaSchedule::MAX_SLOTS];
+    uint8_t     _numSlots       = 0;
+};
+
+#endif // TDMA_H
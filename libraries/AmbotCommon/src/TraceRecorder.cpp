@@ -0,0 +1,31 @@
+#include "TraceRecorder.h"
+
+uint32_t TraceRecorder::drain(Print& out) {
+    out.printf("# trace node=%s clock_hz=%lu dropped=%lu\n", _node,
+               (unsigned long)F_CPU_ACTUAL, (unsigned long)_dropped);
+
+    // Snapshot the window first so events recorded while printing (e.g. by
+    // the SD write itself) are kept for the next drain.
+    uint32_t       primask  = maskIrq();
+    const uint32_t count    = _count;
+    const uint32_t recorded = _recorded;
+    uint32_t       idx      = (_head + _capacity - count) % _capacity;
+    restoreIrq(primask);
+    char           line[96];
+    for (uint32_t i = 0; i < count; i++) {
+        const TraceEvent& e = _ring[idx];
+        snprintf(line, sizeof(line), "%llu,%c,%u,%s,%ld\n", (unsigned long long)e.t, e.ph,
+                 (unsigned)e.track, e.name, (long)e.value);
+        out.print(line);
+        idx = (idx + 1 == _capacity) ? 0 : idx + 1;
+    }
+
+    // What was recorded meanwhile stays; once it fills the ring the excess
+    // overwrote itself and the window (printed as it was by then)
+    primask = maskIrq();
+    const uint32_t since = _recorded - recorded;
+    _count   = since < _capacity ? since : _capacity;
+    _dropped = since - _count;
+    restoreIrq(primask);
+    return count;
+}
@@ -0,0 +1,149 @@
+/**
+ * TIMELINE TRACE RECORDER
+ * Begin/end spans, instants and counters with a 64-bit cycle timestamp,
+ * written into a fixed RAM ring (flight-recorder semantics: when full the
+ * oldest events are overwritten and counted as dropped).
+ *
+ * Tracing is a build option: with TRACE_MODE undefined every TRACE_* macro
+ * compiles to nothing. With it defined the sketch provides one global
+ * 'TraceRecorder trace' (ring in DMAMEM) and drains it on demand:
+ *
+ *     # trace node=TLM clock_hz=600000000 dropped=0
+ *     <cycles>,<ph>,<track>,<name>,<value>        ph: B E I C, track: 0 loop, 1 ISR
+ *
+ * Tools/trace_to_perfetto.py turns one or more drains into a Chrome /
+ * Perfetto JSON timeline.
+ *
+ * TRACE_ISR events come from interrupt handlers, so recording (and the
+ * wrap extension in now()) runs with interrupts masked; the previous mask
+ * is restored, so it works from inside an ISR as well.
+ */
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+
+// Ring length in events (24 bytes each on the Teensy)
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 2048
+#endif
+
+struct TraceEvent {
+    uint64_t    t;          // CPU cycles since boot
+    const char* name;       // string literal
+    int32_t     value;
+    char        ph;         // 'B' begin, 'E' end, 'I' instant, 'C' counter
+    uint8_t     track;      // 0 main loop, 1 interrupt
+};
+
+class TraceRecorder {
+public:
+    static constexpr uint8_t TRACK_LOOP = 0;
+    static constexpr uint8_t TRACK_ISR  = 1;
+
+    TraceRecorder(const char* node, TraceEvent* ring, uint32_t capacity)
+        : _node(node), _ring(ring), _capacity(capacity) {}
+
+    /// 64-bit cycle count. The 32-bit DWT counter wraps every ~7 s at
+    /// 600 MHz, so something must be traced at least that often.
+    uint64_t now() {
+        const uint32_t primask = maskIrq();
+        const uint32_t low     = ARM_DWT_CYCCNT;
+        if (low < _lastLow) _high++;
+        _lastLow = low;
+        const uint64_t t = ((uint64_t)_high << 32) | low;
+        restoreIrq(primask);
+        return t;
+    }
+
+    void begin(const char* name, uint8_t track = TRACK_LOOP)                 { record(name, 'B', 0, track); }
+    void end(const char* name, uint8_t track = TRACK_LOOP)                   { record(name, 'E', 0, track); }
+    void instant(const char* name, int32_t v = 0, uint8_t track = TRACK_LOOP) { record(name, 'I', v, track); }
+    void counter(const char* name, int32_t v)                                { record(name, 'C', v, TRACK_LOOP); }
+
+    /// Print everything recorded since the last drain (oldest first) and
+    /// empty the ring. Works with USB Serial or an open SD file.
+    uint32_t drain(Print& out);
+
+    uint32_t size() const       { return _count; }
+    uint32_t capacity() const   { return _capacity; }
+    uint32_t dropped() const    { return _dropped; }
+
+private:
+    void record(const char* name, char ph, int32_t value, uint8_t track) {
+        const uint32_t primask = maskIrq();
+        TraceEvent&    e       = _ring[_head];
+        e.t     = now();
+        e.name  = name;
+        e.value = value;
+        e.ph    = ph;
+        e.track = track;
+        _head   = (_head + 1 == _capacity) ? 0 : _head + 1;
+        _recorded++;
+        if (_count < _capacity) _count++;
+        else                    _dropped++;
+        restoreIrq(primask);
+    }
+
+    // Returns the previous PRIMASK. On the host the "ISRs" run on the
+    // sketch's own thread, so there is nothing to mask.
+    static uint32_t maskIrq() {
+#ifdef __arm__
+        uint32_t primask;
+        __asm__ volatile("mrs %0, primask\n" : "=r"(primask)::"memory");
+        __disable_irq();
+        return primask;
+#else
+        return 0;
+#endif
+    }
+
+    static void restoreIrq(uint32_t primask) {
+#ifdef __arm__
+        if (!primask) __enable_irq();
+#else
+        (void)primask;
+#endif
+    }
+
+    const char*     _node;
+    TraceEvent*     _ring;
+    uint32_t        _capacity;
+    uint32_t        _head       = 0;
+    uint32_t        _count      = 0;
+    uint32_t        _dropped    = 0;
+    uint32_t        _recorded   = 0;    // ever, wraps
+    uint32_t        _lastLow    = 0;
+    uint32_t        _high       = 0;
+};
+
+// Closes a span when it goes out of scope.
+class TraceScope {
+public:
+    TraceScope(TraceRecorder& rec, const char* name) : _rec(rec), _name(name) { _rec.begin(_name); }
+    ~TraceScope() { _rec.end(_name); }
+
+private:
+    TraceRecorder&  _rec;
+    const char*     _name;
+};
+
+#ifdef TRACE_MODE
+    #define TRACE_BEGIN(name)           trace.begin(name)
+    #define TRACE_END(name)             trace.end(name)
+    #define TRACE_INSTANT(name, v)      trace.instant(name, v)
+    #define TRACE_ISR(name, v)          trace.instant(name, v, TraceRecorder::TRACK_ISR)
+    #define TRACE_COUNTER(name, v)      trace.counter(name, v)
+    #define TRACE_CAT2(a, b)            a##b
+    #define TRACE_CAT(a, b)             TRACE_CAT2(a, b)
+    #define TRACE_SCOPE(name)           TraceScope TRACE_CAT(_traceScope, __LINE__)(trace, name)
+#else
+    #define TRACE_BEGIN(name)           ((void)0)
+    #define TRACE_END(name)             ((void)0)
+    #define TRACE_INSTANT(name, v)      ((void)0)
+    #define TRACE_ISR(name, v)          ((void)0)
+    #define TRACE_COUNTER(name, v)      ((void)0)
+    #define TRACE_SCOPE(name)           ((void)0)
+#endif
+
+#endif // TRACE_RECORDER_H